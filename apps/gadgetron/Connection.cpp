@@ -37,6 +37,8 @@ namespace Gadgetron::Server::Connection {
     ) {
         auto pid = fork();
         if (pid == 0) {
+            // The connection has the process to itself, so all its threads are charged for the memory they allocate.
+            hoMemoryAccount::set_process(std::make_shared<hoMemoryAccount>());
             handle_connection(std::move(stream), paths, args, storage_address);
             std::quick_exit(0);
         }
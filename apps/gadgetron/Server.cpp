@@ -37,6 +37,11 @@ Server::Server(
 
         GINFO_STREAM("Accepted connection from: " << socket->remote_endpoint().address());
 
-        Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(std::move(socket)));
+        Connection::handle(
+                paths,
+                args,
+                storage_address,
+                Gadgetron::Connection::stream_from_socket(std::move(socket), args["socket_buffer_size"].as<size_t>())
+        );
     }
 }
@@ -10,6 +10,7 @@
 #include "HeaderConnection.h"
 #include "config/Config.h"
 
+#include "io/compression.h"
 #include "io/primitives.h"
 #include "Context.h"
 #include "MessageID.h"
@@ -91,6 +92,20 @@ namespace {
         }
     };
 
+    class CompressionHandler : public Handler {
+    public:
+        void handle(std::istream &stream, Gadgetron::Core::OutputChannel &) override {
+            auto peer_codecs = read_string_from_stream<uint64_t>(stream);
+            auto tolerance = read<float>(stream);
+
+            auto compression = negotiate_compression(peer_codecs, tolerance);
+            GINFO_STREAM("Compressing array data; tolerance: " << compression.tolerance << ", deflate: " << compression.deflate);
+
+            // The peer expects compressed data in both directions from here on.
+            set_compression(stream, compression);
+        }
+    };
+
     class ConfigStreamContext {
     public:
         Gadgetron::Core::optional<Config> config;
@@ -113,6 +128,7 @@ namespace {
         handlers[HEADER]   = std::make_unique<ErrorProducingHandler>("Received ISMRMRD header before config file.");
         handlers[QUERY]    = std::make_unique<QueryHandler>();
         handlers[CLOSE]    = std::make_unique<CloseHandler>(close);
+        handlers[COMPRESSION] = std::make_unique<CompressionHandler>();
 
         return handlers;
     }
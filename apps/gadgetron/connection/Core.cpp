@@ -2,6 +2,7 @@
 #include "Core.h"
 
 #include "ConfigConnection.h"
+#include "connection/core/Metrics.h"
 #include "Writers.h"
 
 namespace {
@@ -44,6 +45,15 @@ namespace {
         stream.write(reinterpret_cast<char *>(&close), sizeof(close));
     }
 
+    void log_memory_statistics(const Gadgetron::hoMemoryAccount &account) {
+        auto stats = account.statistics();
+        if (!stats.allocations) return;
+
+        GINFO_STREAM("Memory pool: " << stats.allocations << " allocations, "
+                                     << int(100 * stats.hit_rate()) << "% reused, "
+                                     << (stats.peak_bytes_in_use >> 20) << " MiB peak");
+    }
+
 }
 
 
@@ -59,6 +69,20 @@ namespace Gadgetron::Server::Connection {
         stream->exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
         ErrorSender sender;
 
+        // A forked connection is charged through the process account; otherwise, threads started for the connection
+        // and tasks it submits to the thread pool carry its account.
+        auto memory = hoMemoryAccount::process();
+        if (!memory) memory = std::make_shared<hoMemoryAccount>();
+        hoMemoryAccount::Scope memory_scope(memory);
+
+        if (args.count("metrics_dir")) {
+            Metrics::enable(
+                    args["metrics_dir"].as<boost::filesystem::path>(),
+                    std::chrono::seconds(args["metrics_interval"].as<unsigned int>())
+            );
+            Metrics::memory(memory);
+        }
+
         ErrorHandler error_handler(sender, "Connection Main Thread");
 
         error_handler.handle([&]() {
@@ -74,6 +98,8 @@ namespace Gadgetron::Server::Connection {
         }
         catch (...) {}
 
+        log_memory_statistics(*memory);
+        Metrics::write();
         GINFO_STREAM("Connection state: [FINISHED]");
     }
 
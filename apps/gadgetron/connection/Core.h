@@ -10,6 +10,7 @@
 #include "Channel.h"
 #include "Context.h"
 #include "Address.h"
+#include "hoMemoryPool.h"
 
 namespace Gadgetron::Server::Connection {
 
@@ -69,10 +70,13 @@ namespace Gadgetron::Server::Connection {
 
         template<class F, class... ARGS>
         std::thread run(F fn, ARGS &&... args) {
+            // Memory allocated on the new thread is charged to the same account as memory allocated on this one.
             return std::thread(
-                    []( auto handler, auto fn, auto &&... iargs) {
+                    []( auto account, auto handler, auto fn, auto &&... iargs) {
+                        hoMemoryAccount::Scope scope(std::move(account));
                         handler.handle(fn, std::forward<ARGS>(iargs)...);
                     },
+                    hoMemoryAccount::current(),
                     *this,
                     std::forward<F>(fn),
                     std::forward<ARGS>(args)...
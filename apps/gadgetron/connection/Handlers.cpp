@@ -4,6 +4,7 @@
 
 #include "system_info.h"
 
+#include "io/compression.h"
 #include "io/primitives.h"
 #include "Response.h"
 
@@ -54,6 +55,7 @@ namespace {
         answers["gadgetron::cuda::runtime"]      = Info::CUDA::cuda_runtime_version;
         answers["gadgetron::cuda::memory"]       = cuda_memory;
         answers["gadgetron::cuda::capabilities"] = cuda_capabilities;
+        answers["gadgetron::compression"]        = Gadgetron::Core::IO::supported_codecs;
     }
 }
 
@@ -21,10 +21,11 @@ namespace {
 
     class SocketStreamBuf : public std::streambuf {
     public:
-        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = 1024);
+        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size);
 
     protected:
         std::streamsize xsputn(const char_type* data, std::streamsize length) override;
+        std::streamsize xsgetn(char_type* data, std::streamsize length) override;
 
         int sync() override;
         int underflow() override;
@@ -48,6 +49,25 @@ namespace {
         this->setg(this->eback(), this->eback(), this->eback() + elements_read);
         return traits_type::to_int_type(*this->gptr());
     }
+    std::streamsize SocketStreamBuf::xsgetn(char_type* data, std::streamsize length) {
+        auto buffered = std::min<std::streamsize>(length, std::distance(this->gptr(), this->egptr()));
+        std::copy_n(this->gptr(), buffered, data);
+        this->setg(this->eback(), this->gptr() + buffered, this->egptr());
+
+        auto remaining = length - buffered;
+        if (remaining == 0) return length;
+
+        // Small reads go through the buffer, to avoid a system call per header field.
+        if (remaining < static_cast<std::streamsize>(Gadgetron::Connection::direct_read_threshold))
+            return buffered + std::streambuf::xsgetn(data + buffered, remaining);
+
+        // Large reads, such as acquisition or image data, are received straight into the destination. A peer closing
+        // or resetting the connection ends the read short, which the stream reports as a failed read.
+        boost::system::error_code error;
+        auto received = boost::asio::read(*socket, boost::asio::buffer(data + buffered, remaining), error);
+        return buffered + static_cast<std::streamsize>(received);
+    }
+
     int SocketStreamBuf::overflow(int ch) {
         if (this->pptr() != this->pbase()) {
             boost::asio::write(*socket, boost::asio::buffer(this->pbase(), std::distance(this->pbase(), this->pptr())));
@@ -73,14 +93,14 @@ namespace {
     using namespace Gadgetron::Connection;
     class SocketStream : public std::iostream {
     public:
-        explicit SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket)
-            : std::iostream(new SocketStreamBuf(std::move(socket))) {
+        explicit SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size)
+            : std::iostream(new SocketStreamBuf(std::move(socket), buffer_size)) {
             buffer = std::unique_ptr<SocketStreamBuf>(static_cast<SocketStreamBuf*>(this->rdbuf()));
         }
 
-        SocketStream(const std::string& host, const std::string& service,
+        SocketStream(const std::string& host, const std::string& service, size_t buffer_size,
             std::shared_ptr<boost::asio::io_service> io_service = std::make_shared<boost::asio::io_service>())
-            : SocketStream(connect_socket(host, service, *io_service)) {
+            : SocketStream(connect_socket(host, service, *io_service), buffer_size) {
             this->io_service = io_service;
         }
 
@@ -94,11 +114,11 @@ namespace {
 
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::stream_from_socket(
-    std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
-    return std::make_unique<SocketStream>(std::move(socket));
+    std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size) {
+    return std::make_unique<SocketStream>(std::move(socket), buffer_size);
 }
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::remote_stream(
-    const std::string& host, const std::string& service) {
-    return std::make_unique<SocketStream>(host, service);
+    const std::string& host, const std::string& service, size_t buffer_size) {
+    return std::make_unique<SocketStream>(host, service, buffer_size);
 }
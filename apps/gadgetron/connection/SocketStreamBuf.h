@@ -5,6 +5,20 @@
 
 namespace Gadgetron::Connection {
 
-    std::unique_ptr<std::iostream> stream_from_socket(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
-    std::unique_ptr<std::iostream> remote_stream(const std::string & host, const std::string& service);
+    /// Size of the stream buffers.
+    constexpr size_t default_socket_buffer_size = 64 * 1024;
+
+    /// Reads of at least this many bytes, whatever the buffer size, bypass the buffer and go straight from the socket
+    /// into the destination; for acquisition and image data, the array storage of the reader.
+    constexpr size_t direct_read_threshold = 4 * 1024;
+
+    std::unique_ptr<std::iostream> stream_from_socket(
+            std::unique_ptr<boost::asio::ip::tcp::socket> socket,
+            size_t buffer_size = default_socket_buffer_size
+    );
+    std::unique_ptr<std::iostream> remote_stream(
+            const std::string & host,
+            const std::string& service,
+            size_t buffer_size = default_socket_buffer_size
+    );
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
 
 #include <boost/range/algorithm/transform.hpp>
 #include <boost/range/algorithm/count_if.hpp>
@@ -120,12 +123,22 @@ namespace {
             return parallel_node;
         }
 
+        static void add_compression(const optional<float> &compression, pugi::xml_node &node) {
+            if (!compression) return;
+            if (*compression == 0) {
+                node.append_attribute("compression").set_value("lossless");
+            } else {
+                node.append_attribute("compression").set_value(*compression);
+            }
+        }
+
         static pugi::xml_node add_node(const Config::Distributed &distributed, pugi::xml_node &node) {
             auto distributed_node = node.append_child("distributed");
             add_readers(distributed.readers, distributed_node);
             add_writers(distributed.writers, distributed_node);
             add_node(distributed.distributor, distributed_node);
             add_node(distributed.stream, distributed_node);
+            add_compression(distributed.compression, distributed_node);
 
             return distributed_node;
         }
@@ -146,6 +159,8 @@ namespace {
         static pugi::xml_node add_node(const Config::External &external, pugi::xml_node &node) {
 
             auto external_node = node.append_child("external");
+            if (external.shared_memory)
+                external_node.append_attribute("transport").set_value("shared-memory");
 
             add_readers(external.readers, external_node);
             add_writers(external.writers, external_node);
@@ -161,6 +176,12 @@ namespace {
         static pugi::xml_node add_node(const Config::Stream &stream, pugi::xml_node &node) {
             auto stream_node = node.append_child("stream");
             stream_node.append_attribute("key").set_value(stream.key.c_str());
+            if (stream.capacity)
+                stream_node.append_attribute("capacity").set_value((long long unsigned int)*stream.capacity);
+            if (stream.batch) {
+                stream_node.append_attribute("batch").set_value((long long unsigned int)*stream.batch);
+                stream_node.append_attribute("batch_window").set_value((long long unsigned int)stream.batch_window.count());
+            }
             for (auto n : stream.nodes) {
                 visit([&stream_node](auto &typed_node) { add_node(typed_node, stream_node); }, n);
             }
@@ -184,9 +205,12 @@ namespace {
 
         static pugi::xml_node add_node(const Config::PureDistributed& distributed, pugi::xml_node& node){
             auto puredistributed_node = node.append_child("puredistributed");
+            puredistributed_node.append_attribute("jobs_per_worker").set_value((long long unsigned int)distributed.jobs_per_worker);
+            puredistributed_node.append_attribute("retries").set_value((long long unsigned int)distributed.retries);
             add_readers(distributed.readers,puredistributed_node);
             add_writers(distributed.writers,puredistributed_node);
             add_node(distributed.stream,puredistributed_node);
+            add_compression(distributed.compression, puredistributed_node);
             return puredistributed_node;
         }
     };
@@ -506,16 +530,34 @@ namespace {
                 parse_action(external_node),
                 parse_action_configuration(external_node),
                 parse_readers(external_node.child("readers")),
-                parse_writers(external_node.child("writers"))
+                parse_writers(external_node.child("writers")),
+                parse_transport(external_node)
             };
         }
 
+        static bool parse_transport(const pugi::xml_node &external_node) {
+            std::string transport = external_node.attribute("transport").value();
+            if (transport.empty() || transport == "socket") return false;
+            if (transport == "shared-memory") return true;
+            throw ConfigNodeError("Unknown external transport: " + transport, external_node);
+        }
+
         Config::Distributed parse_distributed(const pugi::xml_node &distributed_node) {
             auto distributor = parse_node<Config::Distributor>(distributed_node.child("distributor"));
             auto stream = parse_stream(distributed_node.child("stream"));
             auto readers = parse_readers(distributed_node.child("readers"));
             auto writers = parse_writers(distributed_node.child("writers"));
-            return {readers,writers,distributor,stream};
+            return {readers,writers,distributor,stream,parse_compression(distributed_node)};
+        }
+
+        static optional<float> parse_compression(const pugi::xml_node &node) {
+            std::string compression = node.attribute("compression").value();
+            if (compression.empty()) return none;
+            if (compression == "lossless") return 0.0f;
+
+            float tolerance = std::stof(compression);
+            if (!(tolerance > 0)) throw ConfigNodeError("Compression tolerance must be positive, or 'lossless'", node);
+            return tolerance;
         }
 
         Config::Stream parse_stream(const pugi::xml_node &stream_node) {
@@ -523,7 +565,52 @@ namespace {
             for (auto &node : stream_node.children()) {
                 nodes.push_back(node_parsers.at(node.name())(node));
             }
-            return Config::Stream{stream_node.attribute("key").value(), nodes};
+            auto stream = Config::Stream{stream_node.attribute("key").value(), nodes, parse_capacity(stream_node)};
+            parse_batching(stream, stream_node);
+            return stream;
+        }
+
+        static size_t parse_integer(const pugi::xml_attribute &attribute, const pugi::xml_node &node, bool allow_zero) {
+            std::string value = attribute.value();
+            auto error = ConfigNodeError(
+                    std::string("Attribute '") + attribute.name() + "' must be a " +
+                    (allow_zero ? "non-negative" : "positive") + " integer, got '" + value + "'",
+                    node);
+
+            if (value.empty() || !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); }))
+                throw error;
+
+            try {
+                size_t result = std::stoull(value);
+                if (result == 0 && !allow_zero) throw error;
+                return result;
+            } catch (const std::out_of_range &) {
+                throw error;
+            }
+        }
+
+        static size_t parse_positive_integer(const pugi::xml_attribute &attribute, const pugi::xml_node &node) {
+            return parse_integer(attribute, node, false);
+        }
+
+        static size_t parse_non_negative_integer(const pugi::xml_attribute &attribute, const pugi::xml_node &node) {
+            return parse_integer(attribute, node, true);
+        }
+
+        static optional<size_t> parse_capacity(const pugi::xml_node &stream_node) {
+            auto capacity = stream_node.attribute("capacity");
+            if (!capacity) return none;
+            return parse_positive_integer(capacity, stream_node);
+        }
+
+        static void parse_batching(Config::Stream &stream, const pugi::xml_node &stream_node) {
+            auto batch = stream_node.attribute("batch");
+            if (!batch) return;
+
+            stream.batch = parse_positive_integer(batch, stream_node);
+
+            if (auto window = stream_node.attribute("batch_window"))
+                stream.batch_window = std::chrono::microseconds(parse_non_negative_integer(window, stream_node));
         }
 
         Config::PureStream parse_purestream(const pugi::xml_node &purestream_node){
@@ -544,7 +631,14 @@ namespace {
             auto purestream = parse_purestream(puredistributedprocess_node.child("purestream"));
             auto readers = parse_readers(puredistributedprocess_node.child("readers"));
             auto writers = parse_writers(puredistributedprocess_node.child("writers"));
-            return {readers,writers,purestream};
+
+            Config::PureDistributed config{readers,writers,purestream};
+            if (auto jobs_per_worker = puredistributedprocess_node.attribute("jobs_per_worker"))
+                config.jobs_per_worker = parse_positive_integer(jobs_per_worker, puredistributedprocess_node);
+            if (auto retries = puredistributedprocess_node.attribute("retries"))
+                config.retries = parse_non_negative_integer(retries, puredistributedprocess_node);
+            config.compression = parse_compression(puredistributedprocess_node);
+            return config;
         }
 
         static optional<std::string> parse_target(std::string s) {
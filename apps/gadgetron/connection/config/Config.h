@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -35,6 +36,12 @@ namespace Gadgetron::Server::Connection {
         struct Stream {
             std::string key;
             std::vector<Node> nodes;
+            // Maximum number of messages buffered between two nodes; unbounded if not set.
+            Core::optional<size_t> capacity = Core::none;
+            // Messages handed between nodes in batches of batch messages, or whatever arrived within batch_window.
+            // Both are attributes of the stream element; batch_window is given in microseconds.
+            Core::optional<size_t> batch = Core::none;
+            std::chrono::microseconds batch_window = std::chrono::milliseconds(5);
         };
 
         struct PureStream{
@@ -70,6 +77,9 @@ namespace Gadgetron::Server::Connection {
 
             std::vector<Reader> readers;
             std::vector<Writer> writers;
+
+            // Offer local peers to exchange messages through shared memory rather than the socket.
+            bool shared_memory = false;
         };
 
         struct Branch : Gadget { using Gadget::Gadget;};
@@ -85,6 +95,9 @@ namespace Gadgetron::Server::Connection {
             std::vector<Reader> readers;
             std::vector<Writer> writers;
             PureStream stream;
+            size_t jobs_per_worker = 4;
+            size_t retries = 2;
+            Core::optional<float> compression;
         };
 
         struct ParallelProcess {
@@ -99,6 +112,7 @@ namespace Gadgetron::Server::Connection {
             std::vector<Writer> writers;
             Distributor distributor;
             Stream stream;
+            Core::optional<float> compression;
         };
 
         std::vector<Reader> readers;
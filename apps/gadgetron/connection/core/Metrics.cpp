@@ -0,0 +1,285 @@
+#include "Metrics.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "log.h"
+
+#if _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    using namespace Gadgetron::Core;
+    namespace fs = boost::filesystem;
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<NodeMetrics>> nodes;
+        std::map<std::string, std::shared_ptr<NodeMetrics>> by_path;
+        std::vector<std::shared_ptr<const Gadgetron::hoMemoryAccount>> accounts;
+
+        std::atomic<bool> enabled{ false };
+        fs::path directory;
+
+        // Held while the files are written or removed, so the writer thread cannot recreate them at exit.
+        std::mutex file_mutex;
+        bool removed = false;
+    };
+
+    Registry &registry() {
+        static Registry registry;
+        return registry;
+    }
+
+    std::vector<std::shared_ptr<NodeMetrics>> snapshot() {
+        auto &state = registry();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        return state.nodes;
+    }
+
+    std::vector<Gadgetron::hoMemoryStatistics> memory_snapshot() {
+        auto &state = registry();
+        std::lock_guard<std::mutex> guard(state.mutex);
+
+        std::vector<Gadgetron::hoMemoryStatistics> statistics;
+        for (auto &account : state.accounts) statistics.push_back(account->statistics());
+        return statistics;
+    }
+
+    std::string escape(const std::string &str) {
+        std::string result;
+        for (auto c : str) {
+            if (c == '"' || c == '\\') result.push_back('\\');
+            if (c == '\n') { result += "\\n"; continue; }
+            result.push_back(c);
+        }
+        return result;
+    }
+
+    void write_json_histogram(std::ostream &stream, const DurationHistogram &histogram) {
+        stream << "{\"count\": " << histogram.count() << ", \"sum\": " << histogram.sum() << ", \"buckets\": [";
+        for (size_t b = 0; b < DurationHistogram::number_of_buckets; b++) {
+            stream << (b ? ", " : "") << histogram.bucket_count(b);
+        }
+        stream << "]}";
+    }
+
+    template<class F>
+    void write_file(const fs::path &file, F writer) {
+        auto temporary = fs::path(file).concat(".tmp");
+        {
+            std::ofstream stream(temporary.string());
+            writer(stream);
+        }
+        fs::rename(temporary, file);
+    }
+
+    fs::path file_base(const Registry &state) {
+        return state.directory / ("gadgetron-" + std::to_string(getpid()));
+    }
+
+    void remove_files() {
+        auto &state = registry();
+        std::lock_guard<std::mutex> guard(state.file_mutex);
+        state.removed = true;
+
+        boost::system::error_code ignored;
+        fs::remove(file_base(state).concat(".json"), ignored);
+        fs::remove(file_base(state).concat(".prom"), ignored);
+    }
+}
+
+namespace Gadgetron::Server::Connection::Metrics {
+
+    void enable(const boost::filesystem::path &directory, std::chrono::seconds interval) {
+        auto &state = registry();
+        {
+            std::lock_guard<std::mutex> guard(state.mutex);
+            if (state.enabled) return;
+            state.directory = directory;
+            state.enabled = true;
+        }
+
+        fs::create_directories(directory);
+
+        // Connection processes end with quick_exit; the files of a process are of no use once it is gone.
+        std::atexit(remove_files);
+        std::at_quick_exit(remove_files);
+
+        // With no interval, the metrics are only written when the connection closes.
+        if (interval.count() <= 0) return;
+
+        std::thread([=]() {
+            while (true) {
+                std::this_thread::sleep_for(interval);
+                write();
+            }
+        }).detach();
+    }
+
+    bool enabled() {
+        return registry().enabled;
+    }
+
+    std::shared_ptr<Core::NodeMetrics> node(const std::string &path) {
+        auto &state = registry();
+        if (!state.enabled) return nullptr;
+
+        std::lock_guard<std::mutex> guard(state.mutex);
+        auto &metrics = state.by_path[path];
+        if (!metrics) {
+            metrics = std::make_shared<NodeMetrics>(path);
+            state.nodes.push_back(metrics);
+        }
+        return metrics;
+    }
+
+    void memory(std::shared_ptr<const hoMemoryAccount> account) {
+        auto &state = registry();
+        if (!state.enabled || !account) return;
+
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.accounts.push_back(std::move(account));
+    }
+
+    void write() {
+        auto &state = registry();
+        if (!state.enabled) return;
+
+        std::lock_guard<std::mutex> guard(state.file_mutex);
+        if (state.removed) return;
+
+        auto base = file_base(state);
+        try {
+            write_file(fs::path(base).concat(".json"), write_json);
+            write_file(fs::path(base).concat(".prom"), write_prometheus);
+        } catch (const std::exception &e) {
+            GWARN_STREAM("Failed to write metrics to " << state.directory << ": " << e.what());
+        }
+    }
+
+    void write_json(std::ostream &stream) {
+        auto nodes = snapshot();
+
+        stream << "{\"pid\": " << getpid() << ", \"nodes\": [";
+        for (size_t i = 0; i < nodes.size(); i++) {
+            auto &metrics = nodes[i];
+
+            stream << (i ? ", " : "") << "{";
+            stream << "\"node\": \"" << escape(metrics->path) << "\", ";
+            stream << "\"messages_in\": " << metrics->messages_in << ", ";
+            stream << "\"bytes_in\": " << metrics->bytes_in << ", ";
+            stream << "\"messages_out\": " << metrics->messages_out << ", ";
+            stream << "\"bytes_out\": " << metrics->bytes_out << ", ";
+            stream << "\"queue_depth\": " << metrics->queue_depth << ", ";
+            stream << "\"max_queue_depth\": " << metrics->max_queue_depth << ", ";
+            stream << "\"wait_seconds\": " << metrics->wait_ns * 1e-9 << ", ";
+            stream << "\"processing_seconds\": ";
+            write_json_histogram(stream, metrics->processing_time);
+            stream << ", \"task_seconds\": ";
+            write_json_histogram(stream, metrics->task_time);
+            stream << "}";
+        }
+        stream << "], \"memory\": [";
+
+        auto memory = memory_snapshot();
+        for (size_t i = 0; i < memory.size(); i++) {
+            stream << (i ? ", " : "") << "{";
+            stream << "\"connection\": " << i << ", ";
+            stream << "\"allocations\": " << memory[i].allocations << ", ";
+            stream << "\"pool_hits\": " << memory[i].pool_hits << ", ";
+            stream << "\"bytes_in_use\": " << memory[i].bytes_in_use << ", ";
+            stream << "\"peak_bytes_in_use\": " << memory[i].peak_bytes_in_use;
+            stream << "}";
+        }
+        stream << "]}" << std::endl;
+    }
+
+    void write_prometheus(std::ostream &stream) {
+        auto nodes = snapshot();
+        auto pid = std::to_string(getpid());
+
+        auto labels = [&](const std::string &path) {
+            return "pid=\"" + pid + "\",node=\"" + escape(path) + "\"";
+        };
+
+        auto series = [&](const std::string &name, const std::string &type, const std::string &help, auto value) {
+            stream << "# HELP gadgetron_node_" << name << " " << help << "\n";
+            stream << "# TYPE gadgetron_node_" << name << " " << type << "\n";
+            for (auto &metrics : nodes) {
+                stream << "gadgetron_node_" << name << "{" << labels(metrics->path) << "} " << value(*metrics) << "\n";
+            }
+        };
+
+        series("messages_in_total", "counter", "Messages taken from the input of the node.",
+               [](auto &m) { return m.messages_in.load(); });
+        series("bytes_in_total", "counter", "Approximate bytes taken from the input of the node.",
+               [](auto &m) { return m.bytes_in.load(); });
+        series("messages_out_total", "counter", "Messages pushed to the output of the node.",
+               [](auto &m) { return m.messages_out.load(); });
+        series("bytes_out_total", "counter", "Approximate bytes pushed to the output of the node.",
+               [](auto &m) { return m.bytes_out.load(); });
+        series("wait_seconds_total", "counter", "Time the node has spent waiting for input.",
+               [](auto &m) { return m.wait_ns.load() * 1e-9; });
+        series("queue_depth", "gauge", "Messages waiting at the input of the node.",
+               [](auto &m) { return m.queue_depth.load(); });
+        series("max_queue_depth", "gauge", "Largest number of messages seen waiting at the input of the node.",
+               [](auto &m) { return m.max_queue_depth.load(); });
+
+        auto histogram = [&](const std::string &name, const std::string &help, auto value) {
+            stream << "# HELP gadgetron_node_" << name << " " << help << "\n";
+            stream << "# TYPE gadgetron_node_" << name << " histogram\n";
+            for (auto &metrics : nodes) {
+                const DurationHistogram &time = value(*metrics);
+                auto node_labels = labels(metrics->path);
+
+                uint64_t cumulative = 0;
+                for (size_t b = 0; b < DurationHistogram::number_of_buckets - 1; b++) {
+                    cumulative += time.bucket_count(b);
+                    stream << "gadgetron_node_" << name << "_bucket{" << node_labels
+                           << ",le=\"" << DurationHistogram::upper_bound(b) << "\"} " << cumulative << "\n";
+                }
+                cumulative += time.bucket_count(DurationHistogram::number_of_buckets - 1);
+                stream << "gadgetron_node_" << name << "_bucket{" << node_labels << ",le=\"+Inf\"} " << cumulative << "\n";
+                stream << "gadgetron_node_" << name << "_sum{" << node_labels << "} " << time.sum() << "\n";
+                stream << "gadgetron_node_" << name << "_count{" << node_labels << "} " << cumulative << "\n";
+            }
+        };
+
+        histogram("processing_seconds", "Time between the node taking a message and asking for the next one.",
+                  [](auto &m) -> const DurationHistogram & { return m.processing_time; });
+        histogram("task_seconds", "Time spent on individual messages by nodes processing messages concurrently.",
+                  [](auto &m) -> const DurationHistogram & { return m.task_time; });
+
+        auto memory = memory_snapshot();
+        auto memory_series = [&](const std::string &name, const std::string &type, const std::string &help, auto value) {
+            stream << "# HELP gadgetron_memory_" << name << " " << help << "\n";
+            stream << "# TYPE gadgetron_memory_" << name << " " << type << "\n";
+            for (size_t i = 0; i < memory.size(); i++) {
+                stream << "gadgetron_memory_" << name << "{pid=\"" << pid << "\",connection=\"" << i << "\"} "
+                       << value(memory[i]) << "\n";
+            }
+        };
+
+        memory_series("allocations_total", "counter", "Array allocations by the connection through the memory pool.",
+                      [](auto &m) { return m.allocations; });
+        memory_series("pool_hits_total", "counter", "Allocations served from memory already held by the pool.",
+                      [](auto &m) { return m.pool_hits; });
+        memory_series("bytes_in_use", "gauge", "Bytes allocated by the connection and not yet released.",
+                      [](auto &m) { return m.bytes_in_use; });
+        memory_series("peak_bytes_in_use", "gauge", "Largest number of bytes the connection has had in use.",
+                      [](auto &m) { return m.peak_bytes_in_use; });
+        stream.flush();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+#include "NodeMetrics.h"
+#include "hoMemoryPool.h"
+
+namespace Gadgetron::Server::Connection::Metrics {
+
+    /**
+     * Starts recording metrics for the nodes of this process, and writes them to directory every interval,
+     * as gadgetron-<pid>.json and gadgetron-<pid>.prom (Prometheus text format, suitable for the node exporter
+     * textfile collector). Connections are usually handled in processes of their own, so every connection gets its
+     * own files. The files are removed when the process exits, so only running processes are reported.
+     * An interval of zero only writes the metrics when write() is called, as it is when a connection closes.
+     * Calling enable again in the same process has no effect.
+     */
+    void enable(const boost::filesystem::path &directory, std::chrono::seconds interval);
+
+    bool enabled();
+
+    /**
+     * The metrics of the node at path, or nullptr if metrics are disabled.
+     * Nodes with the same path share their metrics.
+     */
+    std::shared_ptr<Core::NodeMetrics> node(const std::string &path);
+
+    /**
+     * Reports the memory account of a connection of this process with the node metrics: allocations, pool hits,
+     * bytes in use and peak bytes in use. Connections are numbered in the order they are reported.
+     */
+    void memory(std::shared_ptr<const hoMemoryAccount> account);
+
+    /// Writes the current metrics to the metrics directory, if enabled.
+    void write();
+
+    void write_json(std::ostream &stream);
+    void write_prometheus(std::ostream &stream);
+}
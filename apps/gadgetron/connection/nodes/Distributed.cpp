@@ -10,6 +10,8 @@
 
 #include "io/iostream_operators.h"
 
+#include "connection/core/Metrics.h"
+
 namespace {
     using namespace Gadgetron;
     using namespace Gadgetron::Core;
@@ -68,13 +70,15 @@ namespace {
                 std::shared_ptr<Serialization> serialization,
                 std::shared_ptr<Configuration> configuration,
                 OutputChannel output_channel,
-                ErrorHandler& error_handler
+                ErrorHandler& error_handler,
+                std::shared_ptr<NodeMetrics> metrics
         );
 
     private:
         Address next_peer();
 
         OutputChannel output;
+        std::shared_ptr<NodeMetrics> metrics;
 
         std::shared_ptr<Serialization> serialization;
         std::shared_ptr<Configuration> configuration;
@@ -89,10 +93,12 @@ namespace {
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration,
             OutputChannel output_channel,
-            ErrorHandler &error_handler
+            ErrorHandler &error_handler,
+            std::shared_ptr<NodeMetrics> metrics
     ) : serialization(std::move(serialization)),
         configuration(std::move(configuration)),
         output(std::move(output_channel)),
+        metrics(std::move(metrics)),
         error_handler(error_handler, "Distributed") {
 
         auto ps = discover_peers();
@@ -102,9 +108,15 @@ namespace {
     OutputChannel ChannelCreatorImpl::create() {
 
         auto pair = Core::make_channel<MessageChannel>();
+        auto peer = next_peer();
+
+        if (metrics) {
+            auto peer_name = Core::visit([](auto &address) { return to_string(address); }, peer);
+            pair.input.instrument(Metrics::node(metrics->path + "/" + peer_name));
+        }
 
         auto channel = std::make_shared<ChannelWrapper>(
-                next_peer(),
+                peer,
                 serialization,
                 configuration
         );
@@ -155,7 +167,8 @@ namespace Gadgetron::Server::Connection::Nodes {
             serialization,
             configuration,
             Core::split(output),
-            error_handler
+            error_handler,
+            input.instrumentation()
         };
 
         distributor->process(std::move(input), channel_creator, std::move(output));
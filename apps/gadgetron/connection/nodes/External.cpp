@@ -2,6 +2,7 @@
 
 #include "common/Closer.h"
 #include "common/ExternalChannel.h"
+#include "common/SharedMemory.h"
 
 #include "connection/SocketStreamBuf.h"
 #include "connection/config/Config.h"
@@ -56,8 +57,12 @@ namespace Gadgetron::Server::Connection::Nodes {
 
     std::shared_ptr<ExternalChannel> External::open_connection(Config::Connect connect, const StreamContext &context) {
         GINFO_STREAM("Connecting to external module on address: " << connect.address << ":" << connect.port);
+
+        auto stream = Gadgetron::Connection::remote_stream(connect.address, connect.port);
+        if (shared_memory && is_local_address(connect.address)) stream = offer_shared_memory(std::move(stream));
+
         return std::make_shared<ExternalChannel>(
-                Gadgetron::Connection::remote_stream(connect.address, connect.port),
+                std::move(stream),
                 serialization,
                 configuration
         );
@@ -91,6 +96,8 @@ namespace Gadgetron::Server::Connection::Nodes {
         GINFO_STREAM("Connected to external module '" << execute.name << "' on port: " << port);
 
         auto stream = Gadgetron::Connection::stream_from_socket(std::move(socket));
+        if (shared_memory) stream = offer_shared_memory(std::move(stream));
+
         auto external_channel = std::make_shared<ExternalChannel>(
                 std::move(stream),
                 serialization,
@@ -114,7 +121,8 @@ namespace Gadgetron::Server::Connection::Nodes {
             const Config::External &config,
             const Core::StreamContext &context,
             Loader &loader
-    ) : serialization(std::make_shared<Serialization>(
+    ) : shared_memory(config.shared_memory),
+        serialization(std::make_shared<Serialization>(
                 loader.load_default_or_custom_readers(config),
                 loader.load_default_or_custom_writers(config)
         )),
@@ -43,6 +43,8 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         void monitor_child(std::shared_ptr<boost::process::child>, std::shared_ptr<boost::asio::ip::tcp::acceptor>);
 
+        const bool shared_memory;
+
         std::future<std::shared_ptr<ExternalChannel>> channel;
         std::shared_ptr<Serialization> serialization;
         std::shared_ptr<Configuration> configuration;
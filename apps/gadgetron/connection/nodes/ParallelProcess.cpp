@@ -8,18 +8,23 @@ namespace Gadgetron::Server::Connection::Nodes {
 
     void ParallelProcess::process_input(GenericInputChannel input, Queue &queue) {
 
-        ThreadPool pool(workers ? workers : std::thread::hardware_concurrency());
+        auto tasks = ThreadPool::global().make_group(workers);
+        auto metrics = input.instrumentation();
+
+        auto process_message = [&](auto message) {
+            if (!metrics) return pureStream.process_function(std::move(message));
+
+            auto start = std::chrono::steady_clock::now();
+            auto result = pureStream.process_function(std::move(message));
+            metrics->task_time.record(std::chrono::steady_clock::now() - start);
+            return result;
+        };
 
         for (auto message : input) {
-            queue.push(
-                pool.async(
-                        [&](auto message) { return pureStream.process_function(std::move(message)); },
-                        std::move(message)
-                )
-            );
+            queue.push(tasks.async(process_message, std::move(message)));
         }
 
-        pool.join(); queue.close();
+        tasks.wait(); queue.close();
     }
 
     void ParallelProcess::process_output(OutputChannel output, Queue &queue) {
@@ -63,7 +63,7 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         auto closer = make_closer(jobs);
 
-        auto workers = Pool(finish_connecting_to_peers(std::move(pending_workers)));
+        auto workers = Pool(finish_connecting_to_peers(std::move(pending_workers)), jobs_per_worker, retries);
 
         for (auto message : input) {
             jobs->push(workers.push(std::move(message)));
@@ -106,7 +106,9 @@ namespace Gadgetron::Server::Connection::Nodes {
         configuration(std::make_shared<Configuration>(
                 context,
                 config
-        )) {
+        )),
+        jobs_per_worker(config.jobs_per_worker),
+        retries(config.retries) {
         pending_workers = begin_connecting_to_peers(std::async(discover_peers), serialization, configuration);
     }
 
@@ -45,6 +45,8 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         std::shared_ptr<Serialization> serialization;
         std::shared_ptr<Configuration> configuration;
+        const size_t jobs_per_worker;
+        const size_t retries;
 
         std::list<std::future<std::unique_ptr<Worker>>> pending_workers;
     };
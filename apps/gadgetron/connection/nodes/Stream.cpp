@@ -5,6 +5,7 @@
 #include "Parallel.h"
 #include "ParallelProcess.h"
 #include "PureDistributed.h"
+#include "connection/core/Metrics.h"
 #include "connection/core/Processable.h"
 
 #include "connection/Loader.h"
@@ -90,7 +91,8 @@ namespace {
 
 namespace Gadgetron::Server::Connection::Nodes {
 
-    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader) : key(config.key) {
+    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader)
+        : key(config.key), capacity(config.capacity), batch(config.batch), batch_window(config.batch_window) {
         for (auto &node_config : config.nodes) {
             nodes.emplace_back(
                     Core::visit([&](auto n) { return load_node(n, context, loader); }, node_config)
@@ -109,13 +111,20 @@ namespace Gadgetron::Server::Connection::Nodes {
         std::vector<OutputChannel> output_channels{};
 
         for (auto i = 0; i < nodes.size()-1; i++) {
-            auto channel = make_channel<MessageChannel>();
+            auto channel = make_node_channel();
             input_channels.emplace_back(std::move(channel.input));
             output_channels.emplace_back(std::move(channel.output));
         }
 
         output_channels.emplace_back(std::move(output));
 
+        for (auto i = 0; i < nodes.size(); i++) {
+            if (auto metrics = Metrics::node(node_path(*nodes[i]))) {
+                input_channels[i].instrument(metrics);
+                output_channels[i].instrument(metrics);
+            }
+        }
+
         ErrorHandler nested_handler{error_handler, name()};
 
         std::vector<std::thread> threads(nodes.size());
@@ -133,6 +142,16 @@ namespace Gadgetron::Server::Connection::Nodes {
         }
     }
 
+    ChannelPair Stream::make_node_channel() const {
+        if (batch) return make_channel<BatchedMessageChannel>(*batch, batch_window, capacity);
+        if (capacity) return make_channel<BoundedMessageChannel>(*capacity);
+        return make_channel<MessageChannel>();
+    }
+
+    std::string Stream::node_path(Processable &node) const {
+        return key.empty() ? node.name() : key + "/" + node.name();
+    }
+
     bool Stream::empty() const { return nodes.empty(); }
 }
 
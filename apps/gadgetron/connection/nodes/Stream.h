@@ -32,6 +32,12 @@ namespace Gadgetron::Server::Connection::Nodes {
         const std::string &name() override;
 
     private:
+        Core::ChannelPair make_node_channel() const;
+        std::string node_path(Processable &node) const;
+
         std::vector<std::shared_ptr<Processable>> nodes;
+        const Core::optional<size_t> capacity;
+        const Core::optional<size_t> batch;
+        const std::chrono::microseconds batch_window;
     };
 }
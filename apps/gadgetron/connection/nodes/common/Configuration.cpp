@@ -55,7 +55,9 @@ namespace Gadgetron::Server::Connection::Nodes {
                 config.writers,
                 config.stream
             }
-    ) {}
+    ) {
+        compression = config.compression;
+    }
 
     Configuration::Configuration(
             Core::StreamContext context,
@@ -70,5 +72,7 @@ namespace Gadgetron::Server::Connection::Nodes {
                     std::vector<Config::Node>(config.stream.gadgets.begin(), config.stream.gadgets.end())
                 }
             }
-        ) {}
+        ) {
+        compression = config.compression;
+    }
 }
\ No newline at end of file
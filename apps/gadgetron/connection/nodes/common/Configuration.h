@@ -11,6 +11,9 @@ namespace Gadgetron::Server::Connection::Nodes {
     public:
         const Core::StreamContext context;
 
+        /// Tolerance for compressing float data sent to the peer; zero compresses losslessly, none not at all.
+        Core::optional<float> compression;
+
         void send(std::iostream &stream) const;
 
         Configuration(Core::StreamContext context, Config config);
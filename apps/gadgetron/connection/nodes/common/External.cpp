@@ -7,6 +7,9 @@
 #include "system_info.h"
 
 #include "connection/SocketStreamBuf.h"
+#include "io/compression.h"
+#include "io/primitives.h"
+#include "MessageID.h"
 #include "log.h"
 
 namespace {
@@ -34,6 +37,39 @@ namespace {
     Remote as_remote(Remote remote, const std::shared_ptr<Configuration> &) {
         return remote;
     }
+
+    std::string query_compression_codecs(std::iostream &stream) {
+        using namespace Gadgetron::Core;
+
+        IO::write(stream, QUERY);
+        IO::write(stream, uint64_t(0));
+        IO::write(stream, uint64_t(0));
+        IO::write_string_to_stream<uint64_t>(stream, "gadgetron::compression");
+
+        auto id = IO::read<uint16_t>(stream);
+        if (id != RESPONSE) throw std::runtime_error("Received unexpected reply to compression query: " + std::to_string(id));
+
+        IO::read<uint64_t>(stream);
+        return IO::read_string_from_stream<uint64_t>(stream);
+    }
+
+    void negotiate_compression(std::iostream &stream, float tolerance) {
+        using namespace Gadgetron::Core;
+
+        // Peers predating compression answer the query with an error message rather than a list of codecs.
+        auto peer_codecs = query_compression_codecs(stream);
+        if (peer_codecs.find("nhlbi") == std::string::npos) {
+            GWARN_STREAM("Peer does not support compression; sending data uncompressed.");
+            return;
+        }
+
+        // Ask the peer to compress its replies losslessly; they are usually the final images.
+        IO::write(stream, COMPRESSION);
+        IO::write_string_to_stream<uint64_t>(stream, IO::supported_codecs());
+        IO::write(stream, 0.0f);
+
+        IO::set_compression(stream, IO::negotiate_compression(peer_codecs, tolerance));
+    }
 }
 
 namespace Gadgetron::Server::Connection::Nodes {
@@ -77,6 +113,8 @@ namespace Gadgetron::Server::Connection::Nodes {
     }
 
     std::unique_ptr<std::iostream> connect(const Address &address, std::shared_ptr<Configuration> configuration) {
-        return connect(Core::visit([&](auto address) { return as_remote(address, configuration); }, address));
+        auto stream = connect(Core::visit([&](auto address) { return as_remote(address, configuration); }, address));
+        if (configuration->compression) negotiate_compression(*stream, *configuration->compression);
+        return stream;
     }
 }
@@ -0,0 +1,451 @@
+#include "SharedMemory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/ip/address.hpp>
+
+#include "io/primitives.h"
+#include "MessageID.h"
+#include "log.h"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace Gadgetron::Core;
+
+#if !defined(_WIN32)
+namespace {
+
+    constexpr uint64_t segment_magic = 0x4d48534e52544447;     // "GDTRNSHM"
+    constexpr uint64_t segment_version = 2;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory rings need lock free 64 bit atomics.");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Events are waited on as plain 32 bit words.");
+
+    struct alignas(64) Counter {
+        std::atomic<uint64_t> value{ 0 };
+    };
+
+    // Something one end of a ring may sleep waiting for. The sequence is bumped, and the sleepers woken, only when
+    // sleepers says there are any, so an end which keeps up with the other never makes a system call.
+    struct alignas(64) Event {
+        std::atomic<uint32_t> sequence{ 0 };
+        std::atomic<uint32_t> sleepers{ 0 };
+    };
+
+    struct RingHeader {
+        Counter written;    // Bytes written to the ring so far; only changed by the writer.
+        Counter read;       // Bytes read from the ring so far; only changed by the reader.
+        Counter closed;     // Nonzero once either end is done with the ring.
+        Event data_written; // Waited on by the reader.
+        Event data_read;    // Waited on by the writer.
+    };
+
+    // Sleeps until the sequence of event is bumped past sequence, or for timeout at most. Futex words in shared memory
+    // wake sleepers in any process mapping them. Elsewhere, we fall back to sleeping for a short while.
+    void sleep_on(Event &event, uint32_t sequence, std::chrono::milliseconds timeout) {
+#if defined(__linux__)
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        timespec relative{ time_t(seconds.count()), long(std::chrono::nanoseconds(timeout - seconds).count()) };
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&event.sequence), FUTEX_WAIT, sequence, &relative, nullptr, 0);
+#else
+        if (event.sequence.load(std::memory_order_acquire) == sequence)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+    }
+
+    // Wakes whoever sleeps on event. Called after the state they are waiting for has been published.
+    void notify(Event &event) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (event.sleepers.load(std::memory_order_relaxed) == 0) return;
+
+        event.sequence.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&event.sequence), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+
+    struct SegmentHeader {
+        uint64_t magic = segment_magic;
+        uint64_t version = segment_version;
+        uint64_t size = 0;
+        std::atomic<uint64_t> pids[2] = { 0, 0 };
+        RingHeader rings[2];
+    };
+
+    static_assert(sizeof(SegmentHeader) % 64 == 0, "Ring data must start on a cache line.");
+
+    size_t round_up_to_power_of_two(size_t value) {
+        size_t result = 4096;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    std::system_error system_error(const std::string &what) {
+        return std::system_error(errno, std::generic_category(), what);
+    }
+
+    class Segment {
+    public:
+        static std::shared_ptr<Segment> create(size_t size) {
+            static std::atomic<unsigned> counter{ 0 };
+            auto name = "/gadgetron-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+
+            int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0) throw system_error("Failed to create shared memory segment " + name);
+
+            auto segment = std::shared_ptr<Segment>(new Segment(name, fd, sizeof(SegmentHeader) + 2 * size, true));
+
+            auto header = new (segment->memory) SegmentHeader{};
+            header->size = size;
+            header->pids[0] = uint64_t(getpid());
+
+            return segment;
+        }
+
+        static std::shared_ptr<Segment> open(const std::string &name, size_t size) {
+            int fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd < 0) throw system_error("Failed to open shared memory segment " + name);
+
+            auto segment = std::shared_ptr<Segment>(new Segment(name, fd, sizeof(SegmentHeader) + 2 * size, false));
+
+            auto &header = segment->header();
+            if (header.magic != segment_magic || header.version != segment_version || header.size != size)
+                throw std::runtime_error("Shared memory segment " + name + " has an unexpected layout");
+            header.pids[1] = uint64_t(getpid());
+
+            return segment;
+        }
+
+        ~Segment() {
+            munmap(memory, bytes);
+            unlink();
+        }
+
+        Segment(const Segment &) = delete;
+        Segment &operator=(const Segment &) = delete;
+
+        /// Removes the name of the segment; memory mapped by either end stays valid.
+        void unlink() {
+            if (owner && !unlinked.exchange(true)) shm_unlink(segment_name.c_str());
+        }
+
+        const std::string &name() const { return segment_name; }
+        SegmentHeader &header() { return *static_cast<SegmentHeader *>(memory); }
+        char *data(size_t ring) { return static_cast<char *>(memory) + sizeof(SegmentHeader) + ring * header().size; }
+
+    private:
+        Segment(std::string name, int fd, size_t bytes, bool owner)
+            : segment_name(std::move(name)), bytes(bytes), owner(owner) {
+
+            struct stat status{};
+            if ((owner && ftruncate(fd, off_t(bytes)) != 0) || fstat(fd, &status) != 0 || size_t(status.st_size) < bytes) {
+                auto error = system_error("Failed to size shared memory segment " + segment_name);
+                close(fd);
+                if (owner) shm_unlink(segment_name.c_str());
+                throw error;
+            }
+
+            memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+
+            if (memory == MAP_FAILED) {
+                if (owner) shm_unlink(segment_name.c_str());
+                throw system_error("Failed to map shared memory segment " + segment_name);
+            }
+        }
+
+        const std::string segment_name;
+        const size_t bytes;
+        const bool owner;
+        std::atomic<bool> unlinked{ false };
+        void *memory = nullptr;
+    };
+
+    /**
+     * One direction of a shared memory connection. Positions grow without bound; the ring size is a power of two,
+     * so the offset into the ring is the position modulo the size.
+     */
+    class Ring {
+    public:
+        Ring(RingHeader &header, char *data, size_t size, const std::atomic<uint64_t> &peer)
+            : header(header), data(data), size(size), peer(peer) {}
+
+        /// Blocks until all of source is written, or the ring is closed. Returns the number of bytes written.
+        size_t write(const char *source, size_t length) {
+            auto written = header.written.value.load(std::memory_order_relaxed);
+
+            size_t done = 0;
+            while (done < length && !is_closed()) {
+                if (!wait(header.data_read, [&]() { return space(written) > 0; })) break;
+
+                auto chunk = std::min(length - done, space(written));
+                copy_in(written, source + done, chunk);
+
+                written += chunk;
+                done += chunk;
+                header.written.value.store(written, std::memory_order_release);
+                notify(header.data_written);
+            }
+            return done;
+        }
+
+        /// Blocks until some data is available, and reads up to length bytes of it. Returns 0 once the ring is
+        /// closed and drained.
+        size_t read(char *destination, size_t length) {
+            auto read = header.read.value.load(std::memory_order_relaxed);
+            if (!wait(header.data_written, [&]() { return available(read) > 0; })) return 0;
+
+            auto chunk = std::min(length, available(read));
+            copy_out(read, destination, chunk);
+
+            header.read.value.store(read + chunk, std::memory_order_release);
+            notify(header.data_read);
+            return chunk;
+        }
+
+        void close() {
+            header.closed.value.store(1, std::memory_order_release);
+            notify(header.data_written);
+            notify(header.data_read);
+        }
+
+    private:
+        size_t space(uint64_t written) const {
+            return size - (written - header.read.value.load(std::memory_order_acquire));
+        }
+
+        size_t available(uint64_t read) const {
+            return header.written.value.load(std::memory_order_acquire) - read;
+        }
+
+        bool is_closed() const {
+            return header.closed.value.load(std::memory_order_acquire) != 0;
+        }
+
+        bool peer_alive() const {
+            auto pid = pid_t(peer.load(std::memory_order_relaxed));
+            return pid == 0 || kill(pid, 0) == 0 || errno == EPERM;
+        }
+
+        // Yields for a while, in case the other end is about to catch up, then sleeps on event until the other end
+        // wakes us. Waking up every so often to check whether the peer process is still around keeps a crashed peer
+        // from hanging the connection.
+        template<class F>
+        bool wait(Event &event, F ready) {
+            for (unsigned round = 0; round < 64; round++) {
+                if (ready()) return true;
+                if (is_closed()) return ready();
+                std::this_thread::yield();
+            }
+
+            while (!ready()) {
+                if (is_closed()) return ready();
+
+                if (!peer_alive()) {
+                    close();
+                    return ready();
+                }
+
+                // Reading the sequence before announcing ourselves means a wakeup sent after we checked ready() is
+                // not lost; the sequence will have moved on, and the sleep returns straight away.
+                auto sequence = event.sequence.load(std::memory_order_acquire);
+                event.sleepers.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (!ready() && !is_closed()) sleep_on(event, sequence, std::chrono::milliseconds(100));
+
+                event.sleepers.fetch_sub(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        void copy_in(uint64_t position, const char *source, size_t length) {
+            auto offset = position & (size - 1);
+            auto first = std::min(length, size - offset);
+            std::memcpy(data + offset, source, first);
+            std::memcpy(data, source + first, length - first);
+        }
+
+        void copy_out(uint64_t position, char *destination, size_t length) const {
+            auto offset = position & (size - 1);
+            auto first = std::min(length, size - offset);
+            std::memcpy(destination, data + offset, first);
+            std::memcpy(destination + first, data, length - first);
+        }
+
+        RingHeader &header;
+        char *const data;
+        const size_t size;
+        const std::atomic<uint64_t> &peer;
+    };
+
+    class SharedMemoryStreamBuf : public std::streambuf {
+    public:
+        // Side 0 is the end which created the segment, and writes to ring 0.
+        SharedMemoryStreamBuf(std::shared_ptr<Segment> segment, size_t side)
+            : segment(segment),
+              outbound(segment->header().rings[side], segment->data(side), segment->header().size,
+                       segment->header().pids[1 - side]),
+              inbound(segment->header().rings[1 - side], segment->data(1 - side), segment->header().size,
+                      segment->header().pids[1 - side]),
+              input_buffer(64 * 1024) {
+            this->setg(input_buffer.data(), input_buffer.data() + input_buffer.size(),
+                       input_buffer.data() + input_buffer.size());
+        }
+
+        ~SharedMemoryStreamBuf() override {
+            outbound.close();
+            inbound.close();
+        }
+
+    protected:
+        std::streamsize xsputn(const char_type *data, std::streamsize length) override {
+            return outbound.write(data, length);
+        }
+
+        int overflow(int ch) override {
+            if (ch == traits_type::eof()) return 0;
+            auto c = traits_type::to_char_type(ch);
+            return outbound.write(&c, 1) ? ch : traits_type::eof();
+        }
+
+        int underflow() override {
+            auto elements_read = inbound.read(this->eback(), input_buffer.size());
+            if (!elements_read) return traits_type::eof();
+
+            this->setg(this->eback(), this->eback(), this->eback() + elements_read);
+            return traits_type::to_int_type(*this->gptr());
+        }
+
+        std::streamsize xsgetn(char_type *data, std::streamsize length) override {
+            auto buffered = std::min<std::streamsize>(length, std::distance(this->gptr(), this->egptr()));
+            std::copy_n(this->gptr(), buffered, data);
+            this->setg(this->eback(), this->gptr() + buffered, this->egptr());
+
+            auto remaining = length - buffered;
+            if (remaining < static_cast<std::streamsize>(input_buffer.size()))
+                return buffered + std::streambuf::xsgetn(data + buffered, remaining);
+
+            // Large reads are copied straight from the ring into the destination.
+            std::streamsize done = buffered;
+            while (done < length) {
+                auto elements_read = inbound.read(data + done, length - done);
+                if (!elements_read) break;
+                done += elements_read;
+            }
+            return done;
+        }
+
+    private:
+        std::shared_ptr<Segment> segment;
+        Ring outbound, inbound;
+        std::vector<char> input_buffer;
+    };
+
+    class SharedMemoryStream : public std::iostream {
+    public:
+        SharedMemoryStream(std::shared_ptr<Segment> segment, size_t side, std::unique_ptr<std::iostream> control)
+            : std::iostream(nullptr), buffer(std::move(segment), side), control(std::move(control)) {
+            this->rdbuf(&buffer);
+        }
+
+    private:
+        SharedMemoryStreamBuf buffer;
+
+        // The stream the connection was negotiated on. It is kept open for as long as the shared memory is in use,
+        // so that peers relying on it to tell when the other end goes away keep working.
+        std::unique_ptr<std::iostream> control;
+    };
+}
+#endif
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    std::unique_ptr<std::iostream> offer_shared_memory(std::unique_ptr<std::iostream> stream, size_t size) {
+#if defined(_WIN32)
+        return stream;
+#else
+        std::shared_ptr<Segment> segment;
+        try {
+            segment = Segment::create(round_up_to_power_of_two(size));
+        } catch (const std::exception &e) {
+            GWARN_STREAM("Shared memory is not available; using the socket connection. " << e.what());
+            return stream;
+        }
+
+        IO::write(*stream, SHARED_MEMORY_OFFER);
+        IO::write_string_to_stream<uint64_t>(*stream, segment->name());
+        IO::write<uint64_t>(*stream, segment->header().size);
+
+        auto reply = IO::read<uint16_t>(*stream);
+
+        // The peer has either mapped the segment or turned it down; in both cases, the name has served its purpose.
+        segment->unlink();
+
+        switch (reply) {
+            case SHARED_MEMORY_ACCEPT:
+                GINFO_STREAM("Peer accepted shared memory connection through " << segment->name());
+                return std::make_unique<SharedMemoryStream>(segment, 0, std::move(stream));
+            case SHARED_MEMORY_DECLINE:
+                GINFO_STREAM("Peer declined shared memory connection; using the socket connection.");
+                return stream;
+            default:
+                throw std::runtime_error("Received unexpected reply to shared memory offer: " + std::to_string(reply));
+        }
+#endif
+    }
+
+    std::unique_ptr<std::iostream> accept_shared_memory(std::unique_ptr<std::iostream> stream) {
+        auto id = IO::read<uint16_t>(*stream);
+        if (id != SHARED_MEMORY_OFFER)
+            throw std::runtime_error("Expected shared memory offer; received message id " + std::to_string(id));
+
+        auto name = IO::read_string_from_stream<uint64_t>(*stream);
+        auto size = IO::read<uint64_t>(*stream);
+
+#if defined(_WIN32)
+        IO::write(*stream, SHARED_MEMORY_DECLINE);
+        return stream;
+#else
+        std::shared_ptr<Segment> segment;
+        try {
+            segment = Segment::open(name, size);
+        } catch (const std::exception &e) {
+            GWARN_STREAM("Declining shared memory connection. " << e.what());
+            IO::write(*stream, SHARED_MEMORY_DECLINE);
+            return stream;
+        }
+
+        IO::write(*stream, SHARED_MEMORY_ACCEPT);
+        return std::make_unique<SharedMemoryStream>(segment, 1, std::move(stream));
+#endif
+    }
+
+    bool is_local_address(const std::string &address) {
+        if (address == "localhost") return true;
+
+        boost::system::error_code error;
+        auto ip = boost::asio::ip::address::from_string(address, error);
+        return !error && ip.is_loopback();
+    }
+}
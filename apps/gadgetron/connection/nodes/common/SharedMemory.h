@@ -0,0 +1,41 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /// Capacity of each direction of a shared memory connection.
+    constexpr size_t default_shared_memory_size = size_t(64) << 20;
+
+    /**
+     * Offers the peer at the other end of stream to continue the connection through shared memory.
+     *
+     * The offer is a SHARED_MEMORY_OFFER message id, followed by the name of a POSIX shared memory segment
+     * (uint64 length and characters) and the size of each of its two ring buffers (uint64). The peer answers with
+     * SHARED_MEMORY_ACCEPT once it has mapped the segment, after which all traffic in both directions goes through
+     * the rings, or with SHARED_MEMORY_DECLINE to carry on over the original stream.
+     *
+     * The segment starts with a 64 byte aligned header: magic, version and ring size (uint64 each), the process ids
+     * of the two ends (atomic uint64, the peer filling in its own), and for each ring the written, read and closed
+     * counters (atomic uint64) followed by a data written and a data read event, each on a 64 byte line of its own.
+     * An event is a sequence and a sleeper count (atomic uint32 each); an end which finds a ring empty or full
+     * announces itself as a sleeper and waits for the sequence to change, as a futex on Linux, and the other end bumps
+     * the sequence and wakes it once it has moved the counters on. Ring 0 carries data from Gadgetron to the peer,
+     * ring 1 from the peer to Gadgetron. Their data follows the header in that order.
+     *
+     * Returns the shared memory stream if the peer accepts, and stream itself if the peer declines or shared memory
+     * is not available.
+     */
+    std::unique_ptr<std::iostream> offer_shared_memory(
+            std::unique_ptr<std::iostream> stream,
+            size_t size = default_shared_memory_size
+    );
+
+    /// Accepts a shared memory offer read from stream; the peer's half of offer_shared_memory.
+    std::unique_ptr<std::iostream> accept_shared_memory(std::unique_ptr<std::iostream> stream);
+
+    /// True if address refers to this host, in which case a peer there can share memory with us.
+    bool is_local_address(const std::string &address);
+}
@@ -1,6 +1,7 @@
-
 #include "Pool.h"
 
+#include <limits>
+
 #include "connection/nodes/common/Discovery.h"
 
 #include "log.h"
@@ -10,54 +11,170 @@ using namespace Gadgetron::Core;
 using namespace Gadgetron::Server::Connection::Nodes;
 using namespace Gadgetron;
 
-namespace {
+namespace Gadgetron::Server::Connection::Nodes {
+
+    struct Pool::Job {
+        // Only kept around when the job can be retried.
+        optional<Message> message;
+        size_t retries;
+        std::promise<Message> response;
+        std::exception_ptr failure;
+    };
 
-    bool compare_load(const std::unique_ptr<Worker> &a, const std::unique_ptr<Worker> &b) {
-        return a->current_load() < b->current_load();
+    Pool::Pool(
+            std::list<std::unique_ptr<Worker>> workers,
+            size_t max_jobs_per_worker,
+            size_t retries
+    ) : max_jobs_per_worker(std::max<size_t>(max_jobs_per_worker, 1)), retries(retries) {
+        for (auto &worker : workers) slots.push_back(Slot{std::move(worker)});
+        dispatcher = std::thread([this]() { dispatch_retries(); });
     }
 
-    std::unique_ptr<Worker> &select_best_worker(std::list<std::unique_ptr<Worker>> &workers) {
-        return *std::min_element(workers.begin(), workers.end(), compare_load);
+    Pool::~Pool() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_finished.wait(lock, [&]() { return jobs_in_flight == 0; });
+            closed = true;
+        }
+        retry_queued.notify_all();
+        dispatcher.join();
     }
 
-    Message send_to_best_worker(
-            Message message,
-            std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers,
-            size_t retries
-    ) {
+    std::future<Message> Pool::push(Message message) {
+        auto job = std::make_shared<Job>(Job{std::move(message), retries, std::promise<Message>()});
+        auto response = job->response.get_future();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            jobs_in_flight++;
+        }
+        try {
+            dispatch(std::move(job));
+        }
+        catch (...) {
+            finish_job();
+            throw;
+        }
+        return response;
+    }
 
-        if (!retries) throw std::runtime_error("Multiple workers failed processing job; aborting.");
+    void Pool::dispatch(std::shared_ptr<Job> job) {
+        auto &slot = acquire_slot();
 
-        auto &worker = select_best_worker(*workers);
+        auto message = job->retries ? job->message->clone() : std::move(*job->message);
+        if (!job->retries) job->message.reset();
 
         try {
-            auto response = worker->push(message.clone());
-            GDEBUG_STREAM("Pushed message; waiting for response from worker " << worker->address);
-            auto response_message = response.get();
-            GDEBUG_STREAM("Response gotten from worker " << worker->address);
-            return std::move(response_message);
+            slot.worker->push(
+                    std::move(message),
+                    [this, job, &slot](Message response) {
+                        GDEBUG_STREAM("Response gotten from worker " << slot.worker->address);
+                        release_slot(slot);
+                        job->response.set_value(std::move(response));
+                        finish_job();
+                    },
+                    [this, job, &slot](std::exception_ptr failure) {
+                        release_slot(slot);
+                        retry(job, failure);
+                    }
+            );
+            GDEBUG_STREAM("Pushed message to worker " << slot.worker->address);
+        }
+        catch (const std::exception &) {
+            release_slot(slot);
+            retry(job, std::current_exception());
+        }
+    }
+
+    void Pool::retry(std::shared_ptr<Job> job, std::exception_ptr failure) {
+        job->failure = failure;
+
+        if (!job->message) {
+            job->response.set_exception(failure);
+            finish_job();
+            return;
+        }
+
+        try {
+            std::rethrow_exception(failure);
         }
         catch (const std::exception &e) {
-            GWARN_STREAM("Worker " << worker->address << " failed processing job. The job will be retried. [" << e.what() << "]");
-            return send_to_best_worker(std::move(message), std::move(workers), retries - 1);
+            GWARN_STREAM("Worker failed processing job. The job will be retried. [" << e.what() << "]");
+        }
+        catch (...) {
+            GWARN_STREAM("Worker failed processing job. The job will be retried.");
         }
+
+        job->retries--;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            pending_retries.push_back(std::move(job));
+        }
+        retry_queued.notify_one();
     }
-}
 
-namespace Gadgetron::Server::Connection::Nodes {
+    void Pool::dispatch_retries() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            retry_queued.wait(lock, [&]() { return closed || !pending_retries.empty(); });
+            if (pending_retries.empty()) return;
 
-    Pool::Pool(
-            std::list<std::unique_ptr<Worker>> workers
-    ) : workers(std::make_shared<std::list<std::unique_ptr<Worker>>>(std::move(workers))) {}
+            auto job = std::move(pending_retries.front());
+            pending_retries.pop_front();
+            lock.unlock();
 
-    std::future<Message> Pool::push(Message message) {
-        return std::async(
-                std::launch::async,
-                send_to_best_worker,
-                std::move(message),
-                workers,
-                3
-        );
+            try {
+                dispatch(job);
+            }
+            catch (const std::exception &e) {
+                // Typically no worker is left; the caller is better served by the error that made the job fail.
+                GWARN_STREAM("Could not retry failed job: " << e.what());
+                job->response.set_exception(job->failure);
+                finish_job();
+            }
+
+            lock.lock();
+        }
+    }
+
+    void Pool::finish_job() {
+        std::lock_guard<std::mutex> guard(mutex);
+        jobs_in_flight--;
+        job_finished.notify_all();
     }
-}
 
+    Pool::Slot &Pool::acquire_slot() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        auto is_alive = [](const Slot &slot) {
+            return slot.worker->current_load() != std::numeric_limits<long long>::max();
+        };
+
+        while (true) {
+            if (std::none_of(slots.begin(), slots.end(), is_alive))
+                throw std::runtime_error("No workers available to process job; aborting.");
+
+            auto best = slots.end();
+            long long best_load = std::numeric_limits<long long>::max();
+            for (auto it = slots.begin(); it != slots.end(); ++it) {
+                if (it->jobs >= max_jobs_per_worker) continue;
+                auto load = it->worker->current_load();
+                if (load < best_load) { best = it; best_load = load; }
+            }
+
+            if (best != slots.end()) {
+                best->jobs++;
+                return *best;
+            }
+
+            slot_released.wait(lock);
+        }
+    }
+
+    void Pool::release_slot(Slot &slot) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            slot.jobs--;
+        }
+        slot_released.notify_all();
+    }
+}
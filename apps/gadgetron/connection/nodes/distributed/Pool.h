@@ -1,6 +1,9 @@
 #pragma once
 
+#include <condition_variable>
+#include <list>
 #include <mutex>
+#include <thread>
 #include <vector>
 #include <memory>
 #include <future>
@@ -15,12 +18,43 @@
 
 namespace Gadgetron::Server::Connection::Nodes {
 
+    /**
+     * Dispatches jobs to a set of workers. Each worker is kept busy with up to max_jobs_per_worker pipelined jobs;
+     * pushing a job blocks while every worker is at that limit. Responses are delivered through the returned futures
+     * by the workers' inbound threads, so no thread is spent waiting on any single job. Failed jobs are handed to a
+     * dispatcher thread for retrying, as the inbound thread of a worker must not block waiting for a free slot.
+     */
     class Pool {
     public:
-        explicit Pool(std::list<std::unique_ptr<Worker>> workers);
+        Pool(std::list<std::unique_ptr<Worker>> workers, size_t max_jobs_per_worker, size_t retries);
+        ~Pool();
+
         std::future<Core::Message> push(Core::Message message);
 
     private:
-        std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers;
+        struct Job;
+        struct Slot {
+            std::unique_ptr<Worker> worker;
+            size_t jobs = 0;
+        };
+
+        void dispatch(std::shared_ptr<Job> job);
+        void retry(std::shared_ptr<Job> job, std::exception_ptr failure);
+        void dispatch_retries();
+        void finish_job();
+
+        Slot &acquire_slot();
+        void release_slot(Slot &slot);
+
+        const size_t max_jobs_per_worker;
+        const size_t retries;
+
+        std::mutex mutex;
+        std::condition_variable slot_released, retry_queued, job_finished;
+        size_t jobs_in_flight = 0;
+        bool closed = false;
+        std::list<std::shared_ptr<Job>> pending_retries;
+        std::list<Slot> slots;
+        std::thread dispatcher;
     };
-}
\ No newline at end of file
+}
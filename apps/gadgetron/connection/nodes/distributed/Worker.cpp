@@ -3,6 +3,7 @@
 
 #include <chrono>
 #include <future>
+#include <sstream>
 
 #include "connection/nodes/common/External.h"
 #include "connection/nodes/common/ExternalChannel.h"
@@ -26,7 +27,8 @@ namespace Gadgetron::Server::Connection::Nodes {
 
     struct Worker::Job {
         std::chrono::time_point<std::chrono::steady_clock> start;
-        std::promise<Core::Message> response;
+        ResponseHandler on_response;
+        FailureHandler on_failure;
     };
 
     struct Module {
@@ -38,18 +40,15 @@ namespace Gadgetron::Server::Connection::Nodes {
     struct Worker::PushModule : public Module {
         using Module::Module;
 
-        virtual std::future<Message> push(Message message) {
+        virtual void push(Message message, ResponseHandler on_response, FailureHandler on_failure) {
             GDEBUG_STREAM("Pushing message to remote worker " << worker.address);
 
-            Job job {
-                    std::chrono::steady_clock::now(),
-                    std::promise<Message>()
-            };
-
-            auto future = job.response.get_future();
             worker.channel->push_message(std::move(message));
-            worker.jobs.push_back(std::move(job));
-            return future;
+            worker.jobs.push_back(Job{
+                    std::chrono::steady_clock::now(),
+                    std::move(on_response),
+                    std::move(on_failure)
+            });
         };
     };
 
@@ -57,6 +56,8 @@ namespace Gadgetron::Server::Connection::Nodes {
         using Module::Module;
 
         virtual long long current_load() {
+            if (worker.jobs.empty()) return 0;
+
             auto current_job_duration_estimate = std::max(
                     worker.timing.latest.count(),
                     time_since(worker.jobs.front().start).count()
@@ -68,7 +69,7 @@ namespace Gadgetron::Server::Connection::Nodes {
 
     struct Worker::ClosedPushModule : public Worker::PushModule {
         using Worker::PushModule::PushModule;
-        std::future<Message> push(Message message) override {
+        void push(Message, ResponseHandler, FailureHandler) override {
             throw std::runtime_error("Cannot push message to closed/failed worker.");
         }
     };
@@ -111,9 +112,9 @@ namespace Gadgetron::Server::Connection::Nodes {
         return load_module->current_load();
     }
 
-    std::future<Message> Worker::push(Message message) {
+    void Worker::push(Message message, ResponseHandler on_response, FailureHandler on_failure) {
         std::lock_guard<std::mutex> guard(mutex);
-        return push_module->push(std::move(message));
+        push_module->push(std::move(message), std::move(on_response), std::move(on_failure));
     }
 
     void Worker::close() {
@@ -125,29 +126,43 @@ namespace Gadgetron::Server::Connection::Nodes {
         try {
             while(true) process_inbound_message(channel->pop());
         }
-        catch (const ChannelClosed &) {}
+        catch (const ChannelClosed &) {
+            switch_to_closed_modules();
+            // A remote closing cleanly still owes us a response for every job in flight.
+            std::stringstream message;
+            message << "Worker " << address << " closed with jobs in flight.";
+            fail_pending_messages(std::make_exception_ptr(std::runtime_error(message.str())));
+        }
         catch (const std::exception &e) {
             GWARN_STREAM("Worker " << address << " failed: " << e.what());
+            switch_to_closed_modules();
             fail_pending_messages(std::current_exception());
         }
-        switch_to_closed_modules();
     }
 
     void Worker::process_inbound_message(Core::Message message) {
         GDEBUG_STREAM("Received message from remote worker " << address);
 
-        std::lock_guard<std::mutex> guard(mutex);
+        Job job;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            job = std::move(jobs.front()); jobs.pop_front();
+            timing.latest = time_since(job.start);
+        }
 
-        auto job = std::move(jobs.front()); jobs.pop_front();
-        timing.latest = time_since(job.start);
-        job.response.set_value(std::move(message));
+        // Handlers may push new jobs, so they are called without holding the lock.
+        job.on_response(std::move(message));
     }
 
     void Worker::fail_pending_messages(const std::exception_ptr &e) {
-        std::lock_guard<std::mutex> guard(mutex);
+        std::list<Job> failed_jobs;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            failed_jobs.swap(jobs);
+        }
 
-        for (auto &job : jobs) {
-            job.response.set_exception(e);
+        for (auto &job : failed_jobs) {
+            job.on_failure(e);
         }
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <future>
 
@@ -25,7 +26,12 @@ namespace Gadgetron::Server::Connection::Nodes {
                 std::shared_ptr<Configuration> configuration
         );
 
-        std::future<Core::Message> push(Core::Message message);
+        using ResponseHandler = std::function<void(Core::Message)>;
+        using FailureHandler = std::function<void(std::exception_ptr)>;
+
+        /// Sends a job to the worker. Exactly one of the handlers is called on the worker's inbound thread once
+        /// the job is done. Several jobs may be in flight at once; responses arrive in the order the jobs were sent.
+        void push(Core::Message message, ResponseHandler on_response, FailureHandler on_failure);
         long long current_load() const;
         void close();
 
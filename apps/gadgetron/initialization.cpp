@@ -6,6 +6,10 @@
 #include <string>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include "hoNDFFT.h"
+#include "hoMemoryPool.h"
 
 #ifdef FORCE_LIMIT_OPENBLAS_NUM_THREADS
 #include <cblas.h>
@@ -27,6 +31,46 @@ namespace Gadgetron::Server {
     }
 
 
+    void configure_fft_libraries(const boost::program_options::variables_map &args) {
+
+        auto planner = boost::algorithm::to_lower_copy(args["fftw_planner"].as<std::string>());
+        if (planner == "estimate") {
+            FFT::set_planner_effort(FFT::PlannerEffort::Estimate);
+        } else if (planner == "measure") {
+            FFT::set_planner_effort(FFT::PlannerEffort::Measure);
+        } else if (planner == "patient") {
+            FFT::set_planner_effort(FFT::PlannerEffort::Patient);
+        } else {
+            throw std::runtime_error("Unknown FFTW planner effort: " + planner);
+        }
+
+        if (!args.count("fftw_wisdom")) return;
+
+        auto wisdom_dir = args["fftw_wisdom"].as<boost::filesystem::path>();
+        auto import = [](const boost::filesystem::path &file, auto import_wisdom) {
+            if (!boost::filesystem::exists(file)) return;
+            if (import_wisdom(file.string())) {
+                GINFO_STREAM("Imported FFTW wisdom from " << file);
+            } else {
+                GWARN_STREAM("Unable to import FFTW wisdom from " << file);
+            }
+        };
+
+        import(wisdom_dir / "fftwf_wisdom", FFT::import_wisdom<float>);
+        import(wisdom_dir / "fftw_wisdom", FFT::import_wisdom<double>);
+    }
+
+    void configure_memory_pool(const boost::program_options::variables_map &args) {
+
+        if (!args["memory_pool"].as<bool>()) return;
+
+        hoMemoryPool::Options options;
+        options.max_cached_bytes = args["memory_pool_cache"].as<size_t>() << 20;
+
+        hoNDArrayAllocator::set(std::make_shared<hoMemoryPool>(options));
+        GINFO_STREAM("Using memory pool for array data, caching up to " << args["memory_pool_cache"].as<size_t>() << " MiB");
+    }
+
     void check_environment_variables() {
 
         auto get_policy = []() -> std::string {
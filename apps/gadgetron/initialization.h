@@ -1,8 +1,14 @@
 #pragma once
 
+#include <boost/program_options/variables_map.hpp>
+
 namespace Gadgetron::Server {
     void configure_blas_libraries();
 
+    void configure_fft_libraries(const boost::program_options::variables_map &args);
+
+    void configure_memory_pool(const boost::program_options::variables_map &args);
+
     void check_environment_variables();
 
     void set_locale();
@@ -13,6 +13,8 @@
 #include "gadgetron_config.h"
 
 #include "Server.h"
+#include "connection/SocketStreamBuf.h"
+#include "ThreadPool.h"
 
 using namespace boost::filesystem;
 using namespace boost::program_options;
@@ -32,7 +34,40 @@ int main(int argc, char *argv[]) {
                 "Set the Gadgetron home directory.")
             ("port,p",
                 value<unsigned short>()->default_value(9002),
-                "Listen for incoming connections on this port.");
+                "Listen for incoming connections on this port.")
+            ("socket_buffer_size",
+                value<size_t>()->default_value(Gadgetron::Connection::default_socket_buffer_size),
+                "Size in bytes of the buffer used for reading from and writing to client connections.")
+            ("parallel_workers",
+                value<unsigned int>()->default_value(0),
+                "Number of worker threads shared by the parallel nodes of all connections. Defaults to one per core.");
+
+    options_description fft_options("FFT options");
+    fft_options.add_options()
+            ("fftw_planner",
+                value<std::string>()->default_value("estimate"),
+                "Effort FFTW spends planning new transforms: estimate, measure or patient.")
+            ("fftw_wisdom",
+                value<path>(),
+                "Directory containing FFTW wisdom files (fftwf_wisdom, fftw_wisdom) to import on startup.");
+
+    options_description memory_options("Memory options");
+    memory_options.add_options()
+            ("memory_pool",
+                bool_switch(),
+                "Allocate array data from a pool that keeps released memory for reuse.")
+            ("memory_pool_cache",
+                value<size_t>()->default_value(1024),
+                "Maximum amount of released memory, in MiB, kept by the memory pool.");
+
+    options_description metrics_options("Metrics options");
+    metrics_options.add_options()
+            ("metrics_dir",
+                value<path>(),
+                "Record per node message counts, timings and queue depths, and write them to this directory.")
+            ("metrics_interval",
+                value<unsigned int>()->default_value(10),
+                "Seconds between writing metrics, or 0 to write them only when a connection closes.");
 
     options_description storage_options("Storage options");
     storage_options.add_options()
@@ -52,6 +87,9 @@ int main(int argc, char *argv[]) {
     options_description desc;
     desc
         .add(gadgetron_options)
+        .add(fft_options)
+        .add(memory_options)
+        .add(metrics_options)
         .add(storage_options);
 
     variables_map args;
@@ -76,6 +114,11 @@ int main(int argc, char *argv[]) {
         GINFO("Gadgetron %s [%s]\n", GADGETRON_VERSION_STRING, GADGETRON_GIT_SHA1_HASH);
         GINFO("Running on port %d\n", args["port"].as<unsigned short>());
 
+        configure_fft_libraries(args);
+        configure_memory_pool(args);
+        Gadgetron::Core::ThreadPool::set_global_workers(args["parallel_workers"].as<unsigned int>());
+        Gadgetron::Core::ThreadPool::share_global_workers();
+
         // Ensure working directory exists.
         create_directories(args["dir"].as<path>());
 
@@ -0,0 +1,158 @@
+#include "../connection/nodes/distributed/Pool.h"
+#include "../connection/nodes/distributed/Worker.h"
+
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+#include <future>
+#include <thread>
+
+#include "MessageID.h"
+#include "Writer.h"
+#include "io/primitives.h"
+
+namespace ba = boost::asio;
+using tcp    = boost::asio::ip::tcp;
+using namespace Gadgetron;
+using namespace Gadgetron::Server::Connection;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+
+    class IntWriter : public Core::TypedWriter<int> {
+    protected:
+        void serialize(std::ostream &stream, const int &value) override {
+            Core::IO::write(stream, uint16_t(1024));
+            Core::IO::write(stream, value);
+        }
+    };
+
+    template<class T>
+    T read_value(tcp::socket &socket) {
+        T value;
+        ba::read(socket, ba::buffer(&value, sizeof(value)));
+        return value;
+    }
+
+    void skip_string_message(tcp::socket &socket) {
+        read_value<uint16_t>(socket);
+        std::vector<char> content(read_value<uint32_t>(socket));
+        ba::read(socket, ba::buffer(content));
+    }
+
+    std::shared_ptr<Configuration> make_configuration() {
+        Core::StreamContext context(
+                ISMRMRD::IsmrmrdHeader{},
+                Core::Context::Paths{},
+                Core::StreamContext::Args{},
+                "",
+                StorageSpaces{}
+        );
+        return std::make_shared<Configuration>(std::move(context), Config{});
+    }
+}
+
+TEST(DistributedWorkerTest, remote_closing_with_jobs_in_flight) {
+
+    ba::io_service ios{};
+    tcp::acceptor acceptor(ios, tcp::endpoint(tcp::v6(), 0));
+    auto port = acceptor.local_endpoint().port();
+
+    std::promise<void> jobs_pushed;
+
+    // The remote takes the configuration and the first job, then closes cleanly without answering any of them.
+    auto remote = std::thread([&, pushed = jobs_pushed.get_future()]() mutable {
+        tcp::socket socket{ios};
+        acceptor.accept(socket);
+
+        skip_string_message(socket);
+        skip_string_message(socket);
+
+        pushed.wait();
+        read_value<uint16_t>(socket);
+        read_value<int>(socket);
+
+        uint16_t close = Core::CLOSE;
+        ba::write(socket, ba::buffer(&close, sizeof(close)));
+        socket.close();
+    });
+
+    Serialization::Writers writers;
+    writers.push_back(std::make_unique<IntWriter>());
+    auto serialization = std::make_shared<Serialization>(Serialization::Readers{}, std::move(writers));
+
+    std::list<std::unique_ptr<Worker>> workers;
+    workers.push_back(std::make_unique<Worker>(
+            Remote{"localhost", std::to_string(port)},
+            serialization,
+            make_configuration()
+    ));
+
+    std::vector<std::future<Core::Message>> responses;
+    {
+        Pool pool(std::move(workers), 4, 0);
+        for (int i = 0; i < 3; i++) responses.push_back(pool.push(Core::Message(i)));
+        jobs_pushed.set_value();
+
+        // Destroying the pool waits for every job to be answered or failed; it must not hang.
+    }
+    remote.join();
+
+    for (auto &response : responses) {
+        ASSERT_EQ(response.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+        EXPECT_THROW(response.get(), std::runtime_error);
+    }
+}
+
+TEST(DistributedWorkerTest, failing_job_on_a_single_full_worker) {
+
+    // The failed job holds the only slot until its failure is handled, so a retry must not wait for a slot on the
+    // worker's inbound thread. When the job cannot be retried, the caller gets the worker's own error.
+    for (size_t retries : {0, 2}) {
+        ba::io_service ios{};
+        tcp::acceptor acceptor(ios, tcp::endpoint(tcp::v6(), 0));
+        auto port = acceptor.local_endpoint().port();
+
+        auto remote = std::thread([&]() {
+            tcp::socket socket{ios};
+            acceptor.accept(socket);
+
+            skip_string_message(socket);
+            skip_string_message(socket);
+
+            read_value<uint16_t>(socket);
+            read_value<int>(socket);
+
+            std::string error = "Reconstruction failed.";
+            uint16_t id = Core::ERROR;
+            uint64_t length = error.size();
+            ba::write(socket, ba::buffer(&id, sizeof(id)));
+            ba::write(socket, ba::buffer(&length, sizeof(length)));
+            ba::write(socket, ba::buffer(error));
+
+            id = Core::CLOSE;
+            ba::write(socket, ba::buffer(&id, sizeof(id)));
+            socket.close();
+        });
+
+        Serialization::Writers writers;
+        writers.push_back(std::make_unique<IntWriter>());
+        auto serialization = std::make_shared<Serialization>(Serialization::Readers{}, std::move(writers));
+
+        std::list<std::unique_ptr<Worker>> workers;
+        workers.push_back(std::make_unique<Worker>(
+                Remote{"localhost", std::to_string(port)},
+                serialization,
+                make_configuration()
+        ));
+
+        std::future<Core::Message> response;
+        {
+            Pool pool(std::move(workers), 1, retries);
+            response = pool.push(Core::Message(1));
+        }
+        remote.join();
+
+        ASSERT_EQ(response.wait_for(std::chrono::seconds(0)), std::future_status::ready) << "retries " << retries;
+        EXPECT_THROW(response.get(), RemoteError) << "retries " << retries;
+    }
+}
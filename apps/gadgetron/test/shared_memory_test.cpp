@@ -0,0 +1,129 @@
+#include "../connection/SocketStreamBuf.h"
+#include "../connection/nodes/common/SharedMemory.h"
+
+#include "MessageID.h"
+#include "hoNDArray.h"
+#include "io/primitives.h"
+
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+#include <complex>
+#include <future>
+#include <numeric>
+
+namespace ba = boost::asio;
+using tcp    = boost::asio::ip::tcp;
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+
+class SharedMemoryTest : public ::testing::Test {
+
+public:
+    SharedMemoryTest() : ::testing::Test() {
+        auto endpoint = tcp::endpoint(tcp::v6(), 0);
+        acceptor = std::make_unique<tcp::acceptor>(tcp::acceptor(ios, endpoint));
+
+        auto port    = acceptor->local_endpoint().port();
+        auto socketF = std::async([&]() {
+            auto socket = std::make_unique<tcp::socket>(ios);
+            acceptor->accept(*socket);
+            return socket;
+        });
+
+        gadgetron = Connection::remote_stream("localhost", std::to_string(port));
+        peer = Connection::stream_from_socket(socketF.get());
+    }
+
+    void connect(size_t size = default_shared_memory_size) {
+        auto accepted = std::async([&]() { return accept_shared_memory(std::move(peer)); });
+        gadgetron = offer_shared_memory(std::move(gadgetron), size);
+        peer = accepted.get();
+    }
+
+    ba::io_service ios{};
+    std::unique_ptr<tcp::acceptor> acceptor;
+    std::unique_ptr<std::iostream> gadgetron;
+    std::unique_ptr<std::iostream> peer;
+};
+
+TEST_F(SharedMemoryTest, both_directions) {
+
+    connect();
+
+    IO::write(*gadgetron, uint64_t(42));
+    ASSERT_EQ(IO::read<uint64_t>(*peer), 42);
+
+    IO::write_string_to_stream<uint32_t>(*peer, "Albatros");
+    ASSERT_EQ(IO::read_string_from_stream<uint32_t>(*gadgetron), "Albatros");
+}
+
+TEST_F(SharedMemoryTest, wrap_around) {
+
+    // Much larger than the ring, so the data wraps around many times while both ends are busy.
+    connect(1u << 16);
+
+    auto data = std::vector<char>(1u << 22);
+    std::iota(data.begin(), data.end(), 0);
+
+    auto thread = std::thread([&]() { gadgetron->write(data.data(), data.size()); });
+
+    auto data2 = std::vector<char>(data.size());
+    peer->read(data2.data(), 7);
+    peer->read(data2.data() + 7, data2.size() - 7);
+    thread.join();
+
+    ASSERT_TRUE(peer->good());
+    ASSERT_EQ(data, data2);
+}
+
+TEST_F(SharedMemoryTest, declined) {
+
+    auto declined = std::async([&]() {
+        EXPECT_EQ(IO::read<uint16_t>(*peer), SHARED_MEMORY_OFFER);
+        IO::read_string_from_stream<uint64_t>(*peer);
+        IO::read<uint64_t>(*peer);
+        IO::write(*peer, SHARED_MEMORY_DECLINE);
+    });
+
+    auto tcp_stream = gadgetron.get();
+    gadgetron = offer_shared_memory(std::move(gadgetron));
+    declined.get();
+
+    ASSERT_EQ(gadgetron.get(), tcp_stream);
+
+    IO::write(*gadgetron, uint64_t(42));
+    ASSERT_EQ(IO::read<uint64_t>(*peer), 42);
+}
+
+TEST_F(SharedMemoryTest, peer_closed) {
+
+    connect();
+
+    IO::write(*peer, uint32_t(7));
+    peer.reset();
+
+    ASSERT_EQ(IO::read<uint32_t>(*gadgetron), 7);
+    IO::read<uint32_t>(*gadgetron);
+    ASSERT_TRUE(gadgetron->eof());
+}
+
+TEST_F(SharedMemoryTest, image_round_trip) {
+
+    // Larger than the ring, so the writer has to wait for the reader to make room, and wakes it in turn.
+    connect(1u << 16);
+
+    auto array = hoNDArray<std::complex<float>>(64, 64, 4, 8);
+    std::iota(reinterpret_cast<float *>(array.data()), reinterpret_cast<float *>(array.data() + array.size()), 0.0f);
+
+    auto echo = std::thread([&]() {
+        IO::write(*peer, IO::read<hoNDArray<std::complex<float>>>(*peer));
+    });
+
+    IO::write(*gadgetron, array);
+    auto result = IO::read<hoNDArray<std::complex<float>>>(*gadgetron);
+    echo.join();
+
+    ASSERT_EQ(result, array);
+}
@@ -4,6 +4,7 @@
 #include "../connection/SocketStreamBuf.h"
 #include <boost/asio.hpp>
 #include <gtest/gtest.h>
+#include <numeric>
 #include <random>
 
 namespace ba = boost::asio;
@@ -50,6 +51,37 @@ TEST_F(SocketTest, read_test) {
     ASSERT_EQ(data,data2);
 }
 
+TEST_F(SocketTest, large_read_test) {
+
+    auto data = std::vector<char>(1u << 22);
+    std::iota(data.begin(), data.end(), 0);
+
+    auto thread = std::thread([&](){ ba::write(*server_socket,ba::buffer(data.data(),data.size())); });
+
+    // A small read first, so the large read starts out partially buffered.
+    auto data2 = std::vector<char>(data.size());
+    socketstream->read(data2.data(),7);
+    socketstream->read(data2.data()+7,data2.size()-7);
+
+    ASSERT_EQ(socketstream->gcount(),data2.size()-7);
+    ASSERT_EQ(data,data2);
+    thread.join();
+}
+
+TEST_F(SocketTest, large_read_past_end_of_stream) {
+
+    auto data = std::vector<char>(1000, 42);
+    ba::write(*server_socket,ba::buffer(data.data(),data.size()));
+    server_socket->close();
+
+    auto data2 = std::vector<char>(1u << 22);
+    ASSERT_NO_THROW(socketstream->read(data2.data(),data2.size()));
+
+    ASSERT_EQ(socketstream->gcount(),data.size());
+    ASSERT_TRUE(socketstream->fail());
+    ASSERT_TRUE(std::equal(data.begin(),data.end(),data2.begin()));
+}
+
 TEST_F(SocketTest, write_test) {
 
     auto data = std::vector<char>(1u << 22,42);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/optional.hpp>
+
+namespace Gadgetron::Storage::REST {
+
+    /**
+     * HTTP body serving a byte range of a memory mapped file.
+     *
+     * The range is handed to the socket as a single buffer pointing into the mapping, so blobs are sent straight
+     * from the page cache rather than being read into memory first.
+     */
+    struct MappedFileBody {
+
+        class value_type {
+        public:
+            void open(const boost::filesystem::path &path, boost::beast::error_code &ec) {
+                namespace bip = boost::interprocess;
+
+                file_size_ = boost::filesystem::file_size(path, ec);
+                if (ec) return;
+
+                offset = 0;
+                length = file_size_;
+                region = bip::mapped_region();
+                if (file_size_ == 0) return;
+
+                try {
+                    bip::file_mapping mapping(path.c_str(), bip::read_only);
+                    region = bip::mapped_region(mapping, bip::read_only);
+                    region.advise(bip::mapped_region::advice_sequential);
+                } catch (const bip::interprocess_exception &) {
+                    ec = boost::beast::errc::make_error_code(boost::beast::errc::io_error);
+                }
+            }
+
+            /// Restricts the body to length bytes starting at offset, which must lie within the file.
+            void select(std::uint64_t offset, std::uint64_t length) {
+                this->offset = offset;
+                this->length = length;
+            }
+
+            std::uint64_t file_size() const { return file_size_; }
+
+            std::uint64_t size() const { return length; }
+
+            const char *data() const { return static_cast<const char *>(region.get_address()) + offset; }
+
+        private:
+            boost::interprocess::mapped_region region;
+            std::uint64_t file_size_ = 0;
+            std::uint64_t offset = 0;
+            std::uint64_t length = 0;
+        };
+
+        static std::uint64_t size(const value_type &body) { return body.size(); }
+
+        class writer {
+        public:
+            using const_buffers_type = boost::asio::const_buffer;
+
+            template<bool isRequest, class Fields>
+            writer(const boost::beast::http::header<isRequest, Fields> &, const value_type &body) : body(body) {}
+
+            void init(boost::beast::error_code &ec) { ec = {}; }
+
+            boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code &ec) {
+                ec = {};
+                if (done || body.size() == 0) return boost::none;
+                done = true;
+                return std::make_pair(const_buffers_type(body.data(), body.size()), false);
+            }
+
+        private:
+            const value_type &body;
+            bool done = false;
+        };
+    };
+}
@@ -9,6 +9,9 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <range/v3/view/transform.hpp>
 #include <range/v3/range/conversion.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <map>
+#include <mutex>
 #include <regex>
 
 namespace beast = boost::beast;     // from <boost/beast.hpp>
@@ -68,95 +71,156 @@ namespace {
         req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
         return req;
     }
+}
 
-    auto connect_stream(net::io_context &ioc, const std::string &host, const std::string &service) {
-        tcp::resolver resolver(ioc);
-        beast::tcp_stream stream(ioc);
-        auto const results = resolver.resolve(host, service);
-        stream.connect(results);
-        return stream;
-    }
+namespace Gadgetron::Storage {
+
+    class ConnectionPool {
+    public:
+        ConnectionPool(std::string host, std::string service, size_t max_idle = 8)
+            : host(std::move(host)), service(std::move(service)), max_idle(max_idle) {}
+
+        const std::string& hostname() const { return host; }
+
+        template<class ResponseBody, class Request>
+        http::response<ResponseBody> request(const Request &req) {
+            for (bool retry = true;; retry = false) {
+                auto [stream, reused] = acquire(retry);
+
+                beast::error_code ec;
+                auto written = http::write(stream, req, ec);
+                bool unsent = ec && written == 0;
+
+                beast::flat_buffer buffer;
+                http::response_parser<ResponseBody> parser;
+                parser.body_limit(128ull * 1024ull * 1024ull * 1024ull); //We support files up to 128GB. For now.
+                if (!ec) http::read(stream, buffer, parser, ec);
+
+                if (ec) {
+                    // The server may have closed a pooled connection while it was idle. The request is sent again on
+                    // a new connection only if that cannot repeat its effect: it is a GET, or none of it was written.
+                    // A POST or PATCH may have been processed even if no response came back.
+                    bool idempotent = req.method() == http::verb::get || req.method() == http::verb::head;
+                    if (reused && retry && !parser.got_some() && (idempotent || unsent)) continue;
+                    throw beast::system_error(ec);
+                }
+
+                auto response = parser.release();
+                if (response.keep_alive()) {
+                    release(std::move(stream));
+                } else {
+                    stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+                }
+                return response;
+            }
+        }
+
+    private:
+        std::pair<beast::tcp_stream, bool> acquire(bool reuse) {
+            if (reuse) {
+                std::lock_guard guard(mutex);
+                if (!idle.empty()) {
+                    auto stream = std::move(idle.back());
+                    idle.pop_back();
+                    return {std::move(stream), true};
+                }
+            }
+
+            tcp::resolver resolver(ioc);
+            beast::tcp_stream stream(ioc);
+            stream.connect(resolver.resolve(host, service));
+            return {std::move(stream), false};
+        }
+
+        void release(beast::tcp_stream stream) {
+            std::lock_guard guard(mutex);
+            if (idle.size() < max_idle) idle.push_back(std::move(stream));
+        }
+
+        const std::string host, service;
+        const size_t max_idle;
+
+        net::io_context ioc;
+        std::mutex mutex;
+        std::vector<beast::tcp_stream> idle;
+    };
+}
+
+namespace {
+    using Gadgetron::Storage::ConnectionPool;
 
     json get_content(
-        const std::string &host,
-        const std::string &service,
+        ConnectionPool &connections,
         const std::string &group,
         const std::string &subject,
         const std::string &key
     ) {
-        net::io_context ioc;
-        auto stream = connect_stream(ioc, host, service);
         auto json_body = json{{"storagespace", group},
                               {"subject",      subject},
                               {"key",          key}};
-        auto req = make_json_request(http::verb::get, host, "/v1/data", json_body);
-        http::write(stream, req);
-
-        beast::flat_buffer buffer;
-        http::response<http::string_body> response;
-        http::read(stream, buffer, response);
-        stream.socket().shutdown(tcp::socket::shutdown_both);
+        auto req = make_json_request(http::verb::get, connections.hostname(), "/v1/data", json_body);
+        auto response = connections.request<http::string_body>(req);
         return json::parse(response.body());
     }
 
-    std::vector<char> fetch_data(const std::string &host, const std::string &service, const std::string &path) {
-        net::io_context ioc;
-        auto stream = connect_stream(ioc, host, service);
-        auto req = make_empty_request(http::verb::get, host, path);
-        http::write(stream, req);
-        beast::flat_buffer buf;
-
-        http::response_parser<http::vector_body<char>> response_parser;
-        response_parser.body_limit(128ull * 1024ull * 1024ull * 1024ull); //We support files up to 128GB. For now.
-        http::read(stream, buf, response_parser);
-        stream.socket().shutdown(tcp::socket::shutdown_both);
-        return std::move(response_parser.get().body());
+    std::vector<char> fetch_data(ConnectionPool &connections, const std::string &path) {
+        auto req = make_empty_request(http::verb::get, connections.hostname(), path);
+        auto response = connections.request<http::vector_body<char>>(req);
+        return std::move(response.body());
+    }
+
+    std::vector<char> fetch_data_range(ConnectionPool &connections, const std::string &path, size_t offset, size_t length) {
+        if (length == 0) return {};
+
+        auto req = make_empty_request(http::verb::get, connections.hostname(), path);
+        req.set(http::field::range, "bytes=" + std::to_string(offset) + "-" + std::to_string(offset + length - 1));
+        auto response = connections.request<http::vector_body<char>>(req);
+        auto& body = response.body();
+
+        switch (response.result()) {
+            case http::status::partial_content:
+                return std::move(body);
+            case http::status::range_not_satisfiable:
+                return {};
+            case http::status::ok: {
+                // The server ignored the range and sent the whole blob.
+                auto first = std::min(offset, body.size());
+                auto last = std::min(body.size(), first + length);
+                return std::vector<char>(body.begin() + first, body.begin() + last);
+            }
+            default:
+                throw std::runtime_error("Storage server reported error " + std::string(body.begin(), body.end()));
+        }
     }
 
     json store_request(
-        const std::string &host,
-        const std::string &service,
+        ConnectionPool &connections,
         const std::string &group,
         const std::string &subject,
         const std::string &key,
         const boost::posix_time::time_duration &duration
     ) {
-        net::io_context ioc;
-        auto stream = connect_stream(ioc, host, service);
         auto json_body = json{{"storagespace", group},
                               {"subject",      subject},
                               {"key",          key},
                               {"storage_duration",     boost::posix_time::to_simple_string(duration)}};
-        auto req = make_json_request(http::verb::post, host, "/v1/data", json_body);
-        http::write(stream, req);
-
-        beast::flat_buffer buffer;
-        http::response<http::string_body> response;
-        http::read(stream, buffer, response);
-        stream.socket().shutdown(tcp::socket::shutdown_both);
+        auto req = make_json_request(http::verb::post, connections.hostname(), "/v1/data", json_body);
+        auto response = connections.request<http::string_body>(req);
         if (to_status_class(response.result()) != http::status_class::successful) throw std::runtime_error("Storage server reported error " + response.body());
         return json::parse(response.body());
     }
 
     void store_content(
-        const std::string &host,
-        const std::string &service,
+        ConnectionPool &connections,
         const std::string &path,
         std::vector<char> data
     ) {
-        net::io_context ioc;
-        auto stream = connect_stream(ioc, host, service);
-
         http::request<http::vector_body<char>> req{http::verb::patch, path, http_version};
-        req.set(http::field::host, host);
+        req.set(http::field::host, connections.hostname());
         req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
         req.body() = std::move(data);
         req.prepare_payload();
-        http::write(stream, req);
-        http::response<http::string_body> response;
-        beast::flat_buffer buffer;
-        http::read(stream, buffer, response);
-        stream.socket().shutdown(tcp::socket::shutdown_both);
+        auto response = connections.request<http::string_body>(req);
         if (to_status_class(response.result()) != http::status_class::successful) throw std::runtime_error("Storage server reported error " + response.body());
 
     }
@@ -266,10 +330,15 @@ namespace Gadgetron::Storage {
         std::string host,
         std::string service,
         std::string group
-    ) : host(std::move(host)), service(std::move(service)), group(std::move(group)) {}
+    ) : RESTStorageClient(std::make_shared<ConnectionPool>(std::move(host), std::move(service)), std::move(group)) {}
+
+    RESTStorageClient::RESTStorageClient(
+        std::shared_ptr<ConnectionPool> connections,
+        std::string group
+    ) : connections(std::move(connections)), group(std::move(group)) {}
 
     std::vector<std::string> RESTStorageClient::content(const std::string& subject, const std::string &key) const {
-        auto response = get_content(host, service, group, subject, key);
+        auto response = get_content(*connections, group, subject, key);
 
         return response
                | ranges::views::transform([](const auto &json_value) {
@@ -279,7 +348,11 @@ namespace Gadgetron::Storage {
     }
 
     std::vector<char> RESTStorageClient::fetch(const std::string &uuid) const {
-        return fetch_data(host, service, uuid);
+        return fetch_data(*connections, uuid);
+    }
+
+    std::vector<char> RESTStorageClient::fetch_range(const std::string &uuid, size_t offset, size_t length) const {
+        return fetch_data_range(*connections, uuid, offset, length);
     }
 
     void RESTStorageClient::store(
@@ -288,9 +361,48 @@ namespace Gadgetron::Storage {
         const std::vector<char> &value,
         boost::posix_time::time_duration duration
     ) {
-        auto response = store_request(host, service, group, subject, key, duration);
+        auto response = store_request(*connections, group, subject, key, duration);
         auto blob_path = response["storage_path"];
-        store_content(host, service, blob_path, value);
+        store_content(*connections, blob_path, value);
+    }
+}
+
+namespace {
+    using namespace Gadgetron;
+
+    // Keys under which the gadgets store what later measurements depend on, by dependency type.
+    const std::map<std::string, std::string> dependency_keys = {
+        {"noise", "noise_covariance"}
+    };
+
+    struct SharedStorage {
+        std::shared_ptr<Storage::ConnectionPool> connections;
+        std::shared_ptr<Storage::ObjectCache> cache;
+    };
+
+    // Connections and cached objects are kept for the lifetime of the process. When connections to the Gadgetron are
+    // handled on threads of one process, later connections reuse them. When every connection runs in a process of its
+    // own, as forked by release builds, they are only shared by the storage spaces of that connection.
+    SharedStorage shared_storage(const std::string &host, const std::string &service) {
+        static std::mutex mutex;
+        static std::map<std::pair<std::string, std::string>, SharedStorage> storage;
+
+        std::lock_guard guard(mutex);
+        auto &shared = storage[std::pair(host, service)];
+        if (!shared.connections) {
+            shared.connections = std::make_shared<Storage::ConnectionPool>(host, service);
+            shared.cache = std::make_shared<Storage::ObjectCache>();
+        }
+        return shared;
+    }
+
+    void prefetch_dependencies(MeasurementSpace &measurement, const ISMRMRD::IsmrmrdHeader &header) {
+        if (!header.measurementInformation) return;
+
+        for (auto &dependency : header.measurementInformation->measurementDependency) {
+            auto key = dependency_keys.find(boost::algorithm::to_lower_copy(dependency.dependencyType));
+            if (key != dependency_keys.end()) measurement.prefetch(dependency.measurementID, key->second);
+        }
     }
 }
 
@@ -301,9 +413,15 @@ Gadgetron::StorageSpaces Gadgetron::Storage::setup_storage(
     GDEBUG_STREAM("Using storage address: " << address);
     auto [scheme, user, host, port, path, query, fragment] = parse_url(address);
     auto service = port.empty() ? scheme : port;
-    return {
-        StorageSpace(std::make_shared<RESTStorageClient>(host, service, "session"), patientStudyID(header), boost::posix_time::time_duration(48,0,0)),
-        StorageSpace(std::make_shared<RESTStorageClient>(host, service, "scanner"), scannerID(header), boost::posix_time::time_duration(48,0,0)),
-        MeasurementSpace(std::make_shared<RESTStorageClient>(host, service, "measurement" ), measurementID(header), boost::posix_time::time_duration(48,0,0))
+    auto [connections, cache] = shared_storage(host, service);
+    auto duration = boost::posix_time::time_duration(48,0,0);
+
+    StorageSpaces spaces{
+        StorageSpace(std::make_shared<RESTStorageClient>(connections, "session"), patientStudyID(header), duration, cache),
+        StorageSpace(std::make_shared<RESTStorageClient>(connections, "scanner"), scannerID(header), duration, cache),
+        MeasurementSpace(std::make_shared<RESTStorageClient>(connections, "measurement" ), measurementID(header), duration, cache)
     };
+
+    prefetch_dependencies(spaces.measurement, header);
+    return spaces;
 }
@@ -6,24 +6,36 @@
 
 namespace Gadgetron::Storage{
 
+    /**
+     * Keep-alive connections to a storage server, shared by the clients of every storage space.
+     * Connections are returned to the pool after each request, unless the server asked to close them.
+     */
+    class ConnectionPool;
 
 class RESTStorageClient : public StreamProvider {
     public:
         RESTStorageClient(std::string host, std::string service, std::string group);
+        RESTStorageClient(std::shared_ptr<ConnectionPool> connections, std::string group);
 
         ~RESTStorageClient() override = default;
 
         std::vector<std::string> content(const std::string& subject, const std::string &key) const override;
         std::vector<char> fetch(const std::string &uuid) const override;
+        std::vector<char> fetch_range(const std::string &uuid, size_t offset, size_t length) const override;
 
         void store(const std::string& subject, const std::string &key, const std::vector<char> &value,
                    boost::posix_time::time_duration duration) override;
 
     private:
-        std::string host, service;
+        std::shared_ptr<ConnectionPool> connections;
         std::string group;
     };
 
+    /**
+     * Sets up the storage spaces of a connection. Connections to the server and the cache of fetched objects are
+     * shared with earlier connections to the same address handled by the same process, and the dependencies listed
+     * in the header are prefetched in the background.
+     */
     StorageSpaces setup_storage(const std::string& address, const ISMRMRD::IsmrmrdHeader& header );
 }
 
@@ -6,6 +6,7 @@
 #include <boost/beast.hpp>
 #include <thread>
 #include "RESTServer.h"
+#include "MappedFileBody.h"
 
 #include <nlohmann/json.hpp>
 #include <boost/asio/deadline_timer.hpp>
@@ -16,6 +17,7 @@
 #include <boost/uuid/string_generator.hpp>
 #include "Database.h"
 #include <range/v3/algorithm.hpp>
+#include <charconv>
 
 
 using namespace Gadgetron::Storage;
@@ -137,6 +139,49 @@ namespace {
         return std::string(target);
     }
 
+    struct ByteRange {
+        std::uint64_t offset = 0, length = 0;
+        bool satisfiable = true;
+    };
+
+    // Parses a single range of the form "bytes=first-last", "bytes=first-" or "bytes=-suffix_length".
+    // Anything else, including requests for several ranges, is answered with the whole blob, as RFC 7233 allows.
+    std::optional<ByteRange> parse_range(beast::string_view header, std::uint64_t size) {
+        std::string_view value(header.data(), header.size());
+        constexpr std::string_view unit = "bytes=";
+        if (value.substr(0, unit.size()) != unit) return {};
+        value.remove_prefix(unit.size());
+
+        auto dash = value.find('-');
+        if (dash == std::string_view::npos || value.find(',') != std::string_view::npos) return {};
+
+        auto parse = [](std::string_view text, std::uint64_t &number) {
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+            return error == std::errc() && end == text.data() + text.size();
+        };
+
+        auto first_text = value.substr(0, dash), last_text = value.substr(dash + 1);
+        std::uint64_t first = 0, last = 0;
+
+        if (first_text.empty()) {
+            if (!parse(last_text, last)) return {};
+            if (last == 0 || size == 0) return ByteRange{0, 0, false};
+            auto length = std::min(last, size);
+            return ByteRange{size - length, length};
+        }
+
+        if (!parse(first_text, first)) return {};
+        if (last_text.empty()) {
+            last = size - 1;
+        } else if (!parse(last_text, last) || last < first) {
+            return {};
+        }
+
+        if (first >= size) return ByteRange{0, 0, false};
+        last = std::min(last, size - 1);
+        return ByteRange{first, last - first + 1};
+    }
+
     struct BlobStorageEndPoint {
 
         std::shared_ptr<Database> database;
@@ -202,15 +247,36 @@ namespace {
 
             auto path = blob_folder / to_string(blob_id);
 
-            http::response<http::file_body> response(http::status::ok, req.get().version());
+            http::response<REST::MappedFileBody> response(http::status::ok, req.get().version());
             response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
             response.set(http::field::content_type, "application/json");
+            response.set(http::field::accept_ranges, "bytes");
+            response.keep_alive(req.get().keep_alive());
             beast::error_code ec;
-            response.body().open(path.c_str(), beast::file_mode::read, ec);
+            response.body().open(path, ec);
             if (ec) {
                 return send(string_response(ec.message(), http::status::not_found, req.get()));
             }
 
+            auto size = response.body().file_size();
+            auto range_header = req.get().find(http::field::range);
+            if (range_header != req.get().end()) {
+                if (auto range = parse_range(range_header->value(), size)) {
+                    if (!range->satisfiable) {
+                        auto failure = string_response("Requested range not satisfiable",
+                                                       http::status::range_not_satisfiable, req.get());
+                        failure.set(http::field::content_range, "bytes */" + std::to_string(size));
+                        return send(failure);
+                    }
+
+                    response.result(http::status::partial_content);
+                    response.set(http::field::content_range,
+                                 "bytes " + std::to_string(range->offset) + "-" +
+                                 std::to_string(range->offset + range->length - 1) + "/" + std::to_string(size));
+                    response.body().select(range->offset, range->length);
+                }
+            }
+
             response.prepare_payload();
             return send(response);
         }
@@ -6,10 +6,60 @@
 #include "StorageServer.h"
 #include "RESTStorageClient.h"
 #include <range/v3/range.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <atomic>
+#include <future>
+#include <thread>
 using namespace Gadgetron::Storage;
 using namespace Gadgetron;
 
 
+namespace {
+    class CountingProvider : public StreamProvider {
+    public:
+        explicit CountingProvider(std::shared_ptr<StreamProvider> provider) : provider(std::move(provider)) {}
+
+        std::vector<std::string> content(const std::string &subject, const std::string &key) const override {
+            content_calls++;
+            return provider->content(subject, key);
+        }
+
+        std::vector<char> fetch(const std::string &uuid) const override {
+            fetch_calls++;
+            return provider->fetch(uuid);
+        }
+
+        void store(const std::string &subject, const std::string &key, const std::vector<char> &data,
+                   boost::posix_time::time_duration duration) override {
+            provider->store(subject, key, data, duration);
+        }
+
+        mutable std::atomic<int> content_calls{0}, fetch_calls{0};
+
+    private:
+        std::shared_ptr<StreamProvider> provider;
+    };
+
+    // Content lookups wait until the gate is opened.
+    class BlockingProvider : public StreamProvider {
+    public:
+        explicit BlockingProvider(std::shared_future<void> gate) : gate(std::move(gate)) {}
+
+        std::vector<std::string> content(const std::string &, const std::string &) const override {
+            gate.wait();
+            return {};
+        }
+
+        std::vector<char> fetch(const std::string &) const override { return {}; }
+
+        void store(const std::string &, const std::string &, const std::vector<char> &,
+                   boost::posix_time::time_duration) override {}
+
+    private:
+        std::shared_future<void> gate;
+    };
+}
+
 class ServerTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -23,6 +73,11 @@ protected:
         storage = Storage::setup_storage("https://localhost:" + std::to_string(server->port()), header);
     }
 
+    StorageSpace counted_space(std::shared_ptr<CountingProvider> provider) {
+        return StorageSpace(provider, std::string("Penny the Pirate/YAAARH"), boost::posix_time::hours(1),
+                            std::make_shared<ObjectCache>());
+    }
+
     void TearDown() override {
         server = nullptr;
         boost::filesystem::remove_all(temp_dir);
@@ -107,4 +162,124 @@ TEST_F(ServerTest,image_test){
 
     auto [stored_header,stored_data,stored_meta] = storage_list[0];
     ASSERT_EQ(data,stored_data);
-}
\ No newline at end of file
+}
+
+TEST_F(ServerTest,cached_fetch){
+    auto provider = std::make_shared<CountingProvider>(
+        std::make_shared<RESTStorageClient>("localhost", std::to_string(server->port()), "session"));
+    auto space = counted_space(provider);
+
+    hoNDArray<float> x(128);
+    std::fill(x.begin(),x.end(),7);
+    space.store("stuff",x);
+
+    auto storage_list = space.fetch<hoNDArray<float>>("stuff");
+    ASSERT_EQ(x,storage_list[0]);
+    ASSERT_EQ(x,storage_list[0]);
+    ASSERT_EQ(x,space.fetch<hoNDArray<float>>("stuff")[0]);
+
+    ASSERT_EQ(provider->content_calls.load(),2);
+    ASSERT_EQ(provider->fetch_calls.load(),1);
+}
+
+TEST_F(ServerTest,prefetch){
+    auto provider = std::make_shared<CountingProvider>(
+        std::make_shared<RESTStorageClient>("localhost", std::to_string(server->port()), "session"));
+    auto space = counted_space(provider);
+
+    hoNDArray<float> x(2,2);
+    std::fill(x.begin(),x.end(),23);
+    space.store("stuff",x);
+
+    space.prefetch("stuff");
+    auto storage_list = space.fetch<hoNDArray<float>>("stuff");
+    ASSERT_EQ(storage_list.size(),1);
+    ASSERT_EQ(x,storage_list[0]);
+    ASSERT_EQ(provider->content_calls.load(),1);
+    ASSERT_EQ(provider->fetch_calls.load(),1);
+
+    // The prefetched content is only used once, so a later store is seen by the next fetch.
+    space.store("stuff",x);
+    ASSERT_EQ(space.fetch<hoNDArray<float>>("stuff").size(),2);
+}
+
+TEST(Prefetch,untaken_prefetch_does_not_block){
+    std::promise<void> gate;
+    auto provider = std::make_shared<BlockingProvider>(gate.get_future().share());
+
+    // Dropping a storage space must not wait for the prefetches nobody took.
+    auto dropped = std::async(std::launch::async, [&]() {
+        StorageSpace space(provider, std::string("Penny the Pirate/YAAARH"), boost::posix_time::hours(1), nullptr);
+        space.prefetch("stuff");
+    });
+    auto status = dropped.wait_for(std::chrono::seconds(5));
+    gate.set_value();
+
+    ASSERT_EQ(status, std::future_status::ready);
+}
+
+TEST_F(ServerTest,concurrent_requests){
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([this, t]() {
+            hoNDArray<float> x(64);
+            std::fill(x.begin(), x.end(), float(t));
+            for (int i = 0; i < 8; i++) this->storage.session.store("thread_" + std::to_string(t), x);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 0; t < 4; t++) {
+        auto storage_list = this->storage.session.fetch<hoNDArray<float>>("thread_" + std::to_string(t));
+        ASSERT_EQ(storage_list.size(),8);
+        ASSERT_EQ(storage_list[7][0],float(t));
+    }
+}
+
+TEST(ObjectCache,evicts_least_recently_used){
+    ObjectCache cache(100);
+    cache.put("a",1,40,boost::posix_time::hours(1));
+    cache.put("b",2,40,boost::posix_time::hours(1));
+    ASSERT_EQ(*cache.get<int>("a"),1);
+
+    cache.put("c",3,40,boost::posix_time::hours(1));
+    ASSERT_EQ(cache.size_in_bytes(),80);
+    ASSERT_TRUE(cache.get<int>("a"));
+    ASSERT_FALSE(cache.get<int>("b"));
+    ASSERT_TRUE(cache.get<int>("c"));
+
+    // Entries are typed, and too large ones are not cached at all.
+    ASSERT_FALSE(cache.get<float>("a"));
+    cache.put("d",4,200,boost::posix_time::hours(1));
+    ASSERT_FALSE(cache.get<int>("d"));
+}
+
+TEST(ObjectCache,expires_entries){
+    ObjectCache cache;
+    cache.put("a",1,4,boost::posix_time::milliseconds(0));
+    cache.put("b",2,4,boost::posix_time::hours(1));
+    ASSERT_FALSE(cache.get<int>("a"));
+    ASSERT_EQ(*cache.get<int>("b"),2);
+    ASSERT_EQ(cache.size_in_bytes(),4);
+}
+
+TEST_F(ServerTest,range_fetch){
+    hoNDArray<float> x(4,3,5);
+    for (size_t i = 0; i < x.size(); i++) x[i] = float(i);
+    this->storage.session.store("array",x);
+
+    auto storage_list = this->storage.session.fetch<hoNDArray<float>>("array");
+    auto whole = storage_list.fetch_range(0,0,1ull << 20);
+    auto part = storage_list.fetch_range(0,8,16);
+    ASSERT_EQ(part.size(),16);
+    ASSERT_TRUE(std::equal(part.begin(),part.end(),whole.begin()+8));
+
+    // Ranges are clipped to the end of the blob, and empty past it.
+    ASSERT_EQ(storage_list.fetch_range(0,whole.size()-4,100).size(),4);
+    ASSERT_TRUE(storage_list.fetch_range(0,whole.size()+10,100).empty());
+
+    auto slice = fetch_slice(storage_list,0,3);
+    ASSERT_EQ(slice.dimensions(),std::vector<size_t>({4,3,1}));
+    for (size_t i = 0; i < slice.size(); i++) ASSERT_EQ(slice[i],x[3*12+i]);
+    ASSERT_THROW(fetch_slice(storage_list,0,5),std::out_of_range);
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "MPMCChannel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Gadgetron::Core {
+
+    /**
+     * A bounded multi-producer multi-consumer channel backed by a fixed size ring buffer.
+     *
+     * Pushing to a full channel blocks until a consumer has made room, which gives backpressure to upstream
+     * producers. Slots are claimed with atomic sequence numbers (D. Vyukov's bounded queue), so neither push nor pop
+     * takes a lock unless the channel is full or empty, and no heap allocation happens per message.
+     * The single-producer/single-consumer case never contends on anything but the two ring indices and the count.
+     *
+     * The ring itself is sized to the next power of two, but a separate count of held messages keeps the channel at
+     * exactly the requested capacity.
+     */
+    template <class T> class BoundedMPMCChannel {
+    public:
+        explicit BoundedMPMCChannel(size_t capacity);
+        ~BoundedMPMCChannel();
+
+        BoundedMPMCChannel(const BoundedMPMCChannel&) = delete;
+        BoundedMPMCChannel& operator=(const BoundedMPMCChannel&) = delete;
+
+        /// Blocks while the channel is full. Throws ChannelClosed if the channel is closed.
+        void push(T);
+
+        template <class... ARGS> void emplace(ARGS&&... args);
+
+        /// Pushes the message if there is room, returns false otherwise.
+        bool try_push(T& message);
+
+        /// Blocks while the channel is empty. Throws ChannelClosed once the channel is closed and drained.
+        T pop();
+        optional<T> try_pop();
+
+        void close();
+
+        size_t capacity() const { return max_size; }
+
+        /// Approximate number of messages currently held. Exact only when the channel is quiescent.
+        size_t size() const;
+
+    private:
+        struct alignas(64) Cell {
+            std::atomic<size_t> sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+            T* get() { return reinterpret_cast<T*>(&storage); }
+        };
+
+        template <class... ARGS> bool try_enqueue(ARGS&&... args);
+        bool try_dequeue(optional<T>& out);
+
+        bool try_reserve();
+        void release();
+
+        void notify_consumers();
+        void notify_producers();
+
+        static size_t round_up_to_power_of_two(size_t value);
+
+        const size_t max_size;
+        const size_t mask;
+        std::unique_ptr<Cell[]> buffer;
+
+        // Messages held or being pushed; never exceeds max_size.
+        alignas(64) std::atomic<size_t> count{ 0 };
+
+        alignas(64) std::atomic<size_t> enqueue_pos{ 0 };
+        alignas(64) std::atomic<size_t> dequeue_pos{ 0 };
+
+        alignas(64) std::atomic<bool> is_closed{ false };
+        std::atomic<unsigned> waiting_consumers{ 0 };
+        std::atomic<unsigned> waiting_producers{ 0 };
+        std::mutex m;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+    };
+
+    /** Implementation **/
+
+    // At least two cells, as a single cell cannot tell a full slot from an empty one by its sequence number.
+    template <class T> size_t BoundedMPMCChannel<T>::round_up_to_power_of_two(size_t value) {
+        size_t result = 2;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    template <class T>
+    BoundedMPMCChannel<T>::BoundedMPMCChannel(size_t capacity)
+        : max_size{ capacity }, mask{ round_up_to_power_of_two(capacity) - 1 },
+          buffer{ std::make_unique<Cell[]>(mask + 1) } {
+        if (capacity == 0)
+            throw std::invalid_argument("BoundedMPMCChannel capacity must be positive");
+        for (size_t i = 0; i <= mask; i++)
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <class T> BoundedMPMCChannel<T>::~BoundedMPMCChannel() {
+        optional<T> discarded;
+        while (try_dequeue(discarded))
+            discarded.reset();
+    }
+
+    template <class T> bool BoundedMPMCChannel<T>::try_reserve() {
+        size_t held = count.load(std::memory_order_relaxed);
+        while (held < max_size) {
+            if (count.compare_exchange_weak(held, held + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::release() {
+        count.fetch_sub(1, std::memory_order_release);
+    }
+
+    template <class T> template <class... ARGS> bool BoundedMPMCChannel<T>::try_enqueue(ARGS&&... args) {
+        if (!try_reserve())
+            return false;
+
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell          = &buffer[pos & mask];
+            size_t seq    = cell->sequence.load(std::memory_order_acquire);
+            auto distance = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (distance == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (distance < 0) {
+                // The cell is still being emptied by a consumer which has already taken the message.
+                release();
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->get()) T(std::forward<ARGS>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T> bool BoundedMPMCChannel<T>::try_dequeue(optional<T>& out) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell          = &buffer[pos & mask];
+            size_t seq    = cell->sequence.load(std::memory_order_acquire);
+            auto distance = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (distance == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (distance < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        out.emplace(std::move(*cell->get()));
+        cell->get()->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        release();
+        return true;
+    }
+
+    // Waiters register themselves before their final attempt, and the other side checks for waiters after its
+    // operation. The fences guarantee that at least one of the two sees the other, so no wakeup is lost.
+    template <class T> void BoundedMPMCChannel<T>::notify_consumers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_consumers.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> guard(m);
+            not_empty.notify_one();
+        }
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::notify_producers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_producers.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> guard(m);
+            not_full.notify_one();
+        }
+    }
+
+    template <class T> bool BoundedMPMCChannel<T>::try_push(T& message) {
+        if (is_closed.load(std::memory_order_acquire))
+            throw ChannelClosed();
+        if (!try_enqueue(std::move(message)))
+            return false;
+        notify_consumers();
+        return true;
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::push(T message) {
+        emplace(std::move(message));
+    }
+
+    template <class T> template <class... ARGS> void BoundedMPMCChannel<T>::emplace(ARGS&&... args) {
+        if (is_closed.load(std::memory_order_acquire))
+            throw ChannelClosed();
+
+        if (!try_enqueue(std::forward<ARGS>(args)...)) {
+            std::unique_lock<std::mutex> lock(m);
+            waiting_producers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!try_enqueue(std::forward<ARGS>(args)...)) {
+                if (is_closed.load(std::memory_order_acquire)) {
+                    waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+                    throw ChannelClosed();
+                }
+                not_full.wait(lock);
+            }
+            waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        notify_consumers();
+    }
+
+    template <class T> optional<T> BoundedMPMCChannel<T>::try_pop() {
+        optional<T> message;
+        if (try_dequeue(message))
+            notify_producers();
+        return message;
+    }
+
+    template <class T> T BoundedMPMCChannel<T>::pop() {
+        optional<T> message;
+        if (!try_dequeue(message)) {
+            std::unique_lock<std::mutex> lock(m);
+            waiting_consumers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!try_dequeue(message)) {
+                if (is_closed.load(std::memory_order_acquire)) {
+                    if (try_dequeue(message))
+                        break;
+                    waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+                    throw ChannelClosed();
+                }
+                not_empty.wait(lock);
+            }
+            waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        notify_producers();
+        return std::move(*message);
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::close() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            is_closed.store(true, std::memory_order_release);
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    template <class T> size_t BoundedMPMCChannel<T>::size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+}
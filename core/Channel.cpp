@@ -1,5 +1,7 @@
 #include "Channel.h"
 
+#include <algorithm>
+
 namespace Gadgetron::Core {
 
     class Channel::Closer {
@@ -28,12 +30,173 @@ namespace Gadgetron::Core {
        channel.close();
     }
 
+    size_t MessageChannel::size() {
+        return channel.size();
+    }
+
+    BoundedMessageChannel::BoundedMessageChannel(size_t capacity) : channel(capacity) {}
+
+    Message BoundedMessageChannel::pop() {
+        return channel.pop();
+    }
+
+    optional<Message> BoundedMessageChannel::try_pop() {
+        return channel.try_pop();
+    }
+
+    void BoundedMessageChannel::push_message(Message message) {
+        channel.push(std::move(message));
+    }
+
+    void BoundedMessageChannel::close() {
+        channel.close();
+    }
+
+    size_t BoundedMessageChannel::size() {
+        return channel.size();
+    }
+
+    BatchedMessageChannel::BatchedMessageChannel(size_t batch_size, std::chrono::microseconds window,
+                                                 optional<size_t> capacity)
+        : batch_size{ std::max<size_t>(batch_size, 1) }, window{ window }, capacity{ capacity } {
+        pending.reserve(this->batch_size);
+    }
+
+    void BatchedMessageChannel::push_message(Message message) {
+        bool wake_reader;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            // Messages handed to the reader count against the capacity until they are popped. The flag is only
+            // raised when the channel looks full, and the count checked again after raising it, so a reader popping
+            // concurrently either sees the flag or leaves a count we can push into.
+            while (capacity && !is_closed && held >= *capacity) {
+                writer_waiting = true;
+                if (held < *capacity) break;
+                not_full.wait(lock);
+            }
+            if (is_closed) throw ChannelClosed();
+
+            if (pending.empty()) first_pending = std::chrono::steady_clock::now();
+            pending.emplace_back(std::move(message));
+            held++;
+
+            // A waiting reader is woken by the first message, to start timing the window, and by a full batch.
+            wake_reader = reader_waiting && (pending.size() == 1 || pending.size() == batch_size);
+        }
+        if (wake_reader) batch_available.notify_one();
+    }
+
+    Message BatchedMessageChannel::pop() {
+        std::lock_guard<std::mutex> reader_guard(reader_mutex);
+        if (auto message = take_ready()) return std::move(*message);
+
+        std::unique_lock<std::mutex> lock(m);
+        while (!batch_ready(std::chrono::steady_clock::now())) {
+            if (is_closed) throw ChannelClosed();
+
+            reader_waiting = true;
+            if (pending.empty()) {
+                batch_available.wait(lock);
+            } else {
+                batch_available.wait_until(lock, first_pending + window);
+            }
+            reader_waiting = false;
+        }
+        take_pending(lock);
+
+        return std::move(*take_ready());
+    }
+
+    optional<Message> BatchedMessageChannel::try_pop() {
+        std::unique_lock<std::mutex> reader_guard(reader_mutex, std::try_to_lock);
+        if (!reader_guard) return none;
+        if (auto message = take_ready()) return message;
+
+        std::unique_lock<std::mutex> lock(m);
+        if (pending.empty()) return none;
+        take_pending(lock);
+
+        return take_ready();
+    }
+
+    void BatchedMessageChannel::close() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            is_closed = true;
+        }
+        batch_available.notify_all();
+        not_full.notify_all();
+    }
+
+    size_t BatchedMessageChannel::size() {
+        return held;
+    }
+
+    optional<Message> BatchedMessageChannel::take_ready() {
+        if (next_ready < ready.size()) {
+            auto message = std::move(ready[next_ready++]);
+            held--;
+            if (writer_waiting) {
+                {
+                    std::lock_guard<std::mutex> guard(m);
+                    writer_waiting = false;
+                }
+                not_full.notify_all();
+            }
+            return message;
+        }
+        ready.clear();
+        next_ready = 0;
+        return none;
+    }
+
+    bool BatchedMessageChannel::batch_ready(std::chrono::steady_clock::time_point now) const {
+        if (pending.empty()) return false;
+        return is_closed || pending.size() >= batch_size || now - first_pending >= window;
+    }
+
+    void BatchedMessageChannel::take_pending(std::unique_lock<std::mutex>& lock) {
+        // The drained batch is handed back to the writers, so its storage is reused rather than reallocated.
+        std::swap(ready, pending);
+        lock.unlock();
+    }
+
     Message GenericInputChannel::pop() {
-        return channel->pop();
+        if (!metrics) return channel->pop();
+
+        auto start = std::chrono::steady_clock::now();
+        if (last_pop) metrics->processing_time.record(start - *last_pop);
+        last_pop = none;
+
+        auto message = channel->pop();
+        record_input(message, start);
+        return message;
     }
 
     optional<Message> GenericInputChannel::try_pop() {
-        return channel->try_pop();
+        if (!metrics) return channel->try_pop();
+
+        auto start = std::chrono::steady_clock::now();
+        auto message = channel->try_pop();
+        if (message) record_input(*message, start);
+        return message;
+    }
+
+    void GenericInputChannel::instrument(std::shared_ptr<NodeMetrics> node_metrics) {
+        metrics = std::move(node_metrics);
+        last_pop = none;
+    }
+
+    void GenericInputChannel::record_input(const Message& message, std::chrono::steady_clock::time_point start) {
+        last_pop = std::chrono::steady_clock::now();
+
+        metrics->messages_in.fetch_add(1, std::memory_order_relaxed);
+        metrics->bytes_in.fetch_add(message.size(), std::memory_order_relaxed);
+        metrics->wait_ns.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(*last_pop - start).count(),
+            std::memory_order_relaxed
+        );
+        metrics->record_queue_depth(channel->size());
     }
 
     GenericInputChannel::GenericInputChannel(std::shared_ptr<Channel> channel) : channel{channel},
@@ -41,9 +204,17 @@ namespace Gadgetron::Core {
     }
 
     void OutputChannel::push_message(Gadgetron::Core::Message message) {
+        if (metrics) {
+            metrics->messages_out.fetch_add(1, std::memory_order_relaxed);
+            metrics->bytes_out.fetch_add(message.size(), std::memory_order_relaxed);
+        }
         channel->push_message(std::move(message));
     }
 
+    void OutputChannel::instrument(std::shared_ptr<NodeMetrics> node_metrics) {
+        metrics = std::move(node_metrics);
+    }
+
     OutputChannel::OutputChannel(std::shared_ptr<Channel> channel) : channel{channel},
                                                                      closer{std::make_shared<Channel::Closer>(
                                                                              channel)} {}
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <vector>
 
+#include "BoundedMPMCChannel.h"
 #include "MPMCChannel.h"
 #include "Message.h"
+#include "NodeMetrics.h"
 #include "Types.h"
 
 #include "ChannelIterator.h"
@@ -33,6 +37,9 @@ namespace Gadgetron { namespace Core {
 
         virtual void close() = 0;
 
+        /// Number of messages waiting in the channel. Channels unable to tell report 0.
+        virtual size_t size() { return 0; }
+
         class Closer;
     };
 
@@ -54,6 +61,9 @@ namespace Gadgetron { namespace Core {
 
         ChannelIterator<OutputChannel> begin();
 
+        /// Counts the messages and bytes pushed through this end of the channel in metrics.
+        void instrument(std::shared_ptr<NodeMetrics> metrics);
+
     private:
         OutputChannel(const OutputChannel&) = default;
 
@@ -65,6 +75,7 @@ namespace Gadgetron { namespace Core {
 
         std::shared_ptr<Channel> channel;
         std::shared_ptr<Channel::Closer> closer;
+        std::shared_ptr<NodeMetrics> metrics;
     };
 } }
 
@@ -89,6 +100,15 @@ namespace Gadgetron { namespace Core {
         /// Nonblocking method returning a message if one is available, or None otherwise
         optional<Message> try_pop();
 
+        /**
+         * Records the messages taken from this end of the channel in metrics, along with the depth of the channel
+         * and the time the reader spends between taking messages.
+         */
+        void instrument(std::shared_ptr<NodeMetrics> metrics);
+
+        /// The metrics this end of the channel records in, or nullptr if it is not instrumented.
+        const std::shared_ptr<NodeMetrics>& instrumentation() const { return metrics; }
+
     private:
         GenericInputChannel(const GenericInputChannel&) = default;
 
@@ -98,8 +118,12 @@ namespace Gadgetron { namespace Core {
 
         explicit GenericInputChannel(std::shared_ptr<Channel>);
 
+        void record_input(const Message& message, std::chrono::steady_clock::time_point start);
+
         std::shared_ptr<Channel::Closer> closer;
         std::shared_ptr<Channel> channel;
+        std::shared_ptr<NodeMetrics> metrics;
+        optional<std::chrono::steady_clock::time_point> last_pop;
     };
 
     template <class CHANNEL> class ChannelIterator;
@@ -119,9 +143,85 @@ namespace Gadgetron { namespace Core {
 
         void push_message(Message) override;
 
+        size_t size() override;
+
         MPMCChannel<Message> channel;
     };
 
+    /***
+     * A MessageChannel holding at most capacity messages. Pushing to a full channel blocks until the reader catches up.
+     */
+    class BoundedMessageChannel : public Channel {
+    public:
+        explicit BoundedMessageChannel(size_t capacity);
+
+    protected:
+        Message pop() override;
+
+        optional<Message> try_pop() override;
+
+        void close() override;
+
+        void push_message(Message) override;
+
+        size_t size() override;
+
+        BoundedMPMCChannel<Message> channel;
+    };
+
+    /***
+     * A channel handing messages to its readers in batches, to save the synchronisation a MessageChannel pays for
+     * every message.
+     *
+     * Pushed messages are gathered until batch_size of them are waiting, or the oldest has waited for window, before a
+     * waiting reader is woken. The reader then takes everything waiting in one go, and pops the messages one by one
+     * without touching the writer's side of the channel again. A reader which is busy when a batch fills up simply
+     * takes a larger batch when it comes back. If a capacity is given, writers block while capacity messages are
+     * waiting.
+     */
+    class BatchedMessageChannel : public Channel {
+    public:
+        BatchedMessageChannel(size_t batch_size, std::chrono::microseconds window, optional<size_t> capacity = none);
+
+    protected:
+        Message pop() override;
+
+        optional<Message> try_pop() override;
+
+        void close() override;
+
+        void push_message(Message) override;
+
+        size_t size() override;
+
+    private:
+        optional<Message> take_ready();
+        bool batch_ready(std::chrono::steady_clock::time_point now) const;
+        void take_pending(std::unique_lock<std::mutex>& lock);
+
+        const size_t batch_size;
+        const std::chrono::microseconds window;
+        const optional<size_t> capacity;
+
+        // Writer side; guarded by m.
+        std::mutex m;
+        std::condition_variable batch_available;
+        std::condition_variable not_full;
+        std::vector<Message> pending;
+        std::chrono::steady_clock::time_point first_pending;
+        bool reader_waiting = false;
+        bool is_closed = false;
+
+        // Reader side; guarded by reader_mutex.
+        std::mutex reader_mutex;
+        std::vector<Message> ready;
+        size_t next_ready = 0;
+
+        // Shared; messages pushed but not yet popped, and whether a writer is waiting for the count to drop.
+        std::atomic<size_t> held{ 0 };
+        std::atomic<bool> writer_waiting{ false };
+    };
+
     /***
      * Creates a ChannelPair
      * @tparam ChannelType Type of Channel, typically MessageChannel
@@ -20,6 +20,8 @@ namespace Gadgetron::Core {
 
         void close();
 
+        size_t size();
+
     private:
         T pop_impl(std::unique_lock<std::mutex> lock);
         std::list<T> queue;
@@ -68,6 +70,11 @@ namespace Gadgetron::Core {
         cv.notify_one();
     }
 
+    template <class T> size_t MPMCChannel<T>::size() {
+        std::lock_guard<std::mutex> lock(m);
+        return queue.size();
+    }
+
     template <class T> void MPMCChannel<T>::close() {
         {
             std::lock_guard<std::mutex> lock(m);
@@ -35,4 +35,8 @@ Gadgetron::Core::Message Gadgetron::Core::Message::clone(){
         cloned_messages.emplace_back(chunk->clone());
 
     return Message(std::move(cloned_messages));
-}
\ No newline at end of file
+}
+size_t Gadgetron::Core::Message::size() const {
+    return std::accumulate(messages_.begin(), messages_.end(), size_t(0),
+                           [](size_t total, const auto &chunk) { return total + chunk->size(); });
+}
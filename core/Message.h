@@ -22,6 +22,9 @@ namespace Gadgetron {
         public:
             virtual ~MessageChunk() = default;
             virtual std::unique_ptr<MessageChunk> clone() const = 0;
+
+            /// Approximate size of the data held by the chunk, in bytes.
+            virtual size_t size() const = 0;
         protected:
             virtual GadgetContainerMessageBase *to_container_message() = 0;
 
@@ -49,6 +52,9 @@ namespace Gadgetron {
 
             Message clone();
 
+            /// Approximate size of the data held by the message, in bytes.
+            size_t size() const;
+
         private:
             std::vector<std::unique_ptr<MessageChunk>> messages_;
         };
@@ -92,6 +98,8 @@ namespace Gadgetron {
 
             std::unique_ptr<MessageChunk> clone() const override;
 
+            size_t size() const override;
+
             ~TypedMessageChunk() override = default;
 
             T data;
@@ -22,6 +22,43 @@ namespace Gadgetron::Core {
         return std::make_unique<TypedMessageChunk<T>>(data);
     }
 
+    namespace payload_detail {
+
+        // Types holding data outside of themselves provide a payload_size overload of their own, found by
+        // argument dependent lookup (see mri_core_data.h). Other types are only counted if they are plain data.
+        template<class T>
+        size_t payload_size(const T &) { return std::is_trivially_copyable<T>::value ? sizeof(T) : 0; }
+
+        template<class T>
+        size_t payload_size(const hoNDArray<T> &array) { return array.get_number_of_bytes(); }
+
+        inline size_t payload_size(const std::string &str) { return str.size(); }
+
+        template<class T>
+        size_t payload_size(const std::vector<T> &vector);
+
+        template<class T>
+        size_t payload_size(const optional<T> &opt);
+
+        template<class T>
+        size_t payload_size(const std::vector<T> &vector) {
+            if (std::is_trivially_copyable<T>::value) return vector.size() * sizeof(T);
+
+            size_t total = 0;
+            for (const auto &element : vector) total += payload_size(element);
+            return total;
+        }
+
+        template<class T>
+        size_t payload_size(const optional<T> &opt) { return opt ? payload_size(*opt) : 0; }
+    }
+
+    template<class T>
+    size_t TypedMessageChunk<T>::size() const {
+        using payload_detail::payload_size;
+        return payload_size(data);
+    }
+
     namespace {
         namespace gadgetron_message_detail {
 
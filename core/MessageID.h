@@ -12,6 +12,10 @@ namespace Gadgetron::Core {
         QUERY                                              = 6,
         RESPONSE                                           = 7,
         ERROR                                              = 8,
+        SHARED_MEMORY_OFFER                                = 9,
+        SHARED_MEMORY_ACCEPT                               = 10,
+        SHARED_MEMORY_DECLINE                              = 11,
+        COMPRESSION                                        = 12,
 		GADGET_MESSAGE_EXT_ID_MIN                          = 1000,
 		GADGET_MESSAGE_ISMRMRD_ACQUISITION                 = 1008,
 		GADGET_MESSAGE_DICOM_WITHNAME                      = 1018,
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Gadgetron::Core {
+
+    /**
+     * A histogram of durations with power of two microsecond buckets, from 1 us up to about 9 minutes.
+     * Recording is lock free, so it can be shared by any number of threads.
+     */
+    class DurationHistogram {
+    public:
+        static constexpr size_t number_of_buckets = 31;
+
+        void record(std::chrono::nanoseconds duration) {
+            auto ns = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+
+            size_t bucket = 0;
+            for (auto us = ns / 1000; us && bucket < number_of_buckets - 1; us >>= 1) bucket++;
+
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            total_ns.fetch_add(ns, std::memory_order_relaxed);
+        }
+
+        /// Upper bound of bucket, in seconds. The last bucket is unbounded.
+        static double upper_bound(size_t bucket) { return double(uint64_t(1) << bucket) * 1e-6; }
+
+        uint64_t bucket_count(size_t bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+
+        uint64_t count() const {
+            uint64_t total = 0;
+            for (auto& bucket : buckets) total += bucket.load(std::memory_order_relaxed);
+            return total;
+        }
+
+        double sum() const { return total_ns.load(std::memory_order_relaxed) * 1e-9; }
+
+    private:
+        std::array<std::atomic<uint64_t>, number_of_buckets> buckets{};
+        std::atomic<uint64_t> total_ns{ 0 };
+    };
+
+    /**
+     * Counters describing the traffic through a node of a stream. Filled in by the input and output channels
+     * of the node, once instrumented.
+     */
+    struct NodeMetrics {
+        explicit NodeMetrics(std::string path) : path(std::move(path)) {}
+
+        /// Location of the node in the stream, e.g. "GRAPPA" or "branch/NoiseAdjust".
+        const std::string path;
+
+        std::atomic<uint64_t> messages_in{ 0 };
+        std::atomic<uint64_t> bytes_in{ 0 };
+        std::atomic<uint64_t> messages_out{ 0 };
+        std::atomic<uint64_t> bytes_out{ 0 };
+
+        /// Messages waiting in the input channel, sampled every time the node takes one.
+        std::atomic<uint64_t> queue_depth{ 0 };
+        std::atomic<uint64_t> max_queue_depth{ 0 };
+
+        /// Time from a message being taken from the input until the node asks for the next one.
+        DurationHistogram processing_time;
+
+        /// Time spent on individual messages by nodes processing several messages at once, e.g. ParallelProcess.
+        DurationHistogram task_time;
+
+        /// Total time spent waiting for input.
+        std::atomic<uint64_t> wait_ns{ 0 };
+
+        void record_queue_depth(uint64_t depth) {
+            queue_depth.store(depth, std::memory_order_relaxed);
+            auto max = max_queue_depth.load(std::memory_order_relaxed);
+            while (max < depth && !max_queue_depth.compare_exchange_weak(max, depth, std::memory_order_relaxed));
+        }
+    };
+}
@@ -3,14 +3,112 @@
 #include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/stream_buffer.hpp>
 #include <boost/iostreams/stream.hpp>
+#include <thread>
 
 namespace bio = boost::iostreams;
 namespace Gadgetron::Storage {
     GenericStorageSpace::GenericStorageSpace(
         std::shared_ptr<StreamProvider> provider,
         const Core::optional<std::string>& subject,
-        boost::posix_time::time_duration default_duration
-    ) : provider(std::move(provider)), subject(subject), default_duration{default_duration} {}
+        boost::posix_time::time_duration default_duration,
+        std::shared_ptr<ObjectCache> cache
+    ) : provider(std::move(provider)), subject(subject), default_duration{default_duration}, cache(std::move(cache)) {}
+
+    std::vector<std::string> GenericStorageSpace::content(const std::string &subject, const std::string &key) const {
+        if (auto content = prefetched->take(subject, key)) return std::move(*content);
+        return provider->content(subject, key);
+    }
+
+    void GenericStorageSpace::prefetch(const std::string &subject, const std::string &key) {
+        auto task = [provider = provider, cache = cache, ttl = default_duration, subject, key]() {
+            auto content = provider->content(subject, key);
+            if (cache && !content.empty() && !cache->get<std::vector<char>>(content.front())) {
+                auto data = provider->fetch(content.front());
+                auto size = data.size();
+                cache->put(content.front(), std::move(data), size, ttl);
+            }
+            return content;
+        };
+
+        // Run on a detached thread rather than through std::async, whose future would block in its destructor
+        // until the lookup is done whenever the prefetched content is never taken.
+        std::packaged_task<std::vector<std::string>()> lookup(std::move(task));
+        prefetched->add(subject, key, lookup.get_future().share());
+        std::thread(std::move(lookup)).detach();
+    }
+
+    ObjectCache::ObjectCache(size_t capacity_in_bytes) : capacity(capacity_in_bytes) {}
+
+    size_t ObjectCache::size_in_bytes() const {
+        std::lock_guard guard(mutex);
+        return used;
+    }
+
+    std::shared_ptr<const void> ObjectCache::find(const std::string &blob, std::type_index type) const {
+        std::lock_guard guard(mutex);
+        auto it = index.find(Key(blob, type));
+        if (it == index.end()) return nullptr;
+
+        auto entry = it->second;
+        if (entry->expiry <= std::chrono::steady_clock::now()) {
+            drop(entry);
+            return nullptr;
+        }
+
+        entries.splice(entries.begin(), entries, entry);
+        return entry->value;
+    }
+
+    void ObjectCache::insert(const std::string &blob, std::type_index type, std::shared_ptr<const void> value,
+                             size_t size, boost::posix_time::time_duration ttl) {
+        if (ttl.is_special() || ttl.is_negative() || size > capacity) return;
+        auto expiry = std::chrono::steady_clock::now() + std::chrono::milliseconds(ttl.total_milliseconds());
+
+        std::lock_guard guard(mutex);
+        Key key(blob, type);
+        if (auto it = index.find(key); it != index.end()) drop(it->second);
+
+        entries.push_front(Entry{key, std::move(value), size, expiry});
+        index.emplace(std::move(key), entries.begin());
+        used += size;
+
+        while (used > capacity) drop(std::prev(entries.end()));
+    }
+
+    void ObjectCache::remove(const std::string &blob, std::type_index type) {
+        std::lock_guard guard(mutex);
+        if (auto it = index.find(Key(blob, type)); it != index.end()) drop(it->second);
+    }
+
+    void ObjectCache::drop(std::list<Entry>::iterator entry) const {
+        used -= entry->size;
+        index.erase(entry->key);
+        entries.erase(entry);
+    }
+
+    void PrefetchedContent::add(const std::string &subject, const std::string &key,
+                                std::shared_future<std::vector<std::string>> content) {
+        std::lock_guard guard(mutex);
+        pending.insert_or_assign(std::pair(subject, key), std::move(content));
+    }
+
+    Core::optional<std::vector<std::string>> PrefetchedContent::take(const std::string &subject, const std::string &key) {
+        std::shared_future<std::vector<std::string>> content;
+        {
+            std::lock_guard guard(mutex);
+            auto it = pending.find(std::pair(subject, key));
+            if (it == pending.end()) return {};
+            content = std::move(it->second);
+            pending.erase(it);
+        }
+
+        // A failed prefetch is not an error in itself; the caller looks the content up again.
+        try {
+            return content.get();
+        } catch (const std::exception &) {
+            return {};
+        }
+    }
 
     std::unique_ptr<std::istream> istream_from_data(const std::vector<char> &data) {
 
@@ -1,8 +1,16 @@
 #pragma once
 
-#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
 #include <istream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <typeindex>
 
 #include "io/ismrmrd_types.h"
 #include "io/adapt_struct.h"
@@ -21,6 +29,15 @@ namespace Gadgetron::Storage {
 
         [[nodiscard]] virtual std::vector<char> fetch(const std::string &uuid) const = 0;
 
+        /// Reads length bytes of a blob, starting at offset. The result is shorter if the blob ends first.
+        [[nodiscard]] virtual std::vector<char>
+        fetch_range(const std::string &uuid, size_t offset, size_t length) const {
+            auto data = fetch(uuid);
+            auto first = std::min(offset, data.size());
+            auto last = std::min(data.size(), first + length);
+            return std::vector<char>(data.begin() + first, data.begin() + last);
+        }
+
         virtual void store(const std::string &subject, const std::string &key, const std::vector<char> &data,
                            boost::posix_time::time_duration duration) = 0;
     };
@@ -29,16 +46,85 @@ namespace Gadgetron::Storage {
 
     std::unique_ptr<std::ostream> ostream_view(std::vector<char> &data);
 
+    /**
+     * In-process LRU cache of deserialized storage objects, keyed by blob id and type.
+     *
+     * Blobs are never modified once stored, so an entry only goes stale when the storage server drops the blob.
+     * Entries therefore expire after the storage duration of their space, and the least recently used entries are
+     * evicted to keep the serialized size of the cached objects below the capacity.
+     */
+    class ObjectCache {
+    public:
+        explicit ObjectCache(size_t capacity_in_bytes = 512ull * 1024ull * 1024ull);
+
+        template<class T>
+        std::shared_ptr<const T> get(const std::string &blob) const {
+            return std::static_pointer_cast<const T>(find(blob, typeid(T)));
+        }
+
+        template<class T>
+        void put(const std::string &blob, T value, size_t size_in_bytes, boost::posix_time::time_duration ttl) {
+            insert(blob, typeid(T), std::make_shared<const T>(std::move(value)), size_in_bytes, ttl);
+        }
+
+        template<class T>
+        void erase(const std::string &blob) { remove(blob, typeid(T)); }
+
+        size_t size_in_bytes() const;
+
+    private:
+        using Key = std::pair<std::string, std::type_index>;
+
+        struct Entry {
+            Key key;
+            std::shared_ptr<const void> value;
+            size_t size;
+            std::chrono::steady_clock::time_point expiry;
+        };
+
+        std::shared_ptr<const void> find(const std::string &blob, std::type_index type) const;
+        void insert(const std::string &blob, std::type_index type, std::shared_ptr<const void> value, size_t size,
+                    boost::posix_time::time_duration ttl);
+        void remove(const std::string &blob, std::type_index type);
+        void drop(std::list<Entry>::iterator entry) const;
+
+        const size_t capacity;
+        mutable std::mutex mutex;
+        mutable std::list<Entry> entries; // most recently used first
+        mutable std::map<Key, std::list<Entry>::iterator> index;
+        mutable size_t used = 0;
+    };
+
+    /**
+     * Content lookups started ahead of time, by subject and key. Each is handed out once, so later lookups see
+     * anything stored in the meantime.
+     */
+    class PrefetchedContent {
+    public:
+        void add(const std::string &subject, const std::string &key,
+                 std::shared_future<std::vector<std::string>> content);
+
+        Core::optional<std::vector<std::string>> take(const std::string &subject, const std::string &key);
+
+    private:
+        std::mutex mutex;
+        std::map<std::pair<std::string, std::string>, std::shared_future<std::vector<std::string>>> pending;
+    };
+
     template<class T>
     class StorageList {
     public:
         T operator[](size_t index) {
-            auto data = provider->fetch(keys.at(index));
-            return Core::IO::read<T>(*istream_from_data(data));
+            return load(keys.at(index));
         }
 
         StorageList &operator=(StorageList &&) noexcept = default;
 
+        /// Reads length bytes of the serialized object at index, starting at offset, without fetching the rest.
+        std::vector<char> fetch_range(size_t index, size_t offset, size_t length) {
+            return provider->fetch_range(keys.at(index), offset, length);
+        }
+
         size_t size() { return keys.size(); }
 
         bool empty() { return keys.empty(); }
@@ -47,6 +133,10 @@ namespace Gadgetron::Storage {
                                                                                                provider(std::move(
                                                                                                        provider)) {}
 
+        StorageList(std::shared_ptr<StreamProvider> provider, std::vector<std::string> keys,
+                    std::shared_ptr<ObjectCache> cache, boost::posix_time::time_duration ttl)
+            : keys(std::move(keys)), provider(std::move(provider)), cache(std::move(cache)), ttl(ttl) {}
+
         auto begin() {
             return boost::make_transform_iterator(keys.begin(), iterator_transform());
         }
@@ -58,22 +148,78 @@ namespace Gadgetron::Storage {
     private:
 
         std::function<T(const std::string&)> iterator_transform() {
-            return [this](const std::string &key) -> T {
+            return [this](const std::string &key) -> T { return load(key); };
+        }
+
+        T load(const std::string &key) const {
+            if (!cache) {
                 auto data = provider->fetch(key);
                 return Core::IO::read<T>(*istream_from_data(data));
-            };
+            }
+
+            if (auto cached = cache->get<T>(key)) return *cached;
+
+            // A prefetch leaves the serialized blob in the cache, which is replaced by the object once read.
+            auto data = cache->get<std::vector<char>>(key);
+            if (data) {
+                cache->erase<std::vector<char>>(key);
+            } else {
+                data = std::make_shared<const std::vector<char>>(provider->fetch(key));
+            }
+
+            auto value = Core::IO::read<T>(*istream_from_data(*data));
+            cache->put(key, value, data->size(), ttl);
+            return value;
         }
 
         std::vector<std::string> keys;
         std::shared_ptr<StreamProvider> provider;
+        std::shared_ptr<ObjectCache> cache;
+        boost::posix_time::time_duration ttl;
 
     };
 
+    /**
+     * Reads the slice at index along the last dimension of a stored array, without fetching the rest of the array.
+     * Relies on arrays being stored uncompressed, as the dimensions followed by the elements.
+     */
+    template<class T>
+    hoNDArray<T> fetch_slice(StorageList<hoNDArray<T>> &list, size_t index, size_t slice) {
+        static_assert(Core::is_trivially_copyable_v<T>, "Only arrays of trivially copyable elements can be sliced");
+
+        // Enough for the dimensions of any array seen in practice, so the header usually takes a single request.
+        constexpr size_t header_guess = 16;
+        auto header = list.fetch_range(index, 0, sizeof(size_t) * (header_guess + 1));
+        if (header.size() < sizeof(size_t)) throw std::runtime_error("Stored array is truncated");
+
+        size_t number_of_dimensions;
+        std::memcpy(&number_of_dimensions, header.data(), sizeof(size_t));
+        if (number_of_dimensions == 0) throw std::runtime_error("Stored array is empty");
+
+        auto header_size = sizeof(size_t) * (number_of_dimensions + 1);
+        if (header.size() < header_size) header = list.fetch_range(index, 0, header_size);
+        if (header.size() < header_size) throw std::runtime_error("Stored array is truncated");
+
+        std::vector<size_t> dimensions(number_of_dimensions);
+        std::memcpy(dimensions.data(), header.data() + sizeof(size_t), sizeof(size_t) * number_of_dimensions);
+        if (slice >= dimensions.back()) throw std::out_of_range("Slice is outside the stored array");
+
+        dimensions.back() = 1;
+        hoNDArray<T> result(dimensions);
+        auto slice_bytes = result.get_number_of_elements() * sizeof(T);
+
+        auto data = list.fetch_range(index, header_size + slice * slice_bytes, slice_bytes);
+        if (data.size() != slice_bytes) throw std::runtime_error("Stored array is truncated");
+        std::memcpy(result.data(), data.data(), slice_bytes);
+        return result;
+    }
+
     class GenericStorageSpace {
     public:
 
         GenericStorageSpace(std::shared_ptr<StreamProvider> provider, const Core::optional<std::string> &subject,
-                            boost::posix_time::time_duration default_duration);
+                            boost::posix_time::time_duration default_duration,
+                            std::shared_ptr<ObjectCache> cache = nullptr);
 
         GenericStorageSpace() = default;
 
@@ -95,9 +241,20 @@ namespace Gadgetron::Storage {
         }
 
       protected:
+        template<class T>
+        Storage::StorageList<T> make_list(const std::string &subject, const std::string &key) const {
+            return Storage::StorageList<T>(provider, content(subject, key), cache, default_duration);
+        }
+
+        std::vector<std::string> content(const std::string &subject, const std::string &key) const;
+
+        void prefetch(const std::string &subject, const std::string &key);
+
         Core::optional<std::string> subject;
         std::shared_ptr<StreamProvider> provider;
         boost::posix_time::time_duration default_duration;
+        std::shared_ptr<ObjectCache> cache;
+        std::shared_ptr<PrefetchedContent> prefetched = std::make_shared<PrefetchedContent>();
     };
 }
 
@@ -110,9 +267,15 @@ namespace Gadgetron {
         template<class T>
         Storage::StorageList<T> fetch(const std::string &key) const {
             if (this->subject)
-                return Storage::StorageList<T>(this->provider, this->provider->content(*subject, key));
+                return this->make_list<T>(*subject, key);
             return Storage::StorageList<T>(this->provider, {});
         }
+
+        /// Starts looking up key in the background, and reading the most recent blob stored under it.
+        void prefetch(const std::string &key) {
+            if (this->subject)
+                GenericStorageSpace::prefetch(*subject, key);
+        }
     };
 
     class MeasurementSpace : public Storage::GenericStorageSpace {
@@ -121,7 +284,12 @@ namespace Gadgetron {
 
         template<class T>
         Storage::StorageList<T> fetch(const std::string &measurementID, const std::string &key) const {
-            return Storage::StorageList<T>(this->provider, this->provider->content(measurementID, key));
+            return this->make_list<T>(measurementID, key);
+        }
+
+        /// Starts looking up key in the background, and reading the most recent blob stored under it.
+        void prefetch(const std::string &measurementID, const std::string &key) {
+            GenericStorageSpace::prefetch(measurementID, key);
         }
     };
 
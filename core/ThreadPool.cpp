@@ -0,0 +1,58 @@
+#include "ThreadPool.h"
+
+#include <cerrno>
+#include <system_error>
+
+#if !(_WIN32)
+#include <sys/ipc.h>
+#include <sys/sem.h>
+#include <unistd.h>
+#endif
+
+namespace Gadgetron::Core {
+
+#if _WIN32
+
+    // Windows does not fork, so every pool already lives in the one server process.
+    ProcessTokens::ProcessTokens(unsigned int) {}
+    ProcessTokens::~ProcessTokens() = default;
+    void ProcessTokens::acquire() {}
+    void ProcessTokens::release() {}
+
+#else
+
+    namespace {
+        // SEM_UNDO has the kernel give back the tokens a process still holds when it exits.
+        void change(int semaphore, short delta) {
+            sembuf operation{ 0, delta, SEM_UNDO };
+            while (semop(semaphore, &operation, 1) == -1) {
+                if (errno != EINTR)
+                    throw std::system_error(errno, std::generic_category(), "Failed to update worker tokens");
+            }
+        }
+    }
+
+    ProcessTokens::ProcessTokens(unsigned int count) : owner(getpid()) {
+        semaphore = semget(IPC_PRIVATE, 1, IPC_CREAT | 0600);
+        if (semaphore == -1)
+            throw std::system_error(errno, std::generic_category(), "Failed to create worker tokens");
+
+        if (semctl(semaphore, 0, SETVAL, int(std::max(count, 1u))) == -1) {
+            auto error = errno;
+            semctl(semaphore, 0, IPC_RMID);
+            throw std::system_error(error, std::generic_category(), "Failed to create worker tokens");
+        }
+    }
+
+    ProcessTokens::~ProcessTokens() {
+        // The semaphore outlives the processes using it, so only the process which created it removes it.
+        if (owner == getpid())
+            semctl(semaphore, 0, IPC_RMID);
+    }
+
+    void ProcessTokens::acquire() { change(semaphore, -1); }
+
+    void ProcessTokens::release() { change(semaphore, 1); }
+
+#endif
+}
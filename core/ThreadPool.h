@@ -4,18 +4,66 @@
 
 #pragma once
 #include "MPMCChannel.h"
+#include "hoMemoryPool.h"
 #include <boost/hana.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Gadgetron::Core {
 
+    /**
+     * Tokens shared by the processes forked after they are created, e.g. the connections of a release build server.
+     * A pool given the tokens only lets as many of its workers run tasks as it holds tokens, so the workers of all
+     * the processes together run at most count tasks at a time. The tokens of a process are returned when it exits,
+     * whether or not it exits cleanly.
+     */
+    class ProcessTokens {
+    public:
+        explicit ProcessTokens(unsigned int count);
+        ~ProcessTokens();
+
+        ProcessTokens(const ProcessTokens&) = delete;
+        ProcessTokens& operator=(const ProcessTokens&) = delete;
+
+        /// Blocks until a token is free.
+        void acquire();
+        void release();
+
+    private:
+        int semaphore = -1;
+        long owner    = 0;
+    };
 
+    /**
+     * A work stealing thread pool.
+     *
+     * Every worker owns a deque of tasks. Tasks submitted from inside the pool are pushed onto the submitting
+     * worker's deque and executed most recent first, while idle workers steal the oldest tasks of the others.
+     * Tasks submitted from outside the pool are queued per TaskGroup, and workers take from the groups round robin,
+     * so one busy connection cannot starve the others. A single pool shared by the whole process is available
+     * through ThreadPool::global().
+     *
+     * Every task is counted against its group, wherever it is queued, so TaskGroup::wait() covers nested tasks too.
+     *
+     * A pool created with ProcessTokens holds a token for every worker that is busy, and gives it back when the worker
+     * runs out of tasks or sleeps in TaskGroup::wait().
+     */
     class ThreadPool {
     private:
         class Work {
         public:
             virtual void execute() = 0;
             virtual ~Work()        = default;
+
+            // The memory account of the submitting thread, charged for what the task allocates.
+            std::shared_ptr<hoMemoryAccount> account = hoMemoryAccount::current();
         };
 
         template <class F, class... ARGS> class Storage{
@@ -70,36 +118,345 @@ namespace Gadgetron::Core {
             using ConcreteWorkImpl<F, std::is_same<typename Storage<F,ARGS...>::R,void>::value,ARGS...>::ConcreteWorkImpl;
         };
 
+        struct GroupState {
+            explicit GroupState(size_t max_concurrency) : max_concurrency(max_concurrency) {}
+
+            // Guarded by the scheduler mutex of the pool.
+            std::deque<std::unique_ptr<Work>> tasks;
+            const size_t max_concurrency;
+            size_t running = 0;
+            bool ready     = false;
+
+            // Tasks submitted and not yet finished, wherever they are queued, and threads blocked in wait().
+            std::atomic<size_t> outstanding{ 0 };
+            std::atomic<unsigned> waiters{ 0 };
+        };
+
+        struct Task {
+            std::unique_ptr<Work> work;
+            std::shared_ptr<GroupState> group;
+            // Taken from the group queue, and so counted in group->running.
+            bool counted = false;
+        };
+
+        struct Worker {
+            std::mutex m;
+            std::deque<Task> tasks;
+        };
+
     public:
-        explicit ThreadPool(unsigned int workers) {
-            for (auto i = 0u; i < workers; i++) {
-                threads.emplace_back([this]() {
-                    try {
-                        while (true)
-                            this->work_queue.pop()->execute();
-                    } catch (const ChannelClosed&) {
-                    }
-                });
+        /**
+         * A handle for submitting related tasks, e.g. the tasks of a single connection. Groups are served fairly
+         * with respect to each other, and can limit how many of their tasks run at the same time.
+         */
+        class TaskGroup {
+        public:
+            template <class F, class... ARGS> auto async(F&& f, ARGS&&... args) {
+                auto work = std::make_unique<ConcreteWork<F, ARGS...>>(std::forward<F>(f), std::forward<ARGS>(args)...);
+                auto future_result = work->get_future();
+                pool->submit(std::move(work), state);
+                return future_result;
+            }
+
+            /**
+             * Blocks until every task submitted to the group has finished, running queued tasks on the calling thread
+             * while it waits. Called from a task of the group, it waits for the other tasks of the group. Tasks which
+             * depend on other tasks of the pool should wait here rather than on their futures, as a blocked future
+             * does not help and can deadlock a pool with few workers.
+             */
+            void wait() { pool->wait(state); }
+
+        private:
+            friend ThreadPool;
+            TaskGroup(ThreadPool* pool, std::shared_ptr<GroupState> state) : pool(pool), state(std::move(state)) {}
+
+            ThreadPool* pool;
+            std::shared_ptr<GroupState> state;
+        };
+
+        explicit ThreadPool(unsigned int n_workers, std::shared_ptr<ProcessTokens> tokens = nullptr)
+            : workers(std::max(n_workers, 1u)), tokens(std::move(tokens)), default_group(make_group()) {
+            for (auto i = 0u; i < this->workers.size(); i++) {
+                threads.emplace_back([this, i]() { this->run_worker(i); });
             }
         }
 
+        ~ThreadPool() {
+            if (!closed)
+                join();
+        }
+
         template <class F, class... ARGS> auto async(F&& f, ARGS&&... args) {
-            auto work = std::make_unique<ConcreteWork<F, ARGS...>>(std::forward<F>(f), std::forward<ARGS>(args)...);
-            auto future_result = work->get_future();
-            work_queue.push(std::move(work));
-            return std::move(future_result);
+            return default_group.async(std::forward<F>(f), std::forward<ARGS>(args)...);
+        }
+
+        /**
+         * Creates a new group of tasks
+         * @param max_concurrency Maximum number of tasks from this group running at the same time. 0 means no limit.
+         */
+        TaskGroup make_group(size_t max_concurrency = 0) {
+            return TaskGroup(this, std::make_shared<GroupState>(max_concurrency));
         }
 
+        /// Finishes all submitted work and stops the workers.
         void join(){
-            work_queue.close();
+            {
+                std::lock_guard<std::mutex> guard(scheduler);
+                closed = true;
+            }
+            wake.notify_all();
             for (auto& thread : threads){
-                thread.join();
+                if (thread.joinable())
+                    thread.join();
             }
         }
 
+        size_t size() const { return workers.size(); }
+
+        /**
+         * The pool shared by everything in this process. It is created the first time it is used.
+         *
+         * Release builds handle every connection in a forked process, each with its own global pool. These pools
+         * share their workers through share_global_workers(). The server process itself must not use the pool before
+         * forking, as the worker threads would not exist in the children.
+         */
+        static ThreadPool& global() {
+            static ThreadPool pool(global_worker_count(), global_tokens);
+            return pool;
+        }
+
+        /// Sets the number of workers of the global pool. Has no effect once the global pool has been used.
+        static void set_global_workers(unsigned int n_workers) { global_workers = n_workers; }
+
+        /**
+         * Makes the global pools of this process and the processes forked from it share one set of workers, so that
+         * together they run no more tasks at a time than the global pool has workers. Call before forking.
+         */
+        static void share_global_workers() { global_tokens = std::make_shared<ProcessTokens>(global_worker_count()); }
+
     private:
-        MPMCChannel<std::unique_ptr<Work>> work_queue;
+        static unsigned int global_worker_count() {
+            return global_workers ? global_workers.load() : std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        // A worker holds a token from when it finds a task until it runs out of them. The tokens are only ever
+        // acquired outside the scheduler mutex, as acquiring may wait for another process.
+        void hold_token() {
+            if (!tokens || holding_token) return;
+            tokens->acquire();
+            holding_token = true;
+        }
+
+        bool drop_token() {
+            if (!tokens || !holding_token) return false;
+            tokens->release();
+            holding_token = false;
+            return true;
+        }
+
+        void submit(std::unique_ptr<Work> work, const std::shared_ptr<GroupState>& group) {
+            group->outstanding.fetch_add(1, std::memory_order_relaxed);
+
+            // Nested work of a capped group has to queue behind the cap like any other; otherwise it stays with the
+            // submitting worker, where it is likely to find its data in cache.
+            if (current_pool == this && !group->max_concurrency) {
+                auto& worker = workers[current_worker];
+                std::lock_guard<std::mutex> guard(worker.m);
+                worker.tasks.push_back(Task{ std::move(work), group });
+            } else {
+                std::lock_guard<std::mutex> guard(scheduler);
+                if (closed) {
+                    group->outstanding.fetch_sub(1, std::memory_order_relaxed);
+                    throw ChannelClosed();
+                }
+                group->tasks.push_back(std::move(work));
+                make_ready(group);
+                if (group->waiters.load(std::memory_order_relaxed))
+                    group_changed.notify_all();
+            }
+            notify();
+        }
+
+        // Sleeping workers register themselves before their final look at the epoch, and the fence orders the epoch
+        // increment before the check for sleepers, so the scheduler mutex is only taken when someone is asleep.
+        void notify() {
+            epoch.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> guard(scheduler);
+                wake.notify_one();
+            }
+        }
+
+        // Must be called with the scheduler mutex held
+        static bool can_start(const GroupState& group) {
+            return !group.tasks.empty() && !(group.max_concurrency && group.running >= group.max_concurrency);
+        }
+
+        // Must be called with the scheduler mutex held
+        void make_ready(const std::shared_ptr<GroupState>& group) {
+            if (group->ready || !can_start(*group))
+                return;
+            group->ready = true;
+            ready_groups.push_back(group);
+        }
+
+        // Must be called with the scheduler mutex held
+        static Task take_from(const std::shared_ptr<GroupState>& group) {
+            auto work = std::move(group->tasks.front());
+            group->tasks.pop_front();
+            group->running++;
+            return Task{ std::move(work), group, true };
+        }
+
+        optional<Task> find_work(size_t index) {
+            {
+                auto& own = workers[index];
+                std::lock_guard<std::mutex> guard(own.m);
+                if (!own.tasks.empty()) {
+                    auto task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return task;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> guard(scheduler);
+                while (!ready_groups.empty()) {
+                    auto group = std::move(ready_groups.front());
+                    ready_groups.pop_front();
+                    group->ready = false;
+
+                    // A helping wait() may have emptied the group since it was queued.
+                    if (!can_start(*group))
+                        continue;
+
+                    auto task = take_from(group);
+                    make_ready(group);
+                    return task;
+                }
+            }
+            for (size_t i = 1; i < workers.size(); i++) {
+                auto& victim = workers[(index + i) % workers.size()];
+                std::lock_guard<std::mutex> guard(victim.m);
+                if (!victim.tasks.empty()) {
+                    auto task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return task;
+                }
+            }
+            return none;
+        }
+
+        void run(Task& task) {
+            running_groups.push_back(task.group.get());
+            {
+                hoMemoryAccount::Scope scope(task.work->account);
+                task.work->execute();
+            }
+            running_groups.pop_back();
+            task.work.reset();
+            finish(task);
+        }
+
+        void finish(Task& task) {
+            auto& group = task.group;
+            if (task.counted) {
+                {
+                    std::lock_guard<std::mutex> guard(scheduler);
+                    group->running--;
+                    make_ready(group);
+                }
+                notify();
+            }
+
+            group->outstanding.fetch_sub(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (group->waiters.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> guard(scheduler);
+                group_changed.notify_all();
+            }
+        }
+
+        void wait(const std::shared_ptr<GroupState>& group) {
+            // Tasks of the group running further up this thread's stack cannot finish before we return.
+            const size_t own = std::count(running_groups.begin(), running_groups.end(), group.get());
+            auto done = [&]() { return group->outstanding.load(std::memory_order_relaxed) <= own; };
+
+            while (!done()) {
+                optional<Task> task;
+                {
+                    std::lock_guard<std::mutex> guard(scheduler);
+                    // A task of the group waiting for the group runs the others itself, which does not add to the
+                    // number of its tasks running at once.
+                    if (!group->tasks.empty() && (own || can_start(*group)))
+                        task = take_from(group);
+                }
+                if (!task && current_pool == this)
+                    task = find_work(current_worker);
+                if (task) {
+                    run(*task);
+                    continue;
+                }
+
+                // A worker blocked here lends its token to the other processes until it can go on.
+                bool dropped = current_pool == this && drop_token();
+                {
+                    std::unique_lock<std::mutex> lock(scheduler);
+                    group->waiters.fetch_add(1, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    group_changed.wait(lock, [&]() { return done() || (!group->tasks.empty() && (own || can_start(*group))); });
+                    group->waiters.fetch_sub(1, std::memory_order_relaxed);
+                }
+                if (dropped) hold_token();
+            }
+        }
+
+        void run_worker(size_t index) {
+            current_pool   = this;
+            current_worker = index;
+
+            while (true) {
+                uint64_t seen_epoch = epoch.load(std::memory_order_relaxed);
+
+                if (auto task = find_work(index)) {
+                    hold_token();
+                    run(*task);
+                    continue;
+                }
+                drop_token();
+
+                std::unique_lock<std::mutex> lock(scheduler);
+                sleeping.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (closed && epoch.load(std::memory_order_relaxed) == seen_epoch) {
+                    sleeping.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+                wake.wait(lock, [&]() { return closed || epoch.load(std::memory_order_relaxed) != seen_epoch; });
+                sleeping.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        std::vector<Worker> workers;
         std::vector<std::thread> threads;
+        std::shared_ptr<ProcessTokens> tokens;
+
+        std::mutex scheduler;
+        std::condition_variable wake;
+        std::condition_variable group_changed;
+        std::deque<std::shared_ptr<GroupState>> ready_groups;
+        std::atomic<uint64_t> epoch{ 0 };
+        std::atomic<unsigned> sleeping{ 0 };
+        bool closed    = false;
+
+        TaskGroup default_group;
+
+        static inline std::atomic<unsigned int> global_workers{ 0 };
+        static inline std::shared_ptr<ProcessTokens> global_tokens;
+        static inline thread_local ThreadPool* current_pool = nullptr;
+        static inline thread_local size_t current_worker    = 0;
+        static inline thread_local std::vector<GroupState*> running_groups;
+        static inline thread_local bool holding_token       = false;
     };
 
 }
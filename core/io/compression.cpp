@@ -0,0 +1,288 @@
+#include "compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#if defined GADGETRON_COMPRESSION_ZLIB
+#include <zlib.h>
+#endif
+
+#include "NHLBICompression.h"
+#include "primitives.h"
+
+namespace {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron::Core::IO;
+
+    enum Codec : uint8_t {
+        RAW_BLOCK = 0,
+        DEFLATE_BLOCK = 1,
+        NHLBI_BLOCK = 2
+    };
+
+#pragma pack(push, 1)
+    struct BlockHeader {
+        uint8_t codec;
+        uint8_t word_size;
+        uint32_t raw_bytes;
+        uint32_t stored_bytes;
+    };
+#pragma pack(pop)
+
+    constexpr size_t block_size = size_t(4) << 20;
+
+    enum Flags : long {
+        ENABLED = 1,
+        DEFLATE_ENABLED = 2
+    };
+
+    int flags_index() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    int tolerance_index() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    // Number of LossyScopes open on the stream.
+    int lossy_index() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    void write_block(std::ostream &stream, Codec codec, size_t word_size, size_t raw_bytes, const void *stored, size_t stored_bytes) {
+        BlockHeader header{
+            codec,
+            static_cast<uint8_t>(word_size),
+            static_cast<uint32_t>(raw_bytes),
+            static_cast<uint32_t>(stored_bytes)
+        };
+        IO::write(stream, header);
+        stream.write(reinterpret_cast<const char *>(stored), stored_bytes);
+    }
+
+    // Gathers byte b of every word into plane b; the high bytes of numeric data then line up in runs deflate handles well.
+    void shuffle(const char *data, size_t bytes, size_t word_size, char *out) {
+        size_t words = bytes / word_size;
+        for (size_t b = 0; b < word_size; b++) {
+            for (size_t w = 0; w < words; w++) out[b * words + w] = data[w * word_size + b];
+        }
+    }
+
+    void unshuffle(const char *planes, size_t bytes, size_t word_size, char *out) {
+        size_t words = bytes / word_size;
+        for (size_t b = 0; b < word_size; b++) {
+            for (size_t w = 0; w < words; w++) out[w * word_size + b] = planes[b * words + w];
+        }
+    }
+
+    bool compressible_floats(const float *values, size_t count) {
+        bool nonzero = false;
+        for (size_t i = 0; i < count; i++) {
+            if (!std::isfinite(values[i])) return false;
+            nonzero |= values[i] != 0.0f;
+        }
+        return nonzero;
+    }
+
+    bool write_nhlbi_block(std::ostream &stream, const char *data, size_t bytes, float tolerance) {
+
+        std::vector<float> values(bytes / sizeof(float));
+        std::memcpy(values.data(), data, bytes);
+
+        // The codec needs a finite, non-zero range; such blocks are left for the lossless codecs.
+        if (!compressible_floats(values.data(), values.size())) return false;
+
+        std::unique_ptr<NHLBI::CompressedFloatBuffer> buffer(NHLBI::CompressedFloatBuffer::createCompressedBuffer());
+        try {
+            buffer->compress(values, tolerance);
+        } catch (const std::runtime_error &) {
+            // Tolerance too small for the range of the block; more than 31 bits would be needed.
+            return false;
+        }
+
+        auto stored = buffer->serialize();
+        if (stored.size() >= bytes) return false;
+
+        write_block(stream, NHLBI_BLOCK, sizeof(float), bytes, stored.data(), stored.size());
+        return true;
+    }
+
+    void read_nhlbi_block(std::istream &stream, char *data, const BlockHeader &header) {
+
+        std::vector<uint8_t> stored(header.stored_bytes);
+        stream.read(reinterpret_cast<char *>(stored.data()), stored.size());
+
+        std::unique_ptr<NHLBI::CompressedFloatBuffer> buffer(NHLBI::CompressedFloatBuffer::createCompressedBuffer());
+        buffer->deserialize(stored);
+
+        if (buffer->size() * sizeof(float) != header.raw_bytes)
+            throw std::runtime_error("Compressed block does not match its header.");
+
+        buffer->decompress(reinterpret_cast<float *>(data));
+    }
+
+#if defined GADGETRON_COMPRESSION_ZLIB
+    bool write_deflate_block(std::ostream &stream, const char *data, size_t bytes, size_t word_size) {
+
+        std::vector<char> planes(bytes);
+        shuffle(data, bytes, word_size, planes.data());
+
+        uLongf stored_bytes = compressBound(bytes);
+        std::vector<Bytef> stored(stored_bytes);
+
+        // Favour speed; the network is only faster than the compressor by so much.
+        auto result = compress2(
+                stored.data(), &stored_bytes,
+                reinterpret_cast<const Bytef *>(planes.data()), bytes,
+                Z_BEST_SPEED
+        );
+
+        if (result != Z_OK || stored_bytes >= bytes) return false;
+
+        write_block(stream, DEFLATE_BLOCK, word_size, bytes, stored.data(), stored_bytes);
+        return true;
+    }
+
+    void read_deflate_block(std::istream &stream, char *data, const BlockHeader &header) {
+
+        std::vector<Bytef> stored(header.stored_bytes);
+        stream.read(reinterpret_cast<char *>(stored.data()), stored.size());
+
+        std::vector<char> planes(header.raw_bytes);
+        uLongf raw_bytes = header.raw_bytes;
+
+        auto result = uncompress(reinterpret_cast<Bytef *>(planes.data()), &raw_bytes, stored.data(), stored.size());
+        if (result != Z_OK || raw_bytes != header.raw_bytes)
+            throw std::runtime_error("Failed to inflate compressed block.");
+
+        unshuffle(planes.data(), header.raw_bytes, header.word_size, data);
+    }
+#else
+    bool write_deflate_block(std::ostream &, const char *, size_t, size_t) {
+        return false;
+    }
+
+    void read_deflate_block(std::istream &, char *, const BlockHeader &) {
+        throw std::runtime_error("Received deflated block, but Gadgetron was built without zlib.");
+    }
+#endif
+}
+
+namespace Gadgetron::Core::IO {
+
+    void set_compression(std::ios_base &stream, const Compression &compression) {
+
+        uint32_t tolerance_bits;
+        std::memcpy(&tolerance_bits, &compression.tolerance, sizeof(tolerance_bits));
+
+        stream.iword(flags_index()) = ENABLED | (compression.deflate ? DEFLATE_ENABLED : 0);
+        stream.iword(tolerance_index()) = static_cast<long>(tolerance_bits);
+    }
+
+    LossyScope::LossyScope(std::ios_base &stream) : stream(stream) {
+        stream.iword(lossy_index())++;
+    }
+
+    LossyScope::~LossyScope() {
+        stream.iword(lossy_index())--;
+    }
+
+    optional<Compression> compression(std::ios_base &stream) {
+
+        auto flags = stream.iword(flags_index());
+        if (!(flags & ENABLED)) return none;
+
+        auto tolerance_bits = static_cast<uint32_t>(stream.iword(tolerance_index()));
+
+        Compression compression{};
+        std::memcpy(&compression.tolerance, &tolerance_bits, sizeof(tolerance_bits));
+        compression.deflate = flags & DEFLATE_ENABLED;
+        return compression;
+    }
+
+    std::string supported_codecs() {
+#if defined GADGETRON_COMPRESSION_ZLIB
+        return "nhlbi,deflate";
+#else
+        return "nhlbi";
+#endif
+    }
+
+    Compression negotiate_compression(const std::string &peer_codecs, float tolerance) {
+
+        std::vector<std::string> peer;
+        boost::split(peer, peer_codecs, boost::is_any_of(","));
+
+        auto peer_supports = [&](const std::string &codec) {
+            return std::find(peer.begin(), peer.end(), codec) != peer.end();
+        };
+
+        Compression compression{};
+        compression.tolerance = peer_supports("nhlbi") ? tolerance : 0.0f;
+        compression.deflate = peer_supports("deflate") && supported_codecs().find("deflate") != std::string::npos;
+        return compression;
+    }
+
+    void write_compressed(
+            std::ostream &stream,
+            const char *data,
+            size_t bytes,
+            size_t word_size,
+            bool floats,
+            const Compression &compression
+    ) {
+        const size_t words_per_block = block_size / word_size;
+        const bool lossy = floats && word_size == sizeof(float) && compression.tolerance > 0 &&
+                           stream.iword(lossy_index()) > 0;
+
+        for (size_t offset = 0; offset < bytes; offset += words_per_block * word_size) {
+            auto block = data + offset;
+            auto block_bytes = std::min(bytes - offset, words_per_block * word_size);
+
+            if (lossy && write_nhlbi_block(stream, block, block_bytes, compression.tolerance)) continue;
+            if (compression.deflate && write_deflate_block(stream, block, block_bytes, word_size)) continue;
+
+            write_block(stream, RAW_BLOCK, word_size, block_bytes, block, block_bytes);
+        }
+    }
+
+    void read_compressed(std::istream &stream, char *data, size_t bytes) {
+
+        for (size_t offset = 0; offset < bytes;) {
+
+            auto header = IO::read<BlockHeader>(stream);
+            if (!stream) return;
+
+            if (header.raw_bytes > bytes - offset || header.raw_bytes == 0 || header.word_size == 0 ||
+                header.stored_bytes > 2 * block_size)
+                throw std::runtime_error("Received malformed compressed block.");
+
+            switch (header.codec) {
+                case RAW_BLOCK:
+                    if (header.stored_bytes != header.raw_bytes)
+                        throw std::runtime_error("Received malformed compressed block.");
+                    stream.read(data + offset, header.raw_bytes);
+                    break;
+                case DEFLATE_BLOCK:
+                    read_deflate_block(stream, data + offset, header);
+                    break;
+                case NHLBI_BLOCK:
+                    read_nhlbi_block(stream, data + offset, header);
+                    break;
+                default:
+                    throw std::runtime_error("Received compressed block with unknown codec: " + std::to_string(header.codec));
+            }
+
+            offset += header.raw_bytes;
+        }
+    }
+}
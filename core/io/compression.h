@@ -0,0 +1,105 @@
+#pragma once
+
+#include <complex>
+#include <iostream>
+#include <string>
+
+#include "Types.h"
+
+namespace Gadgetron::Core::IO {
+
+    /**
+     * Compression applied to array data written to a stream.
+     *
+     * Streams with compression set carry array data larger than minimum_compressed_bytes as a sequence of blocks,
+     * each holding up to 4 MiB of the original data: a codec (uint8), the width of the words in the block (uint8),
+     * the number of bytes the block decodes to (uint32) and the number of bytes stored (uint32), followed by the
+     * stored bytes. Blocks are stored raw, deflated after shuffling the bytes of their words into planes, or, for
+     * float data written with a positive tolerance inside a LossyScope, with the NHLBI fixed-precision codec.
+     *
+     * Both ends of a connection must agree on the compression before any array data is sent.
+     */
+    struct Compression {
+        /// Largest absolute error allowed in float data. Zero keeps all data exact.
+        float tolerance = 0;
+
+        /// Whether deflated blocks may be written; the peer must be able to inflate them.
+        bool deflate = false;
+    };
+
+    /// Arrays smaller than this are written as they are, even to streams with compression set.
+    constexpr size_t minimum_compressed_bytes = 4096;
+
+    /**
+     * Allows float data written to stream while in scope to be stored within the tolerance of the stream.
+     * Writers open a scope around image and k-space samples only; everything else written to a stream, such as
+     * trajectories, density weights and waveforms, is compressed losslessly.
+     */
+    class LossyScope {
+    public:
+        explicit LossyScope(std::ios_base &stream);
+        ~LossyScope();
+
+        LossyScope(const LossyScope &) = delete;
+        LossyScope &operator=(const LossyScope &) = delete;
+
+    private:
+        std::ios_base &stream;
+    };
+
+    void set_compression(std::ios_base &stream, const Compression &compression);
+
+    /// The compression set on stream, or none if array data is sent as it is.
+    optional<Compression> compression(std::ios_base &stream);
+
+    /// Comma separated list of the codecs this build can read and write, e.g. "nhlbi,deflate".
+    std::string supported_codecs();
+
+    /// The compression to use when writing to a peer able to read peer_codecs, keeping float data within tolerance.
+    Compression negotiate_compression(const std::string &peer_codecs, float tolerance);
+
+    /**
+     * Writes bytes of data to stream as compressed blocks.
+     * @param word_size Width of the words in data; bytes are shuffled in words of this width before deflating.
+     * @param floats True if data is made up of floats, which may then be stored within compression.tolerance
+     *               while a LossyScope is open on stream.
+     */
+    void write_compressed(
+            std::ostream &stream,
+            const char *data,
+            size_t bytes,
+            size_t word_size,
+            bool floats,
+            const Compression &compression
+    );
+
+    /// Reads compressed blocks from stream until bytes of data have been decoded.
+    void read_compressed(std::istream &stream, char *data, size_t bytes);
+
+    template<class T> struct compression_traits {
+        static constexpr size_t word_size = sizeof(T) <= 8 ? sizeof(T) : 1;
+        static constexpr bool floats = std::is_same<T, float>::value;
+    };
+
+    template<class T> struct compression_traits<std::complex<T>> {
+        static constexpr size_t word_size = sizeof(T);
+        static constexpr bool floats = std::is_same<T, float>::value;
+    };
+
+    template<class T>
+    void write_compressed(std::ostream &stream, const T *data, size_t number_of_elements, const Compression &compression) {
+        write_compressed(
+                stream,
+                reinterpret_cast<const char *>(data),
+                number_of_elements * sizeof(T),
+                compression_traits<T>::word_size,
+                compression_traits<T>::floats,
+                compression
+        );
+    }
+
+    template<class T>
+    void read_compressed(std::istream &stream, T *data, size_t number_of_elements) {
+        read_compressed(stream, reinterpret_cast<char *>(data), number_of_elements * sizeof(T));
+    }
+}
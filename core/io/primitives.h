@@ -7,6 +7,7 @@
 
 #include "hoNDArray.h"
 #include "Types.h"
+#include "compression.h"
 #include <boost/hana/adapt_struct.hpp>
 
 namespace Gadgetron::Core::IO {
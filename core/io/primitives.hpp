@@ -38,6 +38,9 @@ void Gadgetron::Core::IO::write(std::ostream &stream, const T &value) {
 template<class T>
 std::enable_if_t<Gadgetron::Core::is_trivially_copyable_v<T>>
 Gadgetron::Core::IO::write(std::ostream &stream, const T *data, size_t number_of_elements) {
+    if (number_of_elements * sizeof(T) >= minimum_compressed_bytes) {
+        if (auto settings = compression(stream)) return write_compressed(stream, data, number_of_elements, *settings);
+    }
     stream.write(reinterpret_cast<const char *>(data), number_of_elements * sizeof(T));
 }
 
@@ -71,6 +74,7 @@ void Gadgetron::Core::IO::write_string_to_stream(std::ostream &stream, const std
 
 template<class T>
 std::enable_if_t<Gadgetron::Core::is_trivially_copyable_v<T>> Gadgetron::Core::IO::read(std::istream &stream, T *data, size_t elements) {
+    if (elements * sizeof(T) >= minimum_compressed_bytes && compression(stream)) return read_compressed(stream, data, elements);
     stream.read(reinterpret_cast<char *>(data), elements*sizeof(T));
     }
 template<class T>
@@ -1,5 +1,6 @@
 #include "AcquisitionWriter.h"
 #include "io/primitives.h"
+#include "io/compression.h"
 #include "MessageID.h"
 
 namespace Gadgetron::Core::Writers {
@@ -14,6 +15,8 @@ namespace Gadgetron::Core::Writers {
         IO::write(stream, header);
         if (trajectory)
             IO::write(stream, trajectory->get_data_ptr(), trajectory->get_number_of_elements());
+
+        IO::LossyScope lossy(stream);
         IO::write(stream, data.get_data_ptr(), data.get_number_of_elements());
     }
 
@@ -5,23 +5,38 @@
 #include "BufferWriter.h"
 #include "Types.h"
 #include "io/primitives.h"
-#include <boost/hana/adapt_struct.hpp>
+#include "io/compression.h"
 #include "MessageID.h"
-#include "io/adapt_struct.h"
 
+namespace {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
 
-GADGETRON_ADAPT_STRUCT(Gadgetron::IsmrmrdReconBit, GADGETRON_ACCESS_ELEMENT(data_), GADGETRON_ACCESS_ELEMENT(ref_))
-
-GADGETRON_ADAPT_STRUCT(Gadgetron::IsmrmrdDataBuffered, GADGETRON_ACCESS_ELEMENT(data_), GADGETRON_ACCESS_ELEMENT(trajectory_), GADGETRON_ACCESS_ELEMENT(density_),GADGETRON_ACCESS_ELEMENT(headers_),GADGETRON_ACCESS_ELEMENT(sampling_))
-GADGETRON_ADAPT_STRUCT(Gadgetron::IsmrmrdReconData,GADGETRON_ACCESS_ELEMENT(rbit_))
-
+    // Written field by field, in the order BufferReader reads them, so that only the k-space samples may be
+    // stored lossily; trajectories and density weights are always sent exactly.
+    void write_buffer(std::ostream &stream, const IsmrmrdDataBuffered &buffer) {
+        {
+            IO::LossyScope lossy(stream);
+            IO::write(stream, buffer.data_);
+        }
+        IO::write(stream, buffer.trajectory_);
+        IO::write(stream, buffer.density_);
+        IO::write(stream, buffer.headers_);
+        IO::write(stream, buffer.sampling_);
+    }
+}
 
 void
 Gadgetron::Core::Writers::BufferWriter::serialize(std::ostream &stream, const Gadgetron::IsmrmrdReconData &reconData) {
-    static_assert(!Gadgetron::Core::is_trivially_copyable_v<IsmrmrdReconData>);
     GDEBUG("Sending out reconData\n");
     IO::write(stream,MessageID::GADGET_MESSAGE_RECONDATA);
-    IO::write(stream, reconData);
+
+    IO::write(stream, reconData.rbit_.size());
+    for (const auto &bit : reconData.rbit_) {
+        write_buffer(stream, bit.data_);
+        IO::write(stream, bool(bit.ref_));
+        if (bit.ref_) write_buffer(stream, *bit.ref_);
+    }
 }
 
 namespace Gadgetron::Core::Writers {
@@ -3,6 +3,7 @@
 #include <ismrmrd/ismrmrd.h>
 #include <boost/optional.hpp>
 #include <io/primitives.h>
+#include <io/compression.h>
 
 #include "MessageID.h"
 #include "ImageWriter.h"
@@ -25,6 +26,9 @@ namespace {
         ) override {
             auto message_id = GADGET_MESSAGE_ISMRMRD_IMAGE;
             IO::write(stream, message_id);
+
+            // The header and meta data are not float arrays, so only the pixels can be stored lossily.
+            IO::LossyScope lossy(stream);
             IO::write(stream,Image<T>{header,data,meta});
         }
     };
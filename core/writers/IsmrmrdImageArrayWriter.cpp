@@ -1,11 +1,15 @@
 #include "IsmrmrdImageArrayWriter.h"
 #include "io/ismrmrd_types.h"
 #include "io/adapt_struct.h"
+#include "io/compression.h"
 #include "MessageID.h"
 
 void Gadgetron::Core::Writers::IsmrmrdImageArrayWriter::serialize(
     std::ostream& stream, const Gadgetron::IsmrmrdImageArray& image_array) {
     IO::write(stream, MessageID::GADGET_MESSAGE_ISMRMRD_IMAGE_ARRAY);
+
+    // Only the pixels are float arrays; headers, meta data and waveforms are never stored lossily.
+    IO::LossyScope lossy(stream);
     IO::write(stream,image_array);
 }
 
@@ -56,6 +56,8 @@ namespace Gadgetron {
         GADGET_PROPERTY(std_thres_masking, double, "Number of noise std for masking", 3.0);
         GADGET_PROPERTY(mapping_with_masking, bool, "Whether to compute and apply a mask for mapping", true);
 
+        GADGET_PROPERTY(batched_fitting, bool, "Whether to fit the pixels in batches with a Levenberg-Marquardt solver", false);
+
         // ------------------------------------------------------------------------------------
 
     protected:
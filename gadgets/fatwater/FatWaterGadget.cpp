@@ -55,6 +55,7 @@ namespace Gadgetron {
         config.number_of_r2_fine_samples = number_of_r2stars_fine;
         config.do_gradient_descent = do_gradient_descent;
         config.downsamples = downsample_data;
+        config.graph_cut_regions = graph_cut_regions;
 
 
         return GADGET_OK;
@@ -19,6 +19,12 @@ namespace Gadgetron {
     }
 
     GenericReconCartesianGrappaGadget::~GenericReconCartesianGrappaGadget() {
+        this->stop_pipeline();
+
+        if (calib_cache_.hits_ + calib_cache_.misses_ > 0) {
+            GDEBUG_CONDITION_STREAM(verbose.value(), "GenericReconCartesianGrappaGadget, calibration cache hits : "
+                    << calib_cache_.hits_ << ", misses : " << calib_cache_.misses_);
+        }
     }
 
     int GenericReconCartesianGrappaGadget::process_config(ACE_Message_Block *mb) {
@@ -39,13 +45,73 @@ namespace Gadgetron {
         GDEBUG_CONDITION_STREAM(verbose.value(), "Number of encoding spaces: " << NE);
 
         recon_obj_.resize(NE);
+        pipeline_calib_.clear();
+        pipeline_calib_.resize(NE);
+
+        calib_cache_.clear();
+        calib_cache_.max_bytes_ = grappa_calib_cache_max_mb.value() * 1024 * 1024;
 
 
         GDEBUG("PATHNAME %s 'n",this->context.paths.gadgetron_home.c_str());
 
+        if (pipeline_depth.value() > 0) {
+            GDEBUG_CONDITION_STREAM(verbose.value(), "Unwrapping on a worker thread, pipeline depth : " << pipeline_depth.value());
+            this->start_pipeline(pipeline_depth.value());
+        }
+
         return GADGET_OK;
     }
 
+    int GenericReconCartesianGrappaGadget::close(unsigned long flags) {
+        this->stop_pipeline();
+        this->rethrow_pipeline_error();
+
+        return BaseClass::close(flags);
+    }
+
+    void GenericReconCartesianGrappaGadget::start_pipeline(size_t depth) {
+        pipeline_ = std::make_unique<Core::BoundedMPMCChannel<std::function<void()> > >(depth);
+        gt_timer_pipeline_.set_timing_in_destruction(false);
+
+        pipeline_worker_ = std::thread([this]() {
+            while (true) {
+                std::function<void()> task;
+                try {
+                    task = pipeline_->pop();
+                } catch (const Core::ChannelClosed &) {
+                    return;
+                }
+
+                try {
+                    task();
+                } catch (...) {
+                    // the first error is kept for process() or close() to rethrow on the gadget thread
+                    std::lock_guard<std::mutex> guard(pipeline_mutex_);
+                    if (!pipeline_error_) pipeline_error_ = std::current_exception();
+                }
+            }
+        });
+    }
+
+    void GenericReconCartesianGrappaGadget::stop_pipeline() {
+        if (!pipeline_) return;
+
+        // the worker finishes the recon bits already queued before it sees the channel closed
+        pipeline_->close();
+        if (pipeline_worker_.joinable()) pipeline_worker_.join();
+        pipeline_.reset();
+    }
+
+    void GenericReconCartesianGrappaGadget::rethrow_pipeline_error() {
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> guard(pipeline_mutex_);
+            std::swap(error, pipeline_error_);
+        }
+
+        if (error) std::rethrow_exception(error);
+    }
+
     int GenericReconCartesianGrappaGadget::process(Gadgetron::GadgetContainerMessage<IsmrmrdReconData> *m1) {
         if (perform_timing.value()) { gt_timer_local_.start("GenericReconCartesianGrappaGadget::process"); }
 
@@ -68,6 +134,19 @@ namespace Gadgetron {
             }
         }
 
+        // with pipelining, this call calibrates and the worker thread unwraps and sends out the images
+        const bool pipelined = pipeline_ != nullptr;
+        std::shared_ptr<std::vector<std::shared_ptr<ReconObjType> > > pipelined_recon_obj;
+        if (pipelined) {
+            try {
+                this->rethrow_pipeline_error();
+            } catch (...) {
+                m1->release();
+                throw;
+            }
+            pipelined_recon_obj = std::make_shared<std::vector<std::shared_ptr<ReconObjType> > >();
+        }
+
         // for every encoding space
         for (size_t e = 0; e < recon_bit_->rbit_.size(); e++) {
             std::stringstream os;
@@ -95,7 +174,11 @@ namespace Gadgetron {
 
             // ---------------------------------------------------------------
 
-            if (recon_bit_->rbit_[e].ref_) {
+            const bool calibrated = bool(recon_bit_->rbit_[e].ref_);
+            if (calibrated) {
+                // the queued unwrapping stages keep the previous calibration; dropping it here lets the last of them take it over
+                if (pipelined) pipeline_calib_[e].reset();
+
                 if (!debug_folder_full_path_.empty() && necessary_to_save) {
                     gt_exporter_.export_array_complex(recon_bit_->rbit_[e].ref_->data_,
                                                       debug_folder_full_path_ + "ref" + os.str());
@@ -171,124 +254,194 @@ namespace Gadgetron {
                 recon_bit_->rbit_[e].ref_ = Core::none;
             }
 
-            if (recon_bit_->rbit_[e].data_.data_.get_number_of_elements() > 0) {
-                if (!debug_folder_full_path_.empty() && necessary_to_save) {
-                    gt_exporter_.export_array_complex(recon_bit_->rbit_[e].data_.data_,
-                                                      debug_folder_full_path_ + "data_before_unwrapping" + os.str());
+            if (!pipelined) {
+                if (recon_bit_->rbit_[e].data_.data_.get_number_of_elements() > 0) {
+                    this->perform_unwrapping_stage(recon_bit_->rbit_[e], recon_obj_[e], e,
+                                                   wav ? wav->getObjectPtr() : nullptr, gt_timer_, gt_exporter_, os.str());
                 }
 
-                if (!debug_folder_full_path_.empty() && recon_bit_->rbit_[e].data_.trajectory_ && necessary_to_save) {
-                    if (recon_bit_->rbit_[e].data_.trajectory_->get_number_of_elements() > 0) {
-                        gt_exporter_.export_array(*(recon_bit_->rbit_[e].data_.trajectory_),
-                                                  debug_folder_full_path_ + "data_before_unwrapping_traj" + os.str());
-                    }
+                recon_bit_->rbit_[e].additional_data["grappa_recon_obj"] = recon_obj_[e];
+            } else {
+                // the calibration is handed over rather than copied; the next recon bit with ref data calibrates afresh
+                if (calibrated || !pipeline_calib_[e]) {
+                    pipeline_calib_[e] = std::make_shared<ReconObjType>(std::move(recon_obj_[e]));
                 }
+                pipelined_recon_obj->push_back(pipeline_calib_[e]);
+            }
 
-                // ---------------------------------------------------------------
+            recon_obj_[e].recon_res_.data_.clear();
+            recon_obj_[e].gfactor_.clear();
+            recon_obj_[e].recon_res_.headers_.clear();
+            recon_obj_[e].recon_res_.meta_.clear();
+        }
 
-                if (perform_timing.value()) {
-                    gt_timer_.start("GenericReconCartesianGrappaGadget::perform_unwrapping");
-                }
-                this->perform_unwrapping(recon_bit_->rbit_[e], recon_obj_[e], e);
-                if (perform_timing.value()) { gt_timer_.stop(); }
+//        m1->release();
 
-                // ---------------------------------------------------------------
+        if (pipelined) {
+            size_t call = process_called_times_;
+            const std::vector<Core::Waveform> *waveforms = wav ? wav->getObjectPtr() : nullptr;
+
+            // blocks while pipeline_depth recon bits are waiting to be unwrapped
+            pipeline_->push([this, m1, waveforms, call, pipelined_recon_obj]() {
+                try {
+                    IsmrmrdReconData *recon_data = m1->getObjectPtr();
+                    for (size_t e = 0; e < recon_data->rbit_.size(); e++) {
+                        std::stringstream os;
+                        os << "_encoding_" << e << "_" << call;
+
+                        // the worker is the only thread using a queued calibration, so it can store the results in it
+                        std::shared_ptr<ReconObjType> &calib = (*pipelined_recon_obj)[e];
+                        ReconObjType &recon_obj = *calib;
+                        if (recon_data->rbit_[e].data_.data_.get_number_of_elements() > 0) {
+                            this->perform_unwrapping_stage(recon_data->rbit_[e], recon_obj, e, waveforms,
+                                                           gt_timer_pipeline_, gt_exporter_pipeline_, os.str());
+                        }
 
-                if (perform_timing.value()) {
-                    gt_timer_.start("GenericReconCartesianGrappaGadget::compute_image_header");
+                        // the last recon bit using a calibration takes it over, the others copy it as the sequential mode does
+                        auto &grappa_recon_obj = recon_data->rbit_[e].additional_data["grappa_recon_obj"];
+                        if (calib.use_count() == 1) {
+                            grappa_recon_obj = std::move(recon_obj);
+                        } else {
+                            grappa_recon_obj = recon_obj;
+
+                            // later recon bits without ref data get neither the results nor the gfactor of this one
+                            recon_obj.recon_res_.data_.clear();
+                            recon_obj.gfactor_.clear();
+                            recon_obj.recon_res_.headers_.clear();
+                            recon_obj.recon_res_.meta_.clear();
+                        }
+                        calib.reset();
+                    }
+                } catch (...) {
+                    m1->release();
+                    throw;
                 }
-                this->compute_image_header(recon_bit_->rbit_[e], recon_obj_[e].recon_res_, e);
-                if (perform_timing.value()) { gt_timer_.stop(); }
-
-                // ---------------------------------------------------------------
-                // pass down waveform
-                if (wav) recon_obj_[e].recon_res_.waveform_ =  this->set_wave_form_to_image_array(*wav->getObjectPtr());
-                recon_obj_[e].recon_res_.acq_headers_ = recon_bit_->rbit_[e].data_.headers_;
 
-                // ---------------------------------------------------------------
-                if (send_out_gfactor.value() && recon_obj_[e].gfactor_.get_number_of_elements() > 0 &&
-                    (acceFactorE1_[e] * acceFactorE2_[e] > 1)) {
-                    IsmrmrdImageArray res;
-                    Gadgetron::real_to_complex(recon_obj_[e].gfactor_, res.data_);
-                    res.headers_ = recon_obj_[e].recon_res_.headers_;
-                    res.meta_ = recon_obj_[e].recon_res_.meta_;
-
-                    if (perform_timing.value()) {
-                        gt_timer_.start("GenericReconCartesianGrappaGadget::send_out_image_array, gfactor");
-                    }
-                    this->send_out_image_array(res, e, image_series.value() + 10 * ((int) e + 2),
-                                               GADGETRON_IMAGE_GFACTOR);
-                    if (perform_timing.value()) { gt_timer_.stop(); }
+                if (this->next()->putq(m1) < 0) {
+                    throw std::runtime_error("Put IsmrmrdReconData to Q failed ... ");
                 }
+            });
 
-                // ---------------------------------------------------------------
-                if (send_out_snr_map.value()) {
-                    hoNDArray<std::complex<float> > snr_map;
-
-                    if (calib_mode_[e] == Gadgetron::ISMRMRD_noacceleration) {
-                        snr_map = recon_obj_[e].recon_res_.data_;
-                    } else {
-                        if (recon_obj_[e].gfactor_.get_number_of_elements() > 0) {
-                            if (perform_timing.value()) { gt_timer_.start("compute SNR map array"); }
-                            this->compute_snr_map(recon_obj_[e], snr_map);
-                            if (perform_timing.value()) { gt_timer_.stop(); }
-                        }
-                    }
+            if (perform_timing.value()) { gt_timer_local_.stop(); }
+            return GADGET_OK;
+        }
 
-                    if (snr_map.get_number_of_elements() > 0) {
-                        if (!debug_folder_full_path_.empty() && necessary_to_save) {
-                            this->gt_exporter_.export_array_complex(snr_map,
-                                                                    debug_folder_full_path_ + "snr_map" + os.str());
-                        }
+        if (perform_timing.value()) { gt_timer_local_.stop(); }
 
-                        if (perform_timing.value()) { gt_timer_.start("send out gfactor array, snr map"); }
+        if (this->next()->putq(m1) < 0)
+        {
+            GERROR_STREAM("Put IsmrmrdReconData to Q failed ... ");
+            return GADGET_FAIL;
+        }
 
-                        IsmrmrdImageArray res;
-                        res.data_ = snr_map;
-                        res.headers_ = recon_obj_[e].recon_res_.headers_;
-                        res.meta_ = recon_obj_[e].recon_res_.meta_;
-                        res.acq_headers_ = recon_bit_->rbit_[e].data_.headers_;
+        return GADGET_OK;
+    }
 
-                        this->send_out_image_array(res, e,
-                                                   image_series.value() + 100 * ((int) e + 3), GADGETRON_IMAGE_SNR_MAP);
+    void GenericReconCartesianGrappaGadget::perform_unwrapping_stage(IsmrmrdReconBit &recon_bit,
+                                                                     ReconObjType &recon_obj, size_t e,
+                                                                     const std::vector<Core::Waveform> *wav,
+                                                                     GadgetronTimer &timer,
+                                                                     ImageIOAnalyze &exporter,
+                                                                     const std::string &suffix) {
+        bool necessary_to_save = false;
 
-                        if (perform_timing.value()) { gt_timer_.stop(); }
-                    }
-                }
+        if (!debug_folder_full_path_.empty() && necessary_to_save) {
+            exporter.export_array_complex(recon_bit.data_.data_,
+                                          debug_folder_full_path_ + "data_before_unwrapping" + suffix);
+        }
 
-                // ---------------------------------------------------------------
+        if (!debug_folder_full_path_.empty() && recon_bit.data_.trajectory_ && necessary_to_save) {
+            if (recon_bit.data_.trajectory_->get_number_of_elements() > 0) {
+                exporter.export_array(*(recon_bit.data_.trajectory_),
+                                      debug_folder_full_path_ + "data_before_unwrapping_traj" + suffix);
+            }
+        }
 
-                if (!debug_folder_full_path_.empty()) {
-                    this->gt_exporter_.export_array_complex_real_imag(recon_obj_[e].recon_res_.data_,
-                        debug_folder_full_path_ + "recon_res" + os.str());
-                }
+        // ---------------------------------------------------------------
 
-                if (perform_timing.value()) {
-                    gt_timer_.start("GenericReconCartesianGrappaGadget::send_out_image_array");
+        if (perform_timing.value()) {
+            timer.start("GenericReconCartesianGrappaGadget::perform_unwrapping");
+        }
+        this->perform_unwrapping(recon_bit, recon_obj, e);
+        if (perform_timing.value()) { timer.stop(); }
+
+        // ---------------------------------------------------------------
+
+        if (perform_timing.value()) {
+            timer.start("GenericReconCartesianGrappaGadget::compute_image_header");
+        }
+        this->compute_image_header(recon_bit, recon_obj.recon_res_, e);
+        if (perform_timing.value()) { timer.stop(); }
+
+        // ---------------------------------------------------------------
+        // pass down waveform
+        if (wav) recon_obj.recon_res_.waveform_ =  this->set_wave_form_to_image_array(*wav);
+        recon_obj.recon_res_.acq_headers_ = recon_bit.data_.headers_;
+
+        // ---------------------------------------------------------------
+        if (send_out_gfactor.value() && recon_obj.gfactor_.get_number_of_elements() > 0 &&
+            (acceFactorE1_[e] * acceFactorE2_[e] > 1)) {
+            IsmrmrdImageArray res;
+            Gadgetron::real_to_complex(recon_obj.gfactor_, res.data_);
+            res.headers_ = recon_obj.recon_res_.headers_;
+            res.meta_ = recon_obj.recon_res_.meta_;
+
+            if (perform_timing.value()) {
+                timer.start("GenericReconCartesianGrappaGadget::send_out_image_array, gfactor");
+            }
+            this->send_out_image_array(res, e, image_series.value() + 10 * ((int) e + 2),
+                                       GADGETRON_IMAGE_GFACTOR);
+            if (perform_timing.value()) { timer.stop(); }
+        }
+
+        // ---------------------------------------------------------------
+        if (send_out_snr_map.value()) {
+            hoNDArray<std::complex<float> > snr_map;
+
+            if (calib_mode_[e] == Gadgetron::ISMRMRD_noacceleration) {
+                snr_map = recon_obj.recon_res_.data_;
+            } else {
+                if (recon_obj.gfactor_.get_number_of_elements() > 0) {
+                    if (perform_timing.value()) { timer.start("compute SNR map array"); }
+                    this->compute_snr_map(recon_obj, snr_map);
+                    if (perform_timing.value()) { timer.stop(); }
                 }
-                this->send_out_image_array(recon_obj_[e].recon_res_, e,
-                    image_series.value() + ((int)e + 1), GADGETRON_IMAGE_REGULAR);
-                if (perform_timing.value()) { gt_timer_.stop(); }
             }
 
-            recon_bit_->rbit_[e].additional_data["grappa_recon_obj"] = recon_obj_[e];
-            recon_obj_[e].recon_res_.data_.clear();
-            recon_obj_[e].gfactor_.clear();
-            recon_obj_[e].recon_res_.headers_.clear();
-            recon_obj_[e].recon_res_.meta_.clear();
-        }
+            if (snr_map.get_number_of_elements() > 0) {
+                if (!debug_folder_full_path_.empty() && necessary_to_save) {
+                    exporter.export_array_complex(snr_map,
+                                                  debug_folder_full_path_ + "snr_map" + suffix);
+                }
 
-//        m1->release();
+                if (perform_timing.value()) { timer.start("send out gfactor array, snr map"); }
 
-        if (perform_timing.value()) { gt_timer_local_.stop(); }
+                IsmrmrdImageArray res;
+                res.data_ = snr_map;
+                res.headers_ = recon_obj.recon_res_.headers_;
+                res.meta_ = recon_obj.recon_res_.meta_;
+                res.acq_headers_ = recon_bit.data_.headers_;
 
-        if (this->next()->putq(m1) < 0)
-        {
-            GERROR_STREAM("Put IsmrmrdReconData to Q failed ... ");
-            return GADGET_FAIL;
+                this->send_out_image_array(res, e,
+                                           image_series.value() + 100 * ((int) e + 3), GADGETRON_IMAGE_SNR_MAP);
+
+                if (perform_timing.value()) { timer.stop(); }
+            }
         }
 
-        return GADGET_OK;
+        // ---------------------------------------------------------------
+
+        if (!debug_folder_full_path_.empty()) {
+            exporter.export_array_complex_real_imag(recon_obj.recon_res_.data_,
+                debug_folder_full_path_ + "recon_res" + suffix);
+        }
+
+        if (perform_timing.value()) {
+            timer.start("GenericReconCartesianGrappaGadget::send_out_image_array");
+        }
+        this->send_out_image_array(recon_obj.recon_res_, e,
+            image_series.value() + ((int)e + 1), GADGETRON_IMAGE_REGULAR);
+        if (perform_timing.value()) { timer.stop(); }
     }
 
     void GenericReconCartesianGrappaGadget::prepare_down_stream_coil_compression_ref_data(
@@ -402,6 +555,18 @@ namespace Gadgetron {
 
         size_t dstCHA = dst.get_size(3);
 
+        bool accelerated = acceFactorE1_[e] > 1 || acceFactorE2_[e] > 1;
+        bool use_cache = accelerated && grappa_calib_cache.value() && calib_cache_.max_bytes_ > 0;
+
+        GenericReconCartesianGrappaCalibCache::Key cache_key{ 0, 0 };
+        if (use_cache) {
+            cache_key = GenericReconCartesianGrappaCalibCache::key(this->compute_calib_cache_params(recon_bit, e), recon_obj);
+            if (calib_cache_.restore(cache_key, recon_obj)) {
+                GDEBUG_CONDITION_STREAM(verbose.value(), "Reusing cached grappa calibration for encoding space " << e);
+                return;
+            }
+        }
+
         recon_obj.unmixing_coeff_.create(RO, E1, E2, srcCHA, ref_N, ref_S, ref_SLC);
         recon_obj.gfactor_.create(RO, E1, E2, 1, ref_N, ref_S, ref_SLC);
 
@@ -559,6 +724,26 @@ namespace Gadgetron {
             }
         }
 
+        if (use_cache) calib_cache_.store(cache_key, recon_obj);
+    }
+
+    std::vector<double> GenericReconCartesianGrappaGadget::compute_calib_cache_params(IsmrmrdReconBit &recon_bit,
+                                                                                     size_t e) {
+
+        return {
+                (double) recon_bit.data_.data_.get_size(0),
+                (double) recon_bit.data_.data_.get_size(1),
+                (double) recon_bit.data_.data_.get_size(2),
+                (double) e,
+                (double) acceFactorE1_[e],
+                (double) acceFactorE2_[e],
+                (double) grappa_kSize_RO.value(),
+                (double) grappa_kSize_E1.value(),
+                (double) grappa_kSize_E2.value(),
+                grappa_reg_lamda.value(),
+                grappa_calib_over_determine_ratio.value(),
+                (double) downstream_coil_compression.value()
+        };
     }
 
     void GenericReconCartesianGrappaGadget::perform_unwrapping(IsmrmrdReconBit &recon_bit, ReconObjType &recon_obj,
@@ -602,14 +787,14 @@ namespace Gadgetron {
 //        }
 
         // compute aliased images
-        data_recon_buf_.create(RO, E1, E2, dstCHA, N, S, SLC);
+        unwrapping_data_buf_.create(RO, E1, E2, dstCHA, N, S, SLC);
 
         if (E2 > 1) {
-            Gadgetron::hoNDFFT<float>::instance()->ifft3c(recon_bit.data_.data_, complex_im_recon_buf_,
-                                                          data_recon_buf_);
+            Gadgetron::hoNDFFT<float>::instance()->ifft3c(recon_bit.data_.data_, unwrapping_im_buf_,
+                                                          unwrapping_data_buf_);
         } else {
-            Gadgetron::hoNDFFT<float>::instance()->ifft2c(recon_bit.data_.data_, complex_im_recon_buf_,
-                                                          data_recon_buf_);
+            Gadgetron::hoNDFFT<float>::instance()->ifft2c(recon_bit.data_.data_, unwrapping_im_buf_,
+                                                          unwrapping_data_buf_);
         }
 
         // SNR unit scaling
@@ -618,7 +803,7 @@ namespace Gadgetron {
         if (effective_acce_factor > 1) {
             // since the grappa in gadgetron is doing signal preserving scaling, to perserve noise level, we need this compensation factor
             double grappaKernelCompensationFactor = 1.0 / (acceFactorE1_[e] * acceFactorE2_[e]);
-            Gadgetron::scal((float) (grappaKernelCompensationFactor * snr_scaling_ratio), complex_im_recon_buf_);
+            Gadgetron::scal((float) (grappaKernelCompensationFactor * snr_scaling_ratio), unwrapping_im_buf_);
 
             if (this->verbose.value()) GDEBUG_STREAM(
                     "GenericReconCartesianGrappaGadget, grappaKernelCompensationFactor*snr_scaling_ratio : "
@@ -629,7 +814,7 @@ namespace Gadgetron {
 //            std::stringstream os;
 //            os << "encoding_" << e;
 //            std::string suffix = os.str();
-//            gt_exporter_.export_array_complex(complex_im_recon_buf_, debug_folder_full_path_ + "aliasedIm_" + suffix);
+//            gt_exporter_.export_array_complex(unwrapping_im_buf_, debug_folder_full_path_ + "aliasedIm_" + suffix);
 //        }
 
         // unwrapping
@@ -647,7 +832,7 @@ namespace Gadgetron {
                 size_t n = ii - slc * N * S - s * N;
 
                 // combined channels
-                T *pIm = &(complex_im_recon_buf_(0, 0, 0, 0, n, s, slc));
+                T *pIm = &(unwrapping_im_buf_(0, 0, 0, 0, n, s, slc));
 
                 size_t usedN = n;
                 if (n >= ref_N) usedN = ref_N - 1;
@@ -726,6 +911,109 @@ namespace Gadgetron {
     }
 
 
+    // ----------------------------------------------------------------------------------------
+
+    GenericReconCartesianGrappaCalibCache::GenericReconCartesianGrappaCalibCache(size_t max_bytes)
+        : max_bytes_(max_bytes), hits_(0), misses_(0), bytes_(0) {
+    }
+
+    uint64_t GenericReconCartesianGrappaCalibCache::hash(const void *data, size_t bytes, uint64_t seed) {
+
+        // 64 bit multiply-rotate mixing in the style of MurmurHash2; a few GB/s, much faster than the calibration
+        const uint64_t m = 0xc6a4a7935bd1e995ULL;
+        const uint64_t k2 = 0x9e3779b97f4a7c15ULL;
+
+        uint64_t h = seed ^ (bytes * m);
+
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+        size_t words = bytes / sizeof(uint64_t);
+
+        for (size_t i = 0; i < words; i++) {
+            uint64_t k;
+            memcpy(&k, p + i * sizeof(uint64_t), sizeof(uint64_t));
+            k *= m;
+            k = (k << 31) | (k >> 33);
+            k *= k2;
+            h = (h ^ k) * m;
+        }
+
+        uint64_t tail = 0;
+        memcpy(&tail, p + words * sizeof(uint64_t), bytes - words * sizeof(uint64_t));
+        h = (h ^ tail) * m;
+
+        h ^= h >> 29;
+        h *= k2;
+        h ^= h >> 32;
+        return h;
+    }
+
+    uint64_t GenericReconCartesianGrappaCalibCache::hash(const hoNDArray<std::complex<float> > &a, uint64_t seed) {
+        std::vector<size_t> dims = a.dimensions();
+        uint64_t h = hash(dims.data(), dims.size() * sizeof(size_t), seed);
+        return hash(a.begin(), a.get_number_of_bytes(), h);
+    }
+
+    GenericReconCartesianGrappaCalibCache::Key
+    GenericReconCartesianGrappaCalibCache::key(const std::vector<double> &params, const ReconObjType &recon_obj) {
+        Key key{ 0, 0x5851f42d4c957f2dULL };
+        for (uint64_t *h : { &key.hash, &key.check }) {
+            *h = hash(params.data(), params.size() * sizeof(double), *h);
+            *h = hash(recon_obj.ref_calib_, *h);
+            *h = hash(recon_obj.ref_calib_dst_, *h);
+            *h = hash(recon_obj.coil_map_, *h);
+        }
+        return key;
+    }
+
+    size_t GenericReconCartesianGrappaCalibCache::Entry::bytes() const {
+        return kernel_.get_number_of_bytes() + kernelIm_.get_number_of_bytes() + unmixing_coeff_.get_number_of_bytes()
+               + gfactor_.get_number_of_bytes();
+    }
+
+    bool GenericReconCartesianGrappaCalibCache::restore(const Key &key, ReconObjType &recon_obj) {
+
+        for (auto entry = entries_.begin(); entry != entries_.end(); entry++) {
+            if (!(entry->key == key)) continue;
+
+            recon_obj.kernel_ = entry->kernel_;
+            recon_obj.kernelIm_ = entry->kernelIm_;
+            recon_obj.unmixing_coeff_ = entry->unmixing_coeff_;
+            recon_obj.gfactor_ = entry->gfactor_;
+
+            entries_.splice(entries_.begin(), entries_, entry);
+            hits_++;
+            return true;
+        }
+
+        misses_++;
+        return false;
+    }
+
+    void GenericReconCartesianGrappaCalibCache::store(const Key &key, const ReconObjType &recon_obj) {
+
+        Entry entry;
+        entry.key = key;
+        entry.kernel_ = recon_obj.kernel_;
+        entry.kernelIm_ = recon_obj.kernelIm_;
+        entry.unmixing_coeff_ = recon_obj.unmixing_coeff_;
+        entry.gfactor_ = recon_obj.gfactor_;
+
+        size_t entry_bytes = entry.bytes();
+        if (entry_bytes > max_bytes_) return;
+
+        while (!entries_.empty() && bytes_ + entry_bytes > max_bytes_) {
+            bytes_ -= entries_.back().bytes();
+            entries_.pop_back();
+        }
+
+        entries_.push_front(std::move(entry));
+        bytes_ += entry_bytes;
+    }
+
+    void GenericReconCartesianGrappaCalibCache::clear() {
+        entries_.clear();
+        bytes_ = 0;
+    }
 
     GADGET_FACTORY_DECLARE(GenericReconCartesianGrappaGadget)
 }
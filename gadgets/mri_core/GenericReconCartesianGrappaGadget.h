@@ -6,6 +6,14 @@
 #pragma once
 
 #include "GenericReconGadget.h"
+#include "BoundedMPMCChannel.h"
+
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace Gadgetron {
 
@@ -46,6 +54,67 @@ namespace Gadgetron {
         /// coil sensitivity map, [RO E1 E2 dstCHA - uncombinedCHA Nor1 Sor1 SLC]
         hoNDArray<T> coil_map_;
     };
+
+    /// cache of calibration results, keyed on a hash of the reference data, coil maps and calibration parameters
+    /// repetitions sharing their reference data (e.g. separate-ref cine, multi-repetition perfusion) reuse the kernels
+    /// least recently used entries are dropped to keep the cache below max_bytes
+    class EXPORTGADGETSMRICORE GenericReconCartesianGrappaCalibCache
+    {
+    public:
+        typedef GenericReconCartesianGrappaObj< std::complex<float> > ReconObjType;
+
+        /// two independent hashes of the calibration inputs; the second rules out collisions of the first
+        /// without keeping a copy of the inputs
+        struct Key
+        {
+            uint64_t hash;
+            uint64_t check;
+
+            bool operator==(const Key& other) const { return hash == other.hash && check == other.check; }
+        };
+
+        explicit GenericReconCartesianGrappaCalibCache(size_t max_bytes = 0);
+
+        /// hash of the dimensions and content of an array, combined with seed
+        static uint64_t hash(const hoNDArray< std::complex<float> >& a, uint64_t seed);
+        static uint64_t hash(const void* data, size_t bytes, uint64_t seed);
+
+        /// key of the calibration parameters together with the ref_calib_, ref_calib_dst_ and coil_map_ of recon_obj
+        static Key key(const std::vector<double>& params, const ReconObjType& recon_obj);
+
+        /// if key is cached, fill in the kernel_, kernelIm_, unmixing_coeff_ and gfactor_ of recon_obj
+        bool restore(const Key& key, ReconObjType& recon_obj);
+
+        /// cache the calibration results of recon_obj under key
+        void store(const Key& key, const ReconObjType& recon_obj);
+
+        void clear();
+
+        size_t max_bytes_;
+        size_t hits_;
+        size_t misses_;
+
+        size_t bytes() const { return bytes_; }
+        size_t size() const { return entries_.size(); }
+
+    protected:
+
+        struct Entry
+        {
+            Key key;
+
+            hoNDArray< std::complex<float> > kernel_;
+            hoNDArray< std::complex<float> > kernelIm_;
+            hoNDArray< std::complex<float> > unmixing_coeff_;
+            hoNDArray< float > gfactor_;
+
+            size_t bytes() const;
+        };
+
+        /// most recently used first
+        std::list<Entry> entries_;
+        size_t bytes_;
+    };
 }
 
 namespace Gadgetron {
@@ -77,6 +146,8 @@ namespace Gadgetron {
         GADGET_PROPERTY(grappa_kSize_E2, int, "Grappa kernel size E2", 4);
         GADGET_PROPERTY(grappa_reg_lamda, double, "Grappa regularization threshold", 0.0005);
         GADGET_PROPERTY(grappa_calib_over_determine_ratio, double, "Grappa calibration overdermination ratio", 45);
+        GADGET_PROPERTY(grappa_calib_cache, bool, "Whether to reuse the calibration when the reference data and coil maps are unchanged", false);
+        GADGET_PROPERTY(grappa_calib_cache_max_mb, size_t, "Memory cap for cached calibrations, in MB", 512);
 
         /// ------------------------------------------------------------------------------------
         /// down stream coil compression
@@ -87,6 +158,15 @@ namespace Gadgetron {
         GADGET_PROPERTY(downstream_coil_compression_thres, double, "Threadhold for downstream coil compression", 0.002);
         GADGET_PROPERTY(downstream_coil_compression_num_modesKept, size_t, "Number of modes to keep for downstream coil compression", 0);
 
+        /// ------------------------------------------------------------------------------------
+        /// pipelining
+        /// if pipeline_depth > 0, the unwrapping, image header computation and sending out of a recon bit run on a worker thread,
+        /// while the next recon bits are calibrated; up to pipeline_depth recon bits (rounded up to a power of two) wait for the worker
+        /// images and recon data leave in the order the recon bits arrived, but other messages are passed on as they arrive,
+        /// so they may overtake the images of recon bits still waiting for the worker
+        /// an error on the worker thread is rethrown from the next process() or close()
+        GADGET_PROPERTY(pipeline_depth, size_t, "Number of recon bits queued for unwrapping on a worker thread while later bits are calibrated, 0 to process them sequentially", 0);
+
     protected:
 
         // --------------------------------------------------
@@ -95,12 +175,37 @@ namespace Gadgetron {
         // record the recon kernel, coil maps etc. for every encoding space
         std::vector< ReconObjType > recon_obj_;
 
+        // calibration results of earlier recon bits
+        GenericReconCartesianGrappaCalibCache calib_cache_;
+
+        // buffers of perform_unwrapping, separate from the coil map buffers, so calibration and unwrapping can run at the same time
+        hoNDArray< std::complex<float> > unwrapping_im_buf_;
+        hoNDArray< std::complex<float> > unwrapping_data_buf_;
+
+        // unwrapping stages waiting for the worker thread, run in the order the recon bits arrived
+        std::unique_ptr< Core::BoundedMPMCChannel< std::function<void()> > > pipeline_;
+        std::thread pipeline_worker_;
+        std::mutex pipeline_mutex_;
+        std::exception_ptr pipeline_error_;
+        Gadgetron::GadgetronTimer gt_timer_pipeline_;
+        Gadgetron::ImageIOAnalyze gt_exporter_pipeline_;
+
+        // latest calibration of every encoding space, shared with the unwrapping stages queued for the worker thread
+        // a recon bit with ref data calibrates into recon_obj_[e] and replaces it, so a calibration is never modified once queued
+        std::vector< std::shared_ptr<ReconObjType> > pipeline_calib_;
+
         // --------------------------------------------------
         // gadget functions
         // --------------------------------------------------
         // default interface function
         virtual int process_config(ACE_Message_Block* mb);
         virtual int process(Gadgetron::GadgetContainerMessage< IsmrmrdReconData >* m1);
+        virtual int close(unsigned long flags);
+
+        // start the worker thread of the pipelined mode, and stop it once the queued recon bits are done
+        void start_pipeline(size_t depth);
+        void stop_pipeline();
+        void rethrow_pipeline_error();
 
         // --------------------------------------------------
         // recon step functions
@@ -112,9 +217,17 @@ namespace Gadgetron {
         // calibration, if only one dst channel is prescribed, the GrappaOne is used
         virtual void perform_calib(IsmrmrdReconBit& recon_bit, ReconObjType& recon_obj, size_t encoding);
 
+        // parameters perform_calib depends on besides the reference data and coil maps; part of the calibration cache key
+        virtual std::vector<double> compute_calib_cache_params(IsmrmrdReconBit& recon_bit, size_t encoding);
+
         // unwrapping or coil combination
         virtual void perform_unwrapping(IsmrmrdReconBit& recon_bit, ReconObjType& recon_obj, size_t encoding);
 
+        // unwrapping, image header computation and sending out the images of one encoding space; the second stage of the pipeline
+        virtual void perform_unwrapping_stage(IsmrmrdReconBit& recon_bit, ReconObjType& recon_obj, size_t encoding,
+                                              const std::vector<Core::Waveform>* wav, GadgetronTimer& timer,
+                                              ImageIOAnalyze& exporter, const std::string& suffix);
+
         // compute snr map
         virtual void compute_snr_map(ReconObjType& recon_obj, hoNDArray< std::complex<float> >& snr_map);
 
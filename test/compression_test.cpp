@@ -0,0 +1,180 @@
+#include "io/compression.h"
+#include "io/primitives.h"
+#include "readers/BufferReader.h"
+#include "writers/BufferWriter.h"
+#include "MessageID.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <random>
+#include <sstream>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+
+namespace {
+
+    hoNDArray<std::complex<float>> smooth_image(size_t nx, size_t ny, size_t channels) {
+        auto image = hoNDArray<std::complex<float>>(nx, ny, channels);
+        for (size_t c = 0; c < channels; c++)
+            for (size_t y = 0; y < ny; y++)
+                for (size_t x = 0; x < nx; x++)
+                    image(x, y, c) = std::polar(100.0f * std::exp(-0.001f * (x * x + y * y)), 0.01f * (x + c));
+        return image;
+    }
+
+    template<class T>
+    std::pair<hoNDArray<T>, size_t> round_trip(
+            const hoNDArray<T> &array,
+            optional<IO::Compression> compression,
+            bool lossy = true
+    ) {
+        std::stringstream stream;
+        if (compression) IO::set_compression(stream, *compression);
+
+        if (lossy) {
+            IO::LossyScope scope(stream);
+            IO::write(stream, array);
+        } else {
+            IO::write(stream, array);
+        }
+        auto bytes = stream.str().size();
+
+        return {IO::read<hoNDArray<T>>(stream), bytes};
+    }
+}
+
+TEST(CompressionTest, settings_stored_on_stream) {
+
+    std::stringstream stream;
+    ASSERT_FALSE(IO::compression(stream));
+
+    IO::set_compression(stream, IO::Compression{0.25f, true});
+
+    auto compression = IO::compression(stream);
+    ASSERT_TRUE(compression);
+    EXPECT_EQ(compression->tolerance, 0.25f);
+    EXPECT_TRUE(compression->deflate);
+}
+
+TEST(CompressionTest, lossless) {
+
+    auto image = smooth_image(128, 128, 8);
+    auto deflate = IO::supported_codecs().find("deflate") != std::string::npos;
+
+    auto [plain, plain_bytes] = round_trip(image, none);
+    auto [result, bytes] = round_trip(image, IO::Compression{0.0f, deflate});
+
+    EXPECT_EQ(plain, image);
+    EXPECT_EQ(result, image);
+    if (deflate) EXPECT_LT(bytes, plain_bytes);
+}
+
+TEST(CompressionTest, within_tolerance) {
+
+    auto image = smooth_image(128, 128, 8);
+    const float tolerance = 0.01f;
+
+    auto [plain, plain_bytes] = round_trip(image, none);
+    auto [result, bytes] = round_trip(image, IO::Compression{tolerance, false});
+
+    ASSERT_EQ(result.dimensions(), image.dimensions());
+    for (size_t i = 0; i < image.size(); i++) {
+        ASSERT_LE(std::abs(result[i].real() - image[i].real()), tolerance);
+        ASSERT_LE(std::abs(result[i].imag() - image[i].imag()), tolerance);
+    }
+    EXPECT_LT(bytes, plain_bytes / 2);
+}
+
+TEST(CompressionTest, exact_outside_lossy_scope) {
+
+    auto image = smooth_image(128, 128, 8);
+
+    auto [result, bytes] = round_trip(image, IO::Compression{0.01f, false}, false);
+    EXPECT_EQ(result, image);
+}
+
+TEST(CompressionTest, recon_data_lossy_only_for_kspace) {
+
+    auto kspace = smooth_image(128, 64, 4);
+    auto trajectory = hoNDArray<float>(2, 128, 64);
+    for (size_t i = 0; i < trajectory.size(); i++) trajectory[i] = std::sin(0.001f * i);
+
+    IsmrmrdReconData recon_data;
+    recon_data.rbit_.emplace_back();
+    recon_data.rbit_[0].data_.data_ = kspace;
+    recon_data.rbit_[0].data_.trajectory_ = trajectory;
+    recon_data.rbit_[0].ref_ = IsmrmrdDataBuffered{};
+    recon_data.rbit_[0].ref_->data_ = kspace;
+
+    const float tolerance = 0.01f;
+    std::stringstream stream;
+    IO::set_compression(stream, IO::Compression{tolerance, false});
+    Writers::BufferWriter().write(stream, Message(recon_data));
+
+    ASSERT_EQ(IO::read<uint16_t>(stream), GADGET_MESSAGE_RECONDATA);
+    auto result = force_unpack<IsmrmrdReconData>(Readers::BufferReader().read(stream));
+
+    auto &bit = result.rbit_.at(0);
+    EXPECT_EQ(*bit.data_.trajectory_, trajectory);
+    ASSERT_TRUE(bit.ref_);
+    for (auto &data : {bit.data_.data_, bit.ref_->data_}) {
+        ASSERT_EQ(data.dimensions(), kspace.dimensions());
+        EXPECT_FALSE(data == kspace);
+        for (size_t i = 0; i < kspace.size(); i++) ASSERT_LE(std::abs(data[i] - kspace[i]), 2 * tolerance);
+    }
+}
+
+TEST(CompressionTest, non_finite_data_kept_exact) {
+
+    auto data = hoNDArray<float>(4096);
+    for (size_t i = 0; i < data.size(); i++) data[i] = float(i);
+    data[17] = std::numeric_limits<float>::quiet_NaN();
+    data[42] = std::numeric_limits<float>::infinity();
+
+    auto [result, bytes] = round_trip(data, IO::Compression{0.5f, false});
+
+    EXPECT_TRUE(std::isnan(result[17]));
+    EXPECT_EQ(result[42], std::numeric_limits<float>::infinity());
+    for (size_t i = 43; i < data.size(); i++) ASSERT_EQ(result[i], data[i]);
+}
+
+TEST(CompressionTest, integer_data_and_multiple_blocks) {
+
+    // Larger than a single block, so the data is split across several.
+    auto data = hoNDArray<uint16_t>(3 << 20);
+    std::default_random_engine engine(4242);
+    std::uniform_int_distribution<uint16_t> dist(0, 4095);
+    for (auto &d : data) d = dist(engine);
+
+    auto [result, bytes] = round_trip(data, IO::Compression{0.5f, true});
+    EXPECT_EQ(result, data);
+}
+
+TEST(CompressionTest, small_arrays_uncompressed) {
+
+    auto data = hoNDArray<float>(16);
+    for (auto &d : data) d = 1.0f;
+
+    auto [plain, plain_bytes] = round_trip(data, none);
+    auto [result, bytes] = round_trip(data, IO::Compression{0.5f, true});
+
+    EXPECT_EQ(result, data);
+    EXPECT_EQ(bytes, plain_bytes);
+}
+
+TEST(CompressionTest, negotiation) {
+
+    auto unknown = IO::negotiate_compression("Uknown query", 0.5f);
+    EXPECT_EQ(unknown.tolerance, 0.0f);
+    EXPECT_FALSE(unknown.deflate);
+
+    auto nhlbi = IO::negotiate_compression("nhlbi", 0.5f);
+    EXPECT_EQ(nhlbi.tolerance, 0.5f);
+    EXPECT_FALSE(nhlbi.deflate);
+
+    auto both = IO::negotiate_compression("nhlbi,deflate", 0.5f);
+    EXPECT_EQ(both.deflate, IO::supported_codecs() == "nhlbi,deflate");
+}
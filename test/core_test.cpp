@@ -3,6 +3,7 @@
 #include "Message.h"
 #include "Channel.h"
 #include "Types.h"
+#include "mri_core_data.h"
 
 TEST(TypeTests, multitype) {
     using namespace Gadgetron::Core;
@@ -227,3 +228,53 @@ TEST(TypeTests, tupletype3) {
 }
 
 
+
+TEST(ChannelTests, instrumentation) {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron;
+
+    auto channel = make_channel<MessageChannel>();
+    auto metrics = std::make_shared<NodeMetrics>("node");
+    channel.input.instrument(metrics);
+    channel.output.instrument(metrics);
+
+    channel.output.push(hoNDArray<float>(16, 4));
+    channel.output.push(hoNDArray<float>(16, 4), int(4));
+
+    channel.input.pop();
+    channel.input.pop();
+
+    EXPECT_EQ(metrics->messages_out, 2);
+    EXPECT_EQ(metrics->messages_in, 2);
+    EXPECT_EQ(metrics->bytes_in, 2 * 64 * sizeof(float) + sizeof(int));
+    EXPECT_EQ(metrics->max_queue_depth, 1);
+    EXPECT_EQ(metrics->processing_time.count(), 1);
+}
+
+TEST(ChannelTests, instrumentation_payload_size) {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron;
+
+    auto channel = make_channel<MessageChannel>();
+    auto metrics = std::make_shared<NodeMetrics>("node");
+    channel.output.instrument(metrics);
+
+    IsmrmrdImageArray image_array;
+    image_array.data_ = hoNDArray<std::complex<float>>(32, 32, 4);
+    image_array.headers_ = hoNDArray<ISMRMRD::ImageHeader>(4);
+    image_array.meta_ = std::vector<ISMRMRD::MetaContainer>(4);
+
+    IsmrmrdReconData recon_data;
+    recon_data.rbit_.emplace_back();
+    recon_data.rbit_[0].data_.data_ = hoNDArray<std::complex<float>>(64, 16);
+    recon_data.rbit_[0].ref_ = IsmrmrdDataBuffered{};
+    recon_data.rbit_[0].ref_->data_ = hoNDArray<std::complex<float>>(64, 8);
+
+    channel.output.push(std::move(image_array));
+    channel.output.push(std::move(recon_data));
+    channel.output.push(std::string("text"));
+
+    auto image_array_bytes = 32 * 32 * 4 * sizeof(std::complex<float>) + 4 * sizeof(ISMRMRD::ImageHeader);
+    auto recon_data_bytes = 64 * 24 * sizeof(std::complex<float>);
+    EXPECT_EQ(metrics->bytes_out, image_array_bytes + recon_data_bytes + 4);
+}
@@ -12,6 +12,8 @@
 #include "simplexLagariaSolver.h"
 #include "twoParaExpDecayOperator.h"
 #include "twoParaExpRecoveryOperator.h"
+#include "threeParaExpRecoveryOperator.h"
+#include "curveFittingBatchedLMSolver.h"
 #include "curveFittingCostFunction.h"
 #include "cmr_t1_mapping.h"
 #include <gtest/gtest.h>
@@ -125,6 +127,104 @@ TYPED_TEST(curveFitting_test, T1SR)
     EXPECT_NEAR(b[1], 1122.36963, 0.003);
 }
 
+TYPED_TEST(curveFitting_test, BatchedLM)
+{
+    // T2 decay, same points as T2SE, every lane scaled differently
+    std::vector<TypeParam> te = { 10, 20, 30, 40, 60, 80, 120, 160 };
+    std::vector<TypeParam> s = { 606.248226950355, 598.40425531914, 589.368794326241, 580.815602836879,
+                                 563.170212765957, 545.893617021277, 512.31914893617, 480.723404255319 };
+
+    size_t num = te.size(), lanes = 5, n, l;
+
+    std::vector<TypeParam> y(num*lanes), b(2 * lanes);
+    for (l = 0; l < lanes; l++)
+    {
+        for (n = 0; n < num; n++) y[l + n*lanes] = s[n] * (l + 1);
+        b[l] = y[l];
+        b[l + lanes] = 640;
+    }
+
+    Gadgetron::curveFittingBatchedLMSolver<TypeParam, Gadgetron::twoParaExpDecayModel> t2;
+    t2.solve(&te[0], num, &y[0], lanes, &b[0]);
+
+    for (l = 0; l < lanes; l++)
+    {
+        EXPECT_NEAR(b[l] / (l + 1), 617.257, 0.01);
+        EXPECT_NEAR(b[l + lanes], 644.417, 0.01);
+    }
+
+    // three parameter recovery, noise free
+    std::vector<TypeParam> ti = { 100, 180, 260, 1000, 1100, 1200, 2000, 3000 };
+    num = ti.size();
+
+    std::vector<TypeParam> y3(num*lanes), b3(3 * lanes);
+    for (l = 0; l < lanes; l++)
+    {
+        TypeParam T1 = 800 + 100 * l;
+        for (n = 0; n < num; n++) y3[l + n*lanes] = 300 - 550 * std::exp(-ti[n] / T1);
+
+        b3[l] = 250;
+        b3[l + lanes] = 500;
+        b3[l + 2 * lanes] = 1000;
+    }
+
+    Gadgetron::curveFittingBatchedLMSolver<TypeParam, Gadgetron::threeParaExpRecoveryModel> t1_3p;
+    t1_3p.thres_fun_ = 1e-8;
+    t1_3p.solve(&ti[0], num, &y3[0], lanes, &b3[0]);
+
+    for (l = 0; l < lanes; l++)
+    {
+        EXPECT_NEAR(b3[l], 300, 0.1);
+        EXPECT_NEAR(b3[l + lanes], 550, 0.1);
+        EXPECT_NEAR(b3[l + 2 * lanes], 800 + 100 * l, 0.5);
+    }
+}
+
+TYPED_TEST(curveFitting_test, T1SRMappingBatched)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.fill_holes_in_maps_ = false;
+    t1_sr.compute_SD_maps_ = true;
+    t1_sr.batched_fitting_ = true;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+
+    t1_sr.max_iter_ = 150;
+    t1_sr.thres_fun_ = 1e-4;
+    t1_sr.max_map_value_ = 4000;
+
+    size_t RO = 64;
+    size_t E1 = 48;
+    size_t N = t1_sr.ti_.size();
+
+    std::vector<float> y = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    t1_sr.data_.create(RO, E1, N, 1, 1);
+
+    size_t n;
+    for (n = 0; n < N; n++)
+    {
+        Gadgetron::hoNDArray<float> data2D(RO, E1, &(t1_sr.data_(0, 0, n, 0, 0)));
+        Gadgetron::fill(data2D, y[n]);
+    }
+
+    t1_sr.mask_for_mapping_.create(RO, E1, 1);
+    Gadgetron::fill(t1_sr.mask_for_mapping_, (float)1);
+    t1_sr.mask_for_mapping_(12, 23, 0) = 0;
+
+    t1_sr.perform_parametric_mapping();
+
+    EXPECT_NEAR(t1_sr.para_(0, 0, 0, 0, 0), 471.062894, 0.01);
+    EXPECT_NEAR(t1_sr.map_(0, 0, 0, 0), 1122.36963, 0.01);
+    EXPECT_NEAR(t1_sr.map_(RO - 1, E1 - 1, 0, 0), 1122.36963, 0.01);
+    EXPECT_GT(t1_sr.sd_map_(RO / 2, E1 / 2, 0, 0), 0);
+
+    // background pixels are not fitted
+    EXPECT_EQ(t1_sr.map_(12, 23, 0, 0), 0);
+}
+
 TYPED_TEST(curveFitting_test, T1SRMapping)
 {
     Gadgetron::ImageIOAnalyze gt_exporter_;
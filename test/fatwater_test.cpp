@@ -0,0 +1,216 @@
+#include "gtest/gtest.h"
+#include "fatwater_residuals.h"
+#include "graph_cut.h"
+
+#include <boost/math/constants/constants.hpp>
+#include <random>
+
+using namespace Gadgetron;
+using namespace Gadgetron::FatWater;
+
+namespace {
+    using cMat = arma::Mat<std::complex<float>>;
+    constexpr float PI = boost::math::constants::pi<float>();
+
+    const std::vector<float> echo_times = { 1.2e-3f, 2.0e-3f, 2.8e-3f, 3.6e-3f, 4.4e-3f };
+    const std::vector<float> field_map_strengths = { -150.0f, -40.0f, 0.0f, 75.0f };
+    const std::vector<float> r2stars = { 0.0f, 30.0f, 120.0f };
+
+    // Water and a single peak fat species
+    cMat phi_matrix() {
+        cMat phi(echo_times.size(), 2);
+        for (size_t k = 0; k < echo_times.size(); k++) {
+            phi(k, 0) = 1.0f;
+            phi(k, 1) = std::polar(1.0f, -2 * PI * 420.0f * echo_times[k]);
+        }
+        return phi;
+    }
+
+    // Residual of a single voxel, with the projector built from scratch for the candidate
+    float voxel_residual(const hoNDArray<std::complex<float>> &data, size_t voxel, float fm, float r2star) {
+        const size_t voxels = data.get_size(0) * data.get_size(1) * data.get_size(2);
+        const size_t CHA = data.get_size(3);
+        const size_t N = data.get_size(4);
+        const size_t nte = echo_times.size();
+
+        cMat psi = calculate_psi_matrix(echo_times, phi_matrix(), r2star);
+        arma::Col<std::complex<float>> b_shifts(nte);
+        for (size_t k = 0; k < nte; k++) b_shifts[k] = std::polar(1.0f, 2 * PI * (echo_times[k] - echo_times[0]) * fm);
+        cMat P = arma::diagmat(b_shifts) * (arma::eye<cMat>(nte, nte) - psi * arma::pinv(psi)) *
+                 arma::diagmat(arma::conj(b_shifts));
+
+        float residual = 0;
+        for (size_t cha = 0; cha < CHA; cha++) {
+            for (size_t kn = 0; kn < N; kn++) {
+                arma::Col<std::complex<float>> signal(nte);
+                for (size_t ks = 0; ks < nte; ks++) signal[ks] = data[voxel + voxels * (cha + CHA * (kn + N * ks))];
+                cMat projected = P * signal;
+                for (auto v : projected) residual += std::norm(v);
+            }
+        }
+        return residual;
+    }
+
+    hoNDArray<std::complex<float>> random_signals(size_t X, size_t Y, size_t Z, size_t CHA, size_t N) {
+        std::mt19937 rng(17);
+        std::normal_distribution<float> dist;
+        hoNDArray<std::complex<float>> data(X, Y, Z, CHA, N, echo_times.size());
+        for (auto &d : data) d = std::complex<float>(dist(rng), dist(rng));
+        return data;
+    }
+
+    // Graph cut energy: data term plus lambda weighted squared label differences between x, y and z neighbours
+    float field_map_energy(const hoNDArray<uint16_t> &labels, const hoNDArray<float> &residuals, const hoNDArray<float> &lambda) {
+        const size_t X = labels.get_size(0), Y = labels.get_size(1), Z = labels.get_size(2);
+        float result = 0;
+        auto pair = [&](size_t i, size_t j) {
+            float l = std::max(std::min(lambda[i], lambda[j]), 0.0f);
+            float d = float(labels[i]) - float(labels[j]);
+            return l * d * d;
+        };
+        for (size_t kz = 0; kz < Z; kz++) {
+            for (size_t ky = 0; ky < Y; ky++) {
+                for (size_t kx = 0; kx < X; kx++) {
+                    size_t idx = (kz * Y + ky) * X + kx;
+                    result += residuals(labels[idx], kx, ky, kz);
+                    if (kx + 1 < X) result += pair(idx, idx + 1);
+                    if (ky + 1 < Y) result += pair(idx, idx + X);
+                    if (kz + 1 < Z) result += pair(idx, idx + X * Y);
+                }
+            }
+        }
+        return result;
+    }
+
+    // Random problem with integer residuals and lambdas, proposing a constant step up from the current labels.
+    // The current labels are constant over patches of 2 x 3 voxels, so moving part of the image has a boundary cost.
+    struct FieldMapProblem {
+        hoNDArray<uint16_t> current, proposed;
+        hoNDArray<float> residuals, lambda;
+
+        FieldMapProblem(size_t X, size_t Y, size_t Z, unsigned int seed) : current(X, Y, Z), proposed(X, Y, Z),
+                                                                           residuals(8, X, Y, Z), lambda(X, Y, Z) {
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<int> label(0, 4), residual(0, 60), weight(0, 20);
+            for (auto &r : residuals) r = residual(rng);
+            for (auto &l : lambda) l = weight(rng);
+
+            std::vector<uint16_t> patches(X * Y * Z);
+            for (auto &p : patches) p = label(rng);
+            for (size_t kz = 0; kz < Z; kz++) {
+                for (size_t ky = 0; ky < Y; ky++) {
+                    for (size_t kx = 0; kx < X; kx++) {
+                        size_t idx = (kz * Y + ky) * X + kx;
+                        current[idx] = patches[(kz * Y + ky / 3) * X + kx / 2];
+                        proposed[idx] = current[idx] + 3;
+                    }
+                }
+            }
+        }
+    };
+}
+
+TEST(FatWaterResiduals, block_residuals_match_per_voxel_projectors) {
+
+    auto data = random_signals(5, 4, 3, 2, 2);
+    auto bank = calculate_projection_matrices(echo_times, phi_matrix(), field_map_strengths, r2stars);
+    const size_t voxels = 5 * 4 * 3;
+    const size_t num_projectors = field_map_strengths.size() * r2stars.size();
+
+    std::vector<float> residuals(voxels * num_projectors, -1.0f);
+    calculate_residuals(*bank, data, voxels, [&](size_t first, size_t count, const float *res) {
+        std::copy_n(res, count * num_projectors, residuals.begin() + first * num_projectors);
+    });
+
+    for (size_t v = 0; v < voxels; v++) {
+        for (size_t kf = 0; kf < field_map_strengths.size(); kf++) {
+            for (size_t kr = 0; kr < r2stars.size(); kr++) {
+                float expected = voxel_residual(data, v, field_map_strengths[kf], r2stars[kr]);
+                EXPECT_NEAR(expected, residuals[v * num_projectors + kf * r2stars.size() + kr], 1e-4f * (1 + expected))
+                    << "voxel " << v << ", field map " << kf << ", R2* " << kr;
+            }
+        }
+    }
+}
+
+TEST(FatWaterResiduals, first_slice_only) {
+
+    auto data = random_signals(4, 3, 2, 1, 1);
+    auto bank = calculate_projection_matrices(echo_times, phi_matrix(), { 0.0f }, r2stars);
+    const size_t slice_voxels = 4 * 3;
+
+    std::vector<int> visits(4 * 3 * 2, 0);
+    std::vector<float> residuals(slice_voxels * r2stars.size());
+    calculate_residuals(*bank, data, slice_voxels, [&](size_t first, size_t count, const float *res) {
+        for (size_t v = first; v < first + count; v++) visits[v]++;
+        std::copy_n(res, count * r2stars.size(), residuals.begin() + first * r2stars.size());
+    });
+
+    for (size_t v = 0; v < visits.size(); v++) EXPECT_EQ(visits[v], v < slice_voxels ? 1 : 0) << "voxel " << v;
+    for (size_t v = 0; v < slice_voxels; v++) {
+        for (size_t kr = 0; kr < r2stars.size(); kr++) {
+            float expected = voxel_residual(data, v, 0.0f, r2stars[kr]);
+            EXPECT_NEAR(expected, residuals[v * r2stars.size() + kr], 1e-4f * (1 + expected));
+        }
+    }
+}
+
+TEST(FatWaterResiduals, cached_bank_matches_computed_bank) {
+
+    auto bank = projector_bank(echo_times, phi_matrix(), field_map_strengths, r2stars);
+    auto expected = calculate_projection_matrices(echo_times, phi_matrix(), field_map_strengths, r2stars);
+
+    EXPECT_EQ(bank, projector_bank(echo_times, phi_matrix(), field_map_strengths, r2stars));
+    EXPECT_NE(bank, projector_bank(echo_times, phi_matrix(), field_map_strengths, { 0.0f, 30.0f }));
+
+    ASSERT_EQ(bank->nte, expected->nte);
+    ASSERT_EQ(bank->num_fm, expected->num_fm);
+    ASSERT_EQ(bank->num_r2star, expected->num_r2star);
+    ASSERT_EQ(bank->projectors.n_elem, expected->projectors.n_elem);
+    for (size_t i = 0; i < bank->projectors.n_elem; i++)
+        EXPECT_EQ(expected->projectors[i], bank->projectors[i]) << "element " << i;
+}
+
+TEST(FatWaterGraphCut, single_region_finds_minimum_energy) {
+
+    // 12 voxels, small enough to try every choice between the current and the proposed labels
+    const size_t X = 4, Y = 3;
+    for (unsigned int seed = 0; seed < 5; seed++) {
+        FieldMapProblem problem(X, Y, 1, seed);
+
+        auto result = update_field_map(problem.current, problem.proposed, problem.residuals, problem.lambda, 1);
+
+        float minimum = std::numeric_limits<float>::max();
+        hoNDArray<uint16_t> labels(X, Y, 1);
+        for (size_t choice = 0; choice < (size_t(1) << (X * Y)); choice++) {
+            for (size_t i = 0; i < X * Y; i++)
+                labels[i] = (choice >> i) & 1 ? problem.proposed[i] : problem.current[i];
+            minimum = std::min(minimum, field_map_energy(labels, problem.residuals, problem.lambda));
+        }
+
+        EXPECT_EQ(minimum, field_map_energy(result, problem.residuals, problem.lambda)) << "seed " << seed;
+    }
+}
+
+TEST(FatWaterGraphCut, regions_never_raise_energy) {
+
+    for (size_t Z : { 1, 2 }) {
+        for (unsigned int seed = 0; seed < 20; seed++) {
+            FieldMapProblem problem(6, 12, Z, seed);
+            float initial = field_map_energy(problem.current, problem.residuals, problem.lambda);
+            float global = field_map_energy(update_field_map(problem.current, problem.proposed, problem.residuals,
+                                                   problem.lambda, 1), problem.residuals, problem.lambda);
+
+            for (unsigned int regions : { 2, 3, 6 }) {
+                auto result = update_field_map(problem.current, problem.proposed, problem.residuals, problem.lambda,
+                                               regions);
+                for (size_t i = 0; i < result.get_number_of_elements(); i++)
+                    ASSERT_TRUE(result[i] == problem.current[i] || result[i] == problem.proposed[i]);
+
+                float e = field_map_energy(result, problem.residuals, problem.lambda);
+                EXPECT_LE(e, initial) << "Z " << Z << ", seed " << seed << ", regions " << regions;
+                EXPECT_GE(e, global) << "Z " << Z << ", seed " << seed << ", regions " << regions;
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include "GenericReconCartesianGrappaGadget.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    using Cache = GenericReconCartesianGrappaCalibCache;
+
+    Cache::ReconObjType make_recon_obj(unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<float> dist;
+
+        Cache::ReconObjType obj;
+        obj.ref_calib_.create(32, 24, 1, 8);
+        obj.ref_calib_dst_.create(32, 24, 1, 8);
+        obj.coil_map_.create(64, 64, 1, 8);
+        for (auto &v : obj.ref_calib_) v = { dist(engine), dist(engine) };
+        for (auto &v : obj.ref_calib_dst_) v = { dist(engine), dist(engine) };
+        for (auto &v : obj.coil_map_) v = { dist(engine), dist(engine) };
+
+        obj.kernel_.create(5, 7, 8, 8);
+        obj.kernelIm_.create(64, 64, 8, 8);
+        obj.unmixing_coeff_.create(64, 64, 8);
+        obj.gfactor_.create(64, 64);
+        for (auto &v : obj.kernel_) v = { dist(engine), dist(engine) };
+        for (auto &v : obj.unmixing_coeff_) v = { dist(engine), dist(engine) };
+        for (auto &v : obj.gfactor_) v = dist(engine);
+        return obj;
+    }
+
+    const std::vector<double> params = { 64, 64, 1, 0, 4, 1, 5, 4, 4, 0.0005, 0.45, 0 };
+
+    Cache::Key key_of(const Cache::ReconObjType &obj) {
+        return Cache::key(params, obj);
+    }
+}
+
+TEST(GrappaCalibCacheTest, restores_stored_calibration) {
+
+    Cache cache(size_t(64) << 20);
+    auto calibrated = make_recon_obj(1);
+    cache.store(key_of(calibrated), calibrated);
+
+    // Only the calibration results are kept, not the reference data or coil maps they were computed from.
+    EXPECT_EQ(cache.bytes(), calibrated.kernel_.get_number_of_bytes() + calibrated.kernelIm_.get_number_of_bytes()
+                             + calibrated.unmixing_coeff_.get_number_of_bytes() + calibrated.gfactor_.get_number_of_bytes());
+
+    Cache::ReconObjType next;
+    next.ref_calib_ = calibrated.ref_calib_;
+    next.ref_calib_dst_ = calibrated.ref_calib_dst_;
+    next.coil_map_ = calibrated.coil_map_;
+
+    ASSERT_TRUE(cache.restore(key_of(next), next));
+    EXPECT_EQ(next.kernel_, calibrated.kernel_);
+    EXPECT_EQ(next.kernelIm_, calibrated.kernelIm_);
+    EXPECT_EQ(next.unmixing_coeff_, calibrated.unmixing_coeff_);
+    EXPECT_EQ(next.gfactor_, calibrated.gfactor_);
+    EXPECT_EQ(cache.hits_, 1u);
+}
+
+TEST(GrappaCalibCacheTest, changed_reference_misses) {
+
+    Cache cache(size_t(64) << 20);
+    auto calibrated = make_recon_obj(1);
+    cache.store(key_of(calibrated), calibrated);
+
+    auto changed = calibrated;
+    changed.ref_calib_(3, 4, 0, 5) += std::complex<float>(1e-3f, 0);
+    EXPECT_NE(key_of(changed).hash, key_of(calibrated).hash);
+    EXPECT_NE(key_of(changed).check, key_of(calibrated).check);
+    EXPECT_FALSE(cache.restore(key_of(changed), changed));
+
+    // Even a colliding hash does not return the calibration of different reference data.
+    EXPECT_FALSE(cache.restore({ key_of(calibrated).hash, key_of(changed).check }, changed));
+    EXPECT_EQ(cache.misses_, 2u);
+}
+
+TEST(GrappaCalibCacheTest, changed_parameters_or_coil_map_miss) {
+
+    Cache cache(size_t(64) << 20);
+    auto calibrated = make_recon_obj(1);
+    cache.store(key_of(calibrated), calibrated);
+
+    auto other_params = params;
+    other_params[4] = 2;
+    auto probe = calibrated;
+    auto other_key = Cache::key(other_params, probe);
+    EXPECT_NE(other_key.hash, key_of(calibrated).hash);
+    EXPECT_NE(other_key.check, key_of(calibrated).check);
+    EXPECT_FALSE(cache.restore(other_key, probe));
+
+    auto changed = calibrated;
+    changed.coil_map_(7, 9, 0, 2) *= 2.0f;
+    EXPECT_NE(key_of(changed).hash, key_of(calibrated).hash);
+    EXPECT_NE(key_of(changed).check, key_of(calibrated).check);
+    EXPECT_FALSE(cache.restore(key_of(changed), changed));
+
+    // Colliding hashes do not return the calibration either; the check of every input must match too.
+    EXPECT_FALSE(cache.restore({ key_of(calibrated).hash, other_key.check }, probe));
+    EXPECT_FALSE(cache.restore({ key_of(calibrated).hash, key_of(changed).check }, changed));
+    EXPECT_EQ(cache.misses_, 4u);
+    EXPECT_EQ(cache.hits_, 0u);
+}
+
+TEST(GrappaCalibCacheTest, least_recently_used_evicted) {
+
+    auto a = make_recon_obj(1), b = make_recon_obj(2), c = make_recon_obj(3);
+
+    Cache sizing;
+    sizing.max_bytes_ = size_t(1) << 30;
+    sizing.store(key_of(a), a);
+    auto entry_bytes = sizing.bytes();
+
+    Cache cache(2 * entry_bytes);
+    cache.store(key_of(a), a);
+    cache.store(key_of(b), b);
+
+    auto restored = a;
+    ASSERT_TRUE(cache.restore(key_of(a), restored));
+
+    cache.store(key_of(c), c);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_LE(cache.bytes(), 2 * entry_bytes);
+
+    auto probe = b;
+    EXPECT_FALSE(cache.restore(key_of(b), probe));
+    probe = a;
+    EXPECT_TRUE(cache.restore(key_of(a), probe));
+    probe = c;
+    EXPECT_TRUE(cache.restore(key_of(c), probe));
+}
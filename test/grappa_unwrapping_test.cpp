@@ -0,0 +1,80 @@
+#include "mri_core_grappa.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    template <class T> hoNDArray<T> random_array(const std::vector<size_t>& dims, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<typename realType<T>::Type> dist;
+
+        hoNDArray<T> array(dims);
+        for (auto& v : array) v = T(dist(engine), dist(engine));
+        return array;
+    }
+
+    template <class T> typename realType<T>::Type relative_difference(const hoNDArray<T>& expected, const hoNDArray<T>& actual) {
+        hoNDArray<T> diff(expected);
+        Gadgetron::subtract(expected, actual, diff);
+        return Gadgetron::nrm2(diff) / Gadgetron::nrm2(expected);
+    }
+}
+
+template <typename T> class grappa_unwrapping_test : public ::testing::Test {};
+
+typedef ::testing::Types<std::complex<float>, std::complex<double>> cpfloatImplementations;
+TYPED_TEST_CASE(grappa_unwrapping_test, cpfloatImplementations);
+
+TYPED_TEST(grappa_unwrapping_test, unwrapping_2d_matches_elementwise) {
+
+    // Odd sizes leave a partial pixel tile; both the direct (N<4) and the gemm path are covered.
+    for (size_t N : {1, 3, 4, 9}) {
+        auto kerIm = random_array<TypeParam>({37, 29, 6, 5}, 1);
+        auto aliasedIm = random_array<TypeParam>({37, 29, 6, N}, 2);
+
+        hoNDArray<TypeParam> expected, actual;
+        grappa2d_image_domain_unwrapping_aliased_image_elementwise(aliasedIm, kerIm, expected);
+        grappa2d_image_domain_unwrapping_aliased_image(aliasedIm, kerIm, actual);
+
+        ASSERT_EQ(actual.dimensions(), expected.dimensions());
+        EXPECT_LT(relative_difference(expected, actual), 1e-5) << "N = " << N;
+    }
+}
+
+TYPED_TEST(grappa_unwrapping_test, unwrapping_3d_matches_elementwise) {
+
+    auto convKer = random_array<TypeParam>({5, 5, 5, 4, 3}, 3);
+    auto aliasedIm = random_array<TypeParam>({24, 20, 12, 4, 5}, 4);
+
+    hoNDArray<TypeParam> expected, actual;
+    grappa3d_image_domain_unwrapping_aliasedImage_elementwise(convKer, aliasedIm, 2, 2, expected);
+    grappa3d_image_domain_unwrapping_aliasedImage(convKer, aliasedIm, 2, 2, actual);
+
+    ASSERT_EQ(actual.get_size(3), 3u);
+    ASSERT_EQ(actual.dimensions(), expected.dimensions());
+    EXPECT_LT(relative_difference(expected, actual), 1e-5);
+}
+
+TYPED_TEST(grappa_unwrapping_test, unwrapping_3d_slabs_match_elementwise) {
+
+    // Odd E2 and even kE2; the memory caps give single slice slabs of one dst channel, a few slices with a partial
+    // last slab, and all channels at once.
+    auto convKer = random_array<TypeParam>({5, 5, 4, 4, 3}, 5);
+    auto aliasedIm = random_array<TypeParam>({16, 14, 11, 4, 2}, 6);
+
+    hoNDArray<TypeParam> expected;
+    grappa3d_image_domain_unwrapping_aliasedImage_elementwise(convKer, aliasedIm, 2, 2, expected);
+
+    size_t planeBytes = 16 * 14 * 4 * sizeof(TypeParam);
+    for (size_t maxKernelBytes : {size_t(0), 8 * planeBytes, 3 * (4 + 3) * planeBytes, size_t(1) << 30}) {
+        hoNDArray<TypeParam> actual;
+        grappa3d_image_domain_unwrapping_aliasedImage(convKer, aliasedIm, 2, 2, actual, maxKernelBytes);
+
+        ASSERT_EQ(actual.dimensions(), expected.dimensions());
+        EXPECT_LT(relative_difference(expected, actual), 1e-5) << "maxKernelBytes = " << maxKernelBytes;
+    }
+}
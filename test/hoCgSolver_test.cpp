@@ -0,0 +1,141 @@
+#include "hoCgSolver.h"
+#include "hoCgPreconditioner.h"
+#include "diagonalOperator.h"
+#include "identityOperator.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+    template <class T> boost::shared_ptr<hoNDArray<T>> random_array(std::vector<size_t> dims, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<typename realType<T>::Type> dist;
+        auto x = boost::make_shared<hoNDArray<T>>(dims);
+        for (auto& v : *x) {
+            if constexpr (std::is_arithmetic<T>::value) v = dist(engine);
+            else v = T(dist(engine), dist(engine));
+        }
+        return x;
+    }
+}
+
+template <typename T> class hoCgSolver_test : public ::testing::Test {
+protected:
+    typedef typename realType<T>::Type REAL;
+
+    virtual void SetUp() {
+        dims = { 48, 40 };
+
+        // A diagonal encoding with a condition number of about 1e3, plus a weighted identity regularization.
+        auto diagonal = boost::make_shared<hoNDArray<T>>(dims);
+        for (size_t n = 0; n < diagonal->size(); n++) (*diagonal)[n] = T(REAL(1) + REAL(30) * REAL(n % 97) / REAL(96));
+
+        encoding = boost::make_shared<diagonalOperator<hoNDArray<T>>>();
+        encoding->set_diagonal(diagonal);
+        encoding->set_domain_dimensions(&dims);
+        encoding->set_codomain_dimensions(&dims);
+
+        regularization = boost::make_shared<identityOperator<hoNDArray<T>>>();
+        regularization->set_domain_dimensions(&dims);
+        regularization->set_codomain_dimensions(&dims);
+        regularization->set_weight(REAL(0.01));
+
+        data = random_array<T>(dims, 1);
+    }
+
+    void configure(hoCgSolver<T>& solver) {
+        solver.set_encoding_operator(encoding);
+        solver.add_regularization_operator(regularization);
+        solver.set_max_iterations(200);
+        solver.set_tc_tolerance(REAL(1e-10));
+    }
+
+    void expect_near(const hoNDArray<T>& expected, const hoNDArray<T>& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t n = 0; n < expected.size(); n++) {
+            EXPECT_NEAR(real(expected[n]), real(actual[n]), 1e-3);
+            EXPECT_NEAR(imag(expected[n]), imag(actual[n]), 1e-3);
+        }
+    }
+
+    std::vector<size_t> dims;
+    boost::shared_ptr<diagonalOperator<hoNDArray<T>>> encoding;
+    boost::shared_ptr<identityOperator<hoNDArray<T>>> regularization;
+    boost::shared_ptr<hoNDArray<T>> data;
+};
+
+typedef Types<float, double, std::complex<float>, float_complext> Implementations;
+
+TYPED_TEST_CASE(hoCgSolver_test, Implementations);
+
+TYPED_TEST(hoCgSolver_test, converges) {
+    typedef typename realType<TypeParam>::Type REAL;
+
+    hoCgSolver<TypeParam> solver;
+    this->configure(solver);
+    auto x = solver.solve(this->data.get());
+
+    // The solution of (D^H D + 0.01 I) x = D^H d for the diagonal D.
+    auto diagonal = this->encoding->get_diagonal();
+    hoNDArray<TypeParam> expected(this->dims);
+    for (size_t n = 0; n < expected.size(); n++) {
+        REAL d = real((*diagonal)[n]);
+        expected[n] = (*this->data)[n] * TypeParam(d / (d * d + REAL(0.01)));
+    }
+    this->expect_near(expected, *x);
+}
+
+TYPED_TEST(hoCgSolver_test, pipelined_matches_standard) {
+    hoCgSolver<TypeParam> standard, pipelined;
+    this->configure(standard);
+    this->configure(pipelined);
+    pipelined.set_pipelined(true);
+
+    this->expect_near(*standard.solve(this->data.get()), *pipelined.solve(this->data.get()));
+}
+
+TYPED_TEST(hoCgSolver_test, pipelined_with_preconditioner) {
+    typedef typename realType<TypeParam>::Type REAL;
+
+    // Jacobi preconditioner; the solver applies it twice, so the weights are the square root of the inverse diagonal.
+    auto diagonal = this->encoding->get_diagonal();
+    auto weights = boost::make_shared<hoNDArray<TypeParam>>(this->dims);
+    for (size_t n = 0; n < weights->size(); n++) {
+        REAL d = real((*diagonal)[n]);
+        (*weights)[n] = TypeParam(REAL(1) / std::sqrt(d * d + REAL(0.01)));
+    }
+    auto precond = boost::make_shared<hoCgPreconditioner<TypeParam>>();
+    precond->set_weights(weights);
+
+    hoCgSolver<TypeParam> standard, pipelined;
+    this->configure(standard);
+    this->configure(pipelined);
+    standard.set_preconditioner(precond);
+    pipelined.set_preconditioner(precond);
+    pipelined.set_pipelined(true);
+
+    this->expect_near(*standard.solve(this->data.get()), *pipelined.solve(this->data.get()));
+}
+
+TYPED_TEST(hoCgSolver_test, reused_workspace) {
+    hoCgSolver<TypeParam> reused, fresh;
+    this->configure(reused);
+    this->configure(fresh);
+    fresh.set_reuse_workspace(false);
+    EXPECT_TRUE(reused.get_reuse_workspace());
+
+    // The first solution must not be overwritten by the second solve, and a change of size reallocates.
+    auto first = reused.solve(this->data.get());
+    auto first_copy = *first;
+    auto other = random_array<TypeParam>(this->dims, 2);
+    auto second = reused.solve(other.get());
+    this->expect_near(first_copy, *first);
+    this->expect_near(*fresh.solve(other.get()), *second);
+
+    reused.set_pipelined(true);
+    this->expect_near(*fresh.solve(this->data.get()), *reused.solve(this->data.get()));
+}
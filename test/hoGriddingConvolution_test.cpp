@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "complext.h"
+#include "hoGriddingConvolution.h"
+
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    // Trajectory of one frame with num samples, normalized to [-0.5, 0.5].
+    template <unsigned int D> hoNDArray<vector_td<float, D>> random_trajectory(size_t num, size_t frames, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+
+        hoNDArray<vector_td<float, D>> trajectory(num, frames);
+        for (auto& point : trajectory)
+            for (unsigned int d = 0; d < D; d++) point[d] = dist(engine);
+        return trajectory;
+    }
+
+    hoNDArray<float_complext> random_samples(std::vector<size_t> dims, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<float> dist;
+
+        hoNDArray<float_complext> data(dims);
+        for (auto& v : data) v = float_complext(dist(engine), dist(engine));
+        return data;
+    }
+
+    float_complext inner_product(const hoNDArray<float_complext>& x, const hoNDArray<float_complext>& y) {
+        complext<double> sum(0, 0);
+        for (size_t n = 0; n < x.size(); n++) sum += complext<double>(conj(x[n]) * y[n]);
+        return float_complext(sum);
+    }
+
+    KaiserKernel<float, 2> make_kernel(vector_td<size_t, 2> matrix_size, vector_td<size_t, 2> matrix_size_os, float width) {
+        return KaiserKernel<float, 2>(vector_td<unsigned int, 2>(matrix_size), vector_td<unsigned int, 2>(matrix_size_os), width);
+    }
+}
+
+TEST(hoGriddingConvolution, matches_direct_convolution) {
+    vector_td<size_t, 2> matrix_size(32, 24), matrix_size_os(64, 48);
+    auto kernel = make_kernel(matrix_size, matrix_size_os, 5.5f);
+    hoGriddingConvolution<float_complext, 2, KaiserKernel> conv(matrix_size, matrix_size_os, kernel);
+
+    auto trajectory = random_trajectory<2>(200, 1, 1);
+    conv.preprocess(trajectory);
+
+    auto image = random_samples({ 64, 48 }, 2);
+    hoNDArray<float_complext> samples(200);
+    conv.compute(image, samples, GriddingConvolutionMode::C2NC);
+
+    float radius = kernel.get_radius();
+    for (size_t i = 0; i < trajectory.size(); i++) {
+        float px = (trajectory[i][0] + 0.5f) * 64, py = (trajectory[i][1] + 0.5f) * 48;
+
+        // The kernel is not normalised, so the tolerance is relative to the magnitude of the terms.
+        complext<double> expected(0, 0);
+        double scale = 0;
+        for (int y = int(std::ceil(py - radius)); y <= int(std::floor(py + radius)); y++) {
+            for (int x = int(std::ceil(px - radius)); x <= int(std::floor(px + radius)); x++) {
+                float weight = kernel.get(vector_td<float, 2>(std::abs(x - px), std::abs(y - py)));
+                auto term = complext<double>(image[((x + 64) % 64) + 64 * ((y + 48) % 48)] * weight);
+                expected += term;
+                scale += abs(term);
+            }
+        }
+
+        EXPECT_NEAR(expected.real(), samples[i].real(), 1e-5 * scale);
+        EXPECT_NEAR(expected.imag(), samples[i].imag(), 1e-5 * scale);
+    }
+}
+
+TEST(hoGriddingConvolution, adjoint) {
+    vector_td<size_t, 2> matrix_size(64, 64), matrix_size_os(96, 96);
+    hoGriddingConvolution<float_complext, 2, KaiserKernel> conv(matrix_size, matrix_size_os,
+                                                                 make_kernel(matrix_size, matrix_size_os, 4.0f));
+
+    // Two frames and two batches, so the frames are cycled over the batches.
+    conv.preprocess(random_trajectory<2>(1000, 2, 3));
+
+    auto image = random_samples({ 96, 96, 2, 2 }, 4);
+    auto samples = random_samples({ 1000, 2, 2 }, 5);
+
+    hoNDArray<float_complext> forward(samples.dimensions()), backward(image.dimensions());
+    conv.compute(image, forward, GriddingConvolutionMode::C2NC);
+    conv.compute(samples, backward, GriddingConvolutionMode::NC2C);
+
+    auto lhs = inner_product(samples, forward);
+    auto rhs = inner_product(backward, image);
+    EXPECT_NEAR(lhs.real(), rhs.real(), 1e-3 * abs(lhs));
+    EXPECT_NEAR(lhs.imag(), rhs.imag(), 1e-3 * abs(lhs));
+
+    // Accumulating adds the convolution to the output.
+    auto accumulated = backward;
+    conv.compute(samples, accumulated, GriddingConvolutionMode::NC2C, true);
+    for (size_t n = 0; n < backward.size(); n++) {
+        EXPECT_FLOAT_EQ(2 * backward[n].real(), accumulated[n].real());
+        EXPECT_FLOAT_EQ(2 * backward[n].imag(), accumulated[n].imag());
+    }
+}
+
+TEST(hoGriddingConvolution, cached_preprocessing) {
+    vector_td<size_t, 2> matrix_size(48, 48), matrix_size_os(72, 72);
+    auto kernel = make_kernel(matrix_size, matrix_size_os, 5.5f);
+    auto trajectory = random_trajectory<2>(2000, 1, 6);
+    auto image = random_samples({ 72, 72 }, 7);
+
+    hoGriddingConvolution<float_complext, 2, KaiserKernel> first(matrix_size, matrix_size_os, kernel);
+    first.preprocess(trajectory, GriddingConvolutionPrepMode::C2NC);
+    EXPECT_FALSE(first.get_timings().preprocess_cached);
+
+    // Needs the transposed matrices, which the first preprocessing did not build.
+    hoGriddingConvolution<float_complext, 2, KaiserKernel> second(matrix_size, matrix_size_os, kernel);
+    second.preprocess(trajectory);
+    EXPECT_FALSE(second.get_timings().preprocess_cached);
+
+    // A new object with the same trajectory, as for the next frame of a real-time protocol.
+    hoGriddingConvolution<float_complext, 2, KaiserKernel> third(matrix_size, matrix_size_os, kernel);
+    third.preprocess(trajectory);
+    EXPECT_TRUE(third.get_timings().preprocess_cached);
+
+    hoNDArray<float_complext> expected(2000), actual(2000);
+    first.compute(image, expected, GriddingConvolutionMode::C2NC);
+    third.compute(image, actual, GriddingConvolutionMode::C2NC);
+    for (size_t n = 0; n < expected.size(); n++) {
+        EXPECT_EQ(expected[n].real(), actual[n].real());
+        EXPECT_EQ(expected[n].imag(), actual[n].imag());
+    }
+
+    EXPECT_EQ(third.get_timings().apply_count, 1u);
+    EXPECT_GT(third.get_timings().apply_seconds, 0.0);
+
+    // A different trajectory or kernel must not reuse the matrices.
+    trajectory[0][0] = 0.25f;
+    third.preprocess(trajectory);
+    EXPECT_FALSE(third.get_timings().preprocess_cached);
+
+    hoGriddingConvolution<float_complext, 2, KaiserKernel> wider(matrix_size, matrix_size_os,
+                                                                  make_kernel(matrix_size, matrix_size_os, 7.5f));
+    wider.preprocess(trajectory);
+    EXPECT_FALSE(wider.get_timings().preprocess_cached);
+}
@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "hoImageRegContainer2DRegistration.h"
+#include "synthetic_molli_series.h"
+
+#include <cmath>
+
+using namespace Gadgetron;
+
+namespace {
+    typedef hoNDImage<float, 2> ImageType;
+    typedef hoImageRegContainer2DRegistration<ImageType, ImageType, double> RegistrationType;
+
+    double relative_difference(const hoNDImage<double, 2>& expected, const hoNDImage<double, 2>& actual) {
+        const double* e = expected.begin();
+        const double* a = actual.begin();
+
+        double diff = 0, norm = 0;
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++) {
+            diff += (e[i] - a[i]) * (e[i] - a[i]);
+            norm += e[i] * e[i];
+        }
+        return std::sqrt(diff / std::max(norm, 1e-12));
+    }
+}
+
+TEST(hoImageRegContainer2DRegistration, fixed_reference_matches_pairwise) {
+
+    // The container shares the pyramid of each reference frame between the registrations against it; every frame must
+    // still end up where registering it on its own puts it.
+    std::vector<size_t> cols = { 5, 4 };
+    std::vector<unsigned int> referenceFrame = { 4, 1 };
+    auto container = synthetic_molli_series(48, 40, cols);
+
+    RegistrationType reg(3, false, -1);
+    ASSERT_TRUE(reg.registerOverContainer2DFixedReference(container, referenceFrame, true, false));
+
+    RegistrationType pairwise(3, false, -1);
+    for (size_t r = 0; r < cols.size(); r++) {
+        for (size_t n = 0; n < cols[r]; n++) {
+            ImageType warped;
+            hoNDImage<double, 2> dx, dy;
+            hoNDImage<double, 2>* deform[2] = { &dx, &dy };
+            ASSERT_TRUE(pairwise.registerTwoImagesDeformationField(container(r, referenceFrame[r]), container(r, n), false, &warped, deform));
+
+            if (n == referenceFrame[r]) {
+                // The reference is copied rather than registered to itself.
+                EXPECT_LT(std::abs(reg.deformation_field_[0](r, n)(24, 20)), 1e-12);
+                continue;
+            }
+
+            EXPECT_LT(relative_difference(dx, reg.deformation_field_[0](r, n)), 1e-4) << "row " << r << ", frame " << n;
+            EXPECT_LT(relative_difference(dy, reg.deformation_field_[1](r, n)), 1e-4) << "row " << r << ", frame " << n;
+
+            const ImageType& containerWarped = reg.warped_container_(r, n);
+            for (size_t i = 0; i < warped.get_number_of_elements(); i++) {
+                ASSERT_NEAR(warped.begin()[i], containerWarped.begin()[i], 1e-3f) << "row " << r << ", frame " << n << ", pixel " << i;
+            }
+        }
+    }
+}
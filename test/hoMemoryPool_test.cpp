@@ -0,0 +1,159 @@
+#include "hoMemoryPool.h"
+#include "hoNDArray.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron;
+
+TEST(hoMemoryPool, size_classes) {
+
+    EXPECT_EQ(hoMemoryPool::size_class(1), 64);
+    EXPECT_EQ(hoMemoryPool::size_class(64), 64);
+    EXPECT_EQ(hoMemoryPool::size_class(65), 80);
+    EXPECT_EQ(hoMemoryPool::size_class(128), 128);
+    EXPECT_EQ(hoMemoryPool::size_class(129), 160);
+
+    for (size_t bytes = 1; bytes < (size_t(1) << 24); bytes = bytes * 3 / 2 + 1) {
+        auto size = hoMemoryPool::size_class(bytes);
+        EXPECT_GE(size, bytes);
+        EXPECT_LE(size, std::max<size_t>(64, bytes + bytes / 4));
+    }
+}
+
+TEST(hoMemoryPool, reuse) {
+
+    hoMemoryPool pool;
+
+    auto first = pool.allocate(1000);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % pool.alignment(), 0);
+    EXPECT_TRUE(pool.deallocate(first));
+
+    auto second = pool.allocate(1010);
+    EXPECT_EQ(first, second);
+    EXPECT_TRUE(pool.deallocate(second));
+
+    auto stats = pool.statistics();
+    EXPECT_EQ(stats.allocations, 2);
+    EXPECT_EQ(stats.pool_hits, 1);
+    EXPECT_EQ(stats.bytes_in_use, 0);
+    EXPECT_EQ(stats.peak_bytes_in_use, hoMemoryPool::size_class(1000));
+    EXPECT_EQ(stats.bytes_cached, hoMemoryPool::size_class(1000));
+
+    pool.trim();
+    EXPECT_EQ(pool.statistics().bytes_cached, 0);
+}
+
+TEST(hoMemoryPool, foreign_pointer) {
+
+    hoMemoryPool pool;
+    auto foreign = new float[16];
+    EXPECT_FALSE(pool.deallocate(foreign));
+    delete[] foreign;
+}
+
+TEST(hoMemoryPool, huge_pages) {
+
+    hoMemoryPool pool;
+    auto ptr = pool.allocate(size_t(5) << 20);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % (size_t(2) << 20), 0);
+    EXPECT_TRUE(pool.deallocate(ptr));
+}
+
+TEST(hoMemoryPool, cross_thread_release) {
+
+    hoMemoryPool::Options options;
+    options.thread_cache_bytes = 0;
+    hoMemoryPool pool(options);
+
+    auto ptr = pool.allocate(4096);
+    std::thread([&]() { EXPECT_TRUE(pool.deallocate(ptr)); }).join();
+
+    // With no thread cache the block goes straight to the shared cache, where any thread can reuse it.
+    EXPECT_EQ(pool.allocate(4096), ptr);
+    EXPECT_TRUE(pool.deallocate(ptr));
+}
+
+TEST(hoMemoryPool, accounting) {
+
+    hoMemoryPool pool;
+    auto account = std::make_shared<hoMemoryAccount>();
+
+    void* accounted;
+    {
+        hoMemoryAccount::Scope scope(account);
+        accounted = pool.allocate(1 << 16);
+    }
+    auto unaccounted = pool.allocate(1 << 16);
+
+    EXPECT_EQ(account->statistics().allocations, 1);
+    EXPECT_EQ(account->statistics().bytes_in_use, 1 << 16);
+
+    pool.deallocate(accounted);
+    pool.deallocate(unaccounted);
+
+    EXPECT_EQ(account->statistics().bytes_in_use, 0);
+    EXPECT_EQ(account->statistics().peak_bytes_in_use, 1 << 16);
+    EXPECT_EQ(hoMemoryAccount::current(), nullptr);
+}
+
+TEST(hoMemoryPool, process_account) {
+
+    hoMemoryPool pool;
+    auto process = std::make_shared<hoMemoryAccount>();
+    auto own = std::make_shared<hoMemoryAccount>();
+    hoMemoryAccount::set_process(process);
+
+    // A thread started without an account, as OpenMP starts its threads, charges the process account.
+    void* from_thread;
+    std::thread([&]() { from_thread = pool.allocate(1 << 16); }).join();
+
+    void* from_scope;
+    {
+        hoMemoryAccount::Scope scope(own);
+        from_scope = pool.allocate(1 << 12);
+    }
+
+    EXPECT_EQ(process->statistics().allocations, 1);
+    EXPECT_EQ(process->statistics().bytes_in_use, 1 << 16);
+    EXPECT_EQ(own->statistics().allocations, 1);
+    EXPECT_EQ(own->statistics().bytes_in_use, 1 << 12);
+
+    pool.deallocate(from_thread);
+    pool.deallocate(from_scope);
+    EXPECT_EQ(process->statistics().bytes_in_use, 0);
+
+    hoMemoryAccount::set_process(nullptr);
+    EXPECT_EQ(hoMemoryAccount::current(), nullptr);
+}
+
+TEST(hoMemoryPool, hoNDArray) {
+
+    auto pool = std::make_shared<hoMemoryPool>();
+    hoNDArrayAllocator::set(pool);
+
+    {
+        hoNDArray<std::complex<float>> array(128, 64, 8);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(array.data()) % pool->alignment(), 0);
+        for (auto& value : array) EXPECT_EQ(value, std::complex<float>(0));
+
+        // Memory handed over from outside is still released with delete[].
+        hoNDArray<float> adopted;
+        adopted.create(std::vector<size_t>{ 16 }, new float[16], true);
+
+        hoNDArray<std::complex<float>> moved = std::move(array);
+        hoNDArray<std::complex<float>> copied = moved;
+        EXPECT_EQ(pool->statistics().bytes_in_use, 2 * hoMemoryPool::size_class(moved.get_number_of_bytes()));
+    }
+
+    {
+        hoNDArray<std::complex<float>> array(128, 64, 8);
+        EXPECT_EQ(pool->statistics().pool_hits, 1);
+    }
+
+    hoNDArrayAllocator::set(nullptr);
+    EXPECT_EQ(pool->statistics().bytes_in_use, 0);
+}
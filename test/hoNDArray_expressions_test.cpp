@@ -0,0 +1,142 @@
+#include "hoNDArray_expressions.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+#include "hoCgSolver.h"
+#include "identityOperator.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Expressions;
+using testing::Types;
+
+namespace {
+    template <class T> void fill_random(hoNDArray<T>& x, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<typename realType<T>::Type> dist;
+        for (auto& v : x) {
+            if constexpr (std::is_arithmetic<T>::value) v = dist(engine);
+            else v = T(dist(engine), dist(engine));
+        }
+    }
+
+    template <class T> void expect_near(T expected, T actual) {
+        EXPECT_NEAR(real(expected), real(actual), 1e-4);
+        EXPECT_NEAR(imag(expected), imag(actual), 1e-4);
+    }
+}
+
+template <typename T> class hoNDArray_expressions_test : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        // Large enough to be evaluated in parallel.
+        x.create(300, 400);
+        y.create(300, 400);
+        fill_random(x, 1);
+        fill_random(y, 2);
+    }
+
+    hoNDArray<T> x, y;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>, float_complext> Implementations;
+
+TYPED_TEST_CASE(hoNDArray_expressions_test, Implementations);
+
+TYPED_TEST(hoNDArray_expressions_test, linear_combination) {
+    TypeParam a = TypeParam(2), b = TypeParam(-0.5);
+    hoNDArray<TypeParam> r;
+    evaluate(a * lazy(this->x) + b * lazy(this->y) - lazy(this->x) / TypeParam(4), r);
+
+    EXPECT_EQ(r.dimensions(), this->x.dimensions());
+    for (size_t n = 0; n < r.size(); n++)
+        expect_near(TypeParam(a * this->x[n] + b * this->y[n] - this->x[n] / TypeParam(4)), r[n]);
+}
+
+TYPED_TEST(hoNDArray_expressions_test, in_place) {
+    auto expected = this->y;
+    expected *= TypeParam(3);
+    expected += this->x;
+
+    evaluate(lazy(this->x) + TypeParam(3) * lazy(this->y), this->y);
+    for (size_t n = 0; n < expected.size(); n++) expect_near(expected[n], this->y[n]);
+}
+
+TYPED_TEST(hoNDArray_expressions_test, abs_and_conj) {
+    typedef typename realType<TypeParam>::Type REAL;
+
+    hoNDArray<REAL> mask(this->x.dimensions()), magnitude;
+    for (size_t n = 0; n < mask.size(); n++) mask[n] = REAL(n % 2);
+
+    evaluate(abs(lazy(this->x)) * lazy(mask), magnitude);
+    for (size_t n = 0; n < mask.size(); n++) EXPECT_NEAR(abs(this->x[n]) * mask[n], magnitude[n], 1e-4);
+
+    hoNDArray<TypeParam> c;
+    evaluate(-conj(lazy(this->x)), c);
+    for (size_t n = 0; n < c.size(); n++) expect_near(TypeParam(-conj(this->x[n])), c[n]);
+}
+
+TYPED_TEST(hoNDArray_expressions_test, reductions) {
+    auto xy = sum(conj(lazy(this->x)) * lazy(this->y));
+    auto expected = dot(&this->x, &this->y);
+    EXPECT_NEAR(real(expected), real(xy), 1e-2);
+    EXPECT_NEAR(imag(expected), imag(xy), 1e-2);
+
+    hoNDArray<TypeParam> r;
+    auto squared_norm = evaluate_abs_square_sum(lazy(this->x) - lazy(this->y), r);
+    EXPECT_NEAR(std::pow(nrm2(&r), 2), squared_norm, 1e-2 * squared_norm);
+}
+
+TYPED_TEST(hoNDArray_expressions_test, size_mismatch) {
+    hoNDArray<TypeParam> z(7);
+    EXPECT_THROW(lazy(this->x) + lazy(z), std::runtime_error);
+}
+
+TYPED_TEST(hoNDArray_expressions_test, solver_updates) {
+    typedef typename realType<TypeParam>::Type REAL;
+    TypeParam alpha = TypeParam(0.25);
+
+    auto x = this->x, r = this->y, x_ref = this->x, r_ref = this->y;
+    hoNDArray<TypeParam> p(x.dimensions()), q(x.dimensions());
+    fill_random(p, 3);
+    fill_random(q, 4);
+
+    REAL residual = cg_update(alpha, &p, &q, &x, &r, true);
+    axpy(alpha, &p, &x_ref);
+    axpy(-alpha, &q, &r_ref);
+    for (size_t n = 0; n < x.size(); n++) {
+        expect_near(x_ref[n], x[n]);
+        expect_near(r_ref[n], r[n]);
+    }
+    EXPECT_NEAR(real(dot(&r_ref, &r_ref)), residual, 1e-4 * residual);
+
+    axpby(alpha, &x, TypeParam(2), &r);
+    for (size_t n = 0; n < x.size(); n++) expect_near(TypeParam(alpha * x_ref[n] + TypeParam(2) * r_ref[n]), r[n]);
+
+    hoNDArray<REAL> acc;
+    add_abs_square(&x, &acc, true);
+    add_abs_square(&p, &acc, false);
+    for (size_t n = 0; n < x.size(); n++) EXPECT_NEAR(norm(x[n]) + norm(p[n]), acc[n], 1e-4 * acc[n]);
+}
+
+TEST(hoNDArray_expressions, cg_solver) {
+    // The weighted identity gives the normal equations 2*x = 2*b, which converge in a single iteration.
+    auto op = boost::make_shared<identityOperator<hoNDArray<std::complex<float>>>>();
+    std::vector<size_t> dims = { 64, 64 };
+    op->set_domain_dimensions(&dims);
+    op->set_codomain_dimensions(&dims);
+    op->set_weight(2);
+
+    hoNDArray<std::complex<float>> b(dims);
+    fill_random(b, 5);
+
+    hoCgSolver<std::complex<float>> solver;
+    solver.set_encoding_operator(op);
+    solver.set_max_iterations(5);
+    solver.set_tc_tolerance(1e-6f);
+    auto x = solver.solve(&b);
+
+    for (size_t n = 0; n < b.size(); n++) expect_near(b[n], (*x)[n]);
+}
@@ -0,0 +1,130 @@
+#include "hoNDArray_simd.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+#include <vector>
+
+using namespace Gadgetron;
+using SIMD::InstructionSet;
+
+namespace {
+    std::vector<std::complex<float>> random_complex(size_t N, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<float> dist(0.0f, 10.0f);
+
+        std::vector<std::complex<float>> data(N);
+        for (auto& v : data) v = { dist(engine), dist(engine) };
+        return data;
+    }
+
+    // Lengths around the vector widths, so both the vectorised loops and the remainders are covered.
+    const std::vector<size_t> lengths = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 1001 };
+
+    const float tolerance = 1e-5f;
+
+    void expect_near(std::complex<double> expected, std::complex<float> actual, double scale) {
+        EXPECT_NEAR(expected.real(), actual.real(), tolerance * scale);
+        EXPECT_NEAR(expected.imag(), actual.imag(), tolerance * scale);
+    }
+}
+
+class hoNDArray_simd_test : public ::testing::TestWithParam<InstructionSet> {
+protected:
+    void SetUp() override {
+        if (SIMD::kernels(GetParam()).instruction_set != GetParam()) {
+            GTEST_SKIP() << "Instruction set not supported by this CPU or build.";
+        }
+    }
+
+    const SIMD::Kernels& kernels() { return SIMD::kernels(GetParam()); }
+};
+
+TEST_P(hoNDArray_simd_test, multiply) {
+    for (size_t N : lengths) {
+        auto x = random_complex(N, 1), y = random_complex(N, 2);
+        std::vector<std::complex<float>> r(N), rc(N);
+
+        kernels().multiply(N, x.data(), y.data(), r.data());
+        kernels().multiply_conj(N, x.data(), y.data(), rc.data());
+
+        for (size_t n = 0; n < N; n++) {
+            std::complex<double> a = x[n], b = y[n];
+            expect_near(a * b, r[n], std::abs(a) * std::abs(b));
+            expect_near(a * std::conj(b), rc[n], std::abs(a) * std::abs(b));
+        }
+    }
+}
+
+TEST_P(hoNDArray_simd_test, multiply_inplace) {
+    auto x = random_complex(37, 3), y = random_complex(37, 4);
+    auto expected = x;
+
+    kernels().multiply(x.size(), expected.data(), y.data(), expected.data());
+    SIMD::kernels(InstructionSet::Scalar).multiply(x.size(), x.data(), y.data(), x.data());
+
+    for (size_t n = 0; n < x.size(); n++) expect_near(expected[n], x[n], std::abs(expected[n]));
+}
+
+TEST_P(hoNDArray_simd_test, conjugate_and_abs) {
+    for (size_t N : lengths) {
+        auto x = random_complex(N, 5);
+        std::vector<std::complex<float>> c(N);
+        std::vector<float> a(N);
+
+        kernels().conjugate(N, x.data(), c.data());
+        kernels().abs(N, x.data(), a.data());
+
+        for (size_t n = 0; n < N; n++) {
+            EXPECT_EQ(c[n], std::conj(x[n]));
+            EXPECT_NEAR(a[n], std::abs(std::complex<double>(x[n])), tolerance * std::abs(x[n]));
+        }
+    }
+}
+
+TEST_P(hoNDArray_simd_test, dot_and_nrm2) {
+    for (size_t N : lengths) {
+        auto x = random_complex(N, 6), y = random_complex(N, 7);
+
+        std::complex<double> dotc = 0, dotu = 0;
+        double norm = 0, scale = 0;
+        for (size_t n = 0; n < N; n++) {
+            std::complex<double> a = x[n], b = y[n];
+            dotc += std::conj(a) * b;
+            dotu += a * b;
+            norm += std::norm(a);
+            scale += std::abs(a) * std::abs(b);
+        }
+
+        expect_near(dotc, kernels().dot(N, x.data(), y.data(), true), scale);
+        expect_near(dotu, kernels().dot(N, x.data(), y.data(), false), scale);
+        EXPECT_NEAR(std::sqrt(norm), kernels().nrm2(2 * N, reinterpret_cast<const float*>(x.data())), tolerance * std::sqrt(norm));
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(InstructionSets, hoNDArray_simd_test,
+    ::testing::Values(InstructionSet::Scalar, InstructionSet::Avx2, InstructionSet::Avx512));
+
+TEST(hoNDArray_simd, arrays_use_kernels) {
+    hoNDArray<std::complex<float>> x(17, 5), y(17, 5), line(17), r;
+    std::default_random_engine engine(10);
+    std::normal_distribution<float> dist;
+    for (auto& v : x) v = { dist(engine), dist(engine) };
+    for (auto& v : y) v = { dist(engine), dist(engine) };
+    for (auto& v : line) v = { dist(engine), dist(engine) };
+
+    Gadgetron::multiplyConj(x, y, r);
+    for (size_t n = 0; n < x.size(); n++) expect_near(std::complex<double>(x[n]) * std::conj(std::complex<double>(y[n])), r[n], 100);
+
+    // Broadcasting a single line over all of x.
+    Gadgetron::multiply(x, line, r);
+    for (size_t n = 0; n < x.size(); n++) expect_near(std::complex<double>(x[n]) * std::complex<double>(line[n % 17]), r[n], 100);
+
+    hoNDArray<float> magnitude;
+    Gadgetron::abs(x, magnitude);
+    for (size_t n = 0; n < x.size(); n++) EXPECT_NEAR(magnitude[n], std::abs(x[n]), tolerance * 10);
+
+    EXPECT_NEAR(Gadgetron::nrm2(x), std::sqrt(std::real(Gadgetron::dot(x, x))), tolerance * 100);
+}
@@ -168,3 +168,33 @@ TEST(FFTshiftTest, shift3d_random){
 }
 
 
+
+TEST(FFTPlanCacheTest, repeated_transforms){
+    auto array = make_random_array(33,17,5);
+
+    auto first = FFT::fft2c(array);
+    auto second = FFT::fft2c(array);
+    EXPECT_EQ(first,second);
+
+    auto inplace = array;
+    hoNDFFT<float>::instance()->fft2c(inplace);
+    inplace -= first;
+    EXPECT_LE(nrm2(&inplace), nrm2(&first)*1e-5);
+}
+
+TEST(FFTPlanCacheTest, planner_effort){
+    // Odd sizes make consecutive batches start at different alignments
+    auto array = make_random_array(33,17,5,3);
+
+    auto estimate = array;
+    FFT::fft(estimate, std::vector<size_t>{0,2});
+
+    FFT::set_planner_effort(FFT::PlannerEffort::Measure);
+    auto measure = array;
+    FFT::fft(measure, std::vector<size_t>{0,2});
+    FFT::set_planner_effort(FFT::PlannerEffort::Estimate);
+
+    auto difference = estimate;
+    difference -= measure;
+    EXPECT_LE(nrm2(&difference), nrm2(&estimate)*1e-5);
+}
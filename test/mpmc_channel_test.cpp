@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "BoundedMPMCChannel.h"
+#include "Channel.h"
+
+#include <numeric>
+#include <thread>
+
+using namespace Gadgetron::Core;
+
+TEST(BoundedMPMCChannelTest, FIFOOrder) {
+    BoundedMPMCChannel<int> channel{ 4 };
+    for (int i = 0; i < 4; i++)
+        channel.push(i);
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(channel.pop(), i);
+}
+
+TEST(BoundedMPMCChannelTest, TryPushOnFull) {
+    BoundedMPMCChannel<std::unique_ptr<int>> channel{ 2 };
+    auto value = std::make_unique<int>(1);
+    EXPECT_TRUE(channel.try_push(value));
+    value = std::make_unique<int>(2);
+    EXPECT_TRUE(channel.try_push(value));
+    value = std::make_unique<int>(3);
+    EXPECT_FALSE(channel.try_push(value));
+    ASSERT_TRUE(value);
+    EXPECT_EQ(*channel.pop(), 1);
+    EXPECT_TRUE(channel.try_push(value));
+}
+
+TEST(BoundedMPMCChannelTest, DrainsBeforeClosing) {
+    BoundedMPMCChannel<int> channel{ 8 };
+    channel.push(1);
+    channel.push(2);
+    channel.close();
+    EXPECT_THROW(channel.push(3), ChannelClosed);
+    EXPECT_EQ(channel.pop(), 1);
+    EXPECT_EQ(channel.pop(), 2);
+    EXPECT_THROW(channel.pop(), ChannelClosed);
+}
+
+TEST(BoundedMPMCChannelTest, HoldsExactlyCapacity) {
+    for (size_t capacity : { 1, 3, 33 }) {
+        BoundedMPMCChannel<int> channel{ capacity };
+        EXPECT_EQ(channel.capacity(), capacity);
+
+        for (size_t i = 0; i < capacity; i++) {
+            int value = int(i);
+            EXPECT_TRUE(channel.try_push(value));
+        }
+        int value = -1;
+        EXPECT_FALSE(channel.try_push(value));
+        EXPECT_EQ(channel.size(), capacity);
+
+        EXPECT_EQ(channel.pop(), 0);
+        EXPECT_TRUE(channel.try_push(value));
+        EXPECT_FALSE(channel.try_push(value));
+    }
+}
+
+TEST(BoundedMPMCChannelTest, CloseWakesBlockedProducer) {
+    BoundedMPMCChannel<int> channel{ 1 };
+    channel.push(1);
+
+    // Whether the producer blocks before or after close, the push must end in ChannelClosed rather than hang.
+    auto producer = std::thread([&]() { EXPECT_THROW(channel.push(2), ChannelClosed); });
+    channel.close();
+    producer.join();
+
+    EXPECT_EQ(channel.pop(), 1);
+    EXPECT_THROW(channel.pop(), ChannelClosed);
+}
+
+TEST(BoundedMPMCChannelTest, ManyProducersManyConsumers) {
+    BoundedMPMCChannel<std::unique_ptr<size_t>> channel{ 16 };
+    constexpr size_t n_messages = 10000;
+    constexpr size_t n_threads  = 4;
+
+    std::vector<size_t> sums(n_threads, 0);
+    std::vector<std::thread> consumers;
+    for (size_t i = 0; i < n_threads; i++) {
+        consumers.emplace_back([&, i]() {
+            try {
+                while (true)
+                    sums[i] += *channel.pop();
+            } catch (const ChannelClosed&) {
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (size_t i = 0; i < n_threads; i++) {
+        producers.emplace_back([&]() {
+            for (size_t j = 0; j < n_messages; j++)
+                channel.push(std::make_unique<size_t>(j));
+        });
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+    channel.close();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    EXPECT_EQ(std::accumulate(sums.begin(), sums.end(), size_t(0)), n_threads * n_messages * (n_messages - 1) / 2);
+}
+
+TEST(BoundedMPMCChannelTest, BoundedMessageChannel) {
+    auto channel = make_channel<BoundedMessageChannel>(2);
+
+    auto producer = std::thread([output = std::move(channel.output)]() mutable {
+        for (int i = 0; i < 100; i++)
+            output.push(i);
+    });
+
+    int expected = 0;
+    for (auto message : channel.input) {
+        EXPECT_EQ(force_unpack<int>(std::move(message)), expected++);
+    }
+    EXPECT_EQ(expected, 100);
+    producer.join();
+}
+
+TEST(BatchedMessageChannelTest, FIFOOrder) {
+    auto channel = make_channel<BatchedMessageChannel>(16, std::chrono::milliseconds(1));
+
+    auto producer = std::thread([output = std::move(channel.output)]() mutable {
+        for (int i = 0; i < 1000; i++)
+            output.push(i);
+    });
+
+    int expected = 0;
+    for (auto message : channel.input) {
+        EXPECT_EQ(force_unpack<int>(std::move(message)), expected++);
+    }
+    EXPECT_EQ(expected, 1000);
+    producer.join();
+}
+
+TEST(BatchedMessageChannelTest, PartialBatchAfterWindow) {
+    auto channel = make_channel<BatchedMessageChannel>(64, std::chrono::milliseconds(5));
+
+    channel.output.push(1);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(force_unpack<int>(channel.input.pop()), 1);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST(BatchedMessageChannelTest, DrainsBeforeClosing) {
+    auto channel = make_channel<BatchedMessageChannel>(64, std::chrono::hours(1));
+
+    {
+        auto output = std::move(channel.output);
+        output.push(1);
+        output.push(2);
+    }
+
+    EXPECT_EQ(force_unpack<int>(channel.input.pop()), 1);
+    EXPECT_EQ(force_unpack<int>(channel.input.pop()), 2);
+    EXPECT_THROW(channel.input.pop(), ChannelClosed);
+}
+
+TEST(BatchedMessageChannelTest, BlocksWhenFull) {
+    constexpr int capacity = 8;
+    auto channel = make_channel<BatchedMessageChannel>(4, std::chrono::milliseconds(1), capacity);
+
+    std::atomic<int> pushed{ 0 };
+    auto producer = std::thread([&, output = std::move(channel.output)]() mutable {
+        for (int i = 0; i < 100; i++) {
+            output.push(i);
+            pushed++;
+        }
+    });
+
+    // The first pushes fill the channel without blocking.
+    while (pushed < capacity) std::this_thread::yield();
+
+    // Every pop makes room for exactly one more message, including those already handed over in a batch.
+    int expected = 0;
+    for (auto message : channel.input) {
+        EXPECT_EQ(force_unpack<int>(std::move(message)), expected++);
+        EXPECT_LE(pushed, expected + capacity);
+    }
+    EXPECT_EQ(expected, 100);
+    producer.join();
+}
@@ -0,0 +1,122 @@
+#include "mri_core_coil_map_estimation.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    // Smooth coil sensitivities times an object, plus noise, for RO x E1 x E2 x CHA.
+    hoNDArray<std::complex<float>> coil_images(size_t RO, size_t E1, size_t E2, size_t CHA, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<float> noise(0.0f, 0.05f);
+
+        hoNDArray<std::complex<float>> data(RO, E1, E2, CHA);
+        for (size_t cha = 0; cha < CHA; cha++) {
+            float cx = float(RO) * (cha + 1) / (CHA + 1), cy = float(E1) * (cha % 2 ? 0.25f : 0.75f);
+            for (size_t e2 = 0; e2 < E2; e2++)
+                for (size_t e1 = 0; e1 < E1; e1++)
+                    for (size_t ro = 0; ro < RO; ro++) {
+                        float r2 = ((ro - cx) * (ro - cx) + (e1 - cy) * (e1 - cy)) / float(RO * E1);
+                        std::complex<float> sensitivity = std::polar(std::exp(-4 * r2), 0.3f * cha + 0.01f * (ro + e2));
+                        data(ro, e1, e2, cha) = sensitivity * (1.0f + 0.5f * std::sin(0.2f * e1)) +
+                                                std::complex<float>(noise(engine), noise(engine));
+                    }
+        }
+        return data;
+    }
+
+    // Inati estimate of one pixel from its explicit neighbourhood matrix, with periodic boundaries.
+    std::vector<std::complex<double>> reference_pixel(const hoNDArray<std::complex<float>>& data, long long ro, long long e1,
+                                                      long long e2, long long ks, long long kz, size_t power) {
+        const long long RO = data.get_size(0), E1 = data.get_size(1), E2 = data.get_size(2), CHA = data.get_size(3);
+        auto wrap = [](long long n, long long N) { return ((n % N) + N) % N; };
+
+        std::vector<std::vector<std::complex<double>>> D;
+        for (long long kz2 = -kz / 2; kz2 <= kz / 2; kz2++)
+            for (long long ke1 = -ks / 2; ke1 <= ks / 2; ke1++)
+                for (long long kro = -ks / 2; kro <= ks / 2; kro++) {
+                    std::vector<std::complex<double>> row(CHA);
+                    for (long long cha = 0; cha < CHA; cha++)
+                        row[cha] = data(wrap(ro + kro, RO), wrap(e1 + ke1, E1), wrap(e2 + kz2, E2), cha);
+                    D.push_back(row);
+                }
+
+        auto normalize = [](std::vector<std::complex<double>>& v) {
+            double norm = 0;
+            for (auto& c : v) norm += std::norm(c);
+            for (auto& c : v) c /= std::sqrt(norm);
+        };
+
+        std::vector<std::complex<double>> v(CHA, 0.0);
+        for (auto& row : D)
+            for (long long cha = 0; cha < CHA; cha++) v[cha] += row[cha];
+        normalize(v);
+
+        for (size_t po = 0; po < power; po++) {
+            std::vector<std::complex<double>> u(D.size(), 0.0), w(CHA, 0.0);
+            for (size_t k = 0; k < D.size(); k++)
+                for (long long cha = 0; cha < CHA; cha++) u[k] += D[k][cha] * v[cha];
+            for (size_t k = 0; k < D.size(); k++)
+                for (long long cha = 0; cha < CHA; cha++) w[cha] += std::conj(D[k][cha]) * u[k];
+            v = w;
+            normalize(v);
+        }
+
+        std::complex<double> phase = 0;
+        for (auto& row : D)
+            for (long long cha = 0; cha < CHA; cha++) phase += row[cha] * v[cha];
+        phase /= std::abs(phase);
+
+        for (auto& c : v) c = std::conj(c) * phase;
+        return v;
+    }
+
+    void expect_matches_reference(const hoNDArray<std::complex<float>>& data, const hoNDArray<std::complex<float>>& coil_map,
+                                  long long ks, long long kz) {
+        const size_t RO = data.get_size(0), E1 = data.get_size(1), E2 = data.get_size(2), CHA = data.get_size(3);
+        ASSERT_EQ(coil_map.get_number_of_elements(), data.get_number_of_elements());
+
+        // Pixels at the corners, the edges and in the interior.
+        for (size_t e2 : { size_t(0), E2 / 2, E2 - 1 })
+            for (size_t e1 : { size_t(0), size_t(2), E1 / 2, E1 - 1 })
+                for (size_t ro : { size_t(0), size_t(1), RO / 3, RO / 2, RO - 2 }) {
+                    auto expected = reference_pixel(data, ro, e1, e2, ks, kz, 3);
+                    for (size_t cha = 0; cha < CHA; cha++) {
+                        auto actual = coil_map[ro + RO * (e1 + E1 * (e2 + E2 * cha))];
+                        EXPECT_NEAR(expected[cha].real(), actual.real(), 1e-4) << ro << " " << e1 << " " << e2 << " " << cha;
+                        EXPECT_NEAR(expected[cha].imag(), actual.imag(), 1e-4) << ro << " " << e1 << " " << e2 << " " << cha;
+                    }
+                }
+    }
+}
+
+TEST(coil_map_Inati, matches_reference_2d) {
+    // Wide enough to be split into several tiles along RO.
+    auto data = coil_images(150, 38, 1, 6, 1);
+    hoNDArray<std::complex<float>> image(150, 38, 6, data.begin());
+
+    hoNDArray<std::complex<float>> coil_map;
+    coil_map_2d_Inati(image, coil_map, 7, 3);
+    expect_matches_reference(data, coil_map, 7, 1);
+}
+
+TEST(coil_map_Inati, matches_reference_3d) {
+    auto data = coil_images(30, 21, 13, 5, 2);
+
+    hoNDArray<std::complex<float>> coil_map;
+    coil_map_3d_Inati(data, coil_map, 5, 5, 3);
+    expect_matches_reference(data, coil_map, 5, 5);
+}
+
+TEST(coil_map_Inati, even_kernel_size) {
+    // Even kernel sizes are rounded up to the next odd size.
+    auto data = coil_images(24, 20, 1, 4, 3);
+    hoNDArray<std::complex<float>> image(24, 20, 4, data.begin());
+
+    hoNDArray<std::complex<float>> even, odd;
+    coil_map_2d_Inati(image, even, 4, 3);
+    coil_map_2d_Inati(image, odd, 5, 3);
+    for (size_t n = 0; n < even.size(); n++) EXPECT_EQ(even[n], odd[n]);
+}
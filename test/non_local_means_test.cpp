@@ -0,0 +1,97 @@
+#include "non_local_means.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    // Piecewise constant phantom plus noise, for width x height x frames.
+    template <class T> hoNDArray<T> noisy_images(size_t width, size_t height, size_t frames, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<float> noise(0.0f, 0.2f);
+
+        hoNDArray<T> images(width, height, frames);
+        for (size_t f = 0; f < frames; f++)
+            for (size_t y = 0; y < height; y++)
+                for (size_t x = 0; x < width; x++) {
+                    float value = ((x / 8 + y / 8 + f) % 2) ? 2.0f : 1.0f;
+                    if constexpr (std::is_same<T, float>::value)
+                        images(x, y, f) = value + noise(engine);
+                    else
+                        images(x, y, f) = T(value + noise(engine), noise(engine));
+                }
+        return images;
+    }
+
+    // Non local means of one pixel, comparing the full patches for every search offset.
+    template <class T>
+    std::complex<double> reference_pixel(const hoNDArray<T>& images, long long x, long long y, long long frame,
+                                         float noise_std, long long search_radius) {
+        constexpr long long D = 5;
+        const long long width = images.get_size(0), height = images.get_size(1);
+        auto at = [&](long long px, long long py) {
+            return std::complex<double>(images(((px % width) + width) % width, ((py % height) + height) % height, frame));
+        };
+
+        double sum_weight = 0;
+        std::complex<double> sum_value = 0;
+        for (long long dy = -search_radius; dy < search_radius; dy++)
+            for (long long dx = -search_radius; dx < search_radius; dx++) {
+                double distance = 0;
+                for (long long ky = -D / 2; ky <= D / 2; ky++)
+                    for (long long kx = -D / 2; kx <= D / 2; kx++)
+                        distance += std::norm(at(x + kx, y + ky) - at(x + dx + kx, y + dy + ky));
+
+                double weight = std::exp(-distance / (noise_std * noise_std * D * D));
+                sum_weight += weight;
+                sum_value += weight * at(x + dx, y + dy);
+            }
+        return sum_value / sum_weight;
+    }
+
+    template <class T> void compare_to_reference(size_t width, size_t height, size_t frames, unsigned int search_radius) {
+        auto images = noisy_images<T>(width, height, frames, 1);
+        auto result = Denoise::non_local_means(images, 0.2f, search_radius);
+        ASSERT_EQ(result.dimensions(), images.dimensions());
+
+        for (size_t f = 0; f < frames; f++)
+            for (size_t y = 0; y < height; y++)
+                for (size_t x = 0; x < width; x++) {
+                    auto expected = reference_pixel(images, x, y, f, 0.2f, search_radius);
+                    auto actual = std::complex<double>(result(x, y, f));
+                    EXPECT_NEAR(expected.real(), actual.real(), 1e-4);
+                    EXPECT_NEAR(expected.imag(), actual.imag(), 1e-4);
+                }
+    }
+}
+
+TEST(non_local_means, matches_reference_real) {
+    compare_to_reference<float>(37, 29, 1, 4);
+}
+
+TEST(non_local_means, matches_reference_complex) {
+    compare_to_reference<std::complex<float>>(24, 32, 1, 3);
+}
+
+TEST(non_local_means, matches_reference_series) {
+    compare_to_reference<float>(20, 18, 5, 3);
+}
+
+TEST(non_local_means, reduces_noise) {
+    auto images = noisy_images<float>(64, 64, 2, 2);
+    auto clean = images;
+    for (size_t f = 0; f < 2; f++)
+        for (size_t y = 0; y < 64; y++)
+            for (size_t x = 0; x < 64; x++) clean(x, y, f) = ((x / 8 + y / 8 + f) % 2) ? 2.0f : 1.0f;
+
+    auto result = Denoise::non_local_means(images, 0.2f, 5);
+
+    double noisy_error = 0, denoised_error = 0;
+    for (size_t i = 0; i < images.size(); i++) {
+        noisy_error += std::norm(images[i] - clean[i]);
+        denoised_error += std::norm(result[i] - clean[i]);
+    }
+    EXPECT_LT(denoised_error, 0.7 * noisy_error);
+}
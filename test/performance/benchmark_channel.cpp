@@ -0,0 +1,105 @@
+//
+// Benchmark of handing messages from one node to the next through a batched channel.
+//
+// The arguments are the batch size and the capacity, 0 meaning unbounded. A channel with a capacity it never
+// reaches should cost the reader as little as an unbounded one; it only takes the writers' lock to hand over a batch,
+// or when a writer is actually waiting for room. Throughput is reported as the "messages/s" counter, and the mutex
+// locks taken by the reading thread as "reader locks/message", e.g.
+//
+//     benchmark_channel --benchmark_format=json
+//
+
+#include "Channel.h"
+
+#include <benchmark/benchmark.h>
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <thread>
+
+using namespace Gadgetron::Core;
+
+namespace {
+    thread_local bool count_locks = false;
+    thread_local size_t locks = 0;
+}
+
+// Counts the locks taken by the reading thread; std::mutex locks through pthread_mutex_lock.
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    using lock_function = int (*)(pthread_mutex_t*);
+    static auto next = reinterpret_cast<lock_function>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+    if (count_locks) locks++;
+    return next(mutex);
+}
+
+namespace {
+
+    constexpr int messages_per_iteration = 1 << 16;
+
+    void BM_BatchedMessageChannel(benchmark::State& state) {
+        auto batch_size = size_t(state.range(0));
+        auto capacity = state.range(1) ? optional<size_t>(size_t(state.range(1))) : none;
+
+        size_t reader_locks = 0;
+        for (auto _ : state) {
+            auto channel = make_channel<BatchedMessageChannel>(batch_size, std::chrono::milliseconds(1), capacity);
+
+            auto producer = std::thread([output = std::move(channel.output)]() mutable {
+                for (int i = 0; i < messages_per_iteration; i++) output.push(i);
+            });
+
+            int received = 0;
+            locks = 0;
+            count_locks = true;
+            for (auto message : channel.input) {
+                benchmark::DoNotOptimize(message);
+                received++;
+            }
+            count_locks = false;
+            reader_locks += locks;
+            producer.join();
+
+            if (received != messages_per_iteration) state.SkipWithError("Messages were lost in the channel.");
+        }
+
+        state.counters["messages/s"] = benchmark::Counter(
+                double(state.iterations() * messages_per_iteration), benchmark::Counter::kIsRate);
+        state.counters["reader locks/message"] = double(reader_locks) / (state.iterations() * messages_per_iteration);
+    }
+    BENCHMARK(BM_BatchedMessageChannel)
+        ->Args({ 64, 0 })->Args({ 64, 1 << 20 })->Args({ 64, 256 })
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // A writer keeping pace with the reader, pushing a message for every one popped, on a single thread so the
+    // interleaving is the same on every run.
+    void BM_BatchedMessageChannelInterleaved(benchmark::State& state) {
+        auto batch_size = size_t(state.range(0));
+        auto capacity = state.range(1) ? optional<size_t>(size_t(state.range(1))) : none;
+
+        auto channel = make_channel<BatchedMessageChannel>(batch_size, std::chrono::milliseconds(1), capacity);
+        for (size_t i = 0; i < batch_size; i++) channel.output.push(int(i));
+
+        size_t reader_locks = 0;
+        for (auto _ : state) {
+            for (int i = 0; i < messages_per_iteration; i++) {
+                locks = 0;
+                count_locks = true;
+                auto message = channel.input.pop();
+                count_locks = false;
+                reader_locks += locks;
+
+                benchmark::DoNotOptimize(message);
+                channel.output.push(i);
+            }
+        }
+
+        state.counters["messages/s"] = benchmark::Counter(
+                double(state.iterations() * messages_per_iteration), benchmark::Counter::kIsRate);
+        state.counters["reader locks/message"] = double(reader_locks) / (state.iterations() * messages_per_iteration);
+    }
+    BENCHMARK(BM_BatchedMessageChannelInterleaved)
+        ->Args({ 64, 0 })->Args({ 64, 1 << 20 })->Args({ 64, 256 })
+        ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_MAIN();
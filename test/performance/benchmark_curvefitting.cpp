@@ -10,6 +10,7 @@
 #include "simplexLagariaSolver.h"
 #include "twoParaExpDecayOperator.h"
 #include "twoParaExpRecoveryOperator.h"
+#include "curveFittingBatchedLMSolver.h"
 #include "curveFittingCostFunction.h"
 #include "cmr_t1_mapping.h"
 #include <gtest/gtest.h>
@@ -247,9 +248,39 @@ void time_gadgetron(){
     std::cout << "Fitting tookz " << std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count() << std::endl;
     std::cout << "Best cost " << best_cost << " " << b[0] << " " << b[1] <<  std::endl;
 }
+void time_batched_lm(){
+
+    // the same fit as above, ITERATIONS times, in batches of 64 problems
+    const size_t lanes = 64;
+
+    std::vector<float> y = {178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471};
+    auto x = std::vector<float>(11, 545);
+    x[10] = 10000;
+
+    std::vector<float> y_batch(y.size() * lanes), b(2 * lanes);
+    for (size_t n = 0; n < y.size(); n++)
+        std::fill(y_batch.begin() + n * lanes, y_batch.begin() + (n + 1) * lanes, y[n]);
+
+    Gadgetron::curveFittingBatchedLMSolver<float, Gadgetron::twoParaExpRecoveryModel> solver;
+    solver.max_iter_ = 150;
+    solver.thres_fun_ = 1e-4;
+
+    auto start = std::chrono::system_clock::now();
+    for (auto i = 0; i < ITERATIONS; i += lanes) {
+        std::fill(b.begin(), b.begin() + lanes, *std::max_element(y.begin(), y.end()));
+        std::fill(b.begin() + lanes, b.end(), x[x.size() / 2]);
+
+        solver.solve(x.data(), x.size(), y_batch.data(), lanes, b.data());
+    }
+    auto end = std::chrono::system_clock::now();
+
+    std::cout << "Fitting tookz " << std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count() << std::endl;
+    std::cout << "B " << b[0] << " " << b[lanes] <<  std::endl;
+}
 using namespace Gadgetron;
 int main(){
     time_gadgetron();
+    time_batched_lm();
     time_dlib();
     time_ceres();
 }
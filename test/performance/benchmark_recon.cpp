@@ -0,0 +1,620 @@
+//
+// Benchmarks of the main CPU reconstruction kernels on synthetic data of realistic sizes.
+//
+// Every benchmark reports its throughput as the "samples/s" counter, counting the complex samples of the input
+// processed per second. The usual Google Benchmark flags apply, e.g. to keep a JSON record of a run:
+//
+//     benchmark_recon --benchmark_out=recon.json --benchmark_out_format=json
+//     benchmark_recon --benchmark_filter=grappa --benchmark_format=json
+//
+
+#include "../gadgets/setup_gadget.h"
+#include "../synthetic_molli_series.h"
+#include "../../gadgets/mri_core/BucketToBufferGadget.h"
+
+#include "cmr_t1_mapping.h"
+#include "cpp_blas.h"
+#include "hoArmadillo.h"
+#include "hoImageRegContainer2DRegistration.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_simd.h"
+#include "hoNDFFT.h"
+#include "hoNFFT.h"
+#include "hoWavelet1DOperator.h"
+#include "hoWavelet2DTOperator.h"
+#include "hoWavelet3DOperator.h"
+#include "mri_core_acquisition_bucket.h"
+#include "mri_core_coil_map_estimation.h"
+#include "mri_core_data.h"
+#include "mri_core_grappa.h"
+#include "non_local_bayes.h"
+#include "non_local_means.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+
+using namespace Gadgetron;
+typedef std::complex<float> T;
+
+namespace {
+
+    hoNDArray<T> random_array(const std::vector<size_t>& dims, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<float> dist;
+
+        hoNDArray<T> array(dims);
+        for (auto& v : array) v = T(dist(engine), dist(engine));
+        return array;
+    }
+
+    // Smooth coil sensitivities times a disc, so the coil map estimation sees something like an image.
+    hoNDArray<T> synthetic_coil_images(size_t RO, size_t E1, size_t E2, size_t CHA, unsigned int seed) {
+        auto images = random_array({ RO, E1, E2, CHA }, seed);
+        for (size_t cha = 0; cha < CHA; cha++) {
+            float angle = float(2 * M_PI * cha / CHA);
+            for (size_t e2 = 0; e2 < E2; e2++) {
+                for (size_t e1 = 0; e1 < E1; e1++) {
+                    for (size_t ro = 0; ro < RO; ro++) {
+                        float x = float(ro) / RO - 0.5f, y = float(e1) / E1 - 0.5f;
+                        float object = (x * x + y * y < 0.16f) ? 1.0f : 0.0f;
+                        float sensitivity = std::exp(-4 * ((x - 0.5f * std::cos(angle)) * (x - 0.5f * std::cos(angle))
+                                                           + (y - 0.5f * std::sin(angle)) * (y - 0.5f * std::sin(angle))));
+                        images(ro, e1, e2, cha) = object * sensitivity * std::polar(1.0f, angle)
+                                                  + 0.01f * images(ro, e1, e2, cha);
+                    }
+                }
+            }
+        }
+        return images;
+    }
+
+    void set_samples_per_second(benchmark::State& state, size_t samples) {
+        state.counters["samples/s"] = benchmark::Counter(double(samples), benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    // ------------------------------------------------------------------------
+    // hoNDFFT
+    // ------------------------------------------------------------------------
+
+    // RO, E1, CHA
+    void BM_hoNDFFT_fft2c(benchmark::State& state) {
+        auto x = random_array({ size_t(state.range(0)), size_t(state.range(1)), size_t(state.range(2)) }, 1);
+        hoNDArray<T> r(x.dimensions()), buf(x.dimensions());
+
+        for (auto _ : state) {
+            hoNDFFT<float>::instance()->fft2c(x, r, buf);
+            benchmark::DoNotOptimize(r.begin());
+        }
+        set_samples_per_second(state, x.get_number_of_elements());
+    }
+    BENCHMARK(BM_hoNDFFT_fft2c)->Args({ 192, 192, 32 })->Args({ 256, 256, 32 })->Args({ 384, 256, 16 })->Unit(benchmark::kMillisecond);
+
+    // RO, E1, E2, CHA
+    void BM_hoNDFFT_ifft3c(benchmark::State& state) {
+        auto x = random_array({ size_t(state.range(0)), size_t(state.range(1)), size_t(state.range(2)), size_t(state.range(3)) }, 2);
+        hoNDArray<T> r(x.dimensions()), buf(x.dimensions());
+
+        for (auto _ : state) {
+            hoNDFFT<float>::instance()->ifft3c(x, r, buf);
+            benchmark::DoNotOptimize(r.begin());
+        }
+        set_samples_per_second(state, x.get_number_of_elements());
+    }
+    BENCHMARK(BM_hoNDFFT_ifft3c)->Args({ 128, 96, 64, 16 })->Unit(benchmark::kMillisecond);
+
+    // ------------------------------------------------------------------------
+    // Complex elementwise kernels and reductions
+    // ------------------------------------------------------------------------
+
+    // The second argument selects the implementation: a SIMD::InstructionSet, or blas. The hoNDArray dot and nrm2
+    // leave arrays longer than SIMD::blas_reduction_threshold to BLAS and its threads. axpy has no SIMD kernel; its
+    // BLAS version is compared with a plain loop, selected as SIMD::InstructionSet::Scalar.
+    constexpr int blas = -1;
+
+    const SIMD::Kernels* simd_kernels(benchmark::State& state) {
+        auto instruction_set = SIMD::InstructionSet(state.range(1));
+        const auto& kernels = SIMD::kernels(instruction_set);
+        if (kernels.instruction_set != instruction_set) {
+            state.SkipWithError("Instruction set not supported by this CPU or build.");
+            return nullptr;
+        }
+        return &kernels;
+    }
+
+    // N from cache resident to well beyond the threshold, for every instruction set
+    void simd_args(benchmark::internal::Benchmark* benchmark) {
+        for (long N : { 1 << 12, 1 << 16, 1 << 22 }) {
+            for (auto instruction_set : { SIMD::InstructionSet::Scalar, SIMD::InstructionSet::Avx2, SIMD::InstructionSet::Avx512 })
+                benchmark->Args({ N, long(instruction_set) });
+        }
+        benchmark->Unit(benchmark::kMicrosecond);
+    }
+
+    void simd_and_blas_args(benchmark::internal::Benchmark* benchmark) {
+        simd_args(benchmark);
+        for (long N : { 1 << 12, 1 << 16, 1 << 22 }) benchmark->Args({ N, blas });
+    }
+
+    void loop_and_blas_args(benchmark::internal::Benchmark* benchmark) {
+        for (long N : { 1 << 12, 1 << 16, 1 << 22 }) {
+            benchmark->Args({ N, long(SIMD::InstructionSet::Scalar) });
+            benchmark->Args({ N, blas });
+        }
+        benchmark->Unit(benchmark::kMicrosecond);
+    }
+
+    // N, instruction set
+    void BM_simd_multiply(benchmark::State& state) {
+        size_t N = state.range(0);
+        auto x = random_array({ N }, 20), y = random_array({ N }, 21);
+        hoNDArray<T> r(N);
+
+        auto kernels = simd_kernels(state);
+        for (auto _ : state) {
+            kernels->multiply(N, x.data(), y.data(), r.data());
+            benchmark::DoNotOptimize(r.data());
+        }
+        set_samples_per_second(state, N);
+    }
+    BENCHMARK(BM_simd_multiply)->Apply(simd_args);
+
+    // N, plain loop or blas
+    void BM_simd_axpy(benchmark::State& state) {
+        size_t N = state.range(0);
+        auto x = random_array({ N }, 22), y = random_array({ N }, 23);
+        const T a(1e-3f, -1e-3f);
+
+        for (auto _ : state) {
+            if (state.range(1) == blas) {
+                BLAS::axpy(N, a, x.data(), 1, y.data(), 1);
+            } else {
+                for (size_t n = 0; n < N; n++) y[n] += a * x[n];
+            }
+            benchmark::DoNotOptimize(y.data());
+        }
+        set_samples_per_second(state, N);
+    }
+    BENCHMARK(BM_simd_axpy)->Apply(loop_and_blas_args);
+
+    // N, instruction set or blas
+    void BM_simd_dot(benchmark::State& state) {
+        size_t N = state.range(0);
+        auto x = random_array({ N }, 24), y = random_array({ N }, 25);
+
+        auto kernels = state.range(1) == blas ? nullptr : simd_kernels(state);
+        for (auto _ : state) {
+            auto d = kernels ? kernels->dot(N, x.data(), y.data(), true) : BLAS::dotc(N, x.data(), 1, y.data(), 1);
+            benchmark::DoNotOptimize(d);
+        }
+        set_samples_per_second(state, N);
+    }
+    BENCHMARK(BM_simd_dot)->Apply(simd_and_blas_args);
+
+    // N, instruction set or blas
+    void BM_simd_nrm2(benchmark::State& state) {
+        size_t N = state.range(0);
+        auto x = random_array({ N }, 26);
+
+        auto kernels = state.range(1) == blas ? nullptr : simd_kernels(state);
+        for (auto _ : state) {
+            auto n = kernels ? kernels->nrm2(2 * N, reinterpret_cast<const float*>(x.data())) : BLAS::nrm2(N, x.data(), 1);
+            benchmark::DoNotOptimize(n);
+        }
+        set_samples_per_second(state, N);
+    }
+    BENCHMARK(BM_simd_nrm2)->Apply(simd_and_blas_args);
+
+    // ------------------------------------------------------------------------
+    // GRAPPA
+    // ------------------------------------------------------------------------
+
+    // acs RO, acs E1, CHA, acceleration
+    void BM_grappa2d_calib(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1), CHA = state.range(2), accel = state.range(3);
+        auto acs = random_array({ RO, E1, CHA }, 3);
+        hoNDArray<T> convKer, kIm;
+
+        for (auto _ : state) {
+            grappa2d_calib_convolution_kernel(acs, acs, accel, 5e-4, 5, 4, convKer);
+            grappa2d_image_domain_kernel(convKer, 192, 192, kIm);
+            benchmark::DoNotOptimize(kIm.begin());
+        }
+        set_samples_per_second(state, acs.get_number_of_elements());
+    }
+    BENCHMARK(BM_grappa2d_calib)->Args({ 192, 24, 32, 2 })->Args({ 192, 48, 32, 4 })->Args({ 192, 24, 16, 2 })
+        ->Unit(benchmark::kMillisecond);
+
+    // RO, E1, CHA, N, tiled; single slice and cine sized series, for 32 and 64 channel coils. The last argument selects
+    // the tiled gemm unwrapping (1) or the elementwise multiplications per channel pair it replaced (0).
+    void BM_grappa2d_recon_kernel(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1), CHA = state.range(2), N = state.range(3);
+        bool tiled = state.range(4) != 0;
+        auto kerIm = random_array({ RO, E1, CHA, CHA }, 4);
+        auto aliasedIm = random_array({ RO, E1, CHA, N }, 5);
+        hoNDArray<T> complexIm;
+
+        for (auto _ : state) {
+            if (tiled) {
+                grappa2d_image_domain_unwrapping_aliased_image(aliasedIm, kerIm, complexIm);
+            } else {
+                grappa2d_image_domain_unwrapping_aliased_image_elementwise(aliasedIm, kerIm, complexIm);
+            }
+            benchmark::DoNotOptimize(complexIm.begin());
+        }
+        set_samples_per_second(state, aliasedIm.get_number_of_elements());
+    }
+    BENCHMARK(BM_grappa2d_recon_kernel)
+        ->Args({ 192, 192, 32, 1, 0 })->Args({ 192, 192, 32, 1, 1 })
+        ->Args({ 256, 192, 32, 8, 0 })->Args({ 256, 192, 32, 8, 1 })
+        ->Args({ 192, 144, 32, 30, 0 })->Args({ 192, 144, 32, 30, 1 })
+        ->Args({ 256, 192, 64, 8, 0 })->Args({ 256, 192, 64, 8, 1 })
+        ->Unit(benchmark::kMillisecond);
+
+    // RO, E1, E2, CHA, N, tiled; 3D volumes with a 9x9x9 kernel at 2x2 acceleration. The image domain kernels dominate
+    // memory, so the channel counts are kept moderate.
+    void BM_grappa3d_recon_kernel(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1), E2 = state.range(2), CHA = state.range(3), N = state.range(4);
+        bool tiled = state.range(5) != 0;
+        auto convKer = random_array({ 9, 9, 9, CHA, CHA }, 8);
+        auto aliasedIm = random_array({ RO, E1, E2, CHA, N }, 9);
+        hoNDArray<T> complexIm;
+
+        for (auto _ : state) {
+            if (tiled) {
+                grappa3d_image_domain_unwrapping_aliasedImage(convKer, aliasedIm, 2, 2, complexIm);
+            } else {
+                grappa3d_image_domain_unwrapping_aliasedImage_elementwise(convKer, aliasedIm, 2, 2, complexIm);
+            }
+            benchmark::DoNotOptimize(complexIm.begin());
+        }
+        set_samples_per_second(state, aliasedIm.get_number_of_elements());
+    }
+    BENCHMARK(BM_grappa3d_recon_kernel)
+        ->Args({ 128, 96, 64, 32, 1, 0 })->Args({ 128, 96, 64, 32, 1, 1 })
+        ->Args({ 96, 72, 48, 32, 4, 0 })->Args({ 96, 72, 48, 32, 4, 1 })
+        ->Args({ 128, 96, 64, 16, 8, 0 })->Args({ 128, 96, 64, 16, 8, 1 })
+        ->Unit(benchmark::kMillisecond)->Iterations(1);
+
+    // RO, E1, CHA, N
+    void BM_grappa2d_recon_unmixing(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1), CHA = state.range(2), N = state.range(3);
+        auto unmix = random_array({ RO, E1, CHA }, 6);
+        auto aliasedIm = random_array({ RO, E1, CHA, N }, 7);
+        hoNDArray<T> complexIm;
+
+        for (auto _ : state) {
+            apply_unmix_coeff_aliased_image(aliasedIm, unmix, complexIm);
+            benchmark::DoNotOptimize(complexIm.begin());
+        }
+        set_samples_per_second(state, aliasedIm.get_number_of_elements());
+    }
+    BENCHMARK(BM_grappa2d_recon_unmixing)->Args({ 192, 192, 32, 1 })->Args({ 192, 144, 32, 30 })->Unit(benchmark::kMillisecond);
+
+    // ------------------------------------------------------------------------
+    // Coil map estimation
+    // ------------------------------------------------------------------------
+
+    // RO, E1, E2, CHA
+    void BM_coil_map_Inati(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1), E2 = state.range(2), CHA = state.range(3);
+        auto images = synthetic_coil_images(RO, E1, E2, CHA, 8);
+        if (E2 == 1) images.reshape({ RO, E1, CHA });
+        hoNDArray<T> coilMap;
+
+        for (auto _ : state) {
+            coil_map_Inati(images, coilMap, 7, 5, 3);
+            benchmark::DoNotOptimize(coilMap.begin());
+        }
+        set_samples_per_second(state, images.get_number_of_elements());
+    }
+    BENCHMARK(BM_coil_map_Inati)->Args({ 192, 192, 1, 32 })->Args({ 256, 256, 1, 16 })->Args({ 128, 128, 32, 16 })
+        ->Unit(benchmark::kMillisecond);
+
+    // ------------------------------------------------------------------------
+    // hoNFFT
+    // ------------------------------------------------------------------------
+
+    hoNDArray<vector_td<float, 2>> radial_trajectory(size_t samples_per_spoke, size_t spokes) {
+        hoNDArray<vector_td<float, 2>> trajectory(samples_per_spoke * spokes);
+        for (size_t s = 0; s < spokes; s++) {
+            float angle = float(M_PI * s / spokes);
+            for (size_t n = 0; n < samples_per_spoke; n++) {
+                float k = float(n) / samples_per_spoke - 0.5f;
+                trajectory[n + s * samples_per_spoke] = vector_td<float, 2>(k * std::cos(angle), k * std::sin(angle));
+            }
+        }
+        return trajectory;
+    }
+
+    // matrix size, spokes, CHA
+    void BM_hoNFFT_forwards(benchmark::State& state) {
+        size_t M = state.range(0), spokes = state.range(1), CHA = state.range(2);
+        vector_td<size_t, 2> matrix_size(M, M), matrix_size_os(M * 3 / 2, M * 3 / 2);
+        hoNFFT_plan<float, 2> plan(matrix_size, matrix_size_os, 5.5f);
+        plan.preprocess(radial_trajectory(2 * M, spokes), NFFT_prep_mode::ALL);
+
+        auto image = random_array({ M, M, CHA }, 9);
+        hoNDArray<T> samples(2 * M * spokes, 1, CHA);
+
+        for (auto _ : state) {
+            plan.compute(image, samples, nullptr, NFFT_comp_mode::FORWARDS_C2NC);
+            benchmark::DoNotOptimize(samples.begin());
+        }
+        set_samples_per_second(state, samples.get_number_of_elements());
+    }
+    BENCHMARK(BM_hoNFFT_forwards)->Args({ 256, 128, 8 })->Args({ 192, 64, 32 })->Unit(benchmark::kMillisecond);
+
+    // matrix size, spokes, CHA
+    void BM_hoNFFT_backwards(benchmark::State& state) {
+        size_t M = state.range(0), spokes = state.range(1), CHA = state.range(2);
+        vector_td<size_t, 2> matrix_size(M, M), matrix_size_os(M * 3 / 2, M * 3 / 2);
+        hoNFFT_plan<float, 2> plan(matrix_size, matrix_size_os, 5.5f);
+        plan.preprocess(radial_trajectory(2 * M, spokes), NFFT_prep_mode::ALL);
+
+        auto samples = random_array({ 2 * M * spokes, 1, CHA }, 10);
+        hoNDArray<T> image(M, M, CHA);
+
+        for (auto _ : state) {
+            plan.compute(samples, image, nullptr, NFFT_comp_mode::BACKWARDS_NC2C);
+            benchmark::DoNotOptimize(image.begin());
+        }
+        set_samples_per_second(state, samples.get_number_of_elements());
+    }
+    BENCHMARK(BM_hoNFFT_backwards)->Args({ 256, 128, 8 })->Args({ 192, 64, 32 })->Unit(benchmark::kMillisecond);
+
+    // ------------------------------------------------------------------------
+    // Wavelet operators
+    // ------------------------------------------------------------------------
+
+    // The image domain operators as used by the L1 SPIRiT regularization, on [RO E1 CHA N] and [RO E1 E2 CHA N].
+    template <class Operator> void wavelet_round_trip(benchmark::State& state, std::vector<size_t> dims, size_t levels) {
+        auto x = random_array(dims, 11);
+        Operator op(&dims);
+        op.select_wavelet("db2");
+        op.num_of_wav_levels_ = levels;
+        hoNDArray<T> coeff, y;
+
+        for (auto _ : state) {
+            op.mult_M(&x, &coeff);
+            op.mult_MH(&coeff, &y);
+            benchmark::DoNotOptimize(y.begin());
+        }
+        set_samples_per_second(state, x.get_number_of_elements());
+    }
+
+    // RO, E1, CHA, N
+    void BM_hoWavelet2DTOperator(benchmark::State& state) {
+        wavelet_round_trip<hoWavelet2DTOperator<T>>(
+            state, { size_t(state.range(0)), size_t(state.range(1)), size_t(state.range(2)), size_t(state.range(3)) }, 2);
+    }
+    BENCHMARK(BM_hoWavelet2DTOperator)->Args({ 192, 192, 8, 1 })->Args({ 192, 144, 1, 30 })->Unit(benchmark::kMillisecond);
+
+    // RO, E1, E2, CHA
+    void BM_hoWavelet3DOperator(benchmark::State& state) {
+        wavelet_round_trip<hoWavelet3DOperator<T>>(
+            state, { size_t(state.range(0)), size_t(state.range(1)), size_t(state.range(2)), size_t(state.range(3)) }, 1);
+    }
+    BENCHMARK(BM_hoWavelet3DOperator)->Args({ 128, 96, 64, 1 })->Unit(benchmark::kMillisecond);
+
+    // RO, CHA
+    void BM_hoWavelet1DOperator(benchmark::State& state) {
+        wavelet_round_trip<hoWavelet1DOperator<T>>(state, { size_t(state.range(0)), size_t(state.range(1)) }, 3);
+    }
+    BENCHMARK(BM_hoWavelet1DOperator)->Args({ 512, 32 })->Unit(benchmark::kMicrosecond);
+
+    // ------------------------------------------------------------------------
+    // Noise prewhitening
+    // ------------------------------------------------------------------------
+
+    // The NoiseAdjustGadget stores and loads its covariance through the storage server, so its two kernels are
+    // reproduced here: accumulating the noise covariance, and prewhitening every acquisition of a readout.
+
+    // samples, CHA, acquisitions
+    void BM_NoiseAdjust_covariance(benchmark::State& state) {
+        size_t samples = state.range(0), CHA = state.range(1), acquisitions = state.range(2);
+        auto noise = random_array({ samples, CHA, acquisitions }, 12);
+        hoNDArray<T> covariance(CHA, CHA);
+
+        for (auto _ : state) {
+            Gadgetron::clear(covariance);
+            auto covM = as_arma_matrix(covariance);
+            for (size_t a = 0; a < acquisitions; a++) {
+                hoNDArray<T> acq(samples, CHA, noise.begin() + a * samples * CHA);
+                auto dataM = as_arma_matrix(acq);
+                covM += dataM.t() * dataM;
+            }
+            benchmark::DoNotOptimize(covariance.begin());
+        }
+        set_samples_per_second(state, noise.get_number_of_elements());
+    }
+    BENCHMARK(BM_NoiseAdjust_covariance)->Args({ 256, 32, 256 })->Unit(benchmark::kMillisecond);
+
+    // samples, CHA, acquisitions
+    void BM_NoiseAdjust_prewhitening(benchmark::State& state) {
+        size_t samples = state.range(0), CHA = state.range(1), acquisitions = state.range(2);
+        auto noise = random_array({ 4 * CHA, CHA }, 13);
+        auto data = random_array({ samples, CHA, acquisitions }, 14);
+
+        // Cholesky factor of the noise covariance, inverted, as NoiseAdjustGadget computes it
+        hoNDArray<T> prewhitener(CHA, CHA);
+        auto noiseM = as_arma_matrix(noise);
+        auto pwm = as_arma_matrix(prewhitener);
+        pwm = noiseM.t() * noiseM;
+        pwm = arma::inv(arma::trimatu(arma::chol(pwm)));
+
+        // The gadget whitens in place; writing to a second array keeps the input from decaying over the iterations.
+        hoNDArray<T> whitened(data.dimensions());
+        for (auto _ : state) {
+            for (size_t a = 0; a < acquisitions; a++) {
+                hoNDArray<T> acq(samples, CHA, data.begin() + a * samples * CHA);
+                hoNDArray<T> out(samples, CHA, whitened.begin() + a * samples * CHA);
+                auto outM = as_arma_matrix(out);
+                outM = as_arma_matrix(acq) * pwm;
+            }
+            benchmark::DoNotOptimize(whitened.begin());
+        }
+        set_samples_per_second(state, data.get_number_of_elements());
+    }
+    BENCHMARK(BM_NoiseAdjust_prewhitening)->Args({ 384, 32, 192 })->Args({ 256, 64, 192 })->Unit(benchmark::kMillisecond);
+
+    // ------------------------------------------------------------------------
+    // Denoising
+    // ------------------------------------------------------------------------
+
+    // Noisy cine series of a disc moving across the field of view.
+    hoNDArray<T> cine_series(size_t width, size_t height, size_t frames, unsigned int seed) {
+        std::default_random_engine engine(seed);
+        std::normal_distribution<float> noise(0.0f, 0.1f);
+
+        hoNDArray<T> images(width, height, frames);
+        for (size_t f = 0; f < frames; f++) {
+            float cx = width * (0.3f + 0.4f * f / frames), cy = height * 0.5f, r = width * 0.2f;
+            for (size_t y = 0; y < height; y++)
+                for (size_t x = 0; x < width; x++) {
+                    float value = ((x - cx) * (x - cx) + (y - cy) * (y - cy) < r * r) ? 1.0f : 0.2f;
+                    images(x, y, f) = T(value + noise(engine), noise(engine));
+                }
+        }
+        return images;
+    }
+
+    // The denoisers are meant for one image at a time as well as whole series, so the throughput is also reported per image.
+    void set_images_per_second(benchmark::State& state, size_t images) {
+        state.counters["images/s"] = benchmark::Counter(double(images), benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    // width, height, frames, search radius
+    void BM_non_local_means(benchmark::State& state) {
+        size_t width = state.range(0), height = state.range(1), frames = state.range(2);
+        auto images = cine_series(width, height, frames, 10);
+
+        for (auto _ : state) {
+            auto denoised = Denoise::non_local_means(images, 0.1f, (unsigned int)state.range(3));
+            benchmark::DoNotOptimize(denoised.data());
+        }
+        set_samples_per_second(state, images.get_number_of_elements());
+        set_images_per_second(state, frames);
+    }
+    BENCHMARK(BM_non_local_means)->Args({ 192, 192, 1, 5 })->Args({ 192, 192, 30, 5 })->Args({ 256, 256, 30, 10 })
+        ->Unit(benchmark::kMillisecond);
+
+    // width, height, frames, search window
+    void BM_non_local_bayes(benchmark::State& state) {
+        size_t width = state.range(0), height = state.range(1), frames = state.range(2);
+        auto images = cine_series(width, height, frames, 11);
+
+        for (auto _ : state) {
+            auto denoised = Denoise::non_local_bayes(images, 0.1f, (unsigned int)state.range(3));
+            benchmark::DoNotOptimize(denoised.data());
+        }
+        set_samples_per_second(state, images.get_number_of_elements());
+        set_images_per_second(state, frames);
+    }
+    BENCHMARK(BM_non_local_bayes)->Args({ 192, 192, 1, 25 })->Args({ 192, 192, 30, 25 })->Unit(benchmark::kMillisecond);
+
+    // ------------------------------------------------------------------------
+    // Non-rigid registration of a MOLLI series
+    // ------------------------------------------------------------------------
+
+    typedef hoNDImage<float, 2> RegImageType;
+
+    // RO, E1, N; all frames registered to the last one, through the container or one pair at a time
+    void BM_hoImageRegContainer2DRegistration(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1), N = state.range(2);
+        auto container = synthetic_molli_series(RO, E1, std::vector<size_t>(1, N));
+
+        hoImageRegContainer2DRegistration<RegImageType, RegImageType, double> reg(3, false, -1);
+        std::vector<unsigned int> referenceFrame(1, (unsigned int)(N - 1));
+
+        for (auto _ : state) {
+            reg.registerOverContainer2DFixedReference(container, referenceFrame, true, false);
+            benchmark::DoNotOptimize(reg.warped_container_(0, 0).begin());
+        }
+        set_samples_per_second(state, RO * E1 * N);
+    }
+    BENCHMARK(BM_hoImageRegContainer2DRegistration)->Args({ 192, 144, 30 })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    void BM_hoImageRegContainer2DRegistration_pairwise(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1), N = state.range(2);
+        auto container = synthetic_molli_series(RO, E1, std::vector<size_t>(1, N));
+
+        hoImageRegContainer2DRegistration<RegImageType, RegImageType, double> reg(3, false, -1);
+        RegImageType warped;
+        hoNDImage<double, 2> dx, dy;
+        hoNDImage<double, 2>* deform[2] = { &dx, &dy };
+
+        for (auto _ : state) {
+            for (size_t n = 0; n < N - 1; n++) {
+                reg.registerTwoImagesDeformationField(container(0, N - 1), container(0, n), false, &warped, deform);
+            }
+            benchmark::DoNotOptimize(warped.begin());
+        }
+        set_samples_per_second(state, RO * E1 * N);
+    }
+    BENCHMARK(BM_hoImageRegContainer2DRegistration_pairwise)->Args({ 192, 144, 30 })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // ------------------------------------------------------------------------
+    // Parametric mapping
+    // ------------------------------------------------------------------------
+
+    // RO, E1, batched; T1 SR mapping with SD maps, a T1 ramp along RO and some noise
+    void BM_CmrT1SRMapping(benchmark::State& state) {
+        size_t RO = state.range(0), E1 = state.range(1);
+
+        CmrT1SRMapping<float> t1_sr;
+        t1_sr.fill_holes_in_maps_ = false;
+        t1_sr.compute_SD_maps_ = true;
+        t1_sr.batched_fitting_ = state.range(2) != 0;
+        t1_sr.max_map_value_ = 4000;
+
+        t1_sr.ti_.resize(11, 545);
+        t1_sr.ti_[10] = 10000;
+        size_t N = t1_sr.ti_.size();
+
+        std::default_random_engine engine(15);
+        std::normal_distribution<float> dist(0, 5);
+
+        t1_sr.data_.create(RO, E1, N, 1, 1);
+        for (size_t n = 0; n < N; n++)
+            for (size_t e1 = 0; e1 < E1; e1++)
+                for (size_t ro = 0; ro < RO; ro++)
+                    t1_sr.data_(ro, e1, n, 0, 0) = 400 * (1 - std::exp(-t1_sr.ti_[n] / (800.0f + 4 * ro))) + dist(engine);
+
+        for (auto _ : state) {
+            t1_sr.perform_parametric_mapping();
+            benchmark::DoNotOptimize(t1_sr.map_.begin());
+        }
+        set_samples_per_second(state, RO * E1 * N);
+    }
+    BENCHMARK(BM_CmrT1SRMapping)->Args({ 256, 256, 0 })->Args({ 256, 256, 1 })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // ------------------------------------------------------------------------
+    // BucketToBufferGadget
+    // ------------------------------------------------------------------------
+
+    // CHA; one fully sampled 192x192 slice per bucket, as from the context of setup_gadget.h
+    void BM_BucketToBufferGadget(benchmark::State& state) {
+        size_t CHA = state.range(0), E1 = 192, samples = 192;
+
+        AcquisitionBucket bucket;
+        for (size_t e1 = 0; e1 < E1; e1++) {
+            auto acq = Test::generate_acquisition(samples, CHA);
+            std::get<ISMRMRD::AcquisitionHeader>(acq).idx.kspace_encode_step_1 = uint16_t(e1);
+            bucket.add_acquisition(std::move(acq));
+        }
+
+        auto channels = Test::setup_gadget<BucketToBufferGadget>({});
+
+        for (auto _ : state) {
+            channels.input.push(bucket);
+            auto message = channels.output.pop();
+            benchmark::DoNotOptimize(message);
+        }
+        set_samples_per_second(state, E1 * samples * CHA);
+    }
+    BENCHMARK(BM_BucketToBufferGadget)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+BENCHMARK_MAIN();
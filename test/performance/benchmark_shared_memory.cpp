@@ -0,0 +1,117 @@
+//
+// Benchmark of sending data to an external peer and back, over the loopback socket and through shared memory.
+//
+// The first argument selects the transport: 0 for the socket, 1 for shared memory. BM_ImageRoundTrip echoes a large
+// image array, reporting bytes per second. BM_MessageRoundTrip echoes a small message after the number of
+// microseconds given as its second argument, long enough for the waiting end to go to sleep; the time per round
+// trip beyond that delay is the latency of waking it. For example:
+//
+//     benchmark_shared_memory --benchmark_format=json
+//
+
+#include "connection/SocketStreamBuf.h"
+#include "connection/nodes/common/SharedMemory.h"
+
+#include "hoNDArray.h"
+#include "io/primitives.h"
+
+#include <boost/asio.hpp>
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <complex>
+#include <future>
+#include <numeric>
+#include <thread>
+
+namespace ba = boost::asio;
+using tcp    = boost::asio::ip::tcp;
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+
+    // Both ends of a connection, as Gadgetron and an external peer see it.
+    struct Ends {
+        explicit Ends(bool shared_memory) {
+            tcp::acceptor acceptor(ios, tcp::endpoint(tcp::v6(), 0));
+            auto port = acceptor.local_endpoint().port();
+
+            auto socket = std::async([&]() {
+                auto socket = std::make_unique<tcp::socket>(ios);
+                acceptor.accept(*socket);
+                return socket;
+            });
+            gadgetron = Gadgetron::Connection::remote_stream("localhost", std::to_string(port));
+            peer = Gadgetron::Connection::stream_from_socket(socket.get());
+
+            if (!shared_memory) return;
+
+            auto accepted = std::async([&]() { return accept_shared_memory(std::move(peer)); });
+            gadgetron = offer_shared_memory(std::move(gadgetron));
+            peer = accepted.get();
+        }
+
+        ba::io_service ios{};
+        std::unique_ptr<std::iostream> gadgetron;
+        std::unique_ptr<std::iostream> peer;
+    };
+
+    void BM_ImageRoundTrip(benchmark::State& state) {
+        Ends connection(state.range(0) != 0);
+
+        auto array = hoNDArray<std::complex<float>>(256, 256, 40, 32);
+        std::iota(reinterpret_cast<float *>(array.data()), reinterpret_cast<float *>(array.data() + array.size()), 0.0f);
+
+        auto echo = std::thread([&]() {
+            auto &peer = *connection.peer;
+            while (peer.peek() != std::char_traits<char>::eof())
+                IO::write(peer, IO::read<hoNDArray<std::complex<float>>>(peer));
+        });
+
+        hoNDArray<std::complex<float>> result;
+        for (auto _ : state) {
+            IO::write(*connection.gadgetron, array);
+            result = IO::read<hoNDArray<std::complex<float>>>(*connection.gadgetron);
+        }
+
+        connection.gadgetron.reset();
+        echo.join();
+
+        if (!(result == array)) state.SkipWithError("Received array does not match what was sent.");
+        state.SetBytesProcessed(state.iterations() * 2 * array.get_number_of_bytes());
+    }
+    BENCHMARK(BM_ImageRoundTrip)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    void BM_MessageRoundTrip(benchmark::State& state) {
+        Ends connection(state.range(0) != 0);
+        auto delay = std::chrono::microseconds(state.range(1));
+
+        auto echo = std::thread([&]() {
+            auto &peer = *connection.peer;
+            while (peer.peek() != std::char_traits<char>::eof()) {
+                auto message = IO::read<uint64_t>(peer);
+                if (delay.count()) std::this_thread::sleep_for(delay);
+                IO::write(peer, message);
+            }
+        });
+
+        uint64_t message = 0;
+        for (auto _ : state) {
+            IO::write(*connection.gadgetron, message);
+            if (IO::read<uint64_t>(*connection.gadgetron) != message++) {
+                state.SkipWithError("Received message does not match what was sent.");
+                break;
+            }
+        }
+
+        connection.gadgetron.reset();
+        echo.join();
+    }
+    BENCHMARK(BM_MessageRoundTrip)
+        ->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 0, 200 })->Args({ 1, 200 })->Args({ 0, 2000 })->Args({ 1, 2000 })
+        ->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
+
+BENCHMARK_MAIN();
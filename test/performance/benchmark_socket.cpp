@@ -0,0 +1,88 @@
+//
+// Benchmark of reading acquisitions from a loopback socket through the connection stream buffer.
+//
+// The first argument is the stream buffer size; reads of direct_read_threshold bytes or more go straight from the
+// socket into the destination regardless. As in the acquisition reader, the data of every acquisition is read into
+// a new hoNDArray; the second argument installs the memory pool, so the arrays are aligned, reused blocks, as in a
+// server running with --memory_pool. Throughput is reported as the "acquisitions/s" and bytes per second
+// counters, e.g.
+//
+//     benchmark_socket --benchmark_format=json
+//
+
+#include "connection/SocketStreamBuf.h"
+
+#include "hoMemoryPool.h"
+#include "hoNDArray.h"
+
+#include <boost/asio.hpp>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <complex>
+#include <thread>
+#include <vector>
+
+namespace ba = boost::asio;
+using tcp    = boost::asio::ip::tcp;
+
+namespace {
+
+    // Header and data of a 32 channel acquisition with 256 complex float samples.
+    constexpr size_t header_size = 340;
+    constexpr size_t samples = 256;
+    constexpr size_t channels = 32;
+    constexpr size_t data_size = samples * channels * sizeof(std::complex<float>);
+    constexpr size_t acquisitions_per_iteration = 64;
+
+    void BM_SocketAcquisitionRead(benchmark::State& state) {
+        auto buffer_size = size_t(state.range(0));
+        if (state.range(1)) Gadgetron::hoNDArrayAllocator::set(std::make_shared<Gadgetron::hoMemoryPool>());
+
+        ba::io_service ios{};
+        tcp::acceptor acceptor(ios, tcp::endpoint(tcp::v6(), 0));
+        auto port = acceptor.local_endpoint().port();
+
+        tcp::socket server_socket{ios};
+        auto connection = std::thread([&]() { acceptor.accept(server_socket); });
+        auto stream = Gadgetron::Connection::remote_stream("localhost", std::to_string(port), buffer_size);
+        connection.join();
+
+        // The writer keeps the socket full until the reading end is closed.
+        auto writer = std::thread([&]() {
+            auto message = std::vector<char>(header_size + data_size, 42);
+            boost::system::error_code error;
+            while (!error) ba::write(server_socket, ba::buffer(message), error);
+        });
+
+        auto header = std::vector<char>(header_size);
+        Gadgetron::hoNDArray<std::complex<float>> data;
+
+        for (auto _ : state) {
+            for (size_t i = 0; i < acquisitions_per_iteration; i++) {
+                stream->read(header.data(), header.size());
+                data = Gadgetron::hoNDArray<std::complex<float>>(samples, channels);
+                stream->read(reinterpret_cast<char*>(data.data()), data.get_number_of_bytes());
+            }
+            benchmark::DoNotOptimize(data.data());
+        }
+
+        stream.reset();
+        writer.join();
+
+        auto bytes = reinterpret_cast<const char*>(data.data());
+        if (!std::all_of(bytes, bytes + data.get_number_of_bytes(), [](char c) { return c == 42; }))
+            state.SkipWithError("Received data does not match what was sent.");
+        Gadgetron::hoNDArrayAllocator::set(nullptr);
+
+        state.counters["acquisitions/s"] = benchmark::Counter(
+                double(state.iterations() * acquisitions_per_iteration), benchmark::Counter::kIsRate);
+        state.SetBytesProcessed(state.iterations() * acquisitions_per_iteration * (header_size + data_size));
+    }
+    BENCHMARK(BM_SocketAcquisitionRead)
+        ->Args({ 1024, 0 })->Args({ Gadgetron::Connection::default_socket_buffer_size, 0 })
+        ->Args({ Gadgetron::Connection::default_socket_buffer_size, 1 })
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+BENCHMARK_MAIN();
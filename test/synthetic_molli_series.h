@@ -0,0 +1,34 @@
+#pragma once
+
+#include "hoNDImage.h"
+#include "hoNDImageContainer2D.h"
+
+#include <cmath>
+
+namespace Gadgetron {
+
+    // One row per entry of cols: a disc moving with respiration, with the inversion recovery contrast of a MOLLI series
+    // in its centre. Each row moves a pixel further than the one before.
+    inline hoNDImageContainer2D<hoNDImage<float, 2>> synthetic_molli_series(size_t RO, size_t E1, const std::vector<size_t>& cols) {
+        hoNDImageContainer2D<hoNDImage<float, 2>> container;
+        container.create(cols);
+
+        for (size_t r = 0; r < cols.size(); r++) {
+            for (size_t n = 0; n < cols[r]; n++) {
+                float shift = (3.0f + r) * std::sin(float(2 * M_PI * n / cols[r]));
+                float contrast = 1.0f - 2.0f * std::exp(-float(n + 1) * 0.1f);
+
+                hoNDImage<float, 2>& im = container(r, n);
+                im.create(std::vector<size_t>{ RO, E1 });
+                for (size_t e1 = 0; e1 < E1; e1++) {
+                    for (size_t ro = 0; ro < RO; ro++) {
+                        float x = float(ro) - 0.5f * RO - shift, y = float(e1) - 0.5f * E1;
+                        float d = std::sqrt(x * x + y * y);
+                        im(ro, e1) = 100.0f * ((d < 0.25f * E1 ? 1.0f : 0.2f) + (d < 0.1f * E1 ? contrast : 0.0f));
+                    }
+                }
+            }
+        }
+        return container;
+    }
+}
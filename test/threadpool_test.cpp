@@ -5,6 +5,15 @@
 #include <gtest/gtest.h>
 #include "ThreadPool.h"
 
+#include <atomic>
+
+#if !(_WIN32)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Gadgetron;
 using namespace Gadgetron::Core;
 TEST(ThreadPoolTest,VoidTest){
     ThreadPool pool{4};
@@ -24,3 +33,182 @@ TEST(ThreadPoolTest,moveTest){
     pool.join();
 
 }
+
+TEST(ThreadPoolTest,groupConcurrencyTest){
+    ThreadPool pool{4};
+    auto group = pool.make_group(2);
+
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 64; i++) {
+        results.push_back(group.async([&](int i) {
+            int now = ++running;
+            int seen = max_running;
+            while (now > seen && !max_running.compare_exchange_weak(seen, now));
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            running--;
+            return i;
+        }, i));
+    }
+    group.wait();
+
+    EXPECT_LE(max_running, 2);
+    for (int i = 0; i < 64; i++) EXPECT_EQ(results[i].get(), i);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,nestedTest){
+    ThreadPool pool{4};
+    auto outer = pool.async([&]() {
+        std::vector<std::future<int>> inner;
+        for (int i = 0; i < 100; i++) inner.push_back(pool.async([](int x) { return 2 * x; }, i));
+
+        int sum = 0;
+        for (auto& result : inner) {
+            while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) std::this_thread::yield();
+            sum += result.get();
+        }
+        return sum;
+    });
+    EXPECT_EQ(outer.get(), 9900);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,nestedGroupTest){
+    ThreadPool pool{4};
+    auto group = pool.make_group(2);
+
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::atomic<int> finished{0};
+    auto task = [&]() {
+        int now = ++running;
+        int seen = max_running;
+        while (now > seen && !max_running.compare_exchange_weak(seen, now));
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        running--;
+        finished++;
+    };
+
+    for (int i = 0; i < 8; i++) {
+        group.async([&]() {
+            for (int j = 0; j < 8; j++) group.async(task);
+            task();
+        });
+    }
+    group.wait();
+
+    EXPECT_EQ(finished, 8 * 9);
+    EXPECT_LE(max_running, 2);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,waitHelpsTest){
+    ThreadPool pool{1};
+    auto outer = pool.async([&]() {
+        auto inner = pool.make_group();
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 100; i++) results.push_back(inner.async([](int x) { return 2 * x; }, i));
+        inner.wait();
+
+        int sum = 0;
+        for (auto& result : results) sum += result.get();
+        return sum;
+    });
+    EXPECT_EQ(outer.get(), 9900);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,waitInsideGroupTest){
+    ThreadPool pool{1};
+    auto group = pool.make_group(1);
+    std::atomic<int> finished{0};
+    auto outer = group.async([&]() {
+        for (int i = 0; i < 10; i++) group.async([&]() { finished++; });
+        group.wait();
+        return finished.load();
+    });
+    EXPECT_EQ(outer.get(), 10);
+    group.wait();
+    pool.join();
+}
+
+#if !(_WIN32)
+TEST(ThreadPoolTest,memoryAccountTest){
+    ThreadPool pool{2};
+    hoMemoryPool memory_pool;
+    auto account = std::make_shared<hoMemoryAccount>();
+
+    std::future<void*> allocated;
+    {
+        hoMemoryAccount::Scope scope(account);
+        allocated = pool.async([&]() { return memory_pool.allocate(1 << 16); });
+    }
+    auto block = allocated.get();
+    EXPECT_EQ(account->statistics().allocations, 1);
+
+    // Tasks submitted without an account charge no one.
+    pool.async([&]() { memory_pool.deallocate(memory_pool.allocate(1 << 12)); }).get();
+    EXPECT_EQ(account->statistics().allocations, 1);
+
+    memory_pool.deallocate(block);
+    EXPECT_EQ(account->statistics().bytes_in_use, 0);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,processTokensTest){
+    // Pools in two processes share two tokens, so no more than two of their four workers run tasks at a time.
+    auto tokens = std::make_shared<ProcessTokens>(2);
+    auto shared = mmap(nullptr, 2 * sizeof(std::atomic<int>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(shared, MAP_FAILED);
+    auto& running = *new (shared) std::atomic<int>{0};
+    auto& max_running = *new (static_cast<std::atomic<int>*>(shared) + 1) std::atomic<int>{0};
+
+    auto run_tasks = [&]() {
+        ThreadPool pool{2, tokens};
+        std::vector<std::future<void>> results;
+        for (int i = 0; i < 64; i++) {
+            results.push_back(pool.async([&]() {
+                int now = ++running;
+                int seen = max_running;
+                while (now > seen && !max_running.compare_exchange_weak(seen, now));
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                running--;
+            }));
+        }
+        for (auto& result : results) result.get();
+        pool.join();
+    };
+
+    auto child = fork();
+    if (child == 0) {
+        run_tasks();
+        _exit(0);
+    }
+    run_tasks();
+
+    int status;
+    waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_LE(max_running, 2);
+    EXPECT_GE(max_running, 1);
+    munmap(shared, 2 * sizeof(std::atomic<int>));
+}
+
+TEST(ThreadPoolTest,processTokensReturnedOnExitTest){
+    ProcessTokens tokens(1);
+
+    // The child exits without releasing its token, as a crashing connection would.
+    auto child = fork();
+    if (child == 0) {
+        tokens.acquire();
+        _exit(0);
+    }
+    int status;
+    waitpid(child, &status, 0);
+
+    tokens.acquire();
+    tokens.release();
+}
+#endif
@@ -411,7 +411,7 @@ void perform_moco_fixed_key_frame_2DT(Gadgetron::hoNDImageContainer2D< hoNDImage
         reg.div_num_pyramid_level_.clear();
         reg.div_num_pyramid_level_.resize(level, div_num);
 
-        reg.registerOverContainer2DFixedReference(input, key_frame, warp_input, false);
+        GADGET_CHECK_THROW(reg.registerOverContainer2DFixedReference(input, key_frame, warp_input, false));
     }
     catch (...)
     {
@@ -446,7 +446,7 @@ void perform_moco_fixed_key_frame_2DT(const Gadgetron::hoNDArray<T>& input, size
 
     std::vector<unsigned int> referenceFrame(1, key_frame);
 
-    reg.registerOverContainer2DFixedReference(im, referenceFrame, warp_input, false);
+    GADGET_CHECK_THROW(reg.registerOverContainer2DFixedReference(im, referenceFrame, warp_input, false));
 }
 
 template EXPORTCMR void perform_moco_fixed_key_frame_2DT(const Gadgetron::hoNDArray<float>& input, size_t key_frame, bool warp_input, Gadgetron::hoImageRegContainer2DRegistration<Gadgetron::hoNDImage<float, 2>, Gadgetron::hoNDImage<float, 2>, double>& reg);
@@ -192,6 +192,9 @@ CmrParametricMapping<T>::CmrParametricMapping()
     max_map_value_ = -1;
     min_map_value_ = 0;
 
+    batched_fitting_ = false;
+    batch_size_ = 64;
+
     verbose_ = false;
     perform_timing_ = false;
 
@@ -285,6 +288,12 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
                     pMaskCurr = pMask + s*RO*E1 + slc*S*RO*E1;
                 }
 
+                if (this->batched_fitting_)
+                {
+                    this->perform_parametric_mapping_batched(RO, E1, pData, pMaskCurr, pMap, pPara, pMapSD, pParaSD);
+                    continue;
+                }
+
 #pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM)
                 {
                     std::vector<T> yi(num_ti, 0);
@@ -516,6 +525,107 @@ void CmrParametricMapping<T>::compute_sd_impl(const VectorType& ti, const Vector
     }
 }
 
+template <typename T>
+void CmrParametricMapping<T>::compute_map_batch(const VectorType& ti, const T* yi, size_t num, const T* guess, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    size_t num_ti = ti.size();
+    size_t NUM = this->get_num_of_paras();
+
+    VectorType y(num_ti, 0), g(NUM, 0), b(NUM, 0), sd_v(NUM, 0);
+
+    size_t ii, n;
+    for (ii = 0; ii < num; ii++)
+    {
+        for (n = 0; n < num_ti; n++) y[n] = yi[ii + n*num];
+        for (n = 0; n < NUM; n++) g[n] = guess[ii + n*num];
+
+        this->compute_map(ti, y, g, b, map_v[ii]);
+        for (n = 0; n < NUM; n++) bi[ii + n*num] = b[n];
+
+        if (this->compute_SD_maps_)
+        {
+            try
+            {
+                this->compute_sd(ti, y, b, sd_v, map_sd[ii]);
+            }
+            catch (...)
+            {
+                std::fill(sd_v.begin(), sd_v.end(), (T)0);
+                map_sd[ii] = 0;
+            }
+
+            for (n = 0; n < NUM; n++) sd[ii + n*num] = sd_v[n];
+        }
+    }
+}
+
+template <typename T>
+void CmrParametricMapping<T>::perform_parametric_mapping_batched(size_t RO, size_t E1, const T* pData, const T* pMask, T* pMap, T* pPara, T* pMapSD, T* pParaSD)
+{
+    size_t num_ti = ti_.size();
+    size_t NUM = this->get_num_of_paras();
+    size_t B = (this->batch_size_ > 0) ? this->batch_size_ : 1;
+
+    // pixels to fit
+    std::vector<size_t> pixels;
+    pixels.reserve(RO*E1);
+
+    size_t offset;
+    for (offset = 0; offset < RO*E1; offset++)
+    {
+        if (pMask == NULL || pMask[offset] > 0) pixels.push_back(offset);
+    }
+
+    long long num_batches = (long long)((pixels.size() + B - 1) / B);
+    long long batch;
+
+#pragma omp parallel private(batch) shared(RO, E1, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM, B, pixels, num_batches)
+    {
+        std::vector<T> yi(num_ti*B), guess(NUM*B), bi(NUM*B), map_v(B), sd(NUM*B), map_sd(B);
+        VectorType y(num_ti, 0), g(NUM, 0);
+
+        size_t ii, n;
+
+#pragma omp for schedule(dynamic)
+        for (batch = 0; batch < num_batches; batch++)
+        {
+            size_t start = batch*B;
+            size_t num = std::min(B, pixels.size() - start);
+
+            // gather the batch, pixel index running fastest
+            for (ii = 0; ii < num; ii++)
+            {
+                size_t pt = pixels[start + ii];
+                for (n = 0; n < num_ti; n++)
+                {
+                    y[n] = pData[pt + n*RO*E1];
+                    yi[ii + n*num] = y[n];
+                }
+
+                this->get_initial_guess(ti_, y, g);
+                for (n = 0; n < NUM; n++) guess[ii + n*num] = g[n];
+            }
+
+            this->compute_map_batch(ti_, &yi[0], num, &guess[0], &bi[0], &map_v[0], &sd[0], &map_sd[0]);
+
+            // scatter the results
+            for (ii = 0; ii < num; ii++)
+            {
+                size_t pt = pixels[start + ii];
+
+                pMap[pt] = map_v[ii];
+                for (n = 0; n < NUM; n++) pPara[pt + n*RO*E1] = bi[ii + n*num];
+
+                if (this->compute_SD_maps_)
+                {
+                    pMapSD[pt] = map_sd[ii];
+                    for (n = 0; n < NUM; n++) pParaSD[pt + n*RO*E1] = sd[ii + n*num];
+                }
+            }
+        }
+    }
+}
+
 template <typename T>
 size_t CmrParametricMapping<T>::get_num_of_paras() const
 {
@@ -106,6 +106,12 @@ namespace Gadgetron {
         T max_map_value_;
         T min_map_value_;
 
+        /// whether to fit the pixels in batches with compute_map_batch
+        /// mappings with a batched Levenberg-Marquardt fit (e.g. T1 SR and T2) override it; others fall back to compute_map per pixel
+        bool batched_fitting_;
+        /// number of pixels fitted together in a batch
+        size_t batch_size_;
+
         // ======================================================================================
         /// parameter for debugging
         // ======================================================================================
@@ -137,10 +143,21 @@ namespace Gadgetron {
         /// compute SD values for every parameters in bi
         virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
+        /// compute map values for a batch of num pixels, and their SD values if compute_SD_maps_ is true
+        /// yi: [num ti.size()], guess and bi: [num NUM], sd: [num NUM]; the pixel index runs fastest
+        /// map_v and map_sd: [num]
+        /// by default, every pixel is fitted with compute_map and compute_sd
+        virtual void compute_map_batch(const VectorType& ti, const T* yi, size_t num, const T* guess, T* bi, T* map_v, T* sd, T* map_sd);
+
         /// compute SD values from gradient vector
         virtual void compute_sd_impl(const VectorType& ti, const VectorType& yi, const VectorType& bi, const VectorType& res, const hoNDArray<T>& grad, VectorType& sd);
 
         /// return number of parameters, including the map itself
         virtual size_t get_num_of_paras() const;
+
+    protected:
+
+        /// perform the mapping for one [RO E1] slice in batches of batch_size_ pixels; background pixels are skipped
+        void perform_parametric_mapping_batched(size_t RO, size_t E1, const T* pData, const T* pMask, T* pMap, T* pPara, T* pMapSD, T* pParaSD);
     };
 }
@@ -49,6 +49,9 @@ public:
     /// compute SD values for every parameters in bi
     virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
+    /// fit a batch of pixels with the batched Levenberg-Marquardt solver
+    virtual void compute_map_batch(const VectorType& ti, const T* yi, size_t num, const T* guess, T* bi, T* map_v, T* sd, T* map_sd);
+
     /// two parameters, A, T1
     virtual size_t get_num_of_paras() const;
 
@@ -72,6 +75,8 @@ public:
     using BaseClass::thres_fun_;
     using BaseClass::max_map_value_;
     using BaseClass::min_map_value_;
+    using BaseClass::batched_fitting_;
+    using BaseClass::batch_size_;
 
     using BaseClass::verbose_;
     using BaseClass::debug_folder_;
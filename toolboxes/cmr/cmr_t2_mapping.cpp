@@ -12,6 +12,7 @@
 #include "hoNDArray_linalg.h"
 
 #include "simplexLagariaSolver.h"
+#include "curveFittingBatchedLMSolver.h"
 #include "twoParaExpDecayOperator.h"
 #include "curveFittingCostFunction.h"
 
@@ -186,6 +187,51 @@ void CmrT2Mapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, con
     }
 }
 
+template <typename T>
+void CmrT2Mapping<T>::compute_map_batch(const VectorType& ti, const T* yi, size_t num, const T* guess, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    try
+    {
+        size_t num_ti = ti.size();
+        size_t NUM = this->get_num_of_paras();
+
+        memcpy(bi, guess, sizeof(T)*NUM*num);
+
+        Gadgetron::curveFittingBatchedLMSolver<T, Gadgetron::twoParaExpDecayModel> solver;
+        solver.max_iter_ = max_iter_;
+        solver.thres_fun_ = thres_fun_;
+
+        solver.solve(&ti[0], num_ti, yi, num, bi);
+
+        size_t ii;
+        for (ii = 0; ii < num; ii++)
+        {
+            map_v[ii] = 0;
+            if (bi[ii] > 0 && bi[ii + num] > 0)
+            {
+                map_v[ii] = bi[ii + num];
+                if (map_v[ii] >= max_map_value_) map_v[ii] = hole_marking_value_;
+                if (map_v[ii] <= min_map_value_) map_v[ii] = hole_marking_value_;
+            }
+        }
+
+        if (compute_SD_maps_)
+        {
+            solver.compute_sd(&ti[0], num_ti, yi, num, bi, sd);
+
+            for (ii = 0; ii < num; ii++)
+            {
+                map_sd[ii] = sd[ii + num];
+                if (map_sd[ii] > max_map_value_) map_sd[ii] = this->hole_marking_value_;
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrT2Mapping<T>::compute_map_batch(...) ... ");
+    }
+}
+
 template <typename T>
 size_t CmrT2Mapping<T>::get_num_of_paras() const
 {
@@ -68,7 +68,8 @@ void CompressedFloatBuffer::deserialize(std::vector<uint8_t>& buffer)
     this->elements_ = h.elements_;
     this->scale_ = h.scale_;
     this->tolerance_ = 0.5f / h.scale_;
-    this->comp_.resize(bytes_needed, 0);
+    // getValue reads whole qwords, so keep the same padding at the end as initialize does.
+    this->comp_.resize(bytes_needed + sizeof(uint64_t) - sizeof(uint8_t), 0);
 
     memcpy(&comp_[0], &buffer[sizeof(CompressionHeader)], bytes_needed);
 }
@@ -132,7 +133,7 @@ void CompressedFloatBuffer::compress(std::vector<float>& d, float tolerance, uin
 
     float* dptr = d.data();
 
-    float max_val = *dptr;
+    float max_val = std::abs(*dptr);
 
     for (size_t i = 1; i < elements_; i++) {
         float float_val = std::abs(d[i]);
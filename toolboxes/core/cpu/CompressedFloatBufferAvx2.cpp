@@ -121,7 +121,7 @@ void CompressedFloatBufferAvx2::compress(std::vector<float>& d, float tolerance,
     }
     else
     {
-        max_val = dptr[i++];
+        max_val = std::abs(dptr[i++]);
     }
 
     // Short tail
@@ -115,7 +115,7 @@ void CompressedFloatBufferSse41::compress(std::vector<float>& d, float tolerance
     }
     else
     {
-        max_val = dptr[i++];
+        max_val = std::abs(dptr[i++]);
     }
 
     // Short tail
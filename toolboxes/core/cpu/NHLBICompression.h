@@ -13,6 +13,8 @@
 #include <sstream>
 #include <vector>
 
+#include "cpucore_export.h"
+
 namespace NHLBI {
     enum class InstructionSet
     {
@@ -22,7 +24,7 @@ namespace NHLBI {
         Avx2
     };
 
-    class CompressedFloatBuffer
+    class EXPORTCPUCORE CompressedFloatBuffer
     {
     protected:
         CompressedFloatBuffer()
@@ -177,7 +179,7 @@ namespace NHLBI {
         }
     };
 
-    class CompressedFloatBufferSse41 : public CompressedFloatBuffer
+    class EXPORTCPUCORE CompressedFloatBufferSse41 : public CompressedFloatBuffer
     {
     public:
         virtual InstructionSet getInstructionSet();
@@ -185,7 +187,7 @@ namespace NHLBI {
         virtual void compress(std::vector<float>& d, float tolerance = -1.0f, uint8_t precision_bits = 16);
     };
 
-    class CompressedFloatBufferAvx2 : public CompressedFloatBuffer
+    class EXPORTCPUCORE CompressedFloatBufferAvx2 : public CompressedFloatBuffer
     {
     public:
         virtual InstructionSet getInstructionSet();
@@ -0,0 +1,376 @@
+#include "hoMemoryPool.h"
+
+#include <boost/align/aligned_alloc.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace Gadgetron
+{
+    namespace
+    {
+        thread_local std::shared_ptr<hoMemoryAccount> current_account;
+
+        // Accessed through std::atomic_load and std::atomic_store only.
+        std::shared_ptr<hoMemoryAccount> process_account;
+
+        std::atomic<uint64_t> next_pool_id{ 0 };
+
+        constexpr size_t huge_page_size = size_t(2) << 20;
+
+        void update_peak(std::atomic<size_t>& peak, size_t value)
+        {
+            auto previous = peak.load(std::memory_order_relaxed);
+            while (previous < value && !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed));
+        }
+    }
+
+    hoMemoryStatistics hoMemoryAccount::statistics() const
+    {
+        hoMemoryStatistics stats;
+        stats.allocations = allocations.load(std::memory_order_relaxed);
+        stats.pool_hits = pool_hits.load(std::memory_order_relaxed);
+        stats.bytes_in_use = bytes_in_use.load(std::memory_order_relaxed);
+        stats.peak_bytes_in_use = peak_bytes_in_use.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    std::shared_ptr<hoMemoryAccount> hoMemoryAccount::current()
+    {
+        if (current_account) return current_account;
+        return process();
+    }
+
+    void hoMemoryAccount::set_process(std::shared_ptr<hoMemoryAccount> account)
+    {
+        std::atomic_store(&process_account, std::move(account));
+    }
+
+    std::shared_ptr<hoMemoryAccount> hoMemoryAccount::process()
+    {
+        return std::atomic_load(&process_account);
+    }
+
+    void hoMemoryAccount::charge(size_t bytes, bool hit)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (hit) pool_hits.fetch_add(1, std::memory_order_relaxed);
+        update_peak(peak_bytes_in_use, bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    }
+
+    void hoMemoryAccount::credit(size_t bytes)
+    {
+        bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    hoMemoryAccount::Scope::Scope(std::shared_ptr<hoMemoryAccount> account) : previous(std::move(current_account))
+    {
+        current_account = std::move(account);
+    }
+
+    hoMemoryAccount::Scope::~Scope()
+    {
+        current_account = std::move(previous);
+    }
+
+    // ----------------------------------------------------------------------------------------
+
+    struct hoMemoryPool::ThreadCache
+    {
+        std::mutex m;
+        hoMemoryPool* pool;
+        size_t bytes = 0;
+        std::array<std::vector<void*>, number_of_classes> blocks;
+
+        // Hands the cached blocks to the shared cache of the pool when the thread exits.
+        void release()
+        {
+            std::lock_guard<std::mutex> guard(m);
+            if (pool) pool->flush(*this);
+        }
+    };
+
+    namespace
+    {
+        // The caches of one thread, one for each pool the thread has released memory to.
+        template<class Cache> struct ThreadCaches
+        {
+            std::vector<std::pair<uint64_t, std::shared_ptr<Cache>>> caches;
+
+            ~ThreadCaches()
+            {
+                for (auto& entry : caches) entry.second->release();
+            }
+        };
+    }
+
+    hoMemoryPool::hoMemoryPool() : hoMemoryPool(Options{})
+    {
+    }
+
+    hoMemoryPool::hoMemoryPool(Options options) : options(options), id(next_pool_id++)
+    {
+        if (options.alignment == 0 || (options.alignment & (options.alignment - 1)))
+            throw std::invalid_argument("hoMemoryPool alignment must be a power of two");
+    }
+
+    hoMemoryPool::~hoMemoryPool()
+    {
+        std::lock_guard<std::mutex> guard(caches_mutex);
+        for (auto& weak_cache : caches) {
+            auto cache = weak_cache.lock();
+            if (!cache) continue;
+
+            std::lock_guard<std::mutex> cache_guard(cache->m);
+            for (size_t index = 0; index < number_of_classes; index++) {
+                for (auto ptr : cache->blocks[index]) free_block(ptr, class_bytes(index));
+                cache->blocks[index].clear();
+            }
+            cache->pool = nullptr;
+        }
+
+        for (size_t index = 0; index < number_of_classes; index++) {
+            for (auto ptr : free_lists[index].blocks) free_block(ptr, class_bytes(index));
+        }
+    }
+
+    size_t hoMemoryPool::class_index(size_t bytes)
+    {
+        if (bytes <= 64) return 0;
+
+        size_t power = 6;
+        while ((bytes - 1) >> (power + 1)) power++;
+
+        size_t step = size_t(1) << (power - 2);
+        size_t k = (bytes - (size_t(1) << power) + step - 1) / step;
+        return (power - 6) * 4 + k;
+    }
+
+    size_t hoMemoryPool::class_bytes(size_t index)
+    {
+        if (index == 0) return 64;
+
+        size_t power = 6 + (index - 1) / 4;
+        size_t k = (index - 1) % 4 + 1;
+        return (size_t(1) << power) + k * (size_t(1) << (power - 2));
+    }
+
+    size_t hoMemoryPool::size_class(size_t bytes)
+    {
+        return class_bytes(class_index(bytes));
+    }
+
+    hoMemoryPool::Shard& hoMemoryPool::shard_of(void* ptr)
+    {
+        // Blocks are at least 64 byte aligned, so the low bits carry no information.
+        return shards[std::hash<void*>{}(ptr) / 64 % number_of_shards];
+    }
+
+    hoMemoryPool::ThreadCache* hoMemoryPool::thread_cache()
+    {
+        thread_local ThreadCaches<ThreadCache> thread_caches;
+
+        auto& caches_of_thread = thread_caches.caches;
+        for (auto& entry : caches_of_thread) {
+            if (entry.first == id) return entry.second.get();
+        }
+
+        caches_of_thread.erase(
+            std::remove_if(caches_of_thread.begin(), caches_of_thread.end(), [](auto& entry) {
+                std::lock_guard<std::mutex> guard(entry.second->m);
+                return entry.second->pool == nullptr;
+            }),
+            caches_of_thread.end()
+        );
+
+        auto cache = std::make_shared<ThreadCache>();
+        cache->pool = this;
+        caches_of_thread.emplace_back(id, cache);
+
+        std::lock_guard<std::mutex> guard(caches_mutex);
+        caches.erase(
+            std::remove_if(caches.begin(), caches.end(), [](auto& weak_cache) { return weak_cache.expired(); }),
+            caches.end()
+        );
+        caches.push_back(cache);
+        return cache.get();
+    }
+
+    void hoMemoryPool::flush(ThreadCache& cache)
+    {
+        for (size_t index = 0; index < number_of_classes; index++) {
+            for (auto ptr : cache.blocks[index]) {
+                bytes_cached.fetch_sub(class_bytes(index), std::memory_order_relaxed);
+                put_shared(ptr, index);
+            }
+            cache.blocks[index].clear();
+        }
+        cache.bytes = 0;
+        cache.pool = nullptr;
+    }
+
+    void* hoMemoryPool::take_cached(size_t index)
+    {
+        auto bytes = class_bytes(index);
+        {
+            auto cache = thread_cache();
+            std::lock_guard<std::mutex> guard(cache->m);
+            auto& blocks = cache->blocks[index];
+            if (!blocks.empty()) {
+                auto ptr = blocks.back();
+                blocks.pop_back();
+                cache->bytes -= bytes;
+                bytes_cached.fetch_sub(bytes, std::memory_order_relaxed);
+                return ptr;
+            }
+        }
+
+        auto& free_list = free_lists[index];
+        std::lock_guard<std::mutex> guard(free_list.m);
+        if (free_list.blocks.empty()) return nullptr;
+
+        auto ptr = free_list.blocks.back();
+        free_list.blocks.pop_back();
+        bytes_shared.fetch_sub(bytes, std::memory_order_relaxed);
+        bytes_cached.fetch_sub(bytes, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    void hoMemoryPool::put_cached(void* ptr, size_t index)
+    {
+        auto bytes = class_bytes(index);
+        {
+            auto cache = thread_cache();
+            std::lock_guard<std::mutex> guard(cache->m);
+            if (cache->bytes + bytes <= options.thread_cache_bytes) {
+                cache->blocks[index].push_back(ptr);
+                cache->bytes += bytes;
+                bytes_cached.fetch_add(bytes, std::memory_order_relaxed);
+                return;
+            }
+        }
+        put_shared(ptr, index);
+    }
+
+    void hoMemoryPool::put_shared(void* ptr, size_t index)
+    {
+        auto bytes = class_bytes(index);
+        if (bytes_shared.fetch_add(bytes, std::memory_order_relaxed) + bytes > options.max_cached_bytes) {
+            bytes_shared.fetch_sub(bytes, std::memory_order_relaxed);
+            free_block(ptr, bytes);
+            return;
+        }
+
+        auto& free_list = free_lists[index];
+        std::lock_guard<std::mutex> guard(free_list.m);
+        free_list.blocks.push_back(ptr);
+        bytes_cached.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void* hoMemoryPool::allocate_block(size_t bytes)
+    {
+        auto huge = bytes >= options.huge_page_threshold;
+        auto alignment = huge ? std::max(options.alignment, huge_page_size) : options.alignment;
+
+        auto ptr = boost::alignment::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+        if (!ptr) throw std::bad_alloc();
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (huge) madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+        return ptr;
+    }
+
+    void hoMemoryPool::free_block(void* ptr, size_t)
+    {
+        boost::alignment::aligned_free(ptr);
+    }
+
+    void* hoMemoryPool::allocate(size_t bytes)
+    {
+        if (bytes > (size_t(1) << 62)) throw std::bad_alloc();
+
+        auto index = class_index(bytes);
+        auto size = class_bytes(index);
+
+        auto ptr = take_cached(index);
+        auto hit = ptr != nullptr;
+        if (!hit) ptr = allocate_block(size);
+
+        auto account = hoMemoryAccount::current();
+        if (account) account->charge(size, hit);
+
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (hit) pool_hits.fetch_add(1, std::memory_order_relaxed);
+        update_peak(peak_bytes_in_use, bytes_in_use.fetch_add(size, std::memory_order_relaxed) + size);
+
+        auto& shard = shard_of(ptr);
+        std::lock_guard<std::mutex> guard(shard.m);
+        shard.blocks.emplace(ptr, Block{ static_cast<uint8_t>(index), std::move(account) });
+        return ptr;
+    }
+
+    bool hoMemoryPool::deallocate(void* ptr)
+    {
+        Block block;
+        {
+            auto& shard = shard_of(ptr);
+            std::lock_guard<std::mutex> guard(shard.m);
+            auto it = shard.blocks.find(ptr);
+            if (it == shard.blocks.end()) return false;
+            block = std::move(it->second);
+            shard.blocks.erase(it);
+        }
+
+        auto size = class_bytes(block.size_class);
+        if (block.account) block.account->credit(size);
+        bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+
+        put_cached(ptr, block.size_class);
+        return true;
+    }
+
+    void hoMemoryPool::trim()
+    {
+        {
+            auto cache = thread_cache();
+            std::lock_guard<std::mutex> guard(cache->m);
+            for (size_t index = 0; index < number_of_classes; index++) {
+                for (auto ptr : cache->blocks[index]) {
+                    bytes_cached.fetch_sub(class_bytes(index), std::memory_order_relaxed);
+                    free_block(ptr, class_bytes(index));
+                }
+                cache->blocks[index].clear();
+            }
+            cache->bytes = 0;
+        }
+
+        for (size_t index = 0; index < number_of_classes; index++) {
+            auto& free_list = free_lists[index];
+            std::lock_guard<std::mutex> guard(free_list.m);
+            for (auto ptr : free_list.blocks) {
+                bytes_shared.fetch_sub(class_bytes(index), std::memory_order_relaxed);
+                bytes_cached.fetch_sub(class_bytes(index), std::memory_order_relaxed);
+                free_block(ptr, class_bytes(index));
+            }
+            free_list.blocks.clear();
+        }
+    }
+
+    hoMemoryStatistics hoMemoryPool::statistics() const
+    {
+        hoMemoryStatistics stats;
+        stats.allocations = allocations.load(std::memory_order_relaxed);
+        stats.pool_hits = pool_hits.load(std::memory_order_relaxed);
+        stats.bytes_in_use = bytes_in_use.load(std::memory_order_relaxed);
+        stats.peak_bytes_in_use = peak_bytes_in_use.load(std::memory_order_relaxed);
+        stats.bytes_cached = bytes_cached.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
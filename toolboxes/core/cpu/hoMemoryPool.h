@@ -0,0 +1,168 @@
+/** \file hoMemoryPool.h
+    \brief Size-class memory pool with per thread caches, usable as the hoNDArray allocator
+*/
+
+#pragma once
+
+#include "hoNDArrayAllocator.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Gadgetron
+{
+    struct hoMemoryStatistics
+    {
+        size_t allocations = 0;         // Number of allocations
+        size_t pool_hits = 0;           // Allocations served from memory already held by the pool
+        size_t bytes_in_use = 0;        // Bytes currently allocated, rounded up to the size class
+        size_t peak_bytes_in_use = 0;   // Largest value bytes_in_use has had
+        size_t bytes_cached = 0;        // Bytes released but kept by the pool for reuse. Only reported by the pool.
+
+        double hit_rate() const { return allocations ? double(pool_hits) / allocations : 0.0; }
+    };
+
+    /**
+     * Accounts for the memory allocated by a group of threads, e.g. the threads of one connection.
+     *
+     * The account current on a thread when memory is allocated is charged for it, until the memory is released on
+     * any thread. Threads without an account of their own, such as OpenMP threads, charge the process account.
+     */
+    class EXPORTCPUCORE hoMemoryAccount
+    {
+    public:
+        hoMemoryStatistics statistics() const;
+
+        /// The account charged for allocations on this thread: its own if it has one, otherwise the process account.
+        static std::shared_ptr<hoMemoryAccount> current();
+
+        /// Sets the account charged on threads without one of their own, e.g. by a connection which has its process
+        /// to itself. May be nullptr.
+        static void set_process(std::shared_ptr<hoMemoryAccount> account);
+        static std::shared_ptr<hoMemoryAccount> process();
+
+        /// Makes an account current on this thread for the lifetime of the scope.
+        class EXPORTCPUCORE Scope
+        {
+        public:
+            explicit Scope(std::shared_ptr<hoMemoryAccount> account);
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            std::shared_ptr<hoMemoryAccount> previous;
+        };
+
+    private:
+        friend class hoMemoryPool;
+
+        void charge(size_t bytes, bool hit);
+        void credit(size_t bytes);
+
+        std::atomic<size_t> allocations{ 0 };
+        std::atomic<size_t> pool_hits{ 0 };
+        std::atomic<size_t> bytes_in_use{ 0 };
+        std::atomic<size_t> peak_bytes_in_use{ 0 };
+    };
+
+    /**
+     * A pool of aligned memory blocks, rounded up to size classes four to each power of two.
+     *
+     * Released blocks are kept for reuse, first in a cache private to the releasing thread and then in a cache shared
+     * by all threads, so that recon chains allocating identically shaped buffers for every slice and repetition do not
+     * go back to the operating system. Blocks at least huge_page_threshold bytes large are aligned to, and advised
+     * as, transparent huge pages where the platform supports it.
+     */
+    class EXPORTCPUCORE hoMemoryPool : public hoNDArrayAllocator
+    {
+    public:
+        struct Options
+        {
+            size_t alignment = 64;
+            size_t huge_page_threshold = size_t(2) << 20;
+            size_t max_cached_bytes = size_t(1) << 30;      // Released memory kept across all threads
+            size_t thread_cache_bytes = size_t(64) << 20;   // Released memory kept by each thread
+        };
+
+        hoMemoryPool();
+        explicit hoMemoryPool(Options options);
+        ~hoMemoryPool() override;
+
+        hoMemoryPool(const hoMemoryPool&) = delete;
+        hoMemoryPool& operator=(const hoMemoryPool&) = delete;
+
+        size_t alignment() const override { return options.alignment; }
+
+        void* allocate(size_t bytes) override;
+        bool deallocate(void* ptr) override;
+
+        /// Returns all cached memory to the operating system. Blocks cached by other threads are left alone.
+        void trim();
+
+        hoMemoryStatistics statistics() const;
+
+        /// Size of the block used for an allocation of bytes.
+        static size_t size_class(size_t bytes);
+
+    private:
+        static constexpr size_t number_of_classes = 256;
+        static constexpr size_t number_of_shards = 64;
+
+        struct Block
+        {
+            uint8_t size_class;
+            std::shared_ptr<hoMemoryAccount> account;
+        };
+
+        struct Shard
+        {
+            std::mutex m;
+            std::unordered_map<void*, Block> blocks;
+        };
+
+        struct FreeList
+        {
+            std::mutex m;
+            std::vector<void*> blocks;
+        };
+
+        struct ThreadCache;
+
+        static size_t class_index(size_t bytes);
+        static size_t class_bytes(size_t index);
+
+        Shard& shard_of(void* ptr);
+        ThreadCache* thread_cache();
+        void flush(ThreadCache& cache);
+
+        void* take_cached(size_t index);
+        void put_cached(void* ptr, size_t index);
+        void put_shared(void* ptr, size_t index);
+
+        void* allocate_block(size_t bytes);
+        void free_block(void* ptr, size_t bytes);
+
+        const Options options;
+        const uint64_t id;
+
+        std::array<Shard, number_of_shards> shards;
+        std::array<FreeList, number_of_classes> free_lists;
+
+        std::mutex caches_mutex;
+        std::vector<std::weak_ptr<ThreadCache>> caches;
+
+        std::atomic<size_t> allocations{ 0 };
+        std::atomic<size_t> pool_hits{ 0 };
+        std::atomic<size_t> bytes_in_use{ 0 };
+        std::atomic<size_t> peak_bytes_in_use{ 0 };
+        std::atomic<size_t> bytes_cached{ 0 };
+        std::atomic<size_t> bytes_shared{ 0 };
+    };
+}
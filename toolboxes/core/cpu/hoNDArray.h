@@ -11,6 +11,7 @@
 #include <boost/shared_ptr.hpp>
 #include <stdexcept>
 #include "TypeTraits.h"
+#include "hoNDArrayAllocator.h"
 
 namespace Gadgetron{
 
@@ -313,15 +314,28 @@ namespace Gadgetron{
     virtual void deallocate_memory();
 
     // Generic allocator / deallocator
+    // Uses the installed hoNDArrayAllocator, if any, for types that need no destructor.
     //
 
+    template<class X> static constexpr bool _use_allocator = std::is_trivially_destructible<X>::value && alignof(X) <= 64;
+
     template<class X> void _allocate_memory( size_t size, X** data )
     {
+      if constexpr (_use_allocator<X>) {
+        if (auto allocator = hoNDArrayAllocator::get()) {
+          *data = static_cast<X*>(allocator->allocate(size*sizeof(X)));
+          std::uninitialized_default_construct_n(*data, size);
+          return;
+        }
+      }
       *data = new X[size];
     }
 
     template<class X> void _deallocate_memory( X* data )
     {
+      if constexpr (_use_allocator<X>) {
+        if (hoNDArrayAllocator::release(data)) return;
+      }
       delete [] data;
     }
 
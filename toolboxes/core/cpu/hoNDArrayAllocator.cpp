@@ -0,0 +1,65 @@
+#include "hoNDArrayAllocator.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Gadgetron
+{
+    namespace
+    {
+        struct InstalledAllocators
+        {
+            std::mutex m;
+            std::vector<std::shared_ptr<hoNDArrayAllocator>> allocators;
+            std::atomic<hoNDArrayAllocator*> current{ nullptr };
+            std::atomic<bool> any_installed{ false };
+        };
+
+        InstalledAllocators& installed()
+        {
+            // Never destroyed; arrays with static storage duration may be released after main returns.
+            static auto allocators = new InstalledAllocators();
+            return *allocators;
+        }
+    }
+
+    hoNDArrayAllocator* hoNDArrayAllocator::get()
+    {
+        return installed().current.load(std::memory_order_acquire);
+    }
+
+    void hoNDArrayAllocator::set(std::shared_ptr<hoNDArrayAllocator> allocator)
+    {
+        auto& state = installed();
+        std::lock_guard<std::mutex> guard(state.m);
+
+        if (allocator)
+        {
+            state.allocators.push_back(allocator);
+            state.any_installed.store(true, std::memory_order_release);
+        }
+        state.current.store(allocator.get(), std::memory_order_release);
+    }
+
+    bool hoNDArrayAllocator::release(void* ptr)
+    {
+        auto& state = installed();
+        if (!state.any_installed.load(std::memory_order_acquire)) return false;
+
+        auto current = state.current.load(std::memory_order_acquire);
+        if (current && current->deallocate(ptr)) return true;
+
+        std::vector<std::shared_ptr<hoNDArrayAllocator>> allocators;
+        {
+            std::lock_guard<std::mutex> guard(state.m);
+            allocators = state.allocators;
+        }
+
+        for (auto& allocator : allocators)
+        {
+            if (allocator.get() != current && allocator->deallocate(ptr)) return true;
+        }
+        return false;
+    }
+}
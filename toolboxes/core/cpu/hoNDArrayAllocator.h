@@ -0,0 +1,48 @@
+/** \file hoNDArrayAllocator.h
+    \brief Pluggable allocator for the data of hoNDArrays
+*/
+
+#pragma once
+
+#include "cpucore_export.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace Gadgetron
+{
+    /**
+     * Interface for the memory backing hoNDArray data.
+     *
+     * By default hoNDArrays allocate with new[] and delete[]. Once an allocator is installed, arrays of trivially
+     * destructible types are allocated through it instead. Memory handed to an array from outside (create with
+     * delete_data_on_destruct) is still released with delete[], so allocators must be able to tell their own
+     * pointers apart from foreign ones.
+     */
+    class EXPORTCPUCORE hoNDArrayAllocator
+    {
+    public:
+        virtual ~hoNDArrayAllocator() = default;
+
+        /// Alignment guaranteed for every allocation.
+        virtual size_t alignment() const = 0;
+
+        /// Returns at least bytes of memory. Throws std::bad_alloc on failure.
+        virtual void* allocate(size_t bytes) = 0;
+
+        /// Releases memory returned by allocate. Returns false if ptr was not allocated by this allocator.
+        virtual bool deallocate(void* ptr) = 0;
+
+        /// The allocator used for new arrays, or nullptr if arrays use new[].
+        static hoNDArrayAllocator* get();
+
+        /**
+         * Installs the allocator used for new arrays. Pass nullptr to go back to new[].
+         * Previously installed allocators are kept alive, as arrays allocated by them may still be around.
+         */
+        static void set(std::shared_ptr<hoNDArrayAllocator> allocator);
+
+        /// Hands ptr back to the installed allocator that owns it. Returns false if none of them do.
+        static bool release(void* ptr);
+    };
+}
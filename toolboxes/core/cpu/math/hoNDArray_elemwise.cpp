@@ -32,6 +32,11 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
+        if constexpr (::gadgetron_detail::is_simd_complex<T>::value) {
+            SIMD::conjugate(x.get_number_of_elements(), reinterpret_cast<const std::complex<float>*>(x.get_data_ptr()),
+                reinterpret_cast<std::complex<float>*>(r.get_data_ptr()));
+            return;
+        }
         Gadgetron::transform(x,r,[](auto val){return conj(val);});
     }
 
@@ -102,6 +107,10 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
+        if constexpr (::gadgetron_detail::is_simd_complex<T>::value && std::is_same<R, float>::value) {
+            SIMD::abs(x.get_number_of_elements(), reinterpret_cast<const std::complex<float>*>(x.get_data_ptr()), r.get_data_ptr());
+            return;
+        }
         transform(x,r,[](auto val){return abs(val);});
     }
 
@@ -27,6 +27,7 @@
 
 #include "hoNDArray.h"
 #include "cpp_blas.h"
+#include "hoNDArray_simd.h"
 
 #include <complex>
 
@@ -62,9 +62,8 @@ namespace {
                 std::forward<BinaryFunction>(op));
         }
 
-        template <class T, class S, class BinaryFunction>
-        void transform_arrays(const hoNDArray<T>& x, const hoNDArray<S>& y,
-            hoNDArray<typename mathReturnType<T, S>::type>& r, BinaryFunction&& op) {
+        template <class T, class S>
+        void prepare_result(const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
             // Check the dimensions os x and y for broadcasting.
             if (!compatible_dimensions<T, S>(x, y)) {
                 throw std::runtime_error("add: x and y have incompatible dimensions.");
@@ -85,10 +84,70 @@ namespace {
                     r.create(y.dimensions());
                 }
             }
+        }
+
+        template <class T, class S, class BinaryFunction>
+        void transform_arrays(const hoNDArray<T>& x, const hoNDArray<S>& y,
+            hoNDArray<typename mathReturnType<T, S>::type>& r, BinaryFunction&& op) {
+            prepare_result(x, y, r);
 
             transform_impl(x.get_number_of_elements(), y.get_number_of_elements(), x.begin(), y.begin(), r.begin(),
                 std::forward<BinaryFunction>(op));
         }
+
+        // --------------------------------------------------------------------------------
+
+        // Element types laid out as interleaved single precision pairs, which the SIMD kernels work on
+        template <class T> struct is_simd_complex : std::false_type {};
+        template <> struct is_simd_complex<std::complex<float>> : std::true_type {};
+        template <> struct is_simd_complex<Gadgetron::complext<float>> : std::true_type {};
+
+        template <class T, class S>
+        constexpr bool use_simd_kernels = is_simd_complex<T>::value && std::is_same<T, S>::value;
+
+        // internal low level function applying a SIMD kernel, with the same broadcasting as transform_impl
+        template <class T, class Kernel>
+        inline void transform_simd(size_t sizeX, size_t sizeY, const T* x, const T* y, T* r, Kernel kernel) {
+
+            const std::complex<float>* a = reinterpret_cast<const std::complex<float>*>(x);
+            const std::complex<float>* b = reinterpret_cast<const std::complex<float>*>(y);
+            std::complex<float>* c = reinterpret_cast<std::complex<float>*>(r);
+
+            if (sizeX == sizeY) {
+                kernel(sizeX, a, b, c);
+            } else {
+                size_t outerloopsize = sizeX / sizeY;
+                size_t innerloopsize = sizeX / outerloopsize;
+                for (size_t outer = 0; outer < outerloopsize; outer++) {
+                    size_t offset = outer * innerloopsize;
+                    kernel(innerloopsize, a + offset, b, c + offset);
+                }
+            }
+        }
+
+        // transform_arrays, using kernel instead of op for single precision complex arrays
+        template <class T, class S, class BinaryFunction, class Kernel>
+        void transform_arrays(const hoNDArray<T>& x, const hoNDArray<S>& y,
+            hoNDArray<typename mathReturnType<T, S>::type>& r, BinaryFunction&& op, Kernel kernel) {
+            if constexpr (use_simd_kernels<T, S>) {
+                prepare_result(x, y, r);
+                transform_simd(x.get_number_of_elements(), y.get_number_of_elements(), x.begin(), y.begin(), r.begin(), kernel);
+            } else {
+                transform_arrays(x, y, r, std::forward<BinaryFunction>(op));
+            }
+        }
+
+        template <class T, class S, class BinaryFunction, class Kernel>
+        void transform_arrays_inplace(hoNDArray<T>& x, const hoNDArray<S>& y, BinaryFunction&& op, Kernel kernel) {
+            if constexpr (use_simd_kernels<T, S>) {
+                if (!compatible_dimensions<T, S>(x, y)) {
+                    throw std::runtime_error("add: x and y have incompatible dimensions.");
+                }
+                transform_simd(x.get_number_of_elements(), y.get_number_of_elements(), x.data(), y.data(), x.data(), kernel);
+            } else {
+                transform_arrays_inplace(x, y, std::forward<BinaryFunction>(op));
+            }
+        }
     }
 }
 
@@ -106,7 +165,7 @@ void Gadgetron::subtract(
 template <class T, class S>
 void Gadgetron::multiply(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, std::multiplies<>());
+    ::gadgetron_detail::transform_arrays(x, y, r, std::multiplies<>(), SIMD::kernels().multiply);
 }
 
 template <class T, class S>
@@ -117,7 +176,7 @@ void Gadgetron::divide(
 template <class T, class S>
 void Gadgetron::multiplyConj(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, [](auto& a, auto& b) { return a * conj(b); });
+    ::gadgetron_detail::transform_arrays(x, y, r, [](auto& a, auto& b) { return a * conj(b); }, SIMD::kernels().multiply_conj);
 }
 
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator+=(hoNDArray<T>& x, const hoNDArray<S>& y) {
@@ -129,7 +188,7 @@ template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator-=(hoNDA
     return x;
 }
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator*=(hoNDArray<T>& x, const hoNDArray<S>& y) {
-    ::gadgetron_detail::transform_arrays_inplace(x, y, std::multiplies<>());
+    ::gadgetron_detail::transform_arrays_inplace(x, y, std::multiplies<>(), SIMD::kernels().multiply);
     return x;
 }
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator/=(hoNDArray<T>& x, const hoNDArray<S>& y) {
@@ -0,0 +1,322 @@
+/** \file hoNDArray_expressions.h
+    \brief Lazily evaluated elementwise arithmetic on hoNDArray.
+
+    Building an expression such as a * lazy(x) + b * lazy(y) allocates nothing and touches no data;
+    the whole expression is computed in one parallel loop when it is evaluated into an array or summed.
+    This avoids the temporaries and the extra passes over memory of chained hoNDArray operators.
+
+    The layer is opt-in: the operators only apply to expression types, so hoNDArray arithmetic is unchanged.
+
+    \code
+    using namespace Gadgetron::Expressions;
+    evaluate(a * lazy(x) + b * lazy(y), r);                   // r = a*x + b*y
+    auto xy = sum(conj(lazy(x)) * lazy(y));                    // dot product
+    evaluate(abs(lazy(x)) * lazy(mask), magnitude);            // masked magnitude
+    \endcode
+
+    Complex values are computed as complext, whose arithmetic is free of the NaN handling of std::complex,
+    so the loops can be vectorised.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+#include "complext.h"
+
+#include <complex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron {
+    namespace Expressions {
+
+        namespace detail {
+            /// Arrays smaller than this are evaluated on a single thread
+            constexpr size_t parallel_threshold = 64 * 1024;
+
+            /// Type used inside the expressions for elements of type T
+            template <class T> struct compute_type { using type = T; };
+            template <class T> struct compute_type<std::complex<T>> { using type = complext<T>; };
+            template <class T> using compute_type_t = typename compute_type<T>::type;
+
+            /// Type used to accumulate sums of T
+            template <class T> struct accumulation_type { using type = T; };
+            template <> struct accumulation_type<float> { using type = double; };
+            template <> struct accumulation_type<complext<float>> { using type = complext<double>; };
+            template <class T> using accumulation_type_t = typename accumulation_type<T>::type;
+
+            template <class T> struct is_complex : std::false_type {};
+            template <class T> struct is_complex<complext<T>> : std::true_type {};
+            template <class T> struct is_complex<std::complex<T>> : std::true_type {};
+
+            template <class T> struct is_scalar
+                : std::integral_constant<bool, std::is_arithmetic<T>::value || is_complex<T>::value> {};
+        }
+
+        /// Base of all expressions; E is the concrete expression type
+        template <class E> struct Expression {
+            const E& self() const { return static_cast<const E&>(*this); }
+        };
+
+        template <class E>
+        using is_expression = std::is_base_of<Expression<E>, E>;
+
+        /// Leaf referring to the data of an array, which must outlive the expression
+        template <class T> class Terminal : public Expression<Terminal<T>> {
+        public:
+            using value_type = detail::compute_type_t<T>;
+
+            explicit Terminal(const hoNDArray<T>& array)
+                : data_(reinterpret_cast<const value_type*>(array.get_data_ptr())), array_(&array) {}
+
+            value_type operator[](size_t n) const { return data_[n]; }
+            size_t size() const { return array_->get_number_of_elements(); }
+            const std::vector<size_t>& dimensions() const { return array_->dimensions(); }
+
+        private:
+            const value_type* data_;
+            const hoNDArray<T>* array_;
+        };
+
+        /// Leaf holding a value broadcast to every element
+        template <class T> class Constant : public Expression<Constant<T>> {
+        public:
+            using value_type = detail::compute_type_t<T>;
+
+            explicit Constant(T value) : value_(value_type(value)) {}
+
+            value_type operator[](size_t) const { return value_; }
+
+        private:
+            value_type value_;
+        };
+
+        template <class Op, class A> class Unary : public Expression<Unary<Op, A>> {
+        public:
+            using value_type = decltype(Op::apply(std::declval<typename A::value_type>()));
+
+            explicit Unary(const A& a) : a_(a) {}
+
+            value_type operator[](size_t n) const { return Op::apply(a_[n]); }
+            size_t size() const { return a_.size(); }
+            const std::vector<size_t>& dimensions() const { return a_.dimensions(); }
+
+        private:
+            A a_;
+        };
+
+        namespace detail {
+            template <class E> struct has_size : std::true_type {};
+            template <class T> struct has_size<Constant<T>> : std::false_type {};
+        }
+
+        template <class Op, class A, class B> class Binary : public Expression<Binary<Op, A, B>> {
+        public:
+            using value_type
+                = decltype(Op::apply(std::declval<typename A::value_type>(), std::declval<typename B::value_type>()));
+
+            Binary(const A& a, const B& b) : a_(a), b_(b) {
+                if constexpr (detail::has_size<A>::value && detail::has_size<B>::value) {
+                    if (a_.size() != b_.size())
+                        throw std::runtime_error("Expressions: operands have different numbers of elements");
+                }
+            }
+
+            value_type operator[](size_t n) const { return Op::apply(a_[n], b_[n]); }
+
+            // Constants have no size, so the size and dimensions come from whichever operand is an array.
+            size_t size() const {
+                if constexpr (detail::has_size<A>::value) return a_.size();
+                else return b_.size();
+            }
+
+            const std::vector<size_t>& dimensions() const {
+                if constexpr (detail::has_size<A>::value) return a_.dimensions();
+                else return b_.dimensions();
+            }
+
+        private:
+            A a_;
+            B b_;
+        };
+
+        namespace ops {
+            struct add { template <class X, class Y> static auto apply(X x, Y y) { return x + y; } };
+            struct subtract {
+                template <class X, class Y> static auto apply(X x, Y y) {
+                    // complext.h's real minus complext keeps the sign of the imaginary part, so promote first.
+                    if constexpr (!detail::is_complex<X>::value && detail::is_complex<Y>::value) return Y(x) - y;
+                    else return x - y;
+                }
+            };
+            struct multiply { template <class X, class Y> static auto apply(X x, Y y) { return x * y; } };
+            struct divide { template <class X, class Y> static auto apply(X x, Y y) { return x / y; } };
+            struct negate { template <class X> static auto apply(X x) { return -x; } };
+
+            struct conjugate {
+                template <class X> static X apply(X x) {
+                    if constexpr (detail::is_complex<X>::value) return X(x.real(), -x.imag());
+                    else return x;
+                }
+            };
+
+            struct absolute {
+                template <class X> static auto apply(X x) {
+                    if constexpr (detail::is_complex<X>::value) return std::sqrt(x.real() * x.real() + x.imag() * x.imag());
+                    else return std::abs(x);
+                }
+            };
+
+            struct abs_square {
+                template <class X> static auto apply(X x) {
+                    if constexpr (detail::is_complex<X>::value) return x.real() * x.real() + x.imag() * x.imag();
+                    else return x * x;
+                }
+            };
+        }
+
+        /// Wraps an array as an expression; the array must outlive the expression
+        template <class T> Terminal<T> lazy(const hoNDArray<T>& array) { return Terminal<T>(array); }
+
+        // Each operator combines two expressions, or an expression and a scalar. At least one operand must be an
+        // expression, so plain hoNDArray arithmetic is left alone.
+        // The generic operators of complext.h match complext scalars as well as these do, so complext scalars get
+        // overloads for each expression type, which are more specialised than both.
+#define GADGETRON_EXPRESSION_COMPLEXT_OPERATOR(OPERATOR, OP, TEMPLATE_PARAMETERS, EXPRESSION)                            \
+        template <class T, TEMPLATE_PARAMETERS> auto OPERATOR(const EXPRESSION& a, const complext<T>& b) {               \
+            return Binary<OP, EXPRESSION, Constant<complext<T>>>(a, Constant<complext<T>>(b));                          \
+        }                                                                                                                 \
+        template <class T, TEMPLATE_PARAMETERS> auto OPERATOR(const complext<T>& a, const EXPRESSION& b) {               \
+            return Binary<OP, Constant<complext<T>>, EXPRESSION>(Constant<complext<T>>(a), b);                          \
+        }
+
+#define GADGETRON_EXPRESSION_COMMA ,
+
+#define GADGETRON_EXPRESSION_OPERATOR(OPERATOR, OP)                                                                      \
+        template <class A, class B>                                                                                       \
+        auto OPERATOR(const A& a, const B& b)                                                                             \
+            -> std::enable_if_t<is_expression<A>::value && is_expression<B>::value, Binary<OP, A, B>> {                  \
+            return Binary<OP, A, B>(a, b);                                                                                \
+        }                                                                                                                 \
+        template <class A, class S>                                                                                       \
+        auto OPERATOR(const A& a, const S& b)                                                                             \
+            -> std::enable_if_t<is_expression<A>::value && detail::is_scalar<S>::value, Binary<OP, A, Constant<S>>> {    \
+            return Binary<OP, A, Constant<S>>(a, Constant<S>(b));                                                         \
+        }                                                                                                                 \
+        template <class S, class B>                                                                                       \
+        auto OPERATOR(const S& a, const B& b)                                                                             \
+            -> std::enable_if_t<detail::is_scalar<S>::value && is_expression<B>::value, Binary<OP, Constant<S>, B>> {    \
+            return Binary<OP, Constant<S>, B>(Constant<S>(a), b);                                                         \
+        }                                                                                                                 \
+        GADGETRON_EXPRESSION_COMPLEXT_OPERATOR(OPERATOR, OP, class U, Terminal<U>)                                        \
+        GADGETRON_EXPRESSION_COMPLEXT_OPERATOR(OPERATOR, OP, class O GADGETRON_EXPRESSION_COMMA class X,                  \
+            Unary<O GADGETRON_EXPRESSION_COMMA X>)                                                                        \
+        GADGETRON_EXPRESSION_COMPLEXT_OPERATOR(OPERATOR, OP, class O GADGETRON_EXPRESSION_COMMA class X                   \
+            GADGETRON_EXPRESSION_COMMA class Y, Binary<O GADGETRON_EXPRESSION_COMMA X GADGETRON_EXPRESSION_COMMA Y>)
+
+        GADGETRON_EXPRESSION_OPERATOR(operator+, ops::add)
+        GADGETRON_EXPRESSION_OPERATOR(operator-, ops::subtract)
+        GADGETRON_EXPRESSION_OPERATOR(operator*, ops::multiply)
+        GADGETRON_EXPRESSION_OPERATOR(operator/, ops::divide)
+
+#undef GADGETRON_EXPRESSION_OPERATOR
+#undef GADGETRON_EXPRESSION_COMMA
+#undef GADGETRON_EXPRESSION_COMPLEXT_OPERATOR
+
+        template <class E> Unary<ops::negate, E> operator-(const Expression<E>& e) { return Unary<ops::negate, E>(e.self()); }
+
+        template <class E> Unary<ops::conjugate, E> conj(const Expression<E>& e) { return Unary<ops::conjugate, E>(e.self()); }
+
+        template <class E> Unary<ops::absolute, E> abs(const Expression<E>& e) { return Unary<ops::absolute, E>(e.self()); }
+
+        template <class E> Unary<ops::abs_square, E> abs_square(const Expression<E>& e) {
+            return Unary<ops::abs_square, E>(e.self());
+        }
+
+        /**
+        * @brief Computes the expression elementwise into r in a single pass
+          r is created with the dimensions of the expression unless it already holds the same number of elements.
+          r may be one of the arrays of the expression.
+        */
+        template <class E, class T> void evaluate(const Expression<E>& expression, hoNDArray<T>& r) {
+            const E& e = expression.self();
+            const size_t N = e.size();
+
+            if (r.get_number_of_elements() != N) r.create(e.dimensions());
+
+            using value_type = detail::compute_type_t<T>;
+            value_type* pr = reinterpret_cast<value_type*>(r.get_data_ptr());
+
+            long long n;
+#pragma omp parallel for private(n) shared(e, pr) if (N > detail::parallel_threshold)
+            for (n = 0; n < (long long)N; n++) {
+                pr[n] = value_type(e[n]);
+            }
+        }
+
+        /// Sum of all elements of the expression, accumulated in double precision for single precision data
+        template <class E> auto sum(const Expression<E>& expression) {
+            using accumulation_type = detail::accumulation_type_t<typename E::value_type>;
+
+            const E& e = expression.self();
+            const long long N = (long long)e.size();
+            accumulation_type result = accumulation_type(0);
+
+#pragma omp parallel shared(e, result) if (N > (long long)detail::parallel_threshold)
+            {
+                accumulation_type partial = accumulation_type(0);
+
+                long long n;
+#pragma omp for
+                for (n = 0; n < N; n++) {
+                    partial += accumulation_type(e[n]);
+                }
+
+#pragma omp critical
+                result += partial;
+            }
+
+            return result;
+        }
+
+        /**
+        * @brief Computes the expression into r and returns the sum of |r|^2 over the new values, in a single pass
+          This is the residual update of iterative solvers, which otherwise needs a second pass for the norm.
+        */
+        template <class E, class T> auto evaluate_abs_square_sum(const Expression<E>& expression, hoNDArray<T>& r) {
+            using value_type = detail::compute_type_t<T>;
+            using accumulation_type = detail::accumulation_type_t<typename realType<value_type>::Type>;
+
+            const E& e = expression.self();
+            const long long N = (long long)e.size();
+
+            if (r.get_number_of_elements() != size_t(N)) r.create(e.dimensions());
+            value_type* pr = reinterpret_cast<value_type*>(r.get_data_ptr());
+
+            accumulation_type result = accumulation_type(0);
+
+#pragma omp parallel shared(e, pr, result) if (N > (long long)detail::parallel_threshold)
+            {
+                accumulation_type partial = accumulation_type(0);
+
+                long long n;
+#pragma omp for
+                for (n = 0; n < N; n++) {
+                    value_type v = value_type(e[n]);
+                    pr[n] = v;
+                    partial += accumulation_type(ops::abs_square::apply(v));
+                }
+
+#pragma omp critical
+                result += partial;
+            }
+
+            return result;
+        }
+    }
+}
@@ -2,6 +2,7 @@
 
 #include "cpp_blas.h"
 #include "hoNDArray.h"
+#include "hoNDArray_simd.h"
 #include <complex>
 
 namespace Gadgetron {
@@ -14,6 +15,10 @@ namespace Gadgetron {
      std::complex<T>
     dot(const hoNDArray<std::complex<T>> *x, const hoNDArray<std::complex<T>> *y,
                              bool cc) {
+        if constexpr (std::is_same<T, float>::value) {
+            if (x->get_number_of_elements() <= SIMD::blas_reduction_threshold)
+                return SIMD::dot(x->get_number_of_elements(), x->get_data_ptr(), y->get_data_ptr(), cc);
+        }
         if (cc) {
             return BLAS::dotc(x->get_number_of_elements(), x->get_data_ptr(), 1, y->get_data_ptr(), 1);
         } else {
@@ -48,6 +53,15 @@ namespace Gadgetron {
 
     template<class T>
      typename realType<T>::Type nrm2(const hoNDArray<T> *x) {
+        // short single precision arrays are summed in double precision by the SIMD kernel, no scaling needed;
+        // longer ones are left to BLAS, which uses its threads
+        if (x->get_number_of_elements() <= SIMD::blas_reduction_threshold) {
+            if constexpr (std::is_same<T, float>::value) {
+                return SIMD::nrm2(x->get_number_of_elements(), x->get_data_ptr());
+            } else if constexpr (std::is_same<T, std::complex<float>>::value || std::is_same<T, complext<float>>::value) {
+                return SIMD::nrm2(2 * x->get_number_of_elements(), reinterpret_cast<const float*>(x->get_data_ptr()));
+            }
+        }
         return BLAS::nrm2(x->get_number_of_elements(), x->get_data_ptr(), 1);
     }
 
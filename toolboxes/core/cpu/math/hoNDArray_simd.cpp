@@ -0,0 +1,137 @@
+#include "hoNDArray_simd.h"
+
+#include <cmath>
+
+#if defined(GADGETRON_SIMD_AVX2) || defined(GADGETRON_SIMD_AVX512)
+#include "cpuisa.h"
+#endif
+
+namespace Gadgetron {
+    namespace SIMD {
+
+        // Defined in hoNDArray_simd_avx2.cpp and hoNDArray_simd_avx512.cpp, which are built for their instruction sets
+        // on x86-64 only, as signalled by GADGETRON_SIMD_AVX2 and GADGETRON_SIMD_AVX512.
+#ifdef GADGETRON_SIMD_AVX2
+        const Kernels& avx2_kernels();
+#endif
+#ifdef GADGETRON_SIMD_AVX512
+        const Kernels& avx512_kernels();
+#endif
+    }
+}
+
+namespace {
+    using namespace Gadgetron::SIMD;
+
+    // Written on the real and imaginary parts, so the compiler neither calls out for the NaN
+    // handling of std::complex multiplication nor is stopped from vectorising the loops.
+    void multiply_scalar(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+        const float* b = reinterpret_cast<const float*>(y);
+        float* c = reinterpret_cast<float*>(r);
+
+        for (size_t n = 0; n < N; n++) {
+            float re = a[2 * n] * b[2 * n] - a[2 * n + 1] * b[2 * n + 1];
+            float im = a[2 * n] * b[2 * n + 1] + a[2 * n + 1] * b[2 * n];
+            c[2 * n] = re;
+            c[2 * n + 1] = im;
+        }
+    }
+
+    void multiply_conj_scalar(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+        const float* b = reinterpret_cast<const float*>(y);
+        float* c = reinterpret_cast<float*>(r);
+
+        for (size_t n = 0; n < N; n++) {
+            float re = a[2 * n] * b[2 * n] + a[2 * n + 1] * b[2 * n + 1];
+            float im = a[2 * n + 1] * b[2 * n] - a[2 * n] * b[2 * n + 1];
+            c[2 * n] = re;
+            c[2 * n + 1] = im;
+        }
+    }
+
+    void conjugate_scalar(size_t N, const std::complex<float>* x, std::complex<float>* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+        float* c = reinterpret_cast<float*>(r);
+
+        for (size_t n = 0; n < N; n++) {
+            c[2 * n] = a[2 * n];
+            c[2 * n + 1] = -a[2 * n + 1];
+        }
+    }
+
+    void abs_scalar(size_t N, const std::complex<float>* x, float* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+
+        for (size_t n = 0; n < N; n++) {
+            r[n] = std::sqrt(a[2 * n] * a[2 * n] + a[2 * n + 1] * a[2 * n + 1]);
+        }
+    }
+
+    std::complex<float> dot_scalar(size_t N, const std::complex<float>* x, const std::complex<float>* y, bool cc) {
+        const float* a = reinterpret_cast<const float*>(x);
+        const float* b = reinterpret_cast<const float*>(y);
+        const double sign = cc ? -1.0 : 1.0;
+
+        double re = 0, im = 0;
+        for (size_t n = 0; n < N; n++) {
+            double ar = a[2 * n], ai = sign * a[2 * n + 1], br = b[2 * n], bi = b[2 * n + 1];
+            re += ar * br - ai * bi;
+            im += ar * bi + ai * br;
+        }
+        return { float(re), float(im) };
+    }
+
+    float nrm2_scalar(size_t N, const float* x) {
+        double sum = 0;
+        for (size_t n = 0; n < N; n++) sum += double(x[n]) * x[n];
+        return float(std::sqrt(sum));
+    }
+
+    const Kernels scalar_kernels = {
+        InstructionSet::Scalar,
+        multiply_scalar,
+        multiply_conj_scalar,
+        conjugate_scalar,
+        abs_scalar,
+        dot_scalar,
+        nrm2_scalar
+    };
+
+    const Kernels& select_kernels(InstructionSet instruction_set) {
+        switch (instruction_set) {
+        case InstructionSet::Native:
+        case InstructionSet::Avx512:
+#ifdef GADGETRON_SIMD_AVX512
+            if (CPU_supports_AVX512F() && CPU_supports_AVX512DQ()) {
+                return avx512_kernels();
+            }
+#endif
+            // FALLTHROUGH
+        case InstructionSet::Avx2:
+#ifdef GADGETRON_SIMD_AVX2
+            if (CPU_supports_AVX2() && CPU_supports_FMA()) {
+                return avx2_kernels();
+            }
+#endif
+            break;
+        case InstructionSet::Scalar:
+            break;
+        }
+
+        return scalar_kernels;
+    }
+}
+
+namespace Gadgetron {
+    namespace SIMD {
+
+        const Kernels& kernels(InstructionSet instruction_set) {
+            if (instruction_set != InstructionSet::Native) return select_kernels(instruction_set);
+
+            static const Kernels& native = select_kernels(InstructionSet::Native);
+            return native;
+        }
+    }
+}
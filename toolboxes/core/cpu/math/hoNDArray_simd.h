@@ -0,0 +1,75 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+namespace Gadgetron {
+    namespace SIMD {
+
+        enum class InstructionSet
+        {
+            Native,
+            Scalar,
+            Avx2,
+            Avx512
+        };
+
+        /**
+        * @brief Hand vectorised kernels on contiguous single precision data
+          complex arrays are interleaved (real, imag) pairs, as for std::complex<float> and complext<float>
+          in-place computation is supported, e.g. x==r or y==r
+          products use fused multiply-add where the instruction set has it, so results may differ from the
+          scalar kernels in the last bit
+        */
+        struct Kernels
+        {
+            InstructionSet instruction_set;
+
+            /// r = x * y
+            void (*multiply)(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+            /// r = x * conj(y)
+            void (*multiply_conj)(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+            /// r = conj(x)
+            void (*conjugate)(size_t N, const std::complex<float>* x, std::complex<float>* r);
+            /// r = |x|, computed as sqrt(real^2 + imag^2) without guarding against overflow
+            void (*abs)(size_t N, const std::complex<float>* x, float* r);
+
+            /// sum of conj(x) * y if cc is true, otherwise sum of x * y; accumulated in double precision
+            std::complex<float> (*dot)(size_t N, const std::complex<float>* x, const std::complex<float>* y, bool cc);
+            /// l2-norm of N floats, accumulated in double precision
+            float (*nrm2)(size_t N, const float* x);
+        };
+
+        /// Arrays longer than this are reduced by BLAS, which spreads them over its threads, rather than by the
+        /// single threaded dot and nrm2 kernels
+        constexpr size_t blas_reduction_threshold = size_t(1) << 16;
+
+        /// Kernels for the given instruction set; Native selects the best one supported by the CPU.
+        /// Requesting an instruction set the CPU or the build does not support falls back to the next best one.
+        const Kernels& kernels(InstructionSet instruction_set = InstructionSet::Native);
+
+        inline void multiply(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r) {
+            kernels().multiply(N, x, y, r);
+        }
+
+        inline void multiply_conj(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r) {
+            kernels().multiply_conj(N, x, y, r);
+        }
+
+        inline void conjugate(size_t N, const std::complex<float>* x, std::complex<float>* r) {
+            kernels().conjugate(N, x, r);
+        }
+
+        inline void abs(size_t N, const std::complex<float>* x, float* r) {
+            kernels().abs(N, x, r);
+        }
+
+        inline std::complex<float> dot(size_t N, const std::complex<float>* x, const std::complex<float>* y, bool cc) {
+            return kernels().dot(N, x, y, cc);
+        }
+
+        inline float nrm2(size_t N, const float* x) {
+            return kernels().nrm2(N, x);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+// Built with AVX2 and FMA enabled; only called once the CPU is known to support both.
+
+#include "hoNDArray_simd.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+namespace {
+    using namespace Gadgetron::SIMD;
+
+    // Complex products of the interleaved pairs in a and b; conj selects a * conj(b).
+    template <bool conj> inline __m256 complex_multiply(__m256 a, __m256 b) {
+        __m256 b_re = _mm256_moveldup_ps(b);
+        __m256 b_im = _mm256_movehdup_ps(b);
+        __m256 a_swapped = _mm256_permute_ps(a, 0xB1);
+        __m256 cross = _mm256_mul_ps(a_swapped, b_im);
+
+        // (ar*br - ai*bi, ai*br + ar*bi), or (ar*br + ai*bi, ai*br - ar*bi) for the conjugate.
+        return conj ? _mm256_fmsubadd_ps(a, b_re, cross) : _mm256_fmaddsub_ps(a, b_re, cross);
+    }
+
+    template <bool conj>
+    void multiply_avx2(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+        const float* b = reinterpret_cast<const float*>(y);
+        float* c = reinterpret_cast<float*>(r);
+
+        size_t n = 0;
+        for (; n + 4 <= N; n += 4) {
+            _mm256_storeu_ps(c + 2 * n, complex_multiply<conj>(_mm256_loadu_ps(a + 2 * n), _mm256_loadu_ps(b + 2 * n)));
+        }
+
+        for (; n < N; n++) {
+            float ar = a[2 * n], ai = a[2 * n + 1], br = b[2 * n], bi = conj ? -b[2 * n + 1] : b[2 * n + 1];
+            c[2 * n] = ar * br - ai * bi;
+            c[2 * n + 1] = ai * br + ar * bi;
+        }
+    }
+
+    void conjugate_avx2(size_t N, const std::complex<float>* x, std::complex<float>* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+        float* c = reinterpret_cast<float*>(r);
+
+        const __m256 sign = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+
+        size_t n = 0;
+        for (; n + 4 <= N; n += 4) {
+            _mm256_storeu_ps(c + 2 * n, _mm256_xor_ps(_mm256_loadu_ps(a + 2 * n), sign));
+        }
+
+        for (; n < N; n++) {
+            c[2 * n] = a[2 * n];
+            c[2 * n + 1] = -a[2 * n + 1];
+        }
+    }
+
+    void abs_avx2(size_t N, const std::complex<float>* x, float* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+
+        size_t n = 0;
+        for (; n + 8 <= N; n += 8) {
+            __m256 lo = _mm256_loadu_ps(a + 2 * n);
+            __m256 hi = _mm256_loadu_ps(a + 2 * n + 8);
+
+            // hadd leaves the squared magnitudes as (0 1 4 5 | 2 3 6 7); the permute restores their order.
+            __m256 sum = _mm256_hadd_ps(_mm256_mul_ps(lo, lo), _mm256_mul_ps(hi, hi));
+            sum = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), 0xD8));
+
+            _mm256_storeu_ps(r + n, _mm256_sqrt_ps(sum));
+        }
+
+        for (; n < N; n++) {
+            r[n] = std::sqrt(a[2 * n] * a[2 * n] + a[2 * n + 1] * a[2 * n + 1]);
+        }
+    }
+
+    inline double horizontal_sum(__m256d v) {
+        __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    }
+
+    std::complex<float> dot_avx2(size_t N, const std::complex<float>* x, const std::complex<float>* y, bool cc) {
+        const float* a = reinterpret_cast<const float*>(x);
+        const float* b = reinterpret_cast<const float*>(y);
+
+        // straight accumulates (ar*br, ai*bi), crossed (ar*bi, ai*br); both products are combined at the end.
+        __m256d straight = _mm256_setzero_pd(), crossed = _mm256_setzero_pd();
+
+        size_t n = 0;
+        for (; n + 2 <= N; n += 2) {
+            __m256d va = _mm256_cvtps_pd(_mm_loadu_ps(a + 2 * n));
+            __m256d vb = _mm256_cvtps_pd(_mm_loadu_ps(b + 2 * n));
+            straight = _mm256_fmadd_pd(va, vb, straight);
+            crossed = _mm256_fmadd_pd(va, _mm256_permute_pd(vb, 0x5), crossed);
+        }
+
+        double s[4], c[4];
+        _mm256_storeu_pd(s, straight);
+        _mm256_storeu_pd(c, crossed);
+
+        double rr = s[0] + s[2], ii = s[1] + s[3], ri = c[0] + c[2], ir = c[1] + c[3];
+        for (; n < N; n++) {
+            rr += double(a[2 * n]) * b[2 * n];
+            ii += double(a[2 * n + 1]) * b[2 * n + 1];
+            ri += double(a[2 * n]) * b[2 * n + 1];
+            ir += double(a[2 * n + 1]) * b[2 * n];
+        }
+
+        if (cc) return { float(rr + ii), float(ri - ir) };
+        return { float(rr - ii), float(ri + ir) };
+    }
+
+    float nrm2_avx2(size_t N, const float* x) {
+        __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+
+        size_t n = 0;
+        for (; n + 8 <= N; n += 8) {
+            __m256d lo = _mm256_cvtps_pd(_mm_loadu_ps(x + n));
+            __m256d hi = _mm256_cvtps_pd(_mm_loadu_ps(x + n + 4));
+            sum0 = _mm256_fmadd_pd(lo, lo, sum0);
+            sum1 = _mm256_fmadd_pd(hi, hi, sum1);
+        }
+
+        double sum = horizontal_sum(_mm256_add_pd(sum0, sum1));
+        for (; n < N; n++) sum += double(x[n]) * x[n];
+
+        return float(std::sqrt(sum));
+    }
+
+    const Kernels kernels_avx2 = {
+        InstructionSet::Avx2,
+        multiply_avx2<false>,
+        multiply_avx2<true>,
+        conjugate_avx2,
+        abs_avx2,
+        dot_avx2,
+        nrm2_avx2
+    };
+}
+
+namespace Gadgetron {
+    namespace SIMD {
+        const Kernels& avx2_kernels() {
+            return kernels_avx2;
+        }
+    }
+}
@@ -0,0 +1,152 @@
+// Built with AVX-512F/DQ enabled; only called once the CPU is known to support both.
+
+#include "hoNDArray_simd.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+namespace {
+    using namespace Gadgetron::SIMD;
+
+    // Mask of the floats holding the last N % 8 complex values.
+    inline __mmask16 tail_mask(size_t remaining) {
+        return __mmask16((1u << (2 * remaining)) - 1);
+    }
+
+    template <bool conj> inline __m512 complex_multiply(__m512 a, __m512 b) {
+        __m512 b_re = _mm512_moveldup_ps(b);
+        __m512 b_im = _mm512_movehdup_ps(b);
+        __m512 a_swapped = _mm512_permute_ps(a, 0xB1);
+        __m512 cross = _mm512_mul_ps(a_swapped, b_im);
+
+        return conj ? _mm512_fmsubadd_ps(a, b_re, cross) : _mm512_fmaddsub_ps(a, b_re, cross);
+    }
+
+    template <bool conj>
+    void multiply_avx512(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+        const float* b = reinterpret_cast<const float*>(y);
+        float* c = reinterpret_cast<float*>(r);
+
+        size_t n = 0;
+        for (; n + 8 <= N; n += 8) {
+            _mm512_storeu_ps(c + 2 * n, complex_multiply<conj>(_mm512_loadu_ps(a + 2 * n), _mm512_loadu_ps(b + 2 * n)));
+        }
+
+        if (n < N) {
+            __mmask16 mask = tail_mask(N - n);
+            __m512 va = _mm512_maskz_loadu_ps(mask, a + 2 * n);
+            __m512 vb = _mm512_maskz_loadu_ps(mask, b + 2 * n);
+            _mm512_mask_storeu_ps(c + 2 * n, mask, complex_multiply<conj>(va, vb));
+        }
+    }
+
+    void conjugate_avx512(size_t N, const std::complex<float>* x, std::complex<float>* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+        float* c = reinterpret_cast<float*>(r);
+
+        const __m512i sign = _mm512_set1_epi64(0x8000000000000000LL);
+
+        size_t n = 0;
+        for (; n + 8 <= N; n += 8) {
+            __m512i v = _mm512_castps_si512(_mm512_loadu_ps(a + 2 * n));
+            _mm512_storeu_ps(c + 2 * n, _mm512_castsi512_ps(_mm512_xor_si512(v, sign)));
+        }
+
+        if (n < N) {
+            __mmask16 mask = tail_mask(N - n);
+            __m512i v = _mm512_castps_si512(_mm512_maskz_loadu_ps(mask, a + 2 * n));
+            _mm512_mask_storeu_ps(c + 2 * n, mask, _mm512_castsi512_ps(_mm512_xor_si512(v, sign)));
+        }
+    }
+
+    void abs_avx512(size_t N, const std::complex<float>* x, float* r) {
+        const float* a = reinterpret_cast<const float*>(x);
+
+        // Picks the even floats of two vectors, which hold the squared magnitudes after adding the swapped squares.
+        const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+
+        size_t n = 0;
+        for (; n + 16 <= N; n += 16) {
+            __m512 lo = _mm512_loadu_ps(a + 2 * n);
+            __m512 hi = _mm512_loadu_ps(a + 2 * n + 16);
+
+            lo = _mm512_mul_ps(lo, lo);
+            hi = _mm512_mul_ps(hi, hi);
+            lo = _mm512_add_ps(lo, _mm512_permute_ps(lo, 0xB1));
+            hi = _mm512_add_ps(hi, _mm512_permute_ps(hi, 0xB1));
+
+            _mm512_storeu_ps(r + n, _mm512_sqrt_ps(_mm512_permutex2var_ps(lo, even, hi)));
+        }
+
+        for (; n < N; n++) {
+            r[n] = std::sqrt(a[2 * n] * a[2 * n] + a[2 * n + 1] * a[2 * n + 1]);
+        }
+    }
+
+    std::complex<float> dot_avx512(size_t N, const std::complex<float>* x, const std::complex<float>* y, bool cc) {
+        const float* a = reinterpret_cast<const float*>(x);
+        const float* b = reinterpret_cast<const float*>(y);
+
+        // straight accumulates (ar*br, ai*bi), crossed (ar*bi, ai*br); both products are combined at the end.
+        __m512d straight = _mm512_setzero_pd(), crossed = _mm512_setzero_pd();
+
+        size_t n = 0;
+        for (; n + 4 <= N; n += 4) {
+            __m512d va = _mm512_cvtps_pd(_mm256_loadu_ps(a + 2 * n));
+            __m512d vb = _mm512_cvtps_pd(_mm256_loadu_ps(b + 2 * n));
+            straight = _mm512_fmadd_pd(va, vb, straight);
+            crossed = _mm512_fmadd_pd(va, _mm512_permute_pd(vb, 0x55), crossed);
+        }
+
+        double rr = _mm512_mask_reduce_add_pd(0x55, straight);
+        double ii = _mm512_mask_reduce_add_pd(0xAA, straight);
+        double ri = _mm512_mask_reduce_add_pd(0x55, crossed);
+        double ir = _mm512_mask_reduce_add_pd(0xAA, crossed);
+
+        for (; n < N; n++) {
+            rr += double(a[2 * n]) * b[2 * n];
+            ii += double(a[2 * n + 1]) * b[2 * n + 1];
+            ri += double(a[2 * n]) * b[2 * n + 1];
+            ir += double(a[2 * n + 1]) * b[2 * n];
+        }
+
+        if (cc) return { float(rr + ii), float(ri - ir) };
+        return { float(rr - ii), float(ri + ir) };
+    }
+
+    float nrm2_avx512(size_t N, const float* x) {
+        __m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd();
+
+        size_t n = 0;
+        for (; n + 16 <= N; n += 16) {
+            __m512d lo = _mm512_cvtps_pd(_mm256_loadu_ps(x + n));
+            __m512d hi = _mm512_cvtps_pd(_mm256_loadu_ps(x + n + 8));
+            sum0 = _mm512_fmadd_pd(lo, lo, sum0);
+            sum1 = _mm512_fmadd_pd(hi, hi, sum1);
+        }
+
+        double sum = _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+        for (; n < N; n++) sum += double(x[n]) * x[n];
+
+        return float(std::sqrt(sum));
+    }
+
+    const Kernels kernels_avx512 = {
+        InstructionSet::Avx512,
+        multiply_avx512<false>,
+        multiply_avx512<true>,
+        conjugate_avx512,
+        abs_avx512,
+        dot_avx512,
+        nrm2_avx512
+    };
+}
+
+namespace Gadgetron {
+    namespace SIMD {
+        const Kernels& avx512_kernels() {
+            return kernels_avx512;
+        }
+    }
+}
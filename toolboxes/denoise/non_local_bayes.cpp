@@ -3,27 +3,48 @@
 #include "vector_td_utilities.h"
 #include <GadgetronTimer.h>
 #include "hoArmadillo.h"
+#include <algorithm>
 #include <numeric>
+#include <vector>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
 
 namespace Gadgetron {
     namespace Denoise {
 
         namespace {
 
+            // Copy of the image with a periodic border of half a patch, so each patch is patch_size contiguous rows.
             template<class T>
-            arma::Col<T> get_patch(const hoNDArray<T> &image, int x, int y, int patch_size,
-                                   const vector_td<int, 2> &image_dims) {
-
-                const int N = patch_size * patch_size;
-                arma::Col<T> window = arma::Col<T>(N);
-                for (int ky = 0; ky < patch_size; ky++) {
-                    for (int kx = 0; kx < patch_size; kx++) {
-                        window[kx + ky * patch_size] = image(
-                                ((kx - patch_size / 2) + x + image_dims[0]) % image_dims[0],
-                                ((ky - patch_size / 2) + y + image_dims[1]) % image_dims[1]);
-
+            struct PaddedImage {
+                PaddedImage(const T *image, int width, int height, int patch_size)
+                    : border(patch_size / 2), stride(width + 2 * (patch_size / 2)),
+                      data(size_t(stride) * (height + 2 * (patch_size / 2))) {
+                    for (int y = 0; y < height + 2 * border; y++) {
+                        const T *row = image + (((y - border) % height + height) % height) * width;
+                        T *padded_row = data.data() + y * stride;
+                        for (int x = 0; x < stride; x++)
+                            padded_row[x] = row[((x - border) % width + width) % width];
                     }
                 }
+
+                // First element of the patch centred on (x, y).
+                const T *patch(int x, int y) const { return data.data() + y * stride + x; }
+
+                int border, stride;
+                std::vector<T> data;
+            };
+
+            template<class T>
+            arma::Col<T> get_patch(const PaddedImage<T> &image, int x, int y, int patch_size) {
+
+                arma::Col<T> window = arma::Col<T>(patch_size * patch_size);
+                const T *patch = image.patch(x, y);
+                for (int ky = 0; ky < patch_size; ky++)
+                    std::copy(patch + ky * image.stride, patch + ky * image.stride + patch_size,
+                              window.memptr() + ky * patch_size);
                 return window;
             };
 
@@ -35,31 +56,62 @@ namespace Gadgetron {
                 int center_x, center_y;
             };
 
+            struct Candidate {
+                float distance;
+                int center_x, center_y;
+            };
+
+            template<class T>
+            float distance(const T *patch1, const T *patch2, int stride, int patch_size) {
+
+                float result = 0;
+                for (int ky = 0; ky < patch_size; ky++) {
+                    const T *row1 = patch1 + ky * stride;
+                    const T *row2 = patch2 + ky * stride;
+                    for (int kx = 0; kx < patch_size; kx++) result += std::norm(row1[kx] - row2[kx]);
+                }
+                return result;
+            };
 
+
+            // Patches of the search window around (kx, ky) most similar to the reference patch.
+            // The distances are computed in place on the padded image, and only the selected patches are copied out.
             template<class T>
             std::vector<ImagePatch<T>>
-            create_patches(const hoNDArray<T> &image, int kx, int ky, int patch_size, int search_window,
-                           const vector_td<int, 2> &image_dims) {
+            find_similar_patches(const PaddedImage<T> &image, int kx, int ky, int patch_size, int search_window,
+                                 int max_n_patches, const vector_td<int, 2> &image_dims,
+                                 std::vector<Candidate> &candidates) {
 
-                std::vector<ImagePatch<T>> result;
-                result.reserve(search_window);
+                const T *reference = image.patch(kx, ky);
 
+                candidates.clear();
                 for (int dy = std::max(ky - search_window / 2, 0);
                      dy < std::min(search_window / 2 + ky, image_dims[1]); dy++) {
                     for (int dx = std::max(kx - search_window / 2, 0);
                          dx < std::min(search_window / 2 + kx, image_dims[0]); dx++) {
 
-                        result.push_back(ImagePatch<T>{get_patch(image, dx, dy, patch_size, image_dims), dx, dy});
+                        candidates.push_back(
+                                Candidate{distance(reference, image.patch(dx, dy), image.stride, patch_size), dx, dy});
                     }
                 }
 
+                const int n_patches = std::min<int>(candidates.size(), max_n_patches);
+                std::partial_sort(candidates.begin(), candidates.begin() + n_patches, candidates.end(),
+                                  [](const Candidate &c1, const Candidate &c2) { return c1.distance < c2.distance; });
+
+                std::vector<ImagePatch<T>> result(n_patches);
+                for (int i = 0; i < n_patches; i++) {
+                    result[i] = ImagePatch<T>{get_patch(image, candidates[i].center_x, candidates[i].center_y,
+                                                        patch_size), candidates[i].center_x, candidates[i].center_y};
+                }
+
                 return result;
 
             };
 
 
             template<class T>
-            void add_patch(ImagePatch<T> &patch, hoNDArray<T> &image, hoNDArray<int> &count, int patch_size,
+            void add_patch(ImagePatch<T> &patch, T *image, int *count, int patch_size,
                            const vector_td<int, 2> &image_dims) {
 
 
@@ -67,25 +119,14 @@ namespace Gadgetron {
                     auto output_ky = (patch.center_y + ky - patch_size / 2 + image_dims[1]) % image_dims[1];
                     for (int kx = 0; kx < patch_size; kx++) {
                         auto output_kx = (patch.center_x + kx - patch_size / 2 + image_dims[0]) % image_dims[0];
-                        image(output_kx, output_ky) += patch.patch[kx + ky * patch_size];
-                        count(output_kx, output_ky)++;
+                        image[output_kx + output_ky * image_dims[0]] += patch.patch[kx + ky * patch_size];
+                        count[output_kx + output_ky * image_dims[0]]++;
                     }
                 }
 
             };
 
 
-            template<class T>
-            float distance(const arma::Col<T> &patch1, const arma::Col<T> &patch2) {
-                arma::Col<T> diff = patch1 - patch2;
-
-                float result = 0;
-                for (auto d : diff) result += std::norm(d);
-
-                result /= patch1.size() * patch1.size();
-                return result;
-            };
-
             template<class T>
             arma::Col<T> get_mean_patch(const std::vector<ImagePatch<T>> &patches) {
 
@@ -115,30 +156,6 @@ namespace Gadgetron {
             }
 
 
-            template<class T>
-            void
-            filter_patches(std::vector<ImagePatch<T>> &patches, int max_n_patches, const arma::Col<T> &reference_patch) {
-
-                auto distances = std::vector<float>(patches.size());
-                transform(patches.begin(), patches.end(), distances.begin(),
-                          [&](auto patch) { return distance(patch.patch, reference_patch); });
-
-                std::vector<size_t> patch_indices(patches.size());
-                std::iota(patch_indices.begin(), patch_indices.end(), 0);
-
-                sort(patch_indices.begin(), patch_indices.end(),
-                     [&](auto v1, auto v2) { return distances[v1] < distances[v2]; });
-
-                int n_patches = std::min<int>(patches.size(),max_n_patches);
-                std::vector<ImagePatch<T>> best_patches(n_patches);
-
-                for (int i = 0; i < n_patches; i++) {
-                    best_patches[i] = std::move(patches[patch_indices[i]]);
-                }
-
-                patches = std::move(best_patches);
-            }
-
             template<class T>
             bool is_homogenous_area(std::vector<ImagePatch<T>> &patches, float noise_std) {
 
@@ -175,54 +192,64 @@ namespace Gadgetron {
 
             }
 
+            // Denoises one image into result. With parallel_pixels set, the reference pixels are split over the
+            // threads, each aggregating its patches into its own buffers.
             template<class T>
-            hoNDArray<T> non_local_bayes_single_image(const hoNDArray<T> &image, float noise_std, int search_window) {
-
-
-                if (image.get_number_of_dimensions() != 2)
-                    throw std::invalid_argument("non_local_bayes: image must be 2 dimensional");
+            void non_local_bayes_single_image(const T *image, T *result, int width, int height, float noise_std,
+                                              int search_window, bool parallel_pixels) {
 
                 constexpr int patch_size = 5;
                 constexpr int n_patches = 50;
 
-                hoNDArray<T> result(image.dimensions());
-                result.fill(0);
+                const size_t elements = size_t(width) * height;
+                const vector_td<int, 2> image_dims(width, height);
+                const PaddedImage<T> padded(image, width, height, patch_size);
 
-                hoNDArray<bool> mask(image.dimensions());
-                mask.fill(true);
+                std::vector<T> sum(elements, T(0));
+                std::vector<int> count(elements, 0);
 
-                hoNDArray<int> count(image.dimensions());
-                count.fill(0);
+                std::vector<unsigned char> mask(elements, 1);
 
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions())
-                );
+#pragma omp parallel if (parallel_pixels)
+                {
+                    std::vector<T> local_sum(elements, T(0));
+                    std::vector<int> local_count(elements, 0);
+                    std::vector<Candidate> candidates;
 
-#pragma omp parallel for num_threads(4)
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
+#pragma omp for schedule(dynamic)
+                    for (int ky = 0; ky < height; ky++) {
+                        for (int kx = 0; kx < width; kx++) {
 
-                        if (mask(kx, ky)) {
-                            auto reference_patch = get_patch(image, kx, ky, patch_size, image_dims);
-                            auto patches = create_patches(image, kx, ky, patch_size, search_window, image_dims);
+                            unsigned char unvisited;
+#pragma omp atomic read
+                            unvisited = mask[kx + ky * width];
 
-                            filter_patches(patches, n_patches, reference_patch);
-                            denoise_patches(patches, noise_std);
+                            if (unvisited) {
+                                auto patches = find_similar_patches(padded, kx, ky, patch_size, search_window,
+                                                                    n_patches, image_dims, candidates);
+                                denoise_patches(patches, noise_std);
 
-                            for (auto &patch : patches) {
-                                #pragma omp critical
-                                add_patch(patch, result, count, patch_size, image_dims);
-                                mask(patch.center_x, patch.center_y) = false;
+                                for (auto &patch : patches) {
+                                    add_patch(patch, local_sum.data(), local_count.data(), patch_size, image_dims);
+#pragma omp atomic write
+                                    mask[patch.center_x + patch.center_y * width] = 0;
+                                }
                             }
                         }
                     }
-                }
 
-                for (size_t i = 0; i < result.get_number_of_elements(); i++) {
-                    result[i] /= count[i];
+#pragma omp critical
+                    {
+                        for (size_t i = 0; i < elements; i++) {
+                            sum[i] += local_sum[i];
+                            count[i] += local_count[i];
+                        }
+                    }
                 }
 
-                return result;
+                for (size_t i = 0; i < elements; i++) {
+                    result[i] = sum[i] / T(count[i]);
+                }
 
             }
 
@@ -230,22 +257,26 @@ namespace Gadgetron {
             template<class T>
             hoNDArray<T> non_local_bayes_T(const hoNDArray<T> &image, float noise_std, unsigned int search_window) {
 
-                size_t n_images = image.get_number_of_elements() / (image.get_size(0) * image.get_size(1));
-
-                std::vector<size_t> image_dims = {image.get_size(0), image.get_size(1)};
-                size_t image_elements = image_dims[0] * image_dims[1];
+                const int width = int(image.get_size(0));
+                const int height = int(image.get_size(1));
+                const size_t image_elements = size_t(width) * height;
+                const long long n_images = (long long)(image.get_number_of_elements() / image_elements);
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                hoNDArray<T> result_view;
-                result_view.create(image_dims);
-                #pragma omp parallel for
-                for (int i = 0; i < n_images; i++) {
-
-                    auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
-
-                    memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
+                // A series with at least one image per thread is split over the images, otherwise each image is
+                // split over its pixels.
+#ifdef USE_OMP
+                const bool parallel_images = n_images >= omp_get_max_threads();
+#else
+                const bool parallel_images = true;
+#endif
+
+                #pragma omp parallel for schedule(dynamic) if (parallel_images)
+                for (long long i = 0; i < n_images; i++) {
+                    non_local_bayes_single_image(image.get_data_ptr() + i * image_elements,
+                                                 result.get_data_ptr() + i * image_elements, width, height,
+                                                 noise_std, int(search_window), !parallel_images);
                 }
                 return result;
             }
@@ -6,67 +6,150 @@
 #include <GadgetronTimer.h>
 #include "non_local_means.h"
 
+#include <algorithm>
+#include <vector>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
 
 namespace Gadgetron {
     namespace Denoise {
 
         namespace {
 
+            constexpr int patch_size = 5;
 
-            template<class T, int D>
-            vector_td<T, D * D> get_patch(const hoNDArray<T> &image, int x, int y,
-                                          const vector_td<int, 2> &image_dims) {
-
-                constexpr int N = D * D;
-                vector_td<T, N> window;
-                for (int ky = 0; ky < D; ky++) {
-                    for (int kx = 0; kx < D; kx++) {
-                        window[kx + ky * D] = image(((kx - D / 2) + x + image_dims[0]) % image_dims[0],
-                                                    ((ky - D / 2) + y + image_dims[1]) % image_dims[1]);
+            inline float squared_difference(float a, float b) {
+                float d = a - b;
+                return d * d;
+            }
 
-                    }
-                }
-                return window;
-            };
+            inline float squared_difference(std::complex<float> a, std::complex<float> b) {
+                return std::norm(a - b);
+            }
 
+            // Periodic neighbour indices, so the inner loops do not need a modulo per element.
+            std::vector<int> wrapped_indices(int size, int offset) {
+                std::vector<int> indices(size);
+                for (int i = 0; i < size; i++) indices[i] = (((i + offset) % size) + size) % size;
+                return indices;
+            }
 
             template<class T>
-            hoNDArray<T> non_local_means_single_image(const hoNDArray<T> &image, float noise_std, int search_radius) {
+            struct OffsetWorkspace {
+                OffsetWorkspace(int width, int height)
+                    : shifted(size_t(width) * height), difference(size_t(width) * height),
+                      row_sums(size_t(width) * height), column_sums(width),
+                      leading_x(wrapped_indices(width, patch_size / 2 + 1)),
+                      trailing_x(wrapped_indices(width, -(patch_size / 2))),
+                      leading_y(wrapped_indices(height, patch_size / 2 + 1)),
+                      trailing_y(wrapped_indices(height, -(patch_size / 2))) {}
+
+                std::vector<T> shifted;
+                std::vector<float> difference;
+                std::vector<float> row_sums;
+                std::vector<double> column_sums;
+                std::vector<int> leading_x, trailing_x, leading_y, trailing_y;
+            };
 
-                constexpr int D = 5;
+            // Adds the weights and weighted values of the search offset (dx, dy) for every pixel.
+            // The patch distances are box sums of the squared difference image, computed as running sums along
+            // x and then y, so the cost per offset is independent of the patch size.
+            template<class T>
+            void accumulate_offset(const T *image, int width, int height, int dx, int dy, float weight_scale,
+                                   OffsetWorkspace<T> &work, float *sum_weight, T *sum_value) {
 
-                hoNDArray<T> result(image.dimensions());
-                const float noise_std2 = noise_std * noise_std;
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions()));
+                constexpr int half = patch_size / 2;
+                const int shift_x = ((dx % width) + width) % width;
 
-#pragma omp parallel for
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
-                        float sum_weight = 0;
-                        T sum_value = 0;
-                        auto window = get_patch<T, D>(image, kx, ky, image_dims);
+                for (int y = 0; y < height; y++) {
+                    const T *row = image + y * width;
+                    const T *source = image + (((y + dy) % height + height) % height) * width;
+                    T *shifted = work.shifted.data() + y * width;
+                    std::copy(source + shift_x, source + width, shifted);
+                    std::copy(source, source + shift_x, shifted + width - shift_x);
 
-                        for (int dy = -int(search_radius); dy < search_radius; dy++) {
-                            for (int dx = -int(search_radius); dx < search_radius; dx++) {
+                    float *difference = work.difference.data() + y * width;
+                    for (int x = 0; x < width; x++) difference[x] = squared_difference(row[x], shifted[x]);
+                }
 
-                                auto window2 = get_patch<T, D>(image, kx + dx, ky + dy, image_dims);
-                                auto diff = window - window2;
-                                auto weight = std::exp(-norm_squared(diff) / (noise_std2 * D * D));
+                const int *leading_x = work.leading_x.data();
+                const int *trailing_x = work.trailing_x.data();
 
-                                sum_weight += weight;
-                                sum_value += weight * window2[D / 2 + D * (D / 2)];
+                for (int y = 0; y < height; y++) {
+                    const float *difference = work.difference.data() + y * width;
+                    float *row_sums = work.row_sums.data() + y * width;
 
-                            }
-                        }
+                    double sum = 0;
+                    for (int k = -half; k <= half; k++) sum += difference[((k % width) + width) % width];
+                    for (int x = 0; x < width; x++) {
+                        row_sums[x] = float(sum);
+                        sum += difference[leading_x[x]] - difference[trailing_x[x]];
+                    }
+                }
 
-                        result(kx, ky) = sum_value / sum_weight;
+                double *column_sums = work.column_sums.data();
+                std::fill(column_sums, column_sums + width, 0.0);
+                for (int k = -half; k <= half; k++) {
+                    const float *row_sums = work.row_sums.data() + (((k % height) + height) % height) * width;
+                    for (int x = 0; x < width; x++) column_sums[x] += row_sums[x];
+                }
 
+                for (int y = 0; y < height; y++) {
+                    const T *shifted = work.shifted.data() + y * width;
+                    float *weights = sum_weight + y * width;
+                    T *values = sum_value + y * width;
+                    for (int x = 0; x < width; x++) {
+                        float weight = std::exp(-float(column_sums[x]) * weight_scale);
+                        weights[x] += weight;
+                        values[x] += weight * shifted[x];
                     }
+
+                    const float *leading = work.row_sums.data() + work.leading_y[y] * width;
+                    const float *trailing = work.row_sums.data() + work.trailing_y[y] * width;
+                    for (int x = 0; x < width; x++) column_sums[x] += double(leading[x]) - double(trailing[x]);
                 }
+            }
 
-                return result;
+            // Denoises one image into result. With parallel_offsets set, the search offsets are split over the
+            // threads, each accumulating into its own buffers; otherwise the image is processed by the calling thread.
+            template<class T>
+            void non_local_means_single_image(const T *image, T *result, int width, int height, float noise_std,
+                                              int search_radius, bool parallel_offsets) {
+
+                const float weight_scale = 1.0f / (noise_std * noise_std * patch_size * patch_size);
+                const size_t elements = size_t(width) * height;
+                const int search_width = 2 * search_radius;
+                const int n_offsets = search_width * search_width;
+
+                std::vector<float> sum_weight(elements, 0.0f);
+                std::vector<T> sum_value(elements, T(0));
+
+#pragma omp parallel if (parallel_offsets)
+                {
+                    OffsetWorkspace<T> work(width, height);
+                    std::vector<float> local_weight(elements, 0.0f);
+                    std::vector<T> local_value(elements, T(0));
+
+#pragma omp for schedule(dynamic)
+                    for (int offset = 0; offset < n_offsets; offset++) {
+                        int dx = offset % search_width - search_radius;
+                        int dy = offset / search_width - search_radius;
+                        accumulate_offset(image, width, height, dx, dy, weight_scale, work, local_weight.data(),
+                                          local_value.data());
+                    }
 
+#pragma omp critical
+                    {
+                        for (size_t i = 0; i < elements; i++) {
+                            sum_weight[i] += local_weight[i];
+                            sum_value[i] += local_value[i];
+                        }
+                    }
+                }
+
+                for (size_t i = 0; i < elements; i++) result[i] = sum_value[i] / sum_weight[i];
             }
 
             template<class T>
@@ -74,21 +157,26 @@ namespace Gadgetron {
 
 
                 GadgetronTimer timer("Non local means");
-                             size_t n_images = image.get_number_of_elements() / (image.get_size(0) * image.get_size(1));
-
-                std::vector<size_t> image_dims = {image.get_size(0), image.get_size(1)};
-                size_t image_elements = image_dims[0] * image_dims[1];
+                const int width = int(image.get_size(0));
+                const int height = int(image.get_size(1));
+                const size_t image_elements = size_t(width) * height;
+                const long long n_images = (long long)(image.get_number_of_elements() / image_elements);
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                #pragma omp parallel for
-                for (int i = 0; i < n_images; i++) {
-
-                    auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    auto result_view = non_local_means_single_image(image_view, noise_std,search_radius) ;
-
-                    memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
-                    GDEBUG_STREAM("I finished one");
+                // A series with at least one image per thread is split over the images, otherwise each image is
+                // split over its search offsets.
+#ifdef USE_OMP
+                const bool parallel_images = n_images >= omp_get_max_threads();
+#else
+                const bool parallel_images = true;
+#endif
+
+#pragma omp parallel for schedule(dynamic) if (parallel_images)
+                for (long long i = 0; i < n_images; i++) {
+                    non_local_means_single_image(image.get_data_ptr() + i * image_elements,
+                                                 result.get_data_ptr() + i * image_elements, width, height,
+                                                 noise_std, int(search_radius), !parallel_images);
                 }
                 return result;
 
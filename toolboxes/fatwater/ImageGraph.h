@@ -165,6 +165,15 @@ namespace Gadgetron {
 
         edge_descriptor reverse(edge_descriptor e) const {
 
+            size_t normal_vertex_id = e / edges_per_vertex;
+            if (normal_vertex_id < num_image_vertices_) {
+                size_t index_offset = e - normal_vertex_id * edges_per_vertex;
+                // The edge to the previous neighbour pairs with the edge back from its next neighbour. Looking it up
+                // by vertices is ambiguous along a dimension of size 2, where both neighbours are the same voxel.
+                if (index_offset < edges_per_vertex - 2)
+                    return target(e) * edges_per_vertex + (index_offset ^ 1);
+            }
+
             vertex_descriptor sv = source(e);
             vertex_descriptor tv = target(e);
             auto res = edge(tv,sv);
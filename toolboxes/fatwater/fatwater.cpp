@@ -30,7 +30,12 @@
 
 
 #include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
 #include "bounded_field_map.h"
+#include "fatwater_residuals.h"
 
 using namespace boost;
 
@@ -224,7 +229,7 @@ namespace Gadgetron {
                                                                         field_map_strengths.size() - 1);
                 }
 
-                fmIndex = update_field_map(fmIndex, fmIndex_update, residual, second_deriv);
+                fmIndex = update_field_map(fmIndex, fmIndex_update, residual, second_deriv, config.graph_cut_regions);
             }
 
             return fmIndex;
@@ -246,7 +251,7 @@ namespace Gadgetron {
         }
 
 
-        hoNDArray<arma::Mat<std::complex<float>>>
+        std::shared_ptr<const ProjectorBank>
         calculate_projection_matrices(const std::vector<float> &echo_times,
                                       const arma::Mat<std::complex<float>> &phiMatrix,
                                       const std::vector<float> &field_map_strengths,
@@ -254,36 +259,84 @@ namespace Gadgetron {
 
             auto num_fm = field_map_strengths.size();
             auto num_r2star = r2stars.size();
-            hoNDArray<arma::Mat<std::complex<float>>> Ps(num_fm, num_r2star);
             size_t nte = echo_times.size();
 
-#ifdef WIN32
-#pragma omp parallel for
-#else
+            auto bank = std::make_shared<ProjectorBank>();
+            bank->nte = nte;
+            bank->num_fm = num_fm;
+            bank->num_r2star = num_r2star;
+            bank->projectors.set_size(num_fm * num_r2star * nte, nte);
+
+            // The projector only depends on R2*, the field map is a diagonal phase modulation on either side
+            std::vector<arma::Mat<std::complex<float>>> Q(num_r2star);
+            for (int k4 = 0; k4 < num_r2star; k4++) {
+                arma::Mat<std::complex<float>> psiMatrix = calculate_psi_matrix(echo_times, phiMatrix, r2stars[k4]);
+                Q[k4] = arma::eye<arma::Mat<std::complex<float>>>(nte, nte) - psiMatrix * arma::pinv(psiMatrix);
+            }
+
 #pragma omp parallel for
-#endif
             for (int k3 = 0; k3 < num_fm; k3++) {
 
                 float fm = field_map_strengths[k3];
-                arma::Col<std::complex<float>> b_shifts(nte);
+                std::vector<std::complex<float>> b_shifts(nte);
                 for (int kt = 0; kt < nte; kt++)
                     b_shifts[kt] = std::exp(2if * PI * (echo_times[kt] - echo_times[0]) * fm);
-                for (int k4 = 0; k4 < num_r2star; k4++) {
-                    float r2star = r2stars[k4];
-
-                    arma::Mat<std::complex<float>> psiMatrix = calculate_psi_matrix(echo_times, phiMatrix,
-                                                                                    r2star);
-                    Ps(k3, k4) = arma::diagmat(b_shifts) * (arma::eye<arma::Mat<std::complex<float>>>(nte, nte) -
-                                                            psiMatrix * arma::pinv(psiMatrix)) *
-                                 arma::diagmat(arma::conj(b_shifts));
 
+                for (int k4 = 0; k4 < num_r2star; k4++) {
+                    size_t row = (k3 * num_r2star + k4) * nte;
+                    for (size_t j = 0; j < nte; j++)
+                        for (size_t i = 0; i < nte; i++)
+                            bank->projectors(row + i, j) = b_shifts[i] * Q[k4](i, j) * std::conj(b_shifts[j]);
                 }
             }
-            return Ps;
+            return bank;
         }
 
+        /**
+         * Projector banks of recent calls. Consecutive slices and repetitions of a protocol share the echo times,
+         * species and candidate values, so the bank is only computed once.
+         */
+        class ProjectorBankCache {
+        public:
+            std::shared_ptr<const ProjectorBank>
+            get(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phiMatrix,
+                const std::vector<float> &field_map_strengths, const std::vector<float> &r2stars) {
+
+                Key key{echo_times, std::vector<std::complex<float>>(phiMatrix.begin(), phiMatrix.end()),
+                        field_map_strengths, r2stars};
+
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    auto it = std::find_if(entries.begin(), entries.end(),
+                                           [&](const auto &entry) { return entry.first == key; });
+                    if (it != entries.end()) {
+                        entries.splice(entries.begin(), entries, it);
+                        return entries.front().second;
+                    }
+                }
+
+                auto bank = calculate_projection_matrices(echo_times, phiMatrix, field_map_strengths, r2stars);
+
+                std::lock_guard<std::mutex> guard(mutex);
+                entries.emplace_front(std::move(key), bank);
+                if (entries.size() > max_entries) entries.pop_back();
+                return bank;
+            }
+
+        private:
+            using Key = std::tuple<std::vector<float>, std::vector<std::complex<float>>, std::vector<float>, std::vector<float>>;
+            static constexpr size_t max_entries = 8;
 
+            std::mutex mutex;
+            std::list<std::pair<Key, std::shared_ptr<const ProjectorBank>>> entries;
+        };
 
+        std::shared_ptr<const ProjectorBank>
+        projector_bank(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phiMatrix,
+                       const std::vector<float> &field_map_strengths, const std::vector<float> &r2stars) {
+            static ProjectorBankCache cache;
+            return cache.get(echo_times, phiMatrix, field_map_strengths, r2stars);
+        }
 
         hoNDArray<float>
         calculate_r2star_map(const hoNDArray<std::complex<float> > &data, const hoNDArray<float> &field_map,
@@ -316,66 +369,24 @@ namespace Gadgetron {
             }
 
 
-            std::vector<arma::Mat<std::complex<float>>> Ps;
-            for (auto r2star : r2star_values) {
-
-                auto psiMatrix = calculate_psi_matrix(echoTimes, phiMatrix,
-                                                      r2star);
-                Ps.emplace_back(
-                        arma::eye<arma::Mat<std::complex<float>>>(nte, nte) - psiMatrix * arma::pinv(psiMatrix)
-                );
-
-            }
-
+            auto bank = projector_bank(echoTimes, phiMatrix, {0.0f}, r2star_values);
 
             hoNDArray<float> r2star_map(field_map.dimensions());
-#ifdef WIN32
-#pragma omp parallel for
-#else
-#pragma omp parallel for collapse(2)
-#endif
-            for (int k2 = 0; k2 < Y; k2++) {
-                for (int k1 = 0; k1 < X; k1++) {
-                    // Get current signal
-                    std::vector<cMat> signals(CHA, cMat(S, N));
-                    for (int cha = 0; cha < CHA; cha++) {
-                        auto &tempSignal = signals[cha];
-                        for (int k4 = 0; k4 < N; k4++) {
-                            for (int k5 = 0; k5 < S; k5++) {
-                                tempSignal(k5, k4) = data_corrected(k1, k2, 0, cha, k4, k5, 0);
-
-                            }
-                        }
-                    }
-
 
+            // Only the first slice is corrected for the field map
+            calculate_residuals(*bank, data_corrected, size_t(X) * Y,
+                                [&](size_t first, size_t count, const float *residuals) {
+                for (size_t v = 0; v < count; v++) {
+                    const float *res = residuals + v * r2star_values.size();
                     float minResidual = std::numeric_limits<float>::max();
-                    std::vector<float> field_map_strengths = {field_map(k1, k2)};
-
-
                     for (int kr2 = 0; kr2 < r2star_values.size(); kr2++) {
-
-                        float curResidual = 0;
-
-                        for (int cha = 0; cha < CHA; cha++) {
-                            // Apply projector
-                            arma::Mat<std::complex<float>> projected = Ps[kr2] * signals[cha];
-                            curResidual += std::accumulate(projected.begin(), projected.end(), 0.0f,
-                                                           [](auto v1, auto v2) {
-                                                               return v1 +
-                                                                      std::norm(v2);
-                                                           });
+                        if (res[kr2] < minResidual) {
+                            minResidual = res[kr2];
+                            r2star_map[first + v] = r2star_values[kr2];
                         }
-                        if (curResidual < minResidual) {
-                            minResidual = curResidual;
-                            r2star_map(k1, k2) = r2star_values[kr2];
-                        }
-
                     }
-
-
                 }
-            }
+            });
 
             return r2star_map;
         }
@@ -396,8 +407,7 @@ namespace Gadgetron {
             uint16_t LOC = data.get_size(6);
 
 
-            auto projection_matrices = calculate_projection_matrices(parameters.echo_times_s, phi, field_strengths,
-                                                                     r2star_values);
+            auto bank = projector_bank(parameters.echo_times_s, phi, field_strengths, r2star_values);
 
             auto result = std::make_tuple(hoNDArray<float>(field_strengths.size(), X, Y, Z),
                                           hoNDArray<uint16_t>(X, Y, Z, field_strengths.size()));
@@ -405,52 +415,25 @@ namespace Gadgetron {
             auto &residual = std::get<0>(result);
             auto &r2starIndex = std::get<1>(result);
 
-#ifdef WIN32
-#pragma omp parallel for 
-#else
-#pragma omp parallel for collapse(3)
-#endif
-            for (int kz = 0; kz < Z; kz++) {
-                for (int ky = 0; ky < Y; ky++) {
-                    for (int kx = 0; kx < X; kx++) {
+            const size_t voxels = size_t(X) * Y * Z;
+            const size_t num_r2star = r2star_values.size();
 
-                        std::vector<cMat> signals(CHA, cMat(S, N));
-                        for (int cha = 0; cha < CHA; cha++) {
-                            auto &tempSignal = signals[cha];
-                            for (int kn = 0; kn < N; kn++) {
-                                for (int ks = 0; ks < S; ks++) {
-                                    tempSignal(ks, kn) = data(kx, ky, kz, cha, kn, ks, 0);
-                                }
-                            }
-                        }
+            calculate_residuals(*bank, data, voxels, [&](size_t first, size_t count, const float *residuals) {
+                for (size_t v = 0; v < count; v++) {
+                    for (int kf = 0; kf < field_strengths.size(); kf++) {
+                        const float *res = residuals + v * bank->num_fm * num_r2star + kf * num_r2star;
 
-                        for (int kf = 0; kf < field_strengths.size(); kf++) {
-
-                            float minResidual = std::numeric_limits<float>::max();
-
-                            for (int kr = 0; kr < r2star_values.size(); kr++) {
-                                // Apply projector
-                                float curResidual = 0;
-                                for (int cha = 0; cha < CHA; cha++) {
-                                    arma::Mat<std::complex<float>> projected =
-                                            projection_matrices(kf, kr) * signals[cha];
-                                    curResidual += std::accumulate(projected.begin(), projected.end(), 0.0f,
-                                                                   [](auto v1, auto v2) {
-                                                                       return v1 +
-                                                                              std::norm(v2);
-                                                                   });
-                                }
-                                if (curResidual < minResidual) {
-                                    minResidual = curResidual;
-                                    r2starIndex(kx, ky, kz, kf) = kr;
-                                }
+                        float minResidual = std::numeric_limits<float>::max();
+                        for (int kr = 0; kr < num_r2star; kr++) {
+                            if (res[kr] < minResidual) {
+                                minResidual = res[kr];
+                                r2starIndex[first + v + kf * voxels] = kr;
                             }
-                            residual(kf, kx, ky, kz) = minResidual;
-
                         }
+                        residual[kf + (first + v) * field_strengths.size()] = minResidual;
                     }
                 }
-            }
+            });
 
             return result;
         }
@@ -20,6 +20,8 @@ namespace Gadgetron
             size_t number_of_r2_fine_samples = 200;
 
             size_t number_of_iterations = 40;
+            /// Number of regions the graph cut is split into and solved in parallel; 1 solves a single global cut
+            unsigned int graph_cut_regions = 1;
 
             float lambda = 0.02;
             float lambda_extra = 0.01;
@@ -0,0 +1,109 @@
+#pragma once
+#include "fatwater.h"
+#include "hoArmadillo.h"
+
+#include <algorithm>
+#include <complex>
+#include <memory>
+#include <vector>
+
+
+namespace Gadgetron {
+    namespace FatWater {
+
+        /**
+         * Projectors onto the complement of the signal model, for every field map and R2* candidate.
+         * They are kept in one contiguous matrix, with the nte x nte projector of field map k3 and R2* k4 in the rows
+         * [(k3 * num_r2star + k4) * nte, (k3 * num_r2star + k4 + 1) * nte), so that applying all of them to a block of
+         * signals is a single matrix product.
+         */
+        struct ProjectorBank {
+            size_t nte;
+            size_t num_fm;
+            size_t num_r2star;
+            arma::Mat<std::complex<float>> projectors;
+        };
+
+        EXPORTFATWATER arma::Mat<std::complex<float>>
+        calculate_psi_matrix(const std::vector<float> &echoTimes, const arma::Mat<std::complex<float>> &phiMatrix,
+                             float r2star);
+
+        EXPORTFATWATER std::shared_ptr<const ProjectorBank>
+        calculate_projection_matrices(const std::vector<float> &echo_times,
+                                      const arma::Mat<std::complex<float>> &phiMatrix,
+                                      const std::vector<float> &field_map_strengths,
+                                      const std::vector<float> &r2stars);
+
+        /**
+         * Same as calculate_projection_matrices, but returns the bank of an earlier call with the same arguments.
+         */
+        EXPORTFATWATER std::shared_ptr<const ProjectorBank>
+        projector_bank(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phiMatrix,
+                       const std::vector<float> &field_map_strengths, const std::vector<float> &r2stars);
+
+        /**
+         * Residual ||P s||^2, summed over CHA and N, of every projector of the bank for the first num_voxels voxels of
+         * data. The voxels are processed in blocks, applying the whole bank to a block with one matrix product.
+         * @param data [X, Y, Z, CHA, N, S, LOC], only LOC 0 is used
+         * @param num_voxels number of voxels to evaluate, at most X * Y * Z. X * Y only evaluates the first slice.
+         * @param callback called with the first voxel of a block, the number of voxels in it and the residuals,
+         * [num_fm * num_r2star, voxels]. It is called from several threads.
+         */
+        template<class F>
+        void calculate_residuals(const ProjectorBank &bank, const hoNDArray<std::complex<float>> &data, size_t num_voxels,
+                                 F &&callback) {
+            const size_t voxels = data.get_size(0) * data.get_size(1) * data.get_size(2);
+            const size_t CHA = data.get_size(3);
+            const size_t N = data.get_size(4);
+            const size_t S = data.get_size(5);
+            const size_t nte = bank.nte;
+            const size_t num_projectors = bank.num_fm * bank.num_r2star;
+            const size_t columns_per_voxel = CHA * N;
+
+            // about 2 MB of projected signals per block
+            const size_t block_size = std::max<size_t>(1, (size_t(1) << 18) / (num_projectors * nte * columns_per_voxel));
+            const long long num_blocks = (num_voxels + block_size - 1) / block_size;
+
+#pragma omp parallel
+            {
+                arma::Mat<std::complex<float>> signals, projected;
+                std::vector<float> residuals;
+
+#pragma omp for schedule(dynamic)
+                for (long long block = 0; block < num_blocks; block++) {
+                    const size_t first = block * block_size;
+                    const size_t count = std::min(block_size, num_voxels - first);
+
+                    signals.set_size(nte, count * columns_per_voxel);
+                    for (size_t v = 0; v < count; v++) {
+                        for (size_t cha = 0; cha < CHA; cha++) {
+                            for (size_t kn = 0; kn < N; kn++) {
+                                size_t column = v * columns_per_voxel + cha * N + kn;
+                                for (size_t ks = 0; ks < S; ks++) {
+                                    signals(ks, column) = data[first + v + voxels * (cha + CHA * (kn + N * ks))];
+                                }
+                            }
+                        }
+                    }
+
+                    projected = bank.projectors * signals;
+
+                    residuals.assign(num_projectors * count, 0.0f);
+                    for (size_t v = 0; v < count; v++) {
+                        float *res = residuals.data() + v * num_projectors;
+                        for (size_t c = 0; c < columns_per_voxel; c++) {
+                            const std::complex<float> *col = projected.colptr(v * columns_per_voxel + c);
+                            for (size_t p = 0; p < num_projectors; p++) {
+                                float sum = 0;
+                                for (size_t i = 0; i < nte; i++) sum += std::norm(col[p * nte + i]);
+                                res[p] += sum;
+                            }
+                        }
+                    }
+
+                    callback(first, count, residuals.data());
+                }
+            }
+        }
+    }
+}
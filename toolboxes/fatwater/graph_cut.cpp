@@ -2,6 +2,7 @@
 // Created by david on 6/7/2018.
 //
 
+#include <algorithm>
 #include <random>
 #include "ImageGraph.h"
 #include <boost/graph/boykov_kolmogorov_max_flow.hpp>
@@ -132,13 +133,126 @@ namespace {
         return std::move(graph.color_map);
     }
 
+    /**
+     * Adds the regularization towards a voxel held fixed at label fixed_value, which is a unary term for the voxel idx.
+     */
+    template<unsigned int D>
+    void add_fixed_neighbour(ImageGraph<D> &graph, int f_value, int pf_value, int fixed_value, float lambda,
+                             const size_t idx) {
+
+        float keep = std::norm(f_value - fixed_value);
+        float change = std::norm(pf_value - fixed_value);
+
+        float diff = lambda * (keep - change);
+        auto &capacity_map = graph.edge_capacity_map;
+        if (diff > 0) {
+            capacity_map[graph.edge_to_sink(idx)] += diff;
+        } else {
+            capacity_map[graph.edge_from_source(idx)] -= diff;
+        }
+    }
+
+    /**
+     * Graph cut over the rows [y0, y1) only. The voxels outside the region are held at their labels in
+     * field_map_index, so the regularization edges leaving the region become unary terms.
+     */
+    template<unsigned int DIMS>
+    std::vector<boost::default_color_type>
+    graph_cut_region(const hoNDArray<uint16_t> &field_map_index, const hoNDArray<uint16_t> &proposed_field_map_index,
+                     const hoNDArray<float> &lambda_map, const hoNDArray<float> &residual_diff_map, size_t y0,
+                     size_t y1) {
+
+        const size_t X = field_map_index.get_size(0);
+        const size_t Y = field_map_index.get_size(1);
+        const size_t Z = field_map_index.get_size(2);
+        const size_t RY = y1 - y0;
+
+        hoNDArray<uint16_t> field_map(X, RY, Z), proposed_field_map(X, RY, Z);
+        hoNDArray<float> lambda(X, RY, Z), residual_diff(X, RY, Z);
+
+        for (size_t kz = 0; kz < Z; kz++) {
+            for (size_t ky = 0; ky < RY; ky++) {
+                size_t offset = (kz * Y + ky + y0) * X;
+                size_t region_offset = (kz * RY + ky) * X;
+                std::copy_n(field_map_index.begin() + offset, X, field_map.begin() + region_offset);
+                std::copy_n(proposed_field_map_index.begin() + offset, X, proposed_field_map.begin() + region_offset);
+                std::copy_n(lambda_map.begin() + offset, X, lambda.begin() + region_offset);
+                std::copy_n(residual_diff_map.begin() + offset, X, residual_diff.begin() + region_offset);
+            }
+        }
+
+        ImageGraph<DIMS> graph = make_graph<DIMS>(field_map, proposed_field_map, residual_diff, lambda);
+
+        for (size_t kz = 0; kz < Z; kz++) {
+            for (size_t kx = 0; kx < X; kx++) {
+                if (y0 > 0) {
+                    size_t idx = (kz * Y + y0) * X + kx;
+                    size_t idx2 = idx - X;
+                    float l = std::max(std::min(lambda_map[idx], lambda_map[idx2]), 0.0f);
+                    add_fixed_neighbour(graph, field_map_index[idx], proposed_field_map_index[idx],
+                                        field_map_index[idx2], l, (kz * RY) * X + kx);
+                }
+                if (y1 < Y) {
+                    size_t idx = (kz * Y + y1 - 1) * X + kx;
+                    size_t idx2 = idx + X;
+                    float l = std::max(std::min(lambda_map[idx], lambda_map[idx2]), 0.0f);
+                    add_fixed_neighbour(graph, field_map_index[idx], proposed_field_map_index[idx],
+                                        field_map_index[idx2], l, (kz * RY + RY - 1) * X + kx);
+                }
+            }
+        }
+
+        boost::boykov_kolmogorov_max_flow(graph, graph.source_vertex, graph.sink_vertex);
+
+        return std::move(graph.color_map);
+    }
+
+    /**
+     * Splits the image into regions of consecutive rows and updates them in two passes, first the even and then the
+     * odd regions. Regions in the same pass do not touch each other and are cut in parallel, each with its
+     * neighbours held fixed, so every pass can only lower the energy.
+     */
+    template<unsigned int DIMS>
+    void update_field_map_regions(hoNDArray<uint16_t> &result, const hoNDArray<uint16_t> &proposed_field_map_index,
+                                  const hoNDArray<float> &lambda_map, const hoNDArray<float> &residual_diff_map,
+                                  unsigned int regions) {
+
+        const size_t X = result.get_size(0);
+        const size_t Y = result.get_size(1);
+        const size_t Z = result.get_size(2);
+
+        for (int pass = 0; pass < 2; pass++) {
+#pragma omp parallel for schedule(dynamic)
+            for (int region = pass; region < int(regions); region += 2) {
+                size_t y0 = region * Y / regions;
+                size_t y1 = (region + 1) * Y / regions;
+                if (y1 == y0) continue;
+
+                auto color_map = graph_cut_region<DIMS>(result, proposed_field_map_index, lambda_map,
+                                                        residual_diff_map, y0, y1);
+
+                const size_t RY = y1 - y0;
+                for (size_t kz = 0; kz < Z; kz++) {
+                    for (size_t ky = 0; ky < RY; ky++) {
+                        for (size_t kx = 0; kx < X; kx++) {
+                            if (color_map[(kz * RY + ky) * X + kx] != boost::default_color_type::black_color) {
+                                size_t idx = (kz * Y + ky + y0) * X + kx;
+                                result[idx] = proposed_field_map_index[idx];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
 }
 namespace Gadgetron {
 
 
     hoNDArray<uint16_t>
     update_field_map(const hoNDArray<uint16_t> &field_map_index, const hoNDArray<uint16_t> &proposed_field_map_index,
-                     const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map) {
+                     const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map, unsigned int regions) {
 
 
         hoNDArray<float> residual_diff_map(field_map_index.dimensions());
@@ -158,6 +272,16 @@ namespace Gadgetron {
         }
 
 
+        if (regions > 1 && Y >= 2 * regions) {
+            auto result = field_map_index;
+            if (Z == 1) {
+                update_field_map_regions<2>(result, proposed_field_map_index, lambda_map, residual_diff_map, regions);
+            } else {
+                update_field_map_regions<3>(result, proposed_field_map_index, lambda_map, residual_diff_map, regions);
+            }
+            return result;
+        }
+
         std::vector<boost::default_color_type> color_map;
         if (Z == 1) {
             color_map = graph_cut<2>(field_map_index, proposed_field_map_index, lambda_map,
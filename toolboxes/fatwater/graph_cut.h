@@ -6,8 +6,13 @@
 namespace  Gadgetron {
 
 
+    /**
+     * Graph cut update of the field map, taking the proposed index wherever it lowers the energy.
+     * With regions > 1 the image is split along Y into that many regions, which are cut in parallel in two passes
+     * with their neighbours held fixed; this approximates the single global cut.
+     */
     hoNDArray <uint16_t>
     update_field_map(const hoNDArray <uint16_t> &field_map_index, const hoNDArray <uint16_t> &proposed_field_map_index,
-                     const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map);
+                     const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map, unsigned int regions = 1);
 
 }
\ No newline at end of file
@@ -2,14 +2,19 @@
 // Include for Visual studio, 'cos reasons.
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <array>
+#include <atomic>
 #include <numeric>
 #include <set>
+#include <shared_mutex>
+#include <unordered_map>
 
 #include "hoMatrix.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
 #include "hoNDFFT.h"
 #include <boost/container/flat_set.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace Gadgetron {
 
@@ -32,6 +37,11 @@ namespace Gadgetron {
             static constexpr auto plan_dft     = fftwf_plan_dft;
             static constexpr auto execute_dft  = fftwf_execute_dft;
             static constexpr auto destroy_plan = fftwf_destroy_plan;
+            static constexpr auto alignment_of = fftwf_alignment_of;
+            static constexpr auto malloc       = fftwf_malloc;
+            static constexpr auto free         = fftwf_free;
+            static constexpr auto import_wisdom = fftwf_import_wisdom_from_filename;
+            static constexpr auto export_wisdom = fftwf_export_wisdom_to_filename;
         };
 
         template <> struct fftw_types<double> {
@@ -41,36 +51,101 @@ namespace Gadgetron {
             static constexpr auto plan_dft     = fftw_plan_dft;
             static constexpr auto execute_dft  = fftw_execute_dft;
             static constexpr auto destroy_plan = fftw_destroy_plan;
+            static constexpr auto alignment_of = fftw_alignment_of;
+            static constexpr auto malloc       = fftw_malloc;
+            static constexpr auto free         = fftw_free;
+            static constexpr auto import_wisdom = fftw_import_wisdom_from_filename;
+            static constexpr auto export_wisdom = fftw_export_wisdom_to_filename;
         };
         class FFTLock {
         protected:
             static std::mutex lock;
         };
         std::mutex FFTLock::lock;
-        template <class T> class SingleFFTPlan : FFTLock {
+
+        class WisdomLock : FFTLock {
+        public:
+            static std::mutex& get() { return lock; }
+        };
+
+        std::atomic<FFT::PlannerEffort> current_planner_effort{ FFT::PlannerEffort::Estimate };
+
+        unsigned planner_flags(FFT::PlannerEffort effort) {
+            switch (effort) {
+            case FFT::PlannerEffort::Measure: return FFTW_MEASURE;
+            case FFT::PlannerEffort::Patient: return FFTW_PATIENT;
+            default: return FFTW_ESTIMATE;
+            }
+        }
+
+        template <class T> int alignment_of(const std::complex<T>* data) {
+            return fftw_types<T>::alignment_of(reinterpret_cast<T*>(const_cast<std::complex<T>*>(data)));
+        }
+
+        struct PlanKey {
+            std::vector<ptrdiff_t> dimensions; // Size and stride of each transformed dimension, slowest first
+            bool forward;
+            bool in_place;
+            int input_alignment;
+            int output_alignment;
+
+            bool operator==(const PlanKey& other) const {
+                return dimensions == other.dimensions && forward == other.forward && in_place == other.in_place
+                       && input_alignment == other.input_alignment && output_alignment == other.output_alignment;
+            }
+        };
+
+        struct PlanKeyHash {
+            size_t operator()(const PlanKey& key) const {
+                size_t seed = boost::hash_range(key.dimensions.begin(), key.dimensions.end());
+                boost::hash_combine(seed, key.forward);
+                boost::hash_combine(seed, key.in_place);
+                boost::hash_combine(seed, key.input_alignment);
+                boost::hash_combine(seed, key.output_alignment);
+                return seed;
+            }
+        };
+
+        template <class T> class CachedPlan : FFTLock {
         public:
             using FFTWComplex = typename fftw_types<T>::complex;
 
-            SingleFFTPlan(int dimension, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output,
-                bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
+            CachedPlan(const PlanKey& key, unsigned flags) {
+                auto fftw_dimensions = std::vector<fftw_iodim64>();
+                size_t extent        = 1;
+                for (size_t i = 0; i < key.dimensions.size(); i += 2) {
+                    fftw_dimensions.push_back({ key.dimensions[i], key.dimensions[i + 1], key.dimensions[i + 1] });
+                    extent += (key.dimensions[i] - 1) * key.dimensions[i + 1];
+                }
 
-                const auto& dimensions = input.dimensions();
-                size_t stride
-                    = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
+                // FFTW_MEASURE and FFTW_PATIENT overwrite the arrays while planning, so we plan on scratch
+                // buffers with the same alignment as the data the plan will be executed on.
+                size_t bytes = extent * sizeof(std::complex<T>) + 64;
+                auto scratch = [bytes]() {
+                    return std::unique_ptr<void, void (*)(void*)>(fftw_types<T>::malloc(bytes), fftw_types<T>::free);
+                };
+                auto input_buffer  = scratch();
+                auto output_buffer = key.in_place ? std::unique_ptr<void, void (*)(void*)>(nullptr, fftw_types<T>::free)
+                                                  : scratch();
+
+                auto input  = reinterpret_cast<FFTWComplex*>(static_cast<char*>(input_buffer.get()) + key.input_alignment);
+                auto output = key.in_place ? input
+                                           : reinterpret_cast<FFTWComplex*>(
+                                               static_cast<char*>(output_buffer.get()) + key.output_alignment);
 
-                auto fftw_dimensions = fftw_iodim64{ static_cast<ptrdiff_t>(dimensions[dimension]), static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) };
+                std::lock_guard<std::mutex> guard(lock);
+                plan = fftw_types<T>::plan_guru(fftw_dimensions.size(), fftw_dimensions.data(), 0, nullptr, input,
+                    output, key.forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
 
-                plan = fftw_types<T>::plan_guru(1, &fftw_dimensions, 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
             }
 
-            ~SingleFFTPlan() {
+            ~CachedPlan() {
                 std::lock_guard<std::mutex> guard(lock);
                 fftw_types<T>::destroy_plan(plan);
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
+            void execute(const std::complex<T>* input, std::complex<T>* output) const {
                 fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
             }
 
@@ -78,43 +153,104 @@ namespace Gadgetron {
             typename fftw_types<T>::plan* plan;
         };
 
-        template <class T> class ContigousFFTPlan : FFTLock {
+        /**
+         * Process wide cache of FFTW plans, so that repeated transforms of the same shape do not pay for planning.
+         * Lookups only take a shared lock; planning itself is serialised, as the FFTW planner is not thread safe.
+         */
+        template <class T> class FFTPlanCache {
         public:
-            using FFTWComplex = typename fftw_types<T>::complex;
-            ContigousFFTPlan(
-                int rank, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
+            static FFTPlanCache& instance() {
+                static FFTPlanCache cache;
+                return cache;
+            }
 
-                const auto& dimensions = input.dimensions();
+            std::shared_ptr<const CachedPlan<T>> get(const PlanKey& key) {
+                if (auto plan = find(key))
+                    return plan;
 
-                auto strides = std::vector<size_t>(rank + 1, 1);
-                std::partial_sum(
-                    dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+                std::lock_guard<std::mutex> planning_guard(planning);
+                if (auto plan = find(key))
+                    return plan;
 
-                auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+                auto plan = std::make_shared<const CachedPlan<T>>(key, planner_flags(current_planner_effort));
 
-                for (int i = 0; i < rank; i++) {
-                    fftw_dimensions[i] = { (int64_t)dimensions[i], (int64_t)strides[i], (int64_t)strides[i] };
-                }
-                std::reverse(fftw_dimensions.begin(),fftw_dimensions.end());
-                plan = fftw_types<T>::plan_guru(rank, fftw_dimensions.data(), 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                std::unique_lock<std::shared_mutex> guard(mutex);
+                if (plans.size() >= max_cached_plans)
+                    plans.clear();
+                plans.emplace(key, plan);
+                return plan;
+            }
 
-                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
+            void clear() {
+                std::unique_lock<std::shared_mutex> guard(mutex);
+                plans.clear();
             }
-            ~ContigousFFTPlan() {
-                std::lock_guard<std::mutex> guard(lock);
-                fftw_types<T>::destroy_plan(plan);
+
+        private:
+            FFTPlanCache() = default;
+
+            std::shared_ptr<const CachedPlan<T>> find(const PlanKey& key) {
+                std::shared_lock<std::shared_mutex> guard(mutex);
+                auto it = plans.find(key);
+                return it == plans.end() ? nullptr : it->second;
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
-                fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
+            static constexpr size_t max_cached_plans = 512;
+
+            std::mutex planning;
+            std::shared_mutex mutex;
+            std::unordered_map<PlanKey, std::shared_ptr<const CachedPlan<T>>, PlanKeyHash> plans;
+        };
+
+        /**
+         * The plans needed to run one transform over a batch of arrays. FFTW only executes a plan on arrays with the
+         * same alignment as those it was planned for, so batches starting at different alignments get their own plan.
+         * All alignments must be prepared before executing, which makes execute safe to call from multiple threads.
+         */
+        template <class T> class FFTPlan {
+        public:
+            FFTPlan(std::vector<ptrdiff_t> dimensions, bool forward, bool in_place)
+                : dimensions(std::move(dimensions)), forward(forward), in_place(in_place) {}
+
+            void prepare(const std::complex<T>* input, const std::complex<T>* output) {
+                auto& plan = plans[slot(input, output)];
+                if (!plan)
+                    plan = FFTPlanCache<T>::instance().get(
+                        PlanKey{ dimensions, forward, in_place, alignment_of(input), alignment_of(output) });
+            }
+
+            void execute(const std::complex<T>* input, std::complex<T>* output) const {
+                plans[slot(input, output)]->execute(input, output);
             }
 
         private:
-            typename fftw_types<T>::plan* plan;
+            static size_t slot(const void* input, const void* output) {
+                return (reinterpret_cast<uintptr_t>(input) % 64 / 8) * 8 + reinterpret_cast<uintptr_t>(output) % 64 / 8;
+            }
+
+            const std::vector<ptrdiff_t> dimensions;
+            const bool forward;
+            const bool in_place;
+            std::array<std::shared_ptr<const CachedPlan<T>>, 64> plans;
         };
 
+        // Offsets into an array of complex numbers repeat their alignment modulo 64 bytes at least every 8 elements.
+        constexpr size_t alignment_period = 8;
+
+        template <class T>
+        FFTPlan<T> make_contigous_plan(int rank, const hoNDArray<std::complex<T>>& input, bool forward, bool in_place) {
+            const auto& dimensions = input.dimensions();
+
+            auto strides = std::vector<size_t>(rank + 1, 1);
+            std::partial_sum(dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+
+            auto plan_dimensions = std::vector<ptrdiff_t>();
+            for (int i = rank - 1; i >= 0; i--) {
+                plan_dimensions.push_back(dimensions[i]);
+                plan_dimensions.push_back(strides[i]);
+            }
+            return FFTPlan<T>(std::move(plan_dimensions), forward, in_place);
+        }
 
         int contigous_rank(const boost::container::flat_set<int>& dimensions) {
             if (!dimensions.count(0))
@@ -130,11 +266,14 @@ namespace Gadgetron {
         static void contigous_fftn(const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, int rank,
             bool forward, bool normalize) {
 
-            auto plan = ContigousFFTPlan<T>(rank, input, output, forward);
+            auto plan = make_contigous_plan(rank, input, forward, input.data() == output.data());
             size_t batch_size
                 = std::accumulate(input.dimensions().begin(), input.dimensions().begin() + rank, 1, std::multiplies<>());
             size_t batches = input.size() / batch_size;
 
+            for (size_t i = 0; i < std::min(batches, alignment_period); i++)
+                plan.prepare(input.data() + i * batch_size, output.data() + i * batch_size);
+
 #pragma omp parallel for default(none) shared(plan,  input, output, batches, batch_size)
             for (long long i = 0; i < batches; i++) {
 
@@ -149,7 +288,6 @@ namespace Gadgetron {
         static void single_fft(int dimension, const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r,
             bool forward, bool normalize) {
             assert(dimension >= 0);
-            auto plan              = SingleFFTPlan<T>(dimension, a, r, forward);
             const auto& dimensions = a.dimensions();
             size_t inner_batches
                 = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
@@ -157,6 +295,17 @@ namespace Gadgetron {
                 = std::accumulate(dimensions.begin() + dimension + 1, dimensions.end(), 1, std::multiplies<>());
             size_t outer_batchsize = inner_batches * dimensions[dimension];
 
+            auto plan = FFTPlan<T>(
+                { static_cast<ptrdiff_t>(dimensions[dimension]), static_cast<ptrdiff_t>(inner_batches) }, forward,
+                a.data() == r.data());
+
+            for (size_t outer = 0; outer < std::min(outer_batches, alignment_period); outer++) {
+                for (size_t inner = 0; inner < std::min(inner_batches, alignment_period); inner++) {
+                    plan.prepare(
+                        a.data() + inner + outer * outer_batchsize, r.data() + inner + outer * outer_batchsize);
+                }
+            }
+
 #pragma omp parallel for default(none) shared(plan, a, r , outer_batches, inner_batches, outer_batchsize ) collapse(2)
             for (long long outer = 0; outer < outer_batches; outer++) {
                 for (long long inner = 0; inner < inner_batches; inner++) {
@@ -836,6 +985,30 @@ namespace Gadgetron {
     template <class ComplexType, class ENABLER> void FFT::ifft(hoNDArray<ComplexType>& data, size_t dimension) {
         single_fft(dimension,data,data,false,true);
     }
+    void FFT::set_planner_effort(PlannerEffort effort) {
+        current_planner_effort = effort;
+        clear_plan_cache();
+    }
+
+    FFT::PlannerEffort FFT::planner_effort() {
+        return current_planner_effort;
+    }
+
+    void FFT::clear_plan_cache() {
+        FFTPlanCache<float>::instance().clear();
+        FFTPlanCache<double>::instance().clear();
+    }
+
+    template <class T> bool FFT::import_wisdom(const std::string& filename) {
+        std::lock_guard<std::mutex> guard(WisdomLock::get());
+        return fftw_types<T>::import_wisdom(filename.c_str()) != 0;
+    }
+
+    template <class T> bool FFT::export_wisdom(const std::string& filename) {
+        std::lock_guard<std::mutex> guard(WisdomLock::get());
+        return fftw_types<T>::export_wisdom(filename.c_str()) != 0;
+    }
+
     template <class ComplexType, class ENABLER>
     hoNDArray<ComplexType> FFT::fft1c(const hoNDArray<ComplexType> &data) {
       hoNDArray<ComplexType> output(data.dimensions());
@@ -893,6 +1066,11 @@ namespace Gadgetron {
     template void FFT::ifft<std::complex<float>>(hoNDArray<std::complex<float>>& data, size_t dimensions);
     template void FFT::ifft<std::complex<double>>(hoNDArray<std::complex<double>>& data, size_t dimensions);
 
+    template bool FFT::import_wisdom<float>(const std::string& filename);
+    template bool FFT::import_wisdom<double>(const std::string& filename);
+    template bool FFT::export_wisdom<float>(const std::string& filename);
+    template bool FFT::export_wisdom<double>(const std::string& filename);
+
     template hoNDArray<std::complex<float>> FFT::fft1c(const hoNDArray<std::complex<float>> &data);
     template hoNDArray<std::complex<float>> FFT::fft2c(const hoNDArray<std::complex<float>> &data);
     template hoNDArray<std::complex<float>> FFT::fft3c(const hoNDArray<std::complex<float>> &data);
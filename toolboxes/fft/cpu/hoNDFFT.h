@@ -107,6 +107,39 @@ template <class ComplexType,
           class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
 hoNDArray<ComplexType> ifft3c(const hoNDArray<ComplexType> &data);
 
+/**
+ * How hard FFTW tries to find a fast plan. Plans are cached per transform shape and reused between calls,
+ * so the planning cost is only paid the first time a shape is seen.
+ */
+enum class PlannerEffort { Estimate, Measure, Patient };
+
+/**
+ * Sets the planner effort used for new plans. Changing the effort clears the plan cache.
+ */
+EXPORTCPUFFT void set_planner_effort(PlannerEffort effort);
+EXPORTCPUFFT PlannerEffort planner_effort();
+
+/**
+ * Releases all cached plans
+ */
+EXPORTCPUFFT void clear_plan_cache();
+
+/**
+ * Imports FFTW wisdom from a file, such as one produced by the fftwf-wisdom tool
+ * @tparam T Precision of the wisdom, float or double
+ * @param filename Path of the wisdom file
+ * @return true if the wisdom was imported
+ */
+template <class T> bool import_wisdom(const std::string& filename);
+
+/**
+ * Exports the accumulated FFTW wisdom to a file
+ * @tparam T Precision of the wisdom, float or double
+ * @param filename Path of the wisdom file
+ * @return true if the wisdom was exported
+ */
+template <class T> bool export_wisdom(const std::string& filename);
+
 }
 
 
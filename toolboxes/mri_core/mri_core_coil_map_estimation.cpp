@@ -11,6 +11,10 @@
 #include "hoNDArray_reductions.h"
 #include "complext.h"
 #include "GadgetronTimer.h"
+
+#include <algorithm>
+#include <vector>
+
 #ifdef USE_OMP
     #include <omp.h>
 #endif // USE_OMP
@@ -18,201 +22,332 @@
 namespace Gadgetron
 {
 
-template<typename T> 
-void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power)
+namespace
 {
-    try
+    // size of the tiles of the box filtered Inati estimation, along RO and E1
+    const long long inati_tile_width = 64;
+    const long long inati_tile_rows = 8;
+
+    // Inati coil maps computed from box filtered sums instead of per pixel neighbourhood matrices.
+    // For the ks x ks x kz neighbourhood matrix D of a pixel, D^H*D is the neighbourhood sum of conj(x_i)*x_j
+    // and the column sums of D are the neighbourhood sums of x_i. Both are computed with a separable box filter
+    // over RO x E1 tiles streamed along E2, and the power iteration runs vectorised over the pixels of a tile row.
+    // Real and imaginary parts are kept in separate rows, so the loops over RO vectorise.
+    template<typename T>
+    void coil_map_Inati_box_filter(const T* pData, T* pSen, long long RO, long long E1, long long E2, long long CHA, long long ks, long long kz, size_t power)
     {
         typedef typename realType<T>::Type value_type;
-        using std::abs;
 
-        long long RO = data.get_size(0);
-        long long E1 = data.get_size(1);
-        long long CHA = data.get_size(2);
+        const long long halfKs = ks / 2;
+        const long long halfKz = kz / 2;
 
-        long long N = data.get_number_of_elements() / (RO*E1*CHA);
-        GADGET_CHECK_THROW(N == 1);
+        // entries of a pixel: the upper triangle of D^H*D, then the column sums of D
+        const long long NP = CHA*(CHA + 1) / 2;
+        const long long NE = NP + CHA;
 
-        const T* pData = data.begin();
-
-        if (!data.dimensions_equal(&coilMap))
+        std::vector<long long> pair_i(NP), pair_j(NP);
+        long long p = 0;
+        for (long long i = 0; i < CHA; i++)
         {
-            coilMap = data;
+            for (long long j = i; j < CHA; j++)
+            {
+                pair_i[p] = i;
+                pair_j[p] = j;
+                p++;
+            }
         }
-        T* pSen = coilMap.begin();
 
-        if (ks % 2 != 1)
-        {
-            ks++;
-        }
+        const long long planeSize = RO*E1;
+        const long long volumeSize = RO*E1*E2;
 
-        size_t kss = ks*ks;
-        long long halfKs = (long long)ks / 2;
+        // tiles along RO of at most inati_tile_width pixels and of equal width,
+        // tiles of inati_tile_rows along E1, and chunks along E2 when there are too few tiles to occupy all cores
+        const long long numTilesRO = (RO + inati_tile_width - 1) / inati_tile_width;
+        const long long W = (RO + numTilesRO - 1) / numTilesRO;
 
-        long long e1;
+        // strides of the tile buffers: W pixels of a row, RP with the RO neighbourhood, H rows with the E1 neighbourhood
+        const long long RP = W + 2 * halfKs;
+        const long long H = inati_tile_rows + 2 * halfKs;
+        const long long rowSize = NE * 2 * W;
 
-        #pragma omp parallel private(e1) shared(ks, RO, E1, CHA, pSen, pData, halfKs, power, kss)
-        {
-            hoNDArray<T> D(ks*ks, CHA);
-            T* pD = D.begin();
-
-            hoNDArray<T> DC(ks*ks, CHA);
-            T* pDC = DC.begin();
-
-            hoNDArray<T> DH_D(CHA, CHA);
-            Gadgetron::clear(DH_D);
-
-            hoNDArray<T> U1(ks*ks, 1);
-            T* pU1 = U1.begin();
-
-            hoNDArray<T> V1(CHA, 1);
-            T* pV1 = V1.begin();
-
-            hoNDArray<T> V(CHA, 1);
+        const long long numTilesE1 = (E1 + inati_tile_rows - 1) / inati_tile_rows;
+        const long long numTiles = numTilesRO*numTilesE1;
+        long long numChunksE2 = 1;
+#ifdef USE_OMP
+        numChunksE2 = std::max(1LL, std::min(E2 / std::max(kz, 2LL), (2LL * omp_get_max_threads() + numTiles - 1) / numTiles));
+#endif // USE_OMP
+        const long long chunkE2 = (E2 + numChunksE2 - 1) / numChunksE2;
 
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
+        auto wrap = [](long long n, long long N) { n %= N; return (n < 0) ? n + N : n; };
 
-            T phaseU1;
+        long long task;
 
-            value_type v1Norm(1), u1Norm(1);
+#pragma omp parallel private(task) shared(pData, pSen, pair_i, pair_j)
+        {
+            // channel rows padded by the kernel radius, the rows of one entry and their E1 running sum,
+            // the filtered rows of the last kz planes, and the full neighbourhood sums of a row
+            std::vector<value_type> x(H * CHA * 2 * RP), prod(H * 2 * RP), column(2 * RP), planes(kz*inati_tile_rows*rowSize), sums(rowSize);
+            std::vector<value_type> v(CHA * 2 * W), vn(CHA * 2 * W), scale(W);
+            std::vector<long long> roIndex(RP);
+
+#pragma omp for schedule(dynamic)
+            for (task = 0; task < numTiles*numChunksE2; task++)
+            {
+                const long long roStart = (task % numTilesRO)*W;
+                const long long TRO = std::min(W, RO - roStart);
+                const long long e1Start = ((task / numTilesRO) % numTilesE1)*inati_tile_rows;
+                const long long TE1 = std::min(inati_tile_rows, E1 - e1Start);
+                const long long e2Start = (task / numTiles)*chunkE2;
+                const long long e2End = std::min(e2Start + chunkE2, E2);
 
-            long long cha, ro, kro, ke1, de1, dro;
-            size_t po;
+                for (long long k = 0; k < TRO + 2 * halfKs; k++) roIndex[k] = wrap(roStart - halfKs + k, RO);
 
-            #pragma omp for
-            for (e1 = 0; e1<(int)E1; e1++)
-            {
-                for (ro = 0; ro<(long long)RO; ro++)
+                // filter plane z of the input into slot of the planes buffer, one entry at a time so its rows stay in cache
+                auto filter_plane = [&](long long z, long long slot)
                 {
-                    // fill the data matrix D
-                    if (e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
+                    for (long long r = 0; r < TE1 + 2 * halfKs; r++)
                     {
-                        for (cha = 0; cha<CHA; cha++)
+                        const long long e1 = wrap(e1Start - halfKs + r, E1);
+
+                        for (long long cha = 0; cha < CHA; cha++)
                         {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
+                            const T* pRow = pData + cha*volumeSize + z*planeSize + e1*RO;
+                            value_type* xr = x.data() + (r*CHA + cha) * 2 * RP;
+                            value_type* xi = xr + RP;
+                            for (long long k = 0; k < TRO + 2 * halfKs; k++)
                             {
-                                de1 = e1 + ke1;
-                                for (kro = -halfKs; kro <= halfKs; kro++)
-                                {
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + ro + kro];
-                                    ind++;
-                                }
+                                const T& c = pRow[roIndex[k]];
+                                xr[k] = c.real();
+                                xi[k] = c.imag();
                             }
                         }
                     }
-                    else
+
+                    value_type* pPlane = planes.data() + slot*inati_tile_rows*rowSize;
+
+                    for (long long e = 0; e < NE; e++)
                     {
-                        for (cha = 0; cha<CHA; cha++)
+                        // conj(x_i)*x_j for the pairs, or x_i for the column sums, over all rows of the neighbourhood
+                        for (long long r = 0; r < TE1 + 2 * halfKs; r++)
                         {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
+                            value_type* qr = prod.data() + r * 2 * RP;
+                            value_type* qi = qr + RP;
+
+                            if (e < NP)
                             {
-                                de1 = e1 + ke1;
-                                if (de1 < 0) de1 += E1;
-                                if (de1 >= E1) de1 -= E1;
+                                const value_type* ar = x.data() + (r*CHA + pair_i[e]) * 2 * RP;
+                                const value_type* ai = ar + RP;
+                                const value_type* br = x.data() + (r*CHA + pair_j[e]) * 2 * RP;
+                                const value_type* bi = br + RP;
 
-                                for (kro = -halfKs; kro <= halfKs; kro++)
+#pragma omp simd
+                                for (long long k = 0; k < RP; k++)
                                 {
-                                    dro = ro + kro;
-                                    if (dro < 0) dro += RO;
-                                    if (dro >= RO) dro -= RO;
-
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + dro];
-                                    ind++;
+                                    qr[k] = ar[k] * br[k] + ai[k] * bi[k];
+                                    qi[k] = ar[k] * bi[k] - ai[k] * br[k];
                                 }
                             }
+                            else
+                            {
+                                const value_type* pr = x.data() + (r*CHA + e - NP) * 2 * RP;
+                                std::copy(pr, pr + 2 * RP, qr);
+                            }
                         }
-                    }
 
-                    T* pTmp;
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pTmp = pD + cha*kss;
-                        pV1[cha] = pTmp[0];
-                        for (po = 1; po<kss; po++)
+                        // box filter along E1 as a running sum over the rows of the tile, then along RO
+                        value_type* cr = column.data();
+                        const value_type* ci = cr + RP;
+                        std::fill(column.begin(), column.end(), value_type(0));
+                        for (long long k = 0; k < ks; k++)
                         {
-                            pV1[cha] += pTmp[po];
+                            const value_type* pIn = prod.data() + k * 2 * RP;
+#pragma omp simd
+                            for (long long n = 0; n < 2 * RP; n++) cr[n] += pIn[n];
+                        }
+
+                        for (long long t = 0; t < TE1; t++)
+                        {
+                            if (t > 0)
+                            {
+                                const value_type* pAdd = prod.data() + (t + ks - 1) * 2 * RP;
+                                const value_type* pSub = prod.data() + (t - 1) * 2 * RP;
+#pragma omp simd
+                                for (long long n = 0; n < 2 * RP; n++) cr[n] += pAdd[n] - pSub[n];
+                            }
+
+                            value_type* sr = pPlane + t*rowSize + e * 2 * W;
+                            value_type* si = sr + W;
+                            std::fill(sr, sr + 2 * W, value_type(0));
+                            for (long long k = 0; k < ks; k++)
+                            {
+#pragma omp simd
+                                for (long long ro = 0; ro < W; ro++)
+                                {
+                                    sr[ro] += cr[ro + k];
+                                    si[ro] += ci[ro + k];
+                                }
+                            }
                         }
                     }
+                };
 
-                    value_type sum(0);
-                    for (cha = 0; cha<CHA; cha++)
+                auto normalize = [&](value_type* pv)
+                {
+                    std::fill(scale.begin(), scale.end(), value_type(0));
+                    for (long long cha = 0; cha < CHA; cha++)
                     {
-                        const T& c = pV1[cha];
-                        const value_type re = c.real();
-                        const value_type im = c.imag();
-                        sum += ((re*re) + (im * im));
+                        const value_type* vr = pv + cha * 2 * W;
+                        const value_type* vi = vr + W;
+#pragma omp simd
+                        for (long long ro = 0; ro < W; ro++) scale[ro] += vr[ro] * vr[ro] + vi[ro] * vi[ro];
                     }
-                    v1Norm = std::sqrt(sum);
 
-                    value_type v1NormInv = (value_type)1.0 / v1Norm;
-                    for (cha = 0; cha<CHA; cha++)
+                    for (long long ro = 0; ro < W; ro++) scale[ro] = value_type(1) / std::sqrt(scale[ro]);
+
+                    for (long long n = 0; n < CHA * 2; n++)
                     {
-                        pV1[cha] *= v1NormInv;
+                        value_type* pvn = pv + n*W;
+#pragma omp simd
+                        for (long long ro = 0; ro < W; ro++) pvn[ro] *= scale[ro];
                     }
+                };
 
-                    memcpy(pDC, pD, sizeof(T)*ks*ks*CHA);
-                    gemm(DH_D, DC, true, D, false);
+                // planes are numbered from the first input plane of the chunk, and stored in slot n % kz
+                for (long long n = 0; n < kz - 1; n++) filter_plane(wrap(e2Start - halfKz + n, E2), n % kz);
+
+                for (long long e2 = e2Start; e2 < e2End; e2++)
+                {
+                    const long long n = e2 - e2Start + kz - 1;
+                    filter_plane(wrap(e2Start - halfKz + n, E2), n % kz);
 
-                    for (po = 0; po<power; po++)
+                    for (long long t = 0; t < TE1; t++)
                     {
-                        gemm(V, DH_D, false, V1, false);
-                        memcpy(V1.begin(), V.begin(), V.get_number_of_bytes());
+                        // box filter along E2, which is the plane itself for 2D
+                        const value_type* pSums = planes.data() + t*rowSize;
+                        if (kz > 1)
+                        {
+                            std::fill(sums.begin(), sums.end(), value_type(0));
+                            for (long long slot = 0; slot < kz; slot++)
+                            {
+                                const value_type* pIn = planes.data() + (slot*inati_tile_rows + t)*rowSize;
+#pragma omp simd
+                                for (long long k = 0; k < rowSize; k++) sums[k] += pIn[k];
+                            }
+                            pSums = sums.data();
+                        }
+
+                        const value_type* pColSum = pSums + NP * 2 * W;
 
-                        sum = 0;
-                        for (cha = 0; cha<CHA; cha++)
+                        // V1 starts as the normalized column sums
+                        std::copy(pColSum, pColSum + CHA * 2 * W, v.begin());
+                        normalize(v.data());
+
+                        for (size_t po = 0; po < power; po++)
                         {
-                            const T& c = pV1[cha];
-                            const value_type re = c.real();
-                            const value_type im = c.imag();
-                            sum += ((re*re) + (im * im));
+                            std::fill(vn.begin(), vn.end(), value_type(0));
+                            for (long long e = 0; e < NP; e++)
+                            {
+                                const long long i = pair_i[e], j = pair_j[e];
+                                const value_type* cr = pSums + e * 2 * W;
+                                const value_type* ci = cr + W;
+                                const value_type* vir = v.data() + i * 2 * W;
+                                const value_type* vii = vir + W;
+                                const value_type* vjr = v.data() + j * 2 * W;
+                                const value_type* vji = vjr + W;
+                                value_type* nir = vn.data() + i * 2 * W;
+                                value_type* nii = nir + W;
+                                value_type* njr = vn.data() + j * 2 * W;
+                                value_type* nji = njr + W;
+
+                                // vn_i += C_ij*v_j, and by symmetry vn_j += conj(C_ij)*v_i
+#pragma omp simd
+                                for (long long ro = 0; ro < W; ro++)
+                                {
+                                    nir[ro] += cr[ro] * vjr[ro] - ci[ro] * vji[ro];
+                                    nii[ro] += cr[ro] * vji[ro] + ci[ro] * vjr[ro];
+                                }
+
+                                if (i != j)
+                                {
+#pragma omp simd
+                                    for (long long ro = 0; ro < W; ro++)
+                                    {
+                                        njr[ro] += cr[ro] * vir[ro] + ci[ro] * vii[ro];
+                                        nji[ro] += cr[ro] * vii[ro] - ci[ro] * vir[ro];
+                                    }
+                                }
+                            }
+
+                            std::swap(v, vn);
+                            normalize(v.data());
                         }
-                        v1Norm = std::sqrt(sum);
 
-                        value_type v1NormInv = (value_type)1.0 / v1Norm;
-                        for (cha = 0; cha<CHA; cha++)
+                        // the phase of U1 = D*V1 summed over the neighbourhood, which is the column sums times V1
+                        value_type* phr = vn.data();
+                        value_type* phi = phr + W;
+                        std::fill(phr, phr + 2 * W, value_type(0));
+                        for (long long cha = 0; cha < CHA; cha++)
                         {
-                            pV1[cha] *= v1NormInv;
+                            const value_type* sr = pColSum + cha * 2 * W;
+                            const value_type* si = sr + W;
+                            const value_type* vr = v.data() + cha * 2 * W;
+                            const value_type* vi = vr + W;
+#pragma omp simd
+                            for (long long ro = 0; ro < W; ro++)
+                            {
+                                phr[ro] += sr[ro] * vr[ro] - si[ro] * vi[ro];
+                                phi[ro] += sr[ro] * vi[ro] + si[ro] * vr[ro];
+                            }
                         }
-                    }
 
-                    gemm(U1, D, false, V1, false);
+                        for (long long ro = 0; ro < W; ro++)
+                        {
+                            const value_type a = value_type(1) / std::sqrt(phr[ro] * phr[ro] + phi[ro] * phi[ro]);
+                            phr[ro] *= a;
+                            phi[ro] *= a;
+                        }
 
-                    phaseU1 = pU1[0];
-                    for (po = 1; po<kss; po++)
-                    {
-                        phaseU1 += pU1[po];
+                        // put the mean object phase to the coil map, conj(V1)*phase
+                        T* pOut = pSen + e2*planeSize + (e1Start + t)*RO + roStart;
+                        for (long long cha = 0; cha < CHA; cha++)
+                        {
+                            const value_type* vr = v.data() + cha * 2 * W;
+                            const value_type* vi = vr + W;
+                            for (long long ro = 0; ro < TRO; ro++)
+                            {
+                                pOut[cha*volumeSize + ro] = T(vr[ro] * phr[ro] + vi[ro] * phi[ro], vr[ro] * phi[ro] - vi[ro] * phr[ro]);
+                            }
+                        }
                     }
-                    phaseU1 /= abs(phaseU1);
+                }
+            }
+        }
+    }
+}
 
-                    const value_type c = phaseU1.real();
-                    const value_type d = phaseU1.imag();
+template<typename T> 
+void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power)
+{
+    try
+    {
+        long long RO = data.get_size(0);
+        long long E1 = data.get_size(1);
+        long long CHA = data.get_size(2);
 
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        const T& v = pV1[cha];
-                        const value_type a = v.real();
-                        const value_type b = v.imag();
+        long long N = data.get_number_of_elements() / (RO*E1*CHA);
+        GADGET_CHECK_THROW(N == 1);
 
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[0] = a*c + b*d;
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[1] = a*d - b*c;
-                    }
+        if (!data.dimensions_equal(&coilMap))
+        {
+            coilMap = data;
+        }
 
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pSen[cha*RO*E1 + e1*RO + ro] = V1(cha, 0);
-                    }
-                }
-            }
+        if (ks % 2 != 1)
+        {
+            ks++;
         }
+
+        coil_map_Inati_box_filter(data.begin(), coilMap.begin(), RO, E1, 1, CHA, (long long)ks, 1, power);
     }
     catch (...)
     {
@@ -233,9 +368,6 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
 {
     try
     {
-        typedef typename realType<T>::Type value_type;
-        using std::abs;
-
         long long RO = data.get_size(0);
         long long E1 = data.get_size(1);
         long long E2 = data.get_size(2);
@@ -244,13 +376,10 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
         long long N = data.get_number_of_elements() / (RO*E1*E2*CHA);
         GADGET_CHECK_THROW(N == 1);
 
-        const T* pData = data.begin();
-
         if (!data.dimensions_equal(&coilMap))
         {
             coilMap = data;
         }
-        T* pSen = coilMap.begin();
 
         if (ks % 2 != 1)
         {
@@ -262,134 +391,7 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
             kz++;
         }
 
-        size_t kss = ks*ks*kz;
-        long long halfKs = (long long)ks / 2;
-        long long halfKz = (long long)kz / 2;
-
-        long long e2;
-
-        #pragma omp parallel default(none) private(e2) shared(ks, kz, RO, E1, E2, CHA, pSen, pData, halfKs, halfKz, power, kss)
-        {
-            hoMatrix<T> D(kss, CHA);
-            hoMatrix<T> DC(kss, CHA);
-            hoMatrix<T> DH_D(CHA, CHA);
-
-            hoMatrix<T> U1(kss, 1);
-            hoMatrix<T> V1(CHA, 1);
-            hoMatrix<T> V(CHA, 1);
-
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
-
-            T phaseU1;
-
-            value_type v1Norm(1);
-
-            long long cha, ro, e1, kro, dro, ke1, de1, ke2, de2;
-            size_t po;
-
-            #pragma omp for
-            for (e2 = 0; e2<(long long)E2; e2++)
-            {
-                for (e1 = 0; e1<(long long)E1; e1++)
-                {
-                    for (ro = 0; ro<(long long)RO; ro++)
-                    {
-                        // fill the data matrix D
-                        if (e2 >= halfKz && e2<E2 - halfKz && e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKz; ke2 <= halfKz; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + ro + kro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKz; ke2 <= halfKz; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    if (de2 < 0) de2 += E2;
-                                    if (de2 >= E2) de2 -= E2;
-
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        if (de1 < 0) de1 += E1;
-                                        if (de1 >= E1) de1 -= E1;
-
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            dro = ro + kro;
-                                            if (dro < 0) dro += RO;
-                                            if (dro >= RO) dro -= RO;
-
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + dro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        // compute V1
-                        D.sumOverCol(V1);
-                        v1Norm = nrm2(V1);
-                        scal((value_type)1.0 / v1Norm, V1);
-
-                        memcpy(DC.begin(), D.begin(), sizeof(T)*kss*CHA);
-                        gemm(DH_D, DC, true, D, false);
-                        // gemm(DH_D, D, true, D, false);
-
-                        for (po = 0; po<power; po++)
-                        {
-                            gemm(V, DH_D, false, V1, false);
-                            V1 = V;
-                            v1Norm = nrm2(V1);
-                            scal((value_type)1.0 / v1Norm, V1);
-                        }
-
-                        // compute U1
-                        gemm(U1, D, false, V1, false);
-
-                        phaseU1 = U1(0, 0);
-                        for (po = 1; po<kss; po++)
-                        {
-                            phaseU1 += U1(po, 0);
-                        }
-                        phaseU1 /= abs(phaseU1);
-
-                        // put the mean object phase to coil map
-                        conjugate(V1, V1);
-                        scal(phaseU1, V1);
-
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            pSen[cha*RO*E1*E2 + e2*RO*E1 + e1*RO + ro] = V1(cha, 0);
-                        }
-                    }
-                }
-            }
-        }
+        coil_map_Inati_box_filter(data.begin(), coilMap.begin(), RO, E1, E2, CHA, (long long)ks, (long long)kz, power);
     }
     catch (...)
     {
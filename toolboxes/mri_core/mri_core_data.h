@@ -177,6 +177,36 @@ namespace Gadgetron
 
   };
 
+  /**
+     Approximate size of the arrays held, in bytes, as counted by the node metrics for messages carrying these types.
+   */
+  inline size_t payload_size(const IsmrmrdDataBuffered& buffer)
+  {
+    size_t size = buffer.data_.get_number_of_bytes() + buffer.headers_.get_number_of_bytes();
+    if (buffer.trajectory_) size += buffer.trajectory_->get_number_of_bytes();
+    if (buffer.density_) size += buffer.density_->get_number_of_bytes();
+    return size;
+  }
+
+  inline size_t payload_size(const IsmrmrdReconData& recon_data)
+  {
+    size_t size = 0;
+    for (const auto& bit : recon_data.rbit_)
+    {
+      size += payload_size(bit.data_);
+      if (bit.ref_) size += payload_size(*bit.ref_);
+      if (bit.sms_ref_) size += payload_size(*bit.sms_ref_);
+    }
+    return size;
+  }
+
+  inline size_t payload_size(const IsmrmrdImageArray& image_array)
+  {
+    size_t size = image_array.data_.get_number_of_bytes() + image_array.headers_.get_number_of_bytes();
+    if (image_array.acq_headers_) size += image_array.acq_headers_->get_number_of_bytes();
+    return size;
+  }
+
 
   using ReconData = IsmrmrdReconData;
   using ImageArray = IsmrmrdImageArray;
@@ -775,6 +775,149 @@ template EXPORTMRICORE void grappa2d_unmixing_coeff(const hoNDArray< std::comple
 
 // ------------------------------------------------------------------------
 
+namespace
+{
+    // pixel tiles are sized so the gathered kernels, aliased and unwrapped pixels of a tile stay in L2
+    const size_t grappa_unwrapping_tile_bytes = 256 * 1024;
+    const size_t grappa_unwrapping_max_tile = 256;
+
+    // below this many aliased images per pixel, a gemm per pixel costs more than it saves
+    const size_t grappa_unwrapping_min_gemm_num = 4;
+
+    /// unwrap P pixels, with kerIm [P srcCHA dstCHA] and aliasedIm [P srcCHA num];
+    /// results go to channels [dstOffset, dstOffset+dstCHA) of complexIm [P outCHA num]
+    /// channels and images of aliasedIm and complexIm are imStride apart, so that P may be a slab of larger images
+    /// every pixel tile of kerIm is gathered once and applied to all num aliased images with one gemm per pixel
+    template <typename T>
+    void grappa_unwrap_pixel_tiles_gemm(const T* pKerIm, const T* pAliasedIm, size_t P, size_t imStride, size_t srcCHA, size_t dstCHA, size_t num,
+                                        T* pComplexIm, size_t outCHA, size_t dstOffset)
+    {
+        const size_t kerSize = srcCHA*dstCHA;
+        const size_t aliasedSize = srcCHA*num;
+        const size_t unwrappedSize = dstCHA*num;
+
+        const size_t pixelBytes = sizeof(T)*(kerSize + aliasedSize + unwrappedSize);
+        const size_t tile = std::max<size_t>(8, std::min<size_t>(grappa_unwrapping_max_tile, grappa_unwrapping_tile_bytes / pixelBytes));
+        const long long numTiles = (long long)((P + tile - 1) / tile);
+
+        long long t;
+
+#pragma omp parallel private(t) shared(pKerIm, pAliasedIm, pComplexIm) if(numTiles>1)
+        {
+            // per pixel, column-major [dstCHA srcCHA] kernel, [srcCHA num] aliased and [dstCHA num] unwrapped matrices
+            std::vector<T> ker(tile*kerSize), aliased(tile*aliasedSize), unwrapped(tile*unwrappedSize);
+
+#pragma omp for
+            for (t = 0; t < numTiles; t++)
+            {
+                const size_t p0 = t*tile;
+                const size_t np = std::min(tile, P - p0);
+
+                for (size_t d = 0; d < dstCHA; d++)
+                {
+                    for (size_t s = 0; s < srcCHA; s++)
+                    {
+                        const T* pKer = pKerIm + p0 + (s + d*srcCHA)*P;
+                        for (size_t p = 0; p < np; p++) ker[p*kerSize + d + s*dstCHA] = pKer[p];
+                    }
+                }
+
+                for (size_t n = 0; n < num; n++)
+                {
+                    for (size_t s = 0; s < srcCHA; s++)
+                    {
+                        const T* pAliased = pAliasedIm + p0 + (s + n*srcCHA)*imStride;
+                        for (size_t p = 0; p < np; p++) aliased[p*aliasedSize + s + n*srcCHA] = pAliased[p];
+                    }
+                }
+
+                for (size_t p = 0; p < np; p++)
+                {
+                    Gadgetron::BLAS::gemm(false, false, dstCHA, num, srcCHA, T(1),
+                        ker.data() + p*kerSize, dstCHA,
+                        aliased.data() + p*aliasedSize, srcCHA,
+                        T(0), unwrapped.data() + p*unwrappedSize, dstCHA);
+                }
+
+                for (size_t n = 0; n < num; n++)
+                {
+                    for (size_t d = 0; d < dstCHA; d++)
+                    {
+                        T* pUnwrapped = pComplexIm + p0 + (dstOffset + d + n*outCHA)*imStride;
+                        for (size_t p = 0; p < np; p++) pUnwrapped[p] = unwrapped[p*unwrappedSize + d + n*dstCHA];
+                    }
+                }
+            }
+        }
+    }
+
+    /// same as grappa_unwrap_pixel_tiles_gemm, but accumulates a pixel tile directly from kerIm and aliasedIm
+    /// the inner loop runs over the contiguous pixels of a tile, which is faster for very few aliased images
+    template <typename T>
+    void grappa_unwrap_pixel_tiles_direct(const T* pKerIm, const T* pAliasedIm, size_t P, size_t imStride, size_t srcCHA, size_t dstCHA, size_t num,
+                                          T* pComplexIm, size_t outCHA, size_t dstOffset)
+    {
+        typedef typename realType<T>::Type value_type;
+
+        const size_t tile = 64;
+        const long long numTiles = (long long)((P + tile - 1) / tile);
+
+        long long t;
+
+#pragma omp parallel private(t) shared(pKerIm, pAliasedIm, pComplexIm) if(numTiles>1)
+        {
+            value_type re[tile], im[tile];
+
+#pragma omp for
+            for (t = 0; t < numTiles; t++)
+            {
+                const size_t p0 = t*tile;
+                const size_t np = std::min(tile, P - p0);
+
+                for (size_t n = 0; n < num; n++)
+                {
+                    for (size_t d = 0; d < dstCHA; d++)
+                    {
+                        std::fill(re, re + tile, value_type(0));
+                        std::fill(im, im + tile, value_type(0));
+
+                        for (size_t s = 0; s < srcCHA; s++)
+                        {
+                            const value_type* k = reinterpret_cast<const value_type*>(pKerIm + p0 + (s + d*srcCHA)*P);
+                            const value_type* a = reinterpret_cast<const value_type*>(pAliasedIm + p0 + (s + n*srcCHA)*imStride);
+
+                            for (size_t p = 0; p < np; p++)
+                            {
+                                re[p] += k[2*p] * a[2*p] - k[2*p+1] * a[2*p+1];
+                                im[p] += k[2*p] * a[2*p+1] + k[2*p+1] * a[2*p];
+                            }
+                        }
+
+                        T* pUnwrapped = pComplexIm + p0 + (dstOffset + d + n*outCHA)*imStride;
+                        for (size_t p = 0; p < np; p++) pUnwrapped[p] = T(re[p], im[p]);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void grappa_unwrap_pixel_tiles(const T* pKerIm, const T* pAliasedIm, size_t P, size_t imStride, size_t srcCHA, size_t dstCHA, size_t num,
+                                   T* pComplexIm, size_t outCHA, size_t dstOffset)
+    {
+        if (num >= grappa_unwrapping_min_gemm_num)
+        {
+            grappa_unwrap_pixel_tiles_gemm(pKerIm, pAliasedIm, P, imStride, srcCHA, dstCHA, num, pComplexIm, outCHA, dstOffset);
+        }
+        else
+        {
+            grappa_unwrap_pixel_tiles_direct(pKerIm, pAliasedIm, P, imStride, srcCHA, dstCHA, num, pComplexIm, outCHA, dstOffset);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
 template <typename T> 
 void grappa2d_image_domain_unwrapping(const hoNDArray<T>& kspace, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm)
 {
@@ -823,6 +966,46 @@ void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray<T>& aliasedI
 
         size_t num = aliasedIm.get_number_of_elements() / (RO*E1*srcCHA);
 
+        grappa_unwrap_pixel_tiles(kerIm.begin(), aliasedIm.begin(), RO*E1, RO*E1, srcCHA, dstCHA, num, complexIm.begin(), dstCHA, 0);
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm) ... ");
+    }
+}
+
+template EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray< std::complex<float> >& aliasedIm, const hoNDArray< std::complex<float> >& kerIm, hoNDArray< std::complex<float> >& complexIm);
+template EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray< std::complex<double> >& aliasedIm, const hoNDArray< std::complex<double> >& kerIm, hoNDArray< std::complex<double> >& complexIm);
+
+// ------------------------------------------------------------------------
+
+template <typename T> 
+void grappa2d_image_domain_unwrapping_aliased_image_elementwise(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm)
+{
+    try
+    {
+        size_t RO = kerIm.get_size(0);
+        size_t E1 = kerIm.get_size(1);
+        size_t srcCHA = kerIm.get_size(2);
+        size_t dstCHA = kerIm.get_size(3);
+
+        GADGET_CHECK_THROW(aliasedIm.get_size(0) == RO);
+        GADGET_CHECK_THROW(aliasedIm.get_size(1) == E1);
+        GADGET_CHECK_THROW(aliasedIm.get_size(2) == srcCHA);
+
+        std::vector<size_t> dim;
+        aliasedIm.get_dimensions(dim);
+
+        std::vector<size_t> dimIm(dim);
+        dimIm[2] = dstCHA;
+
+        if (!complexIm.dimensions_equal(&dimIm))
+        {
+            complexIm.create(dimIm);
+        }
+
+        size_t num = aliasedIm.get_number_of_elements() / (RO*E1*srcCHA);
+
         long long n;
 
 #pragma omp parallel default(none) private(n) shared(kerIm, num, aliasedIm, RO, E1, srcCHA, dstCHA, complexIm) if(num>=16)
@@ -852,12 +1035,12 @@ void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray<T>& aliasedI
     }
     catch (...)
     {
-        GADGET_THROW("Errors in grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm) ... ");
+        GADGET_THROW("Errors in grappa2d_image_domain_unwrapping_aliased_image_elementwise(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm) ... ");
     }
 }
 
-template EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray< std::complex<float> >& aliasedIm, const hoNDArray< std::complex<float> >& kerIm, hoNDArray< std::complex<float> >& complexIm);
-template EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray< std::complex<double> >& aliasedIm, const hoNDArray< std::complex<double> >& kerIm, hoNDArray< std::complex<double> >& complexIm);
+template EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image_elementwise(const hoNDArray< std::complex<float> >& aliasedIm, const hoNDArray< std::complex<float> >& kerIm, hoNDArray< std::complex<float> >& complexIm);
+template EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image_elementwise(const hoNDArray< std::complex<double> >& aliasedIm, const hoNDArray< std::complex<double> >& kerIm, hoNDArray< std::complex<double> >& complexIm);
 
 // ------------------------------------------------------------------------
 
@@ -1563,6 +1746,27 @@ template <typename T>
 void grappa3d_image_domain_unwrapping(const hoNDArray<T>& convKer, const hoNDArray<T>& kspace,
                                 size_t acceFactorE1, size_t acceFactorE2,
                                 hoNDArray<T>& complexIm)
+{
+    try
+    {
+        hoNDArray<T> aliasedIm(kspace.dimensions());
+        Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(kspace, aliasedIm);
+
+        Gadgetron::grappa3d_image_domain_unwrapping_aliasedImage(convKer, aliasedIm, acceFactorE1, acceFactorE2, complexIm);
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa3d_image_domain_unwrapping(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping(const hoNDArray< std::complex<float> >& convKer, const hoNDArray< std::complex<float> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<float> >& complexIm);
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping(const hoNDArray< std::complex<double> >& convKer, const hoNDArray< std::complex<double> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<double> >& complexIm);
+
+template <typename T>
+void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray<T>& convKer, const hoNDArray<T>& aliasedIm,
+                                            size_t acceFactorE1, size_t acceFactorE2,
+                                            hoNDArray<T>& complexIm, size_t maxKernelBytes)
 {
     try
     {
@@ -1572,88 +1776,133 @@ void grappa3d_image_domain_unwrapping(const hoNDArray<T>& convKer, const hoNDArr
         size_t srcCHA = convKer.get_size(3);
         size_t dstCHA = convKer.get_size(4);
 
-        size_t RO = kspace.get_size(0);
-        size_t E1 = kspace.get_size(1);
-        size_t E2 = kspace.get_size(2);
+        size_t RO = aliasedIm.get_size(0);
+        size_t E1 = aliasedIm.get_size(1);
+        size_t E2 = aliasedIm.get_size(2);
 
-        GADGET_CHECK_THROW(kspace.get_size(3) == srcCHA);
+        GADGET_CHECK_THROW(aliasedIm.get_size(3) == srcCHA);
 
-        size_t N = kspace.get_size(4);
+        size_t N = aliasedIm.get_number_of_elements() / (RO*E1*E2*srcCHA);
 
         std::vector<size_t> dim;
-        kspace.get_dimensions(dim);
+        aliasedIm.get_dimensions(dim);
 
         std::vector<size_t> dimRes(dim);
         dimRes[3] = dstCHA;
 
         if (!complexIm.dimensions_equal(&dimRes))
         {
-            complexIm.create(dim);
+            complexIm.create(dimRes);
         }
 
-        Gadgetron::clear(&complexIm);
-
-        // compute aliased image
-
-        hoNDArray<T> aliasedIm;
-        aliasedIm.create(dim);
-
-        Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(kspace, aliasedIm);
-
         // scaled conv kernel
         hoNDArray<T> convKerScaled;
         convKerScaled = convKer;
 
         Gadgetron::scal((typename realType<T>::Type)(std::sqrt((double)(RO*E1*E2))), convKerScaled);
 
-        long long dcha;
+        // image domain kernels of all channel pairs rarely fit in memory for 3D, so they are computed for E2 slabs of as
+        // many dst channels at a time as fit in maxKernelBytes, together with the 2D transformed kernel planes
+        // the kernels are separable: ifft2c of the kE2 non-zero kernel planes, then an inverse DFT of kE2 terms along E2
+        typedef typename realType<T>::Type value_type;
 
-#pragma omp parallel private(dcha) shared(RO, E1, E2, srcCHA, dstCHA, kRO, kE1, kE2, convKerScaled, aliasedIm, complexIm)
+        size_t planeSize = RO*E1;
+        size_t P = planeSize*E2;
+        size_t planeBytes = planeSize*srcCHA*sizeof(T);
+
+        size_t groupCHA = maxKernelBytes / ((kE2 + 1)*planeBytes);
+        groupCHA = std::max((size_t)1, std::min(dstCHA, groupCHA));
+
+        size_t slabE2 = maxKernelBytes / (groupCHA*planeBytes);
+        slabE2 = (slabE2 > kE2) ? std::min(E2, slabE2 - kE2) : 1;
+
+        // weight of kernel plane j in slice z of the centered, unitary inverse DFT along E2
+        hoNDArray<T> phase(kE2, E2);
+        for (size_t z = 0; z < E2; z++)
         {
-            hoNDArray<T> convKerCha;
-            hoNDArray<T> convKerChaPadded;
-            convKerChaPadded.create(RO, E1, E2);
+            for (size_t j = 0; j < kE2; j++)
+            {
+                double arg = 2 * M_PI * ((double)j - (double)(kE2 / 2)) * ((double)z - (double)(E2 / 2)) / (double)E2;
+                phase(j, z) = T((value_type)(std::cos(arg) / std::sqrt((double)E2)), (value_type)(std::sin(arg) / std::sqrt((double)E2)));
+            }
+        }
 
-            hoNDArray<T> kImCha, kImTmp;
-            kImCha.create(RO, E1, E2);
-            kImTmp.create(RO, E1, E2);
+        hoNDArray<T> kPlanes(RO, E1, kE2, srcCHA, groupCHA);
+        hoNDArray<T> kIm(RO, E1, slabE2, srcCHA, groupCHA);
 
-            hoNDArray<T> aliasedImCha;
-            hoNDArray<T> complexImCha;
+        for (size_t dstStart = 0; dstStart < dstCHA; dstStart += groupCHA)
+        {
+            size_t numCHA = std::min(groupCHA, dstCHA - dstStart);
 
-#pragma omp for 
-            for (dcha = 0; dcha < (long long)dstCHA; dcha++)
+            long long ii;
+
+#pragma omp parallel private(ii) shared(RO, E1, kRO, kE1, kE2, srcCHA, dstStart, numCHA, planeSize, convKerScaled, kPlanes)
             {
-                for (size_t scha = 0; scha < srcCHA; scha++)
+                hoNDArray<T> convKerCha;
+                hoNDArray<T> convKerChaPadded;
+                convKerChaPadded.create(RO, E1, kE2);
+
+                hoNDArray<T> kPlanesCha;
+
+#pragma omp for 
+                for (ii = 0; ii < (long long)(srcCHA*numCHA); ii++)
                 {
+                    size_t scha = ii % srcCHA;
+                    size_t dcha = dstStart + ii / srcCHA;
+
                     convKerCha.create(kRO, kE1, kE2, convKerScaled.begin() + scha*kRO*kE1*kE2 + dcha*kRO*kE1*kE2*srcCHA);
-                    Gadgetron::pad(RO, E1, E2, convKerCha, convKerChaPadded, true);
-                    Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(convKerChaPadded, kImCha, kImTmp);
+                    Gadgetron::pad(RO, E1, convKerCha, convKerChaPadded, true);
 
-                    for (size_t n = 0; n < N; n++)
-                    {
-                        complexImCha.create(RO, E1, E2, complexIm.begin() + dcha*RO*E1*E2 + n*RO*E1*E2*dstCHA);
+                    kPlanesCha.create(RO, E1, kE2, kPlanes.begin() + ii*planeSize*kE2);
+                    Gadgetron::hoNDFFT<value_type>::instance()->ifft2c(convKerChaPadded, kPlanesCha);
+                }
+            }
 
-                        aliasedImCha.create(RO, E1, E2, aliasedIm.begin() + scha*RO*E1*E2 + n*RO*E1*E2*srcCHA);
+            for (size_t z0 = 0; z0 < E2; z0 += slabE2)
+            {
+                size_t numE2 = std::min(slabE2, E2 - z0);
+                size_t slabSize = planeSize*numE2;
 
-                        Gadgetron::multiply(kImCha, aliasedImCha, kImTmp);
-                        Gadgetron::add(complexImCha, kImTmp, complexImCha);
+#pragma omp parallel for private(ii) shared(kE2, z0, numE2, planeSize, slabSize, phase, kPlanes, kIm)
+                for (ii = 0; ii < (long long)(srcCHA*numCHA*numE2); ii++)
+                {
+                    size_t pair = ii / numE2;
+                    size_t z = ii % numE2;
+
+                    const value_type* planes = reinterpret_cast<const value_type*>(kPlanes.begin() + pair*planeSize*kE2);
+                    value_type* out = reinterpret_cast<value_type*>(kIm.begin() + pair*slabSize + z*planeSize);
+                    std::fill(out, out + 2*planeSize, value_type(0));
+
+                    for (size_t j = 0; j < kE2; j++)
+                    {
+                        const value_type wr = phase(j, z0 + z).real();
+                        const value_type wi = phase(j, z0 + z).imag();
+                        const value_type* p = planes + 2*j*planeSize;
+
+                        for (size_t x = 0; x < planeSize; x++)
+                        {
+                            out[2*x] += wr * p[2*x] - wi * p[2*x+1];
+                            out[2*x+1] += wr * p[2*x+1] + wi * p[2*x];
+                        }
                     }
                 }
+
+                grappa_unwrap_pixel_tiles(kIm.begin(), aliasedIm.begin() + z0*planeSize, slabSize, P, srcCHA, numCHA, N,
+                                          complexIm.begin() + z0*planeSize, dstCHA, dstStart);
             }
         }
     }
     catch (...)
     {
-        GADGET_THROW("Errors in grappa3d_image_domain_unwrapping(...) ... ");
+        GADGET_THROW("Errors in grappa3d_image_domain_unwrapping_aliasedImage(...) ... ");
     }
 }
 
-template EXPORTMRICORE void grappa3d_image_domain_unwrapping(const hoNDArray< std::complex<float> >& convKer, const hoNDArray< std::complex<float> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<float> >& complexIm);
-template EXPORTMRICORE void grappa3d_image_domain_unwrapping(const hoNDArray< std::complex<double> >& convKer, const hoNDArray< std::complex<double> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<double> >& complexIm);
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray< std::complex<float> >& convKer, const hoNDArray< std::complex<float> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<float> >& complexIm, size_t maxKernelBytes);
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray< std::complex<double> >& convKer, const hoNDArray< std::complex<double> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<double> >& complexIm, size_t maxKernelBytes);
 
 template <typename T>
-void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray<T>& convKer, const hoNDArray<T>& aliasedIm,
+void grappa3d_image_domain_unwrapping_aliasedImage_elementwise(const hoNDArray<T>& convKer, const hoNDArray<T>& aliasedIm,
                                             size_t acceFactorE1, size_t acceFactorE2,
                                             hoNDArray<T>& complexIm)
 {
@@ -1681,7 +1930,7 @@ void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray<T>& convKer,
 
         if (!complexIm.dimensions_equal(&dimRes))
         {
-            complexIm.create(dim);
+            complexIm.create(dimRes);
         }
 
         Gadgetron::clear(&complexIm);
@@ -1731,12 +1980,12 @@ void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray<T>& convKer,
     }
     catch (...)
     {
-        GADGET_THROW("Errors in grappa3d_image_domain_unwrapping_aliasedImage(...) ... ");
+        GADGET_THROW("Errors in grappa3d_image_domain_unwrapping_aliasedImage_elementwise(...) ... ");
     }
 }
 
-template EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray< std::complex<float> >& convKer, const hoNDArray< std::complex<float> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<float> >& complexIm);
-template EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray< std::complex<double> >& convKer, const hoNDArray< std::complex<double> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<double> >& complexIm);
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage_elementwise(const hoNDArray< std::complex<float> >& convKer, const hoNDArray< std::complex<float> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<float> >& complexIm);
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage_elementwise(const hoNDArray< std::complex<double> >& convKer, const hoNDArray< std::complex<double> >& kspace, size_t acceFactorE1, size_t acceFactorE2, hoNDArray< std::complex<double> >& complexIm);
 
 // ------------------------------------------------------------------------
 
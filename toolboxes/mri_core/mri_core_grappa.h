@@ -47,7 +47,10 @@ namespace Gadgetron {
     /// complexIm: [RO E1 dstCHA ... ]
     template <typename T> EXPORTMRICORE void grappa2d_image_domain_unwrapping(const hoNDArray<T>& kspace, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm);
     /// aliasedIm : [RO E1 srcCHA ...]
+    /// pixels are unwrapped in cache sized tiles; for several aliased images, each pixel is one complex gemm over all of them
     template <typename T> EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm);
+    /// same as grappa2d_image_domain_unwrapping_aliased_image, with elementwise multiplications per dstCHA and image
+    template <typename T> EXPORTMRICORE void grappa2d_image_domain_unwrapping_aliased_image_elementwise(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& kerIm, hoNDArray<T>& complexIm);
 
     /// apply unmixing coefficient on undersampled kspace
     /// kspace: [RO E1 srcCHA ...]
@@ -170,7 +173,13 @@ namespace Gadgetron {
                                                                         hoNDArray<T>& complexIm);
 
     /// aliasedIm: wrapped complex images [RO E1 E2 srcCHA] or [RO E1 E2 srcCHA N]
+    /// maxKernelBytes: memory for the image domain kernels, which are computed and applied in E2 slabs that fit in it
     template <typename T> EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage(const hoNDArray<T>& convKer, const hoNDArray<T>& aliasedIm,
+                                                                        size_t acceFactorE1, size_t acceFactorE2,
+                                                                        hoNDArray<T>& complexIm, size_t maxKernelBytes = size_t(1) << 30);
+
+    /// same as grappa3d_image_domain_unwrapping_aliasedImage, with elementwise multiplications per channel pair and image
+    template <typename T> EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage_elementwise(const hoNDArray<T>& convKer, const hoNDArray<T>& aliasedIm,
                                                                         size_t acceFactorE1, size_t acceFactorE2,
                                                                         hoNDArray<T>& complexIm);
 
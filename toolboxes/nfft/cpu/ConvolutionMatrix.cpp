@@ -6,7 +6,6 @@
 #include <GadgetronTimer.h>
 #include <numeric>
 #include "vector_td_utilities.h"
-#include <boost/range/irange.hpp>
 
 namespace
 {
@@ -81,20 +80,41 @@ namespace
 template<class REAL, unsigned int D, template<class, unsigned int> class K>
 Gadgetron::ConvInternal::ConvolutionMatrix<REAL>
 Gadgetron::ConvInternal::make_conv_matrix(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<REAL, D>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<REAL, D>>& trajectory,
     const Gadgetron::vector_td<size_t, D> &matrix_size,
     const ConvolutionKernel<REAL, D, K>& kernel)
 {
-    ConvolutionMatrix<REAL> matrix(trajectory.get_number_of_elements(),
-                                   prod(matrix_size));
-    
+    const size_t num_samples = trajectory.get_number_of_elements();
+
+    // The entries of each sample are computed independently, then packed into
+    // the compressed rows.
+    std::vector<std::vector<size_t>> sample_indices(num_samples);
+    std::vector<std::vector<REAL>> sample_weights(num_samples);
+
     #pragma omp parallel for 
-    for (int i = 0; i < (int)trajectory.get_number_of_elements(); i++)
+    for (int i = 0; i < (int)num_samples; i++)
     {
-        std::tie(matrix.indices[i], matrix.weights[i]) = get_indices(
+        std::tie(sample_indices[i], sample_weights[i]) = get_indices(
             trajectory[i], matrix_size, kernel);
     }
 
+    ConvolutionMatrix<REAL> matrix(num_samples, prod(matrix_size));
+
+    for (size_t i = 0; i < num_samples; i++)
+        matrix.offsets[i + 1] = matrix.offsets[i] + sample_indices[i].size();
+
+    matrix.indices.resize(matrix.offsets.back());
+    matrix.weights.resize(matrix.offsets.back());
+
+    #pragma omp parallel for 
+    for (int i = 0; i < (int)num_samples; i++)
+    {
+        std::copy(sample_indices[i].begin(), sample_indices[i].end(),
+                  matrix.indices.begin() + matrix.offsets[i]);
+        std::copy(sample_weights[i].begin(), sample_weights[i].end(),
+                  matrix.weights.begin() + matrix.offsets[i]);
+    }
+
     return matrix;
 }
 
@@ -103,33 +123,28 @@ template<class REAL>
 Gadgetron::ConvInternal::ConvolutionMatrix<REAL>
 Gadgetron::ConvInternal::transpose(const Gadgetron::ConvInternal::ConvolutionMatrix<REAL> &matrix) {
 
-    auto work_index = boost::irange(size_t(0),matrix.n_cols);
-
     ConvolutionMatrix<REAL> transposed(matrix.n_rows, matrix.n_cols);
 
-    std::vector<int> counts(matrix.n_rows, 0);
+    // Count the entries of each row, then fill the rows in column order so the
+    // entries of every transposed row stay sorted.
+    for (size_t row : matrix.indices)
+        transposed.offsets[row + 1]++;
 
-    for (size_t i : work_index)
-    {
-        auto &rows = matrix.indices[i];
-        for (auto &row : rows)
-            counts[row]++;
-    }
+    for (size_t i = 0; i < matrix.n_rows; i++)
+        transposed.offsets[i + 1] += transposed.offsets[i];
 
-    for (size_t i = 0; i < counts.size(); i++)
-    {
-        transposed.indices[i].reserve(counts[i]);
-        transposed.weights[i].reserve(counts[i]);
-    }
+    transposed.indices.resize(matrix.indices.size());
+    transposed.weights.resize(matrix.weights.size());
+
+    std::vector<size_t> positions(transposed.offsets.begin(), transposed.offsets.end() - 1);
 
-    for (size_t i : work_index )
+    for (size_t i = 0; i < matrix.n_cols; i++)
     {
-        auto &rows = matrix.indices[i];
-        auto &weights = matrix.weights[i];
-        for (size_t n = 0; n < rows.size(); n++)
+        for (size_t n = matrix.offsets[i]; n < matrix.offsets[i + 1]; n++)
         {
-            transposed.indices[rows[n]].push_back(i);
-            transposed.weights[rows[n]].push_back(weights[n]);
+            size_t position = positions[matrix.indices[n]]++;
+            transposed.indices[position] = i;
+            transposed.weights[position] = matrix.weights[n];
         }
     }
 
@@ -139,97 +154,97 @@ Gadgetron::ConvInternal::transpose(const Gadgetron::ConvInternal::ConvolutionMat
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 1, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 1>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 1>>& trajectory,
     const Gadgetron::vector_td<size_t, 1> &matrix_size,
     const ConvolutionKernel<float, 1, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 2, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 2>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 2>>& trajectory,
     const Gadgetron::vector_td<size_t, 2> &matrix_size,
     const ConvolutionKernel<float, 2, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 3, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 3>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 3>>& trajectory,
     const Gadgetron::vector_td<size_t, 3> &matrix_size,
     const ConvolutionKernel<float, 3, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 4, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 4>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 4>>& trajectory,
     const Gadgetron::vector_td<size_t, 4> &matrix_size,
     const ConvolutionKernel<float, 4, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 1, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 1>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 1>>& trajectory,
     const Gadgetron::vector_td<size_t, 1> &matrix_size,
     const ConvolutionKernel<double, 1, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 2, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 2>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 2>>& trajectory,
     const Gadgetron::vector_td<size_t, 2> &matrix_size,
     const ConvolutionKernel<double, 2, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 3, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 3>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 3>>& trajectory,
     const Gadgetron::vector_td<size_t, 3> &matrix_size,
     const ConvolutionKernel<double, 3, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 4, Gadgetron::KaiserKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 4>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 4>>& trajectory,
     const Gadgetron::vector_td<size_t, 4> &matrix_size,
     const ConvolutionKernel<double, 4, Gadgetron::KaiserKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 1, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 1>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 1>>& trajectory,
     const Gadgetron::vector_td<size_t, 1> &matrix_size,
     const ConvolutionKernel<float, 1, Gadgetron::JincKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 2, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 2>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 2>>& trajectory,
     const Gadgetron::vector_td<size_t, 2> &matrix_size,
     const ConvolutionKernel<float, 2, Gadgetron::JincKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 3, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 3>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 3>>& trajectory,
     const Gadgetron::vector_td<size_t, 3> &matrix_size,
     const ConvolutionKernel<float, 3, Gadgetron::JincKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<float>
 Gadgetron::ConvInternal::make_conv_matrix<float, 4, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 4>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<float, 4>>& trajectory,
     const Gadgetron::vector_td<size_t, 4> &matrix_size,
     const ConvolutionKernel<float, 4, Gadgetron::JincKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 1, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 1>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 1>>& trajectory,
     const Gadgetron::vector_td<size_t, 1> &matrix_size,
     const ConvolutionKernel<double, 1, Gadgetron::JincKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 2, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 2>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 2>>& trajectory,
     const Gadgetron::vector_td<size_t, 2> &matrix_size,
     const ConvolutionKernel<double, 2, Gadgetron::JincKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 3, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 3>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 3>>& trajectory,
     const Gadgetron::vector_td<size_t, 3> &matrix_size,
     const ConvolutionKernel<double, 3, Gadgetron::JincKernel>& kernel);
 
 template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::make_conv_matrix<double, 4, Gadgetron::JincKernel>(
-    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 4>> trajectory,
+    const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 4>>& trajectory,
     const Gadgetron::vector_td<size_t, 4> &matrix_size,
     const ConvolutionKernel<double, 4, Gadgetron::JincKernel>& kernel);
 
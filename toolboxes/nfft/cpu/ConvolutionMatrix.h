@@ -10,10 +10,18 @@ namespace Gadgetron
 {
     namespace ConvInternal
     {
+        /**
+         * \brief Sparse convolution matrix in compressed sparse row format.
+         *
+         * Output element i is the sum over n in [offsets[i], offsets[i + 1]) of
+         * weights[n] * input[indices[n]]. n_cols is the number of output
+         * elements and n_rows the number of input elements.
+         */
         template<class REAL>
         struct ConvolutionMatrix
         {
             ConvolutionMatrix()
+              : n_cols(0), n_rows(0)
             {
                 
             }
@@ -21,13 +29,23 @@ namespace Gadgetron
             ConvolutionMatrix(size_t cols, size_t rows)
               : n_cols(cols),n_rows(rows)
             {
-                weights = std::vector<std::vector<REAL>>(n_cols);
-                indices = std::vector<std::vector<size_t>>(n_cols);
+                offsets = std::vector<size_t>(n_cols + 1, 0);
+            }
+
+            /**
+             * \brief Size of the matrix in bytes.
+             */
+            size_t get_number_of_bytes() const
+            {
+                return offsets.size() * sizeof(size_t) +
+                       indices.size() * sizeof(size_t) +
+                       weights.size() * sizeof(REAL);
             }
 
-            std::vector<std::vector<REAL>> weights;
-            std::vector<std::vector<size_t>> indices;
             size_t n_cols, n_rows;
+            std::vector<size_t> offsets;
+            std::vector<size_t> indices;
+            std::vector<REAL> weights;
         };
 
 
@@ -36,7 +54,7 @@ namespace Gadgetron
 
         template<class REAL, unsigned int D, template<class, unsigned int> class K>
         ConvolutionMatrix<REAL> make_conv_matrix(
-            const hoNDArray<vector_td<REAL, D>> trajectory,
+            const hoNDArray<vector_td<REAL, D>>& trajectory,
             const vector_td<size_t, D> &matrix_size,
             const ConvolutionKernel<REAL, D, K>& kernel);
     }
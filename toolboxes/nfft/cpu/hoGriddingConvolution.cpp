@@ -5,6 +5,13 @@
 #include "NDArray_utils.h"
 
 #include "ConvolutionMatrix.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string_view>
 
 namespace Gadgetron
 {
@@ -39,70 +46,297 @@ namespace Gadgetron
     }
 
 
+    namespace
+    {
+        template<class REAL>
+        using ConvolutionMatrices = std::vector<ConvInternal::ConvolutionMatrix<REAL>>;
+
+        template<class REAL>
+        size_t get_number_of_bytes(const std::shared_ptr<const ConvolutionMatrices<REAL>>& matrices)
+        {
+            size_t bytes = 0;
+            if (matrices)
+                for (auto& matrix : *matrices) bytes += matrix.get_number_of_bytes();
+            return bytes;
+        }
+
+        /**
+         * \brief Convolution matrices of recently preprocessed trajectories.
+         *
+         * Real-time protocols preprocess the same trajectory for every frame;
+         * the cache lets them pay for building the matrices once. Entries are
+         * matched on the full trajectory, not just its hash, and the least
+         * recently used ones are evicted once the cache exceeds its budget.
+         */
+        template<class REAL, unsigned int D>
+        class ConvolutionMatrixCache
+        {
+        public:
+            struct Matrices
+            {
+                std::shared_ptr<const ConvolutionMatrices<REAL>> forward;
+                std::shared_ptr<const ConvolutionMatrices<REAL>> transposed;
+            };
+
+            Matrices find(const hoNDArray<vector_td<REAL, D>>& trajectory,
+                          const vector_td<size_t, D>& matrix_size,
+                          const vector_td<size_t, D>& matrix_size_os,
+                          REAL width)
+            {
+                size_t hash = hash_trajectory(trajectory);
+
+                std::lock_guard<std::mutex> guard(mutex_);
+                for (auto it = entries_.begin(); it != entries_.end(); ++it)
+                {
+                    if (it->hash == hash && it->matrix_size == matrix_size &&
+                        it->matrix_size_os == matrix_size_os && it->width == width &&
+                        it->trajectory.dimensions() == trajectory.dimensions() &&
+                        std::equal(trajectory.begin(), trajectory.end(), it->trajectory.begin()))
+                    {
+                        entries_.splice(entries_.begin(), entries_, it);
+                        return it->matrices;
+                    }
+                }
+                return Matrices();
+            }
+
+            void insert(const hoNDArray<vector_td<REAL, D>>& trajectory,
+                        const vector_td<size_t, D>& matrix_size,
+                        const vector_td<size_t, D>& matrix_size_os,
+                        REAL width,
+                        const Matrices& matrices)
+            {
+                Entry entry{ hash_trajectory(trajectory), trajectory, matrix_size, matrix_size_os, width, matrices,
+                             get_number_of_bytes(matrices.forward) + get_number_of_bytes(matrices.transposed) };
+
+                std::lock_guard<std::mutex> guard(mutex_);
+                entries_.remove_if([&](const Entry& e)
+                {
+                    return e.hash == entry.hash && e.matrix_size == matrix_size &&
+                           e.matrix_size_os == matrix_size_os && e.width == width &&
+                           e.trajectory.dimensions() == trajectory.dimensions() &&
+                           std::equal(trajectory.begin(), trajectory.end(), e.trajectory.begin());
+                });
+                entries_.push_front(std::move(entry));
+
+                // The newest entry is kept even if it exceeds the budget on its own.
+                while (entries_.size() > 1 && total_bytes() > max_bytes)
+                    entries_.pop_back();
+            }
+
+        private:
+            static constexpr size_t max_bytes = size_t(1) << 30;
+
+            struct Entry
+            {
+                size_t hash;
+                hoNDArray<vector_td<REAL, D>> trajectory;
+                vector_td<size_t, D> matrix_size;
+                vector_td<size_t, D> matrix_size_os;
+                REAL width;
+                Matrices matrices;
+                size_t bytes;
+            };
+
+            static size_t hash_trajectory(const hoNDArray<vector_td<REAL, D>>& trajectory)
+            {
+                return std::hash<std::string_view>()(std::string_view(
+                    reinterpret_cast<const char*>(trajectory.get_data_ptr()),
+                    trajectory.get_number_of_bytes()));
+            }
+
+            size_t total_bytes() const
+            {
+                size_t bytes = 0;
+                for (auto& entry : entries_) bytes += entry.bytes;
+                return bytes;
+            }
+
+            std::mutex mutex_;
+            std::list<Entry> entries_;
+        };
+
+        /**
+         * \brief The cache shared by all convolutions with kernel K.
+         */
+        template<class REAL, unsigned int D, template<class, unsigned int> class K>
+        ConvolutionMatrixCache<REAL, D>& get_matrix_cache()
+        {
+            static ConvolutionMatrixCache<REAL, D> cache;
+            return cache;
+        }
+    }
+
+
     template<class T, unsigned int D, template<class, unsigned int> class K>
     void hoGriddingConvolution<T, D, K>::preprocess(
         const hoNDArray<vector_td<REAL, D>> &trajectory,
         GriddingConvolutionPrepMode prep_mode)
     {       
+        auto start = std::chrono::steady_clock::now();
+
         GriddingConvolutionBase<hoNDArray, T, D, K>::preprocess(
             trajectory, prep_mode);
 
-        auto scaled_trajectory = trajectory;
-        auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os_);
-        std::transform(scaled_trajectory.begin(),
-                       scaled_trajectory.end(),
-                       scaled_trajectory.begin(),
-                       [matrix_size_os_real](auto point)
-                       { return (point + REAL(0.5)) * matrix_size_os_real; });
+        bool need_transpose = prep_mode == GriddingConvolutionPrepMode::NC2C ||
+                              prep_mode == GriddingConvolutionPrepMode::ALL;
 
-        conv_matrix_.reserve(this->num_frames_);
-        conv_matrix_T_.reserve(this->num_frames_);
+        auto& cache = get_matrix_cache<REAL, D, K>();
+        auto matrices = cache.find(trajectory, this->matrix_size_, this->matrix_size_os_,
+                                   this->kernel_.get_width());
 
-        for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(
-                            scaled_trajectory, 0))
-        {
-            conv_matrix_.push_back(ConvInternal::make_conv_matrix(
-                traj, this->matrix_size_os_, this->kernel_));
+        bool cached = matrices.forward && (matrices.transposed || !need_transpose);
 
-            if (prep_mode == GriddingConvolutionPrepMode::NC2C ||
-                prep_mode == GriddingConvolutionPrepMode::ALL)
+        if (!matrices.forward)
+        {
+            auto scaled_trajectory = trajectory;
+            auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os_);
+            std::transform(scaled_trajectory.begin(),
+                           scaled_trajectory.end(),
+                           scaled_trajectory.begin(),
+                           [matrix_size_os_real](auto point)
+                           { return (point + REAL(0.5)) * matrix_size_os_real; });
+
+            auto forward = std::make_shared<ConvolutionMatrices<REAL>>();
+            forward->reserve(this->num_frames_);
+
+            for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(
+                                scaled_trajectory, 0))
             {
-                conv_matrix_T_.push_back(ConvInternal::transpose(conv_matrix_.back()));
+                forward->push_back(ConvInternal::make_conv_matrix(
+                    traj, this->matrix_size_os_, this->kernel_));
             }
+            matrices.forward = forward;
+        }
+
+        if (need_transpose && !matrices.transposed)
+        {
+            auto transposed = std::make_shared<ConvolutionMatrices<REAL>>();
+            transposed->reserve(matrices.forward->size());
+            for (auto& matrix : *matrices.forward)
+                transposed->push_back(ConvInternal::transpose(matrix));
+            matrices.transposed = transposed;
         }
+
+        if (!cached)
+            cache.insert(trajectory, this->matrix_size_, this->matrix_size_os_,
+                         this->kernel_.get_width(), matrices);
+
+        conv_matrix_ = matrices.forward;
+        conv_matrix_T_ = matrices.transposed;
+
+        timings_ = hoGriddingConvolutionTimings();
+        timings_.preprocess_cached = cached;
+        timings_.preprocess_seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        GDEBUG_STREAM("Gridding convolution preprocessing took " << timings_.preprocess_seconds * 1e3
+                      << " ms" << (cached ? " (cached)" : ""));
+    }
+
+
+    template<class T, unsigned int D, template<class, unsigned int> class K>
+    const hoGriddingConvolutionTimings& hoGriddingConvolution<T, D, K>::get_timings() const
+    {
+        return timings_;
     }
 
 
     namespace
     {   
+        // Rows are convolved in blocks of this size, so a single batch is
+        // still spread over all threads.
+        constexpr size_t mvm_block_size = 256;
+
         /**
-         * \brief Matrix-vector multiplication.
+         * \brief Matrix-vector multiplication over a block of rows.
          * 
          * \tparam T Value type. Can be real or complex.
          * \param[in] matrix Convolution matrix.
          * \param[in] vector Vector.
          * \param[out] result Operation result.
+         * \param[in] begin First row.
+         * \param[in] end One past the last row.
+         * \param[in] accumulate If true, add to the result instead of overwriting it.
          */
         template<class T>
         void mvm(
             const ConvInternal::ConvolutionMatrix<realType_t<T>>& matrix,
             const T* vector,
-            T* result)
+            T* result,
+            size_t begin,
+            size_t end,
+            bool accumulate)
         {
-            for (size_t i = 0; i < matrix.n_cols; i++)
+            using REAL = realType_t<T>;
+
+            for (size_t i = begin; i < end; i++)
             {
-                auto &row_indices = matrix.indices[i];
-                auto &weights = matrix.weights[i];
+                const size_t* indices = matrix.indices.data() + matrix.offsets[i];
+                const REAL* weights = matrix.weights.data() + matrix.offsets[i];
+                const size_t count = matrix.offsets[i + 1] - matrix.offsets[i];
 
-                #ifndef WIN32
-                    #pragma omp simd
-                #endif // WIN32
-                for (size_t n = 0; n < row_indices.size(); n++)
+                if constexpr (std::is_same<T, complext<REAL>>::value)
+                {
+                    // Real and imaginary parts are summed separately, which
+                    // lets the compiler vectorise the gathers.
+                    const REAL* v = reinterpret_cast<const REAL*>(vector);
+                    REAL re = 0, im = 0;
+
+                    #ifndef WIN32
+                        #pragma omp simd reduction(+:re,im)
+                    #endif // WIN32
+                    for (size_t n = 0; n < count; n++)
+                    {
+                        re += v[2 * indices[n]] * weights[n];
+                        im += v[2 * indices[n] + 1] * weights[n];
+                    }
+
+                    result[i] = accumulate ? result[i] + T(re, im) : T(re, im);
+                }
+                else
                 {
-                    result[i] += vector[row_indices[n]] * weights[n];
+                    T sum = 0;
+
+                    #ifndef WIN32
+                        #pragma omp simd reduction(+:sum)
+                    #endif // WIN32
+                    for (size_t n = 0; n < count; n++)
+                    {
+                        sum += vector[indices[n]] * weights[n];
+                    }
+
+                    result[i] = accumulate ? result[i] + sum : sum;
                 }
             }
         }
+
+        /**
+         * \brief Apply the matrices to all batches, parallel over batches and row blocks.
+         */
+        template<class T>
+        void mvm_batches(
+            const std::vector<ConvInternal::ConvolutionMatrix<realType_t<T>>>& matrices,
+            const T* input,
+            T* output,
+            size_t nbatches,
+            bool accumulate)
+        {
+            const size_t n_in = matrices.front().n_rows;
+            const size_t n_out = matrices.front().n_cols;
+            const long long nblocks = (long long)((n_out + mvm_block_size - 1) / mvm_block_size);
+
+            #pragma omp parallel for schedule(dynamic)
+            for (long long job = 0; job < (long long)nbatches * nblocks; job++)
+            {
+                size_t b = size_t(job / nblocks);
+                size_t begin = size_t(job % nblocks) * mvm_block_size;
+                size_t end = std::min(begin + mvm_block_size, n_out);
+
+                mvm(matrices[b % matrices.size()], input + b * n_in, output + b * n_out,
+                    begin, end, accumulate);
+            }
+        }
     }
 
 
@@ -112,19 +346,15 @@ namespace Gadgetron
         hoNDArray<T> &samples,
         bool accumulate)
     {
-        size_t nbatches = image.get_number_of_elements() / conv_matrix_.front().n_rows;
-        assert(nbatches == samples.get_number_of_elements() / conv_matrix_.front().n_cols);
+        auto start = std::chrono::steady_clock::now();
 
-        if (!accumulate) clear(&samples);
+        size_t nbatches = image.get_number_of_elements() / conv_matrix_->front().n_rows;
+        assert(nbatches == samples.get_number_of_elements() / conv_matrix_->front().n_cols);
 
-        #pragma omp parallel for
-        for (int b = 0; b < (int)nbatches; b++)
-        {
-            const T* image_view = image.get_data_ptr() + b * conv_matrix_.front().n_rows;
-            T* samples_view = samples.get_data_ptr() + b * conv_matrix_.front().n_cols;
-            size_t matrix_index = b % conv_matrix_.size();
-            mvm(conv_matrix_[matrix_index], image_view, samples_view);
-        }
+        mvm_batches(*conv_matrix_, image.get_data_ptr(), samples.get_data_ptr(), nbatches, accumulate);
+
+        timings_.apply_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        timings_.apply_count++;
     }
 
 
@@ -134,19 +364,18 @@ namespace Gadgetron
         hoNDArray<T> &image,
         bool accumulate)
     {
-        size_t nbatches = image.get_number_of_elements() / conv_matrix_.front().n_rows;
-        assert(nbatches == samples.get_number_of_elements() / conv_matrix_.front().n_cols);
+        if (!conv_matrix_T_)
+            throw std::runtime_error("hoGriddingConvolution: not preprocessed for NC2C convolution");
 
-        if (!accumulate) clear(&image);
+        auto start = std::chrono::steady_clock::now();
 
-        #pragma omp parallel for
-        for (int b = 0; b < (int)nbatches; b++)
-        {
-            T* image_view = image.get_data_ptr() + b * conv_matrix_.front().n_rows;
-            const T* samples_view = samples.get_data_ptr() + b * conv_matrix_.front().n_cols;
-            size_t matrix_index = b % conv_matrix_.size();
-            mvm(conv_matrix_T_[matrix_index], samples_view, image_view);
-        }
+        size_t nbatches = image.get_number_of_elements() / conv_matrix_->front().n_rows;
+        assert(nbatches == samples.get_number_of_elements() / conv_matrix_->front().n_cols);
+
+        mvm_batches(*conv_matrix_T_, samples.get_data_ptr(), image.get_data_ptr(), nbatches, accumulate);
+
+        timings_.apply_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        timings_.apply_count++;
     }
 }
 
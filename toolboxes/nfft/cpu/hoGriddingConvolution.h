@@ -6,8 +6,28 @@
 
 #include "ConvolutionMatrix.h"
 
+#include <memory>
+
 namespace Gadgetron
 {
+    /**
+     * \brief Time spent preparing and applying a CPU gridding convolution.
+     */
+    struct hoGriddingConvolutionTimings
+    {
+        /** Seconds spent in the last call to preprocess. */
+        double preprocess_seconds = 0;
+
+        /** Whether the last call to preprocess reused cached convolution matrices. */
+        bool preprocess_cached = false;
+
+        /** Seconds spent convolving since the last call to preprocess. */
+        double apply_seconds = 0;
+
+        /** Number of convolutions since the last call to preprocess. */
+        size_t apply_count = 0;
+    };
+
     /**
      * \brief Gridding convolution (CPU implementation).
      * 
@@ -56,6 +76,11 @@ namespace Gadgetron
             const hoNDArray<vector_td<REAL, D>>& trajectory, 
             GriddingConvolutionPrepMode prep_mode = GriddingConvolutionPrepMode::ALL) override;
 
+        /**
+         * \brief Get the preprocessing and convolution times.
+         */
+        const hoGriddingConvolutionTimings& get_timings() const;
+
     private:
 
         /**
@@ -82,8 +107,12 @@ namespace Gadgetron
                            hoNDArray<T> &image,
                            bool accumulate) override;
 
-        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix_;
-        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix_T_;
+        // One matrix per frame. The matrices are shared with the process wide
+        // cache, so an unchanged trajectory is only preprocessed once.
+        std::shared_ptr<const std::vector<ConvInternal::ConvolutionMatrix<REAL>>> conv_matrix_;
+        std::shared_ptr<const std::vector<ConvInternal::ConvolutionMatrix<REAL>>> conv_matrix_T_;
+
+        hoGriddingConvolutionTimings timings_;
     };
 
     /**
@@ -289,6 +289,12 @@ namespace Gadgetron {
         this->deapodize(*pd,fourierDomain);
     }
 
+    template<class REAL, unsigned int D>
+    const hoGriddingConvolutionTimings& hoNFFT_plan<REAL, D>::get_gridding_timings() const {
+        // The convolution is always made by the hoNDArray gridding convolution factory.
+        return static_cast<const hoGriddingConvolution<complext<REAL>, D, KaiserKernel>&>(*this->conv_).get_timings();
+    }
+
     template<class REAL, unsigned int D>
     boost::shared_ptr<hoNFFT_plan<REAL,D>> NFFT<hoNDArray,REAL,D>::make_plan(const Gadgetron::vector_td<size_t, D> &matrix_size,
                                         const Gadgetron::vector_td<size_t, D> &matrix_size_os, REAL W) {
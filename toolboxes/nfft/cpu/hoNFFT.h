@@ -15,6 +15,7 @@
 #include "complext.h"
 #include <complex>
 #include "NFFT.h"
+#include "hoGriddingConvolution.h"
 
 #include <boost/shared_ptr.hpp>
 #include "hoArmadillo.h"
@@ -140,6 +141,13 @@ namespace Gadgetron{
                 bool fourierDomain = false
             ) override;
 
+            /**
+                Time spent preprocessing the trajectory and convolving since.
+                Preprocessing an unchanged trajectory reuses the cached convolution
+                matrices, so real-time reconstructions only pay for it once.
+            */
+            const hoGriddingConvolutionTimings& get_gridding_timings() const;
+
 
         private:
 
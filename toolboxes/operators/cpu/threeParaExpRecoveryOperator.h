@@ -76,4 +76,22 @@ namespace Gadgetron {
             y[ii] = b[0] - b[1] * exp( -1 * x[ii] * rb);
         }
     }
+
+    // y = bi[0] -  bi[1]* exp(-x/bi[2]) at a single point, for curveFittingBatchedLMSolver
+    struct threeParaExpRecoveryModel
+    {
+        static const size_t num_of_paras = 3;
+
+        template <typename T>
+        static inline void evaluate(T x, const T* b, T& y, T* grad)
+        {
+            T rb = 1 / ( (std::abs(b[2])<FLT_EPSILON) ? ((b[2]<0) ? -FLT_EPSILON : FLT_EPSILON) : b[2] );
+
+            T val = std::exp(-1 * x * rb);
+            y = b[0] - b[1] * val;
+            grad[0] = 1;
+            grad[1] = -val;
+            grad[2] = -1 * b[1] * val * x * rb * rb;
+        }
+    };
 }
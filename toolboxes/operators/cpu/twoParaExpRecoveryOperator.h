@@ -75,4 +75,21 @@ namespace Gadgetron {
             y[ii] = b[0] - b[0] * exp( -1 * x[ii] * rb);
         }
     }
+
+    // y = bi[0] -  bi[0]* exp(-x/bi[1]) at a single point, for curveFittingBatchedLMSolver
+    struct twoParaExpRecoveryModel
+    {
+        static const size_t num_of_paras = 2;
+
+        template <typename T>
+        static inline void evaluate(T x, const T* b, T& y, T* grad)
+        {
+            T rb = 1 / ( (std::abs(b[1])<FLT_EPSILON) ? ((b[1]<0) ? -FLT_EPSILON : FLT_EPSILON) : b[1] );
+
+            T val = std::exp(-1 * x * rb);
+            y = b[0] - b[0] * val;
+            grad[0] = 1 - val;
+            grad[1] = -1 * b[0] * val * x * rb * rb;
+        }
+    };
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <sstream>
+#include <memory>
 #include "hoNDArray.h"
 #include "hoNDImage.h"
 #include "hoMRImage.h"
@@ -179,6 +180,9 @@ namespace Gadgetron {
         typedef hoNDImageContainer2D<SourceType> SourceContinerType;
         typedef hoNDImageContainer2D<DeformationFieldType> DeformationFieldContinerType;
 
+        /// register types
+        typedef hoImageRegDeformationFieldRegister<TargetType, CoordType> DeformationFieldRegisterType;
+
         hoImageRegContainer2DRegistration(unsigned int resolution_pyramid_levels=3, bool use_world_coordinates=false, ValueType bg_value=ValueType(0));
         virtual ~hoImageRegContainer2DRegistration();
 
@@ -367,6 +371,9 @@ namespace Gadgetron {
         /// threshold for dissimilarity for every pyramid level
         std::vector<ValueType> dissimilarity_thres_pyramid_level_;
 
+        /// relative dissimilarity change to stop the iterations for every pyramid level, 0 disables the early termination
+        std::vector<ValueType> dissimilarity_stop_thres_pyramid_level_;
+
         /// number of search size division for every pyramid level
         std::vector<unsigned int> div_num_pyramid_level_;
 
@@ -436,6 +443,16 @@ namespace Gadgetron {
 
         bool initialize(const TargetContinerType& targetContainer, bool warped);
 
+        /// set the parameters of a deformation field register and initialize it for a pair of images
+        /// if targetPyramid is not NULL, it is used as the target pyramid instead of creating it again
+        bool initializeDeformationFieldRegister(DeformationFieldRegisterType& reg, const TargetType& target, const SourceType& source, bool initial, DeformationFieldType** deform, const std::vector<TargetType>* targetPyramid);
+
+        /// copy out the deformation field of a performed registration and compute the warped image if warped != NULL
+        bool completeDeformationFieldRegister(DeformationFieldRegisterType& reg, const TargetType& target, const SourceType& source, TargetType* warped, DeformationFieldType** deform);
+
+        /// register a pair of images, using the precomputed pyramid of the target shared by all pairs with the same target
+        bool registerTwoImagesDeformationField(const TargetType& target, const std::vector<TargetType>& targetPyramid, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform);
+
     };
 
     template<typename TargetType, typename SourceType, typename CoordType> 
@@ -494,6 +511,9 @@ namespace Gadgetron {
         dissimilarity_thres_pyramid_level_.clear();
         dissimilarity_thres_pyramid_level_.resize(resolution_pyramid_levels_, (ValueType)(1e-5) );
 
+        dissimilarity_stop_thres_pyramid_level_.clear();
+        dissimilarity_stop_thres_pyramid_level_.resize(resolution_pyramid_levels_, 0);
+
         div_num_pyramid_level_.clear();
         div_num_pyramid_level_.resize(resolution_pyramid_levels_, 2);
 
@@ -558,7 +578,28 @@ namespace Gadgetron {
         {
             GADGET_CHECK_RETURN_FALSE(deform!=NULL);
 
-            hoImageRegDeformationFieldRegister<TargetType, CoordType> reg(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
+            DeformationFieldRegisterType reg(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
+
+            GADGET_CHECK_RETURN_FALSE(this->initializeDeformationFieldRegister(reg, target, source, initial, deform, NULL));
+            GADGET_CHECK_RETURN_FALSE(reg.performRegistration());
+            GADGET_CHECK_RETURN_FALSE(this->completeDeformationFieldRegister(reg, target, source, warped, deform));
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationField(...) ... ");
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    initializeDeformationFieldRegister(DeformationFieldRegisterType& reg, const TargetType& target, const SourceType& source, bool initial, DeformationFieldType** deform, const std::vector<TargetType>* targetPyramid)
+    {
+        try
+        {
+            GADGET_CHECK_RETURN_FALSE(deform!=NULL);
 
             if ( !debugFolder_.empty() )
             {
@@ -568,6 +609,7 @@ namespace Gadgetron {
             GADGET_CHECK_RETURN_FALSE(reg.setDefaultParameters(resolution_pyramid_levels_, use_world_coordinates_));
 
             reg.max_iter_num_pyramid_level_ = max_iter_num_pyramid_level_;
+            reg.dissimilarity_stop_thres_pyramid_level_ = dissimilarity_stop_thres_pyramid_level_;
             reg.div_num_pyramid_level_ = div_num_pyramid_level_;
             reg.dissimilarity_MI_betaArg_ = dissimilarity_MI_betaArg_;
             reg.regularization_hilbert_strength_world_coordinate_ = regularization_hilbert_strength_world_coordinate_;
@@ -585,6 +627,11 @@ namespace Gadgetron {
             reg.setTarget( const_cast<TargetType&>(target) );
             reg.setSource( const_cast<TargetType&>(source) );
 
+            if ( targetPyramid != NULL )
+            {
+                reg.setTargetPyramid(*targetPyramid);
+            }
+
             if ( verbose_ )
             {
                 std::ostringstream outs;
@@ -614,8 +661,23 @@ namespace Gadgetron {
                     Gadgetron::clear( *(deform[d]) );
                 }
             }
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::initializeDeformationFieldRegister(...) ... ");
+            return false;
+        }
 
-            GADGET_CHECK_RETURN_FALSE(reg.performRegistration());
+        return true;
+    }
+
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    completeDeformationFieldRegister(DeformationFieldRegisterType& reg, const TargetType& target, const SourceType& source, TargetType* warped, DeformationFieldType** deform)
+    {
+        try
+        {
+            unsigned int d;
 
             for ( d=0; d<DIn; d++ )
             {
@@ -642,7 +704,30 @@ namespace Gadgetron {
         }
         catch(...)
         {
-            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationField(...) ... ");
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::completeDeformationFieldRegister(...) ... ");
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    registerTwoImagesDeformationField(const TargetType& target, const std::vector<TargetType>& targetPyramid, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform)
+    {
+        try
+        {
+            GADGET_CHECK_RETURN_FALSE(deform!=NULL);
+
+            DeformationFieldRegisterType reg(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
+
+            GADGET_CHECK_RETURN_FALSE(this->initializeDeformationFieldRegister(reg, target, source, initial, deform, &targetPyramid));
+            GADGET_CHECK_RETURN_FALSE(reg.performRegistration());
+            GADGET_CHECK_RETURN_FALSE(this->completeDeformationFieldRegister(reg, target, source, warped, deform));
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationField(targetPyramid, ...) ... ");
             return false;
         }
 
@@ -1032,11 +1117,41 @@ namespace Gadgetron {
                     deformation_field_[ii].get_all_images(deform[ii]);
                 }
 
-                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, warpedImages) num_threads(numOfThreads)
+                // the pyramid of every reference frame is created once and shared by all registrations against it
+                std::vector< std::vector<TargetType> > refPyramid(row);
+                std::vector<int> pyramidStatus(row, 1);
+
+                long long numOfRows = (long long)row;
+                long long rr;
+
+                #pragma omp parallel for default(none) private(rr) shared(numOfRows, imageContainer, referenceFrame, refPyramid, pyramidStatus) num_threads(numOfThreads)
+                for ( rr=0; rr<numOfRows; rr++ )
+                {
+                    DeformationFieldRegisterType reg(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
+                    pyramidStatus[rr] = reg.createTargetPyramid(imageContainer(rr, referenceFrame[rr]), refPyramid[rr]);
+                }
+
+                for ( r=0; r<row; r++ )
+                {
+                    GADGET_CHECK_RETURN_FALSE(pyramidStatus[r]);
+                }
+
+                std::vector<int> status(numOfImages, 1);
+                std::vector<size_t> rowOfImage(numOfImages);
+                ind = 0;
+                for ( r=0; r<row; r++ )
+                {
+                    for ( c=0; c<col[r]; c++ )
+                    {
+                        rowOfImage[ind++] = r;
+                    }
+                }
+
+                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, warpedImages, refPyramid, rowOfImage, status) num_threads(numOfThreads)
                 {
                     DeformationFieldType* deformCurr[DIn];
 
-                    #pragma omp for 
+                    #pragma omp for schedule(dynamic)
                     for ( n=0; n<numOfImages; n++ )
                     {
                         if ( targetImages[n] == sourceImages[n] )
@@ -1063,9 +1178,22 @@ namespace Gadgetron {
                             deformCurr[ii] = deform[ii][n];
                         }
 
-                        registerTwoImagesDeformationField(target, source, initial, warpedImages[n], deformCurr);
+                        status[n] = registerTwoImagesDeformationField(target, refPyramid[rowOfImage[n]], source, initial, warpedImages[n], deformCurr);
+                    }
+                }
+
+                // a failed pair does not stop the others; the failures are reported once all pairs are done
+                bool allRegistered = true;
+                for ( n=0; n<numOfImages; n++ )
+                {
+                    if ( !status[n] )
+                    {
+                        GERROR_STREAM("registerOverContainer2DFixedReference - registration failed for image " << n);
+                        allRegistered = false;
                     }
                 }
+
+                if ( !allRegistered ) return false;
             }
             else if ( container_reg_transformation_ == GT_IMAGE_REG_TRANSFORMATION_DEFORMATION_FIELD_BIDIRECTIONAL )
             {
@@ -82,12 +82,15 @@ namespace Gadgetron {
 
         /// these parameter names are kept same as the source code on page 183 - 185 in ref [2]
         hoNDArray<computing_value_type> cc; computing_value_type* p_cc;
-        hoNDArray<computing_value_type> mu1; computing_value_type* p_mu1;
         hoNDArray<computing_value_type> mu2; computing_value_type* p_mu2;
         hoNDArray<computing_value_type> v1; computing_value_type* p_v1;
         hoNDArray<computing_value_type> v2; computing_value_type* p_v2;
         hoNDArray<computing_value_type> v12; computing_value_type* p_v12;
 
+        /// local mean and second moment of the target, which do not change between iterations
+        hoNDArray<computing_value_type> target_mu_; computing_value_type* p_target_mu_;
+        hoNDArray<computing_value_type> target_v_; computing_value_type* p_target_v_;
+
         //hoNDArray<computing_value_type> vv1; computing_value_type* p_vv1;
         //hoNDArray<computing_value_type> vv2; computing_value_type* p_vv2;
         //hoNDArray<computing_value_type> vv12; computing_value_type* p_vv12;
@@ -131,7 +134,6 @@ namespace Gadgetron {
 
         // allocate arrays for the computation
         cc.create(image_dim_); p_cc = cc.begin();
-        mu1.create(image_dim_); p_mu1 = mu1.begin();
         mu2.create(image_dim_); p_mu2 = mu2.begin();
         v1.create(image_dim_); p_v1 = v1.begin();
         v2.create(image_dim_); p_v2 = v2.begin();
@@ -148,6 +150,22 @@ namespace Gadgetron {
         #endif // WIN32
 
         eps_ = std::numeric_limits<computing_value_type>::epsilon();
+
+        // the target terms are filtered once here, rather than in every evaluation
+        target_mu_.create(image_dim_); p_target_mu_ = target_mu_.begin();
+        target_v_.create(image_dim_); p_target_v_ = target_v_.begin();
+
+        const ValueType* pT = target.begin();
+        long long N = (long long)target.get_number_of_elements();
+        for ( long long n=0; n<N; ++n )
+        {
+            const computing_value_type v = (computing_value_type)pT[n];
+            p_target_mu_[n] = v;
+            p_target_v_[n] = v*v;
+        }
+
+        Gadgetron::filterGaussian(target_mu_, sigmaArg_, mem_.begin());
+        Gadgetron::filterGaussian(target_v_, sigmaArg_, mem_.begin());
     }
 
     template<typename ImageType> 
@@ -225,17 +243,13 @@ namespace Gadgetron {
                 const computing_value_type v1 = (computing_value_type)pT[n];
                 const computing_value_type v2 = (computing_value_type)pW[n];
 
-                p_mu1[n] = v1;
                 p_mu2[n] = v2;
-                p_v1[n] = v1*v1;
                 p_v2[n] = v2*v2;
                 p_v12[n] = v1*v2;
             }
 
                 //#ifdef WIN32
-                    Gadgetron::filterGaussian(mu1, sigmaArg_, mem_.begin());
                     Gadgetron::filterGaussian(mu2, sigmaArg_, mem_.begin());
-                    Gadgetron::filterGaussian(v1, sigmaArg_, mem_.begin());
                     Gadgetron::filterGaussian(v2, sigmaArg_, mem_.begin());
                     Gadgetron::filterGaussian(v12, sigmaArg_, mem_.begin());
                 //#else
@@ -295,10 +309,10 @@ namespace Gadgetron {
             //#pragma omp parallel for private(n)
             for ( n=0; n<N; ++n )
             {
-                const computing_value_type u1 = p_mu1[n];
+                const computing_value_type u1 = p_target_mu_[n];
                 const computing_value_type u2 = p_mu2[n];
 
-                const computing_value_type vv1 = p_v1[n] - u1 * u1;
+                const computing_value_type vv1 = p_target_v_[n] - u1 * u1;
                 const computing_value_type vv2 = p_v2[n] - u2 * u2;
                 const computing_value_type vv12 = p_v12[n] - u1 * u2;
 
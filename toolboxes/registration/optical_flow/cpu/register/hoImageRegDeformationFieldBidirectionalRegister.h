@@ -117,6 +117,7 @@ namespace Gadgetron {
 
         using BaseClass::max_iter_num_pyramid_level_;
         using BaseClass::dissimilarity_thres_pyramid_level_;
+        using BaseClass::dissimilarity_stop_thres_pyramid_level_;
         using BaseClass::div_num_pyramid_level_;
         using BaseClass::step_size_para_pyramid_level_;
         using BaseClass::step_size_div_para_pyramid_level_;
@@ -261,6 +262,7 @@ namespace Gadgetron {
 
                 solver_pyramid_inverse_[ii].max_iter_num_ = max_iter_num_pyramid_level_[ii];
                 solver_pyramid_inverse_[ii].dissimilarity_thres_ = dissimilarity_thres_pyramid_level_[ii];
+                solver_pyramid_inverse_[ii].dissimilarity_stop_thres_ = dissimilarity_stop_thres_pyramid_level_[ii];
                 solver_pyramid_inverse_[ii].div_num_ = div_num_pyramid_level_[ii];
                 solver_pyramid_inverse_[ii].step_size_para_ = step_size_para_pyramid_level_[ii];
                 solver_pyramid_inverse_[ii].step_size_div_para_ = step_size_div_para_pyramid_level_[ii];
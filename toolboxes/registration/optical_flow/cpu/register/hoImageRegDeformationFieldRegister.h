@@ -100,6 +100,10 @@ namespace Gadgetron {
         /// perform the registration
         virtual bool performRegistration();
 
+        /// solve one pyramid level and expand the deformation field to the next finer level
+        /// performRegistration() runs this from the coarsest level to level 0
+        virtual bool performRegistrationOnLevel(unsigned int level);
+
         virtual void printContent(std::ostream& os) const;
         virtual void print(std::ostream& os) const;
 
@@ -128,6 +132,8 @@ namespace Gadgetron {
         std::vector<unsigned int> max_iter_num_pyramid_level_;
         /// threshold for dissimilarity for every pyramid level
         std::vector<ValueType> dissimilarity_thres_pyramid_level_;
+        /// relative dissimilarity change to stop the iterations for every pyramid level, 0 disables the early termination
+        std::vector<ValueType> dissimilarity_stop_thres_pyramid_level_;
         /// number of search size division for every pyramid level
         std::vector<unsigned int> div_num_pyramid_level_;
         /// solver step size for every pyramid level
@@ -251,6 +257,9 @@ namespace Gadgetron {
         dissimilarity_thres_pyramid_level_.clear();
         dissimilarity_thres_pyramid_level_.resize(resolution_pyramid_levels_, 1e-6);
 
+        dissimilarity_stop_thres_pyramid_level_.clear();
+        dissimilarity_stop_thres_pyramid_level_.resize(resolution_pyramid_levels_, 0);
+
         div_num_pyramid_level_.clear();
         div_num_pyramid_level_.resize(resolution_pyramid_levels_, 2);
 
@@ -328,6 +337,7 @@ namespace Gadgetron {
 
                 solver_pyramid_[ii].max_iter_num_ = max_iter_num_pyramid_level_[ii];
                 solver_pyramid_[ii].dissimilarity_thres_ = dissimilarity_thres_pyramid_level_[ii];
+                solver_pyramid_[ii].dissimilarity_stop_thres_ = dissimilarity_stop_thres_pyramid_level_[ii];
                 solver_pyramid_[ii].div_num_ = div_num_pyramid_level_[ii];
                 solver_pyramid_[ii].step_size_para_ = step_size_para_pyramid_level_[ii];
                 solver_pyramid_[ii].step_size_div_para_ = step_size_div_para_pyramid_level_[ii];
@@ -407,92 +417,110 @@ namespace Gadgetron {
             int level;
             for ( level=(int)resolution_pyramid_levels_-1; level>=0; level-- )
             {
-                // update the transform for multi-resolution pyramid
-                transform_->update();
+                GADGET_CHECK_RETURN_FALSE(this->performRegistrationOnLevel( (unsigned int)level ));
+            }
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Errors happened in hoImageRegDeformationFieldRegister<TargetType, CoordType>::performRegistration() ... ");
+        }
 
-                // GADGET_CHECK_RETURN_FALSE(solver_pyramid_[level].initialize());
-                GADGET_CHECK_RETURN_FALSE(solver_pyramid_[level].solve());
+        return true;
+    }
 
-                if ( !debugFolder_.empty() )
+    template<typename TargetType, typename CoordType> 
+    bool hoImageRegDeformationFieldRegister<TargetType, CoordType>::performRegistrationOnLevel(unsigned int level)
+    {
+        try
+        {
+            GADGET_CHECK_RETURN_FALSE(level<resolution_pyramid_levels_);
+
+            // update the transform for multi-resolution pyramid
+            transform_->update();
+
+            // GADGET_CHECK_RETURN_FALSE(solver_pyramid_[level].initialize());
+            GADGET_CHECK_RETURN_FALSE(solver_pyramid_[level].solve());
+
+            if ( !debugFolder_.empty() )
+            {
+                unsigned int jj;
+                for ( jj=0; jj<D; jj++ )
                 {
-                    unsigned int jj;
-                    for ( jj=0; jj<D; jj++ )
-                    {
-                        std::ostringstream ostr;
-                        ostr << "deform_" << jj;
+                    std::ostringstream ostr;
+                    ostr << "deform_" << jj;
 
-                        gt_exporter_.export_image(transform_->getDeformationField(jj), debugFolder_+ostr.str());
-                    }
+                    gt_exporter_.export_image(transform_->getDeformationField(jj), debugFolder_+ostr.str());
                 }
+            }
 
-                // expand the deformation field for next resolution level
-                if ( level>0 )
-                {
-                    std::vector<float> ratio = resolution_pyramid_downsample_ratio_[level-1];
+            // expand the deformation field for next resolution level
+            if ( level>0 )
+            {
+                std::vector<float> ratio = resolution_pyramid_downsample_ratio_[level-1];
 
-                    unsigned int jj;
-                    bool downsampledBy2 = true;
-                    for ( jj=0; jj<D; jj++ )
+                unsigned int jj;
+                bool downsampledBy2 = true;
+                for ( jj=0; jj<D; jj++ )
+                {
+                    if ( std::abs(ratio[jj]-2.0f) > FLT_EPSILON )
                     {
-                        if ( std::abs(ratio[jj]-2.0f) > FLT_EPSILON )
-                        {
-                            downsampledBy2 = false;
-                            break;
-                        }
+                        downsampledBy2 = false;
+                        break;
                     }
+                }
 
-                    DeformationFieldType deformExpanded;
-                    deformExpanded.createFrom(target_pyramid_[level-1]);
-                    // Gadgetron::clear(deformExpanded);
-                    memset(deformExpanded.begin(), 0, deformExpanded.get_number_of_bytes());
+                DeformationFieldType deformExpanded;
+                deformExpanded.createFrom(target_pyramid_[level-1]);
+                // Gadgetron::clear(deformExpanded);
+                memset(deformExpanded.begin(), 0, deformExpanded.get_number_of_bytes());
 
-                    if ( downsampledBy2 || resolution_pyramid_divided_by_2_ )
+                if ( downsampledBy2 || resolution_pyramid_divided_by_2_ )
+                {
+                    for ( jj=0; jj<D; jj++ )
                     {
-                        for ( jj=0; jj<D; jj++ )
-                        {
-                            DeformationFieldType& deform = transform_->getDeformationField(jj);
-                            Gadgetron::expandImageBy2(deform, *deform_field_bh_, deformExpanded);
-
-                            if ( !use_world_coordinates_ )
-                            {
-                                Gadgetron::scal(CoordType(2.0), deformExpanded); // the deformation vector should be doubled in length
-                            }
+                        DeformationFieldType& deform = transform_->getDeformationField(jj);
+                        Gadgetron::expandImageBy2(deform, *deform_field_bh_, deformExpanded);
 
-                            deform = deformExpanded;
+                        if ( !use_world_coordinates_ )
+                        {
+                            Gadgetron::scal(CoordType(2.0), deformExpanded); // the deformation vector should be doubled in length
                         }
+
+                        deform = deformExpanded;
                     }
-                    else
+                }
+                else
+                {
+                    for ( jj=0; jj<D; jj++ )
                     {
-                        for ( jj=0; jj<D; jj++ )
-                        {
-                            DeformationFieldType& deform = transform_->getDeformationField(jj);
-                            Gadgetron::upsampleImage(deform, *deform_field_interp_, deformExpanded, &ratio[0]);
+                        DeformationFieldType& deform = transform_->getDeformationField(jj);
+                        Gadgetron::upsampleImage(deform, *deform_field_interp_, deformExpanded, &ratio[0]);
 
-                            if ( !use_world_coordinates_ )
-                            {
-                                Gadgetron::scal(CoordType(ratio[jj]), deformExpanded);
-                            }
-
-                            deform = deformExpanded;
+                        if ( !use_world_coordinates_ )
+                        {
+                            Gadgetron::scal(CoordType(ratio[jj]), deformExpanded);
                         }
+
+                        deform = deformExpanded;
                     }
+                }
 
-                    if ( !debugFolder_.empty() )
+                if ( !debugFolder_.empty() )
+                {
+                    for ( jj=0; jj<D; jj++ )
                     {
-                        for ( jj=0; jj<D; jj++ )
-                        {
-                            std::ostringstream ostr;
-                            ostr << "deformExpanded_" << jj;
+                        std::ostringstream ostr;
+                        ostr << "deformExpanded_" << jj;
 
-                            gt_exporter_.export_image(transform_->getDeformationField(jj), debugFolder_+ostr.str());
-                        }
+                        gt_exporter_.export_image(transform_->getDeformationField(jj), debugFolder_+ostr.str());
                     }
                 }
             }
         }
         catch(...)
         {
-            GERROR_STREAM("Errors happened in hoImageRegDeformationFieldRegister<TargetType, CoordType>::performRegistration() ... ");
+            GERROR_STREAM("Errors happened in hoImageRegDeformationFieldRegister<TargetType, CoordType>::performRegistrationOnLevel(...) ... ");
+            return false;
         }
 
         return true;
@@ -522,6 +550,14 @@ namespace Gadgetron {
                 << dissimilarity_thres_pyramid_level_[ii] << std::endl;
         }
 
+        os << "------------" << std::endl;
+        os << "Relative dissimilarity change to stop for every pyramid level is : " << std::endl;
+        for ( ii=0; ii<resolution_pyramid_levels_; ii++ )
+        {
+            os << " Level " << ii << " - " 
+                << dissimilarity_stop_thres_pyramid_level_[ii] << std::endl;
+        }
+
         os << "------------" << std::endl;
         os << "Number of search size division for every pyramid level is : " << std::endl;
         for ( ii=0; ii<resolution_pyramid_levels_; ii++ )
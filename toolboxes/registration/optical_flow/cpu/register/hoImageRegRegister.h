@@ -108,6 +108,13 @@ namespace Gadgetron {
         virtual void setTarget(TargetType& target);
         virtual void setSource(SourceType& source);
 
+        /// reuse a target pyramid created by createTargetPyramid(...), e.g. when many sources are registered to the same target
+        /// the pyramid must be created with the same pyramid parameters; it is not copied, so it must outlive the registration
+        virtual void setTargetPyramid(const std::vector<TargetType>& target_pyramid);
+
+        /// create the multi-resolution pyramid of a target image with the current pyramid parameters
+        virtual bool createTargetPyramid(const TargetType& target, std::vector<TargetType>& target_pyramid);
+
         /// create dissimilarity measures
         DissimilarityType* createDissimilarity(GT_IMAGE_DISSIMILARITY v, unsigned int level);
 
@@ -199,6 +206,9 @@ namespace Gadgetron {
         std::vector<TargetType> target_pyramid_;
         std::vector<TargetType> source_pyramid_;
 
+        /// preset target pyramid, if not NULL, it is used instead of creating the target pyramid in initialize()
+        const std::vector<TargetType>* preset_target_pyramid_;
+
         /// store the boundary handler and interpolator for warpers
         std::vector<BoundaryHandlerTargetType*> target_bh_warper_;
         std::vector<InterpTargetType*> target_interp_warper_;
@@ -229,7 +239,7 @@ namespace Gadgetron {
     template<typename TargetType, typename SourceType, typename CoordType> 
     hoImageRegRegister<TargetType, SourceType, CoordType>::
     hoImageRegRegister(unsigned int resolution_pyramid_levels, ValueType bg_value) 
-    : target_(NULL), source_(NULL), bg_value_(bg_value), performTiming_(false)
+    : target_(NULL), source_(NULL), bg_value_(bg_value), preset_target_pyramid_(NULL), performTiming_(false)
     {
         gt_timer1_.set_timing_in_destruction(false);
         gt_timer2_.set_timing_in_destruction(false);
@@ -382,15 +392,30 @@ namespace Gadgetron {
             GADGET_CHECK_RETURN_FALSE(dissimilarity_type_.size()==resolution_pyramid_levels_);
             GADGET_CHECK_RETURN_FALSE(solver_type_.size()==resolution_pyramid_levels_);
 
-            target_pyramid_.resize(resolution_pyramid_levels_);
-            source_pyramid_.resize(resolution_pyramid_levels_);
+            if ( preset_target_pyramid_ != NULL )
+            {
+                GADGET_CHECK_RETURN_FALSE(preset_target_pyramid_->size()==resolution_pyramid_levels_);
+                GADGET_CHECK_RETURN_FALSE((*preset_target_pyramid_)[0].dimensions_equal(*target_));
+                // the levels refer to the preset images rather than copying them, so many registrations can share one pyramid
+                // nothing in the registration writes to the target pyramid
+                target_pyramid_.resize(resolution_pyramid_levels_);
+                for ( unsigned int level=0; level<resolution_pyramid_levels_; level++ )
+                {
+                    TargetType& preset = const_cast<TargetType&>((*preset_target_pyramid_)[level]);
 
-            target_pyramid_[0] = *target_;
-            source_pyramid_[0] = *source_;
+                    std::vector<size_t> dim;
+                    preset.get_dimensions(dim);
+                    target_pyramid_[level].create(dim, preset.begin(), false);
+                    target_pyramid_[level].copyImageInfoWithoutImageSize(preset);
+                }
+            }
+            else
+            {
+                GADGET_CHECK_RETURN_FALSE(this->createTargetPyramid(*target_, target_pyramid_));
+            }
 
-            target_bh_pyramid_construction_ = createBoundaryHandler<TargetType>(boundary_handler_type_pyramid_construction_);
-            target_interp_pyramid_construction_ = createInterpolator<TargetType, DOut>(interp_type_pyramid_construction_);
-            target_interp_pyramid_construction_->setBoundaryHandler(*target_bh_pyramid_construction_);
+            source_pyramid_.resize(resolution_pyramid_levels_);
+            source_pyramid_[0] = *source_;
 
             source_bh_pyramid_construction_ = createBoundaryHandler<SourceType>(boundary_handler_type_pyramid_construction_);
             source_interp_pyramid_construction_ = createInterpolator<SourceType, DIn>(interp_type_pyramid_construction_);
@@ -400,59 +425,6 @@ namespace Gadgetron {
             unsigned int ii, jj;
             for ( ii=0; ii<resolution_pyramid_levels_-1; ii++ )
             {
-                // create pyramid
-                target_bh_pyramid_construction_->setArray(target_pyramid_[ii]);
-                target_interp_pyramid_construction_->setArray(target_pyramid_[ii]);
-
-                if ( use_world_coordinates_ )
-                {
-                    if ( resolution_pyramid_divided_by_2_ )
-                    {
-                        Gadgetron::downsampleImageBy2WithAveraging(target_pyramid_[ii], *target_bh_pyramid_construction_, target_pyramid_[ii+1]);
-                    }
-                    else
-                    {
-                        std::vector<float> ratio = resolution_pyramid_downsample_ratio_[ii];
-                        Gadgetron::downsampleImage(target_pyramid_[ii], *target_interp_pyramid_construction_, target_pyramid_[ii+1], &ratio[0]);
-
-                        std::vector<float> sigma = resolution_pyramid_blurring_sigma_[ii+1];
-                        for ( jj=0; jj<DOut; jj++ )
-                        {
-                            sigma[jj] /= target_pyramid_[ii+1].get_pixel_size(jj); // world to pixel
-                        }
-
-                        Gadgetron::filterGaussian(target_pyramid_[ii+1], &sigma[0]);
-                    }
-                }
-                else
-                {
-                    std::vector<float> ratio = resolution_pyramid_downsample_ratio_[ii];
-
-                    bool downsampledBy2 = true;
-                    for ( jj=0; jj<DOut; jj++ )
-                    {
-                        if ( std::abs(ratio[jj]-2.0f) > FLT_EPSILON )
-                        {
-                            downsampledBy2 = false;
-                            break;
-                        }
-                    }
-
-                    if ( downsampledBy2 )
-                    {
-                        Gadgetron::downsampleImageBy2WithAveraging(target_pyramid_[ii], *target_bh_pyramid_construction_, target_pyramid_[ii+1]);
-                        // Gadgetron::downsampleImage(target_pyramid_[ii], *target_interp_pyramid_construction_, target_pyramid_[ii+1], &ratio[0]);
-                    }
-                    else
-                    {
-                        Gadgetron::downsampleImage(target_pyramid_[ii], *target_interp_pyramid_construction_, target_pyramid_[ii+1], &ratio[0]);
-                        std::vector<float> sigma = resolution_pyramid_blurring_sigma_[ii+1];
-                        Gadgetron::filterGaussian(target_pyramid_[ii+1], &sigma[0]);
-                    }
-                }
-
-                // source
-
                 source_bh_pyramid_construction_->setArray(source_pyramid_[ii]);
                 source_interp_pyramid_construction_->setArray(source_pyramid_[ii]);
 
@@ -553,6 +525,94 @@ namespace Gadgetron {
         return true;
     }
 
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegRegister<TargetType, SourceType, CoordType>::createTargetPyramid(const TargetType& target, std::vector<TargetType>& target_pyramid)
+    {
+        try
+        {
+            GADGET_CHECK_RETURN_FALSE(resolution_pyramid_downsample_ratio_.size()==resolution_pyramid_levels_-1);
+            GADGET_CHECK_RETURN_FALSE(resolution_pyramid_blurring_sigma_.size()==resolution_pyramid_levels_);
+
+            target_pyramid.resize(resolution_pyramid_levels_);
+            target_pyramid[0] = target;
+
+            if ( target_bh_pyramid_construction_ == NULL )
+            {
+                target_bh_pyramid_construction_ = createBoundaryHandler<TargetType>(boundary_handler_type_pyramid_construction_);
+                target_interp_pyramid_construction_ = createInterpolator<TargetType, DOut>(interp_type_pyramid_construction_);
+                target_interp_pyramid_construction_->setBoundaryHandler(*target_bh_pyramid_construction_);
+            }
+
+            unsigned int ii, jj;
+            for ( ii=0; ii<resolution_pyramid_levels_-1; ii++ )
+            {
+                // create pyramid
+                target_bh_pyramid_construction_->setArray(target_pyramid[ii]);
+                target_interp_pyramid_construction_->setArray(target_pyramid[ii]);
+
+                if ( use_world_coordinates_ )
+                {
+                    if ( resolution_pyramid_divided_by_2_ )
+                    {
+                        Gadgetron::downsampleImageBy2WithAveraging(target_pyramid[ii], *target_bh_pyramid_construction_, target_pyramid[ii+1]);
+                    }
+                    else
+                    {
+                        std::vector<float> ratio = resolution_pyramid_downsample_ratio_[ii];
+                        Gadgetron::downsampleImage(target_pyramid[ii], *target_interp_pyramid_construction_, target_pyramid[ii+1], &ratio[0]);
+
+                        std::vector<float> sigma = resolution_pyramid_blurring_sigma_[ii+1];
+                        for ( jj=0; jj<DOut; jj++ )
+                        {
+                            sigma[jj] /= target_pyramid[ii+1].get_pixel_size(jj); // world to pixel
+                        }
+
+                        Gadgetron::filterGaussian(target_pyramid[ii+1], &sigma[0]);
+                    }
+                }
+                else
+                {
+                    std::vector<float> ratio = resolution_pyramid_downsample_ratio_[ii];
+
+                    bool downsampledBy2 = true;
+                    for ( jj=0; jj<DOut; jj++ )
+                    {
+                        if ( std::abs(ratio[jj]-2.0f) > FLT_EPSILON )
+                        {
+                            downsampledBy2 = false;
+                            break;
+                        }
+                    }
+
+                    if ( downsampledBy2 )
+                    {
+                        Gadgetron::downsampleImageBy2WithAveraging(target_pyramid[ii], *target_bh_pyramid_construction_, target_pyramid[ii+1]);
+                        // Gadgetron::downsampleImage(target_pyramid[ii], *target_interp_pyramid_construction_, target_pyramid[ii+1], &ratio[0]);
+                    }
+                    else
+                    {
+                        Gadgetron::downsampleImage(target_pyramid[ii], *target_interp_pyramid_construction_, target_pyramid[ii+1], &ratio[0]);
+                        std::vector<float> sigma = resolution_pyramid_blurring_sigma_[ii+1];
+                        Gadgetron::filterGaussian(target_pyramid[ii+1], &sigma[0]);
+                    }
+                }
+            }
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Errors happened in hoImageRegRegister<TargetType, SourceType, CoordType>::createTargetPyramid(...) ... ");
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    inline void hoImageRegRegister<TargetType, SourceType, CoordType>::setTargetPyramid(const std::vector<TargetType>& target_pyramid)
+    {
+        preset_target_pyramid_ = &target_pyramid;
+    }
+
     template<typename TargetType, typename SourceType, typename CoordType> 
     inline void hoImageRegRegister<TargetType, SourceType, CoordType>::setTarget(TargetType& target)
     {
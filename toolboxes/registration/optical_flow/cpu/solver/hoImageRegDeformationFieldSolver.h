@@ -124,6 +124,7 @@ namespace Gadgetron {
         using BaseClass::max_iter_num_;
         using BaseClass::dissimilarity_thres_;
         using BaseClass::parameter_thres_;
+        using BaseClass::dissimilarity_stop_thres_;
         using BaseClass::div_num_;
         using BaseClass::step_size_para_;
         using BaseClass::step_size_div_para_;
@@ -285,6 +286,14 @@ namespace Gadgetron {
             curr_dissimilarity = dissimilarity.getDissimilarity();
             if ( verbose_ ) { GDEBUG_STREAM("--> Iteration " << iter_num << " [out of " << max_iter_num << "] : \t" << curr_dissimilarity); }
 
+            if ( dissimilarity_stop_thres_ > 0 && iter_num > 0
+                && std::abs(prev_dissimilarity - curr_dissimilarity) <= dissimilarity_stop_thres_ * std::abs(prev_dissimilarity) )
+            {
+                if ( verbose_ ) { GDEBUG_STREAM("----> Dissimilarity change below " << dissimilarity_stop_thres_ << ", stop iterations "); }
+                stopIteration = true;
+                return true;
+            }
+
             if ( prev_dissimilarity < curr_dissimilarity + dissimilarity_thres_ )
             {
                 if ( ++divTimes > div_num_ )
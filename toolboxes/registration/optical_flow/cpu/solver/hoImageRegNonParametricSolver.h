@@ -72,6 +72,10 @@ namespace Gadgetron {
         /// threshold for minimal parameter changes
         ValueType parameter_thres_;
 
+        /// stop the iterations when the relative dissimilarity change between two iterations is below this threshold
+        /// 0 disables the early termination
+        ValueType dissimilarity_stop_thres_;
+
         /// number of search size division
         unsigned int div_num_;
 
@@ -105,7 +109,7 @@ namespace Gadgetron {
 
     template<typename TargetType, typename SourceType, typename CoordType> 
     hoImageRegNonParametricSolver<TargetType, SourceType, CoordType>::hoImageRegNonParametricSolver() 
-        : BaseClass(), dissimilarity_thres_(0), parameter_thres_( (ValueType)1e-8 ), div_num_(3), step_size_para_( (ValueType)0.8 ), step_size_div_para_( (ValueType)0.5 )
+        : BaseClass(), dissimilarity_thres_(0), parameter_thres_( (ValueType)1e-8 ), dissimilarity_stop_thres_(0), div_num_(3), step_size_para_( (ValueType)0.8 ), step_size_div_para_( (ValueType)0.5 )
     {
     }
 
@@ -159,6 +163,7 @@ namespace Gadgetron {
         os << "Maximal iteration number is : " << max_iter_num_ << std::endl;
         os << "Dissimilarity threshold is : " << dissimilarity_thres_ << std::endl;
         os << "Parameter threshold is : " << parameter_thres_ << std::endl;
+        os << "Relative dissimilarity change to stop is : " << dissimilarity_stop_thres_ << std::endl;
         os << "Number of search size division is : " << div_num_ << std::endl;
         os << "Solver step size is : " << step_size_para_ << std::endl;
         os << "Step size division ratio is : " << step_size_div_para_ << std::endl;
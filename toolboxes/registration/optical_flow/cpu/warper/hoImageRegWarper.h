@@ -52,6 +52,7 @@ namespace Gadgetron {
         typedef Target2DType Source3DType;
 
         typedef hoNDInterpolator<SourceType> InterpolatorType;
+        typedef hoNDInterpolatorLinear<SourceType> InterpolatorLinearType;
 
         typedef hoImageRegTransformation<CoordType, DIn, DOut> TransformationType;
         typedef hoImageRegDeformationField<CoordType, DIn> DeformTransformationType;
@@ -104,6 +105,11 @@ namespace Gadgetron {
 
     protected:
 
+        /// 2D image domain warping with a deformation field
+        /// the field is read directly, the source positions are computed for a row at a time and
+        /// the linear interpolator is called without virtual dispatch
+        bool warpWithDeformationField2D(const TargetType& target, const SourceType& source, DeformTransformationType& transform, TargetType& warped);
+
         TransformationType* transform_;
         InterpolatorType* interp_;
 
@@ -172,6 +178,13 @@ namespace Gadgetron {
 
                 long long y;
 
+                DeformTransformationType* transformDeformField = dynamic_cast<DeformTransformationType*>(transform_);
+
+                if ( !useWorldCoordinate && transformDeformField != NULL )
+                {
+                    return this->warpWithDeformationField2D(target, source, *transformDeformField, warped);
+                }
+
                 if ( useWorldCoordinate )
                 {
                     // #pragma omp parallel private(y) shared(sx, sy, target, source, warped) num_threads(2)
@@ -518,6 +531,71 @@ namespace Gadgetron {
         return true;
     }
 
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegWarper<TargetType, SourceType, CoordType>::
+    warpWithDeformationField2D(const TargetType& target, const SourceType& source, DeformTransformationType& transform, TargetType& warped)
+    {
+        try
+        {
+            typedef typename TargetType::coord_type target_coord_type;
+
+            size_t sx = target.get_size(0);
+            size_t sy = target.get_size(1);
+
+            const CoordType* pDx = transform.getDeformationField(0).begin();
+            const CoordType* pDy = transform.getDeformationField(1).begin();
+
+            GADGET_DEBUG_CHECK_RETURN_FALSE(transform.getDeformationField(0).get_number_of_elements()==target.get_number_of_elements());
+
+            const ValueType* pTarget = target.begin();
+            ValueType* pWarped = warped.begin();
+
+            InterpolatorLinearType* interpLinear = dynamic_cast<InterpolatorLinearType*>(interp_);
+
+            std::vector<target_coord_type> ix_source(sx), iy_source(sx);
+
+            for ( size_t y=0; y<sy; y++ )
+            {
+                size_t offset = y*sx;
+
+                #pragma omp simd
+                for ( size_t x=0; x<sx; x++ )
+                {
+                    ix_source[x] = (target_coord_type)( x + pDx[offset+x] );
+                    iy_source[x] = (target_coord_type)( y + pDy[offset+x] );
+                }
+
+                if ( interpLinear != NULL )
+                {
+                    for ( size_t x=0; x<sx; x++ )
+                    {
+                        if ( pTarget[offset+x] != bg_value_ )
+                        {
+                            pWarped[offset+x] = interpLinear->InterpolatorLinearType::operator()(ix_source[x], iy_source[x]);
+                        }
+                    }
+                }
+                else
+                {
+                    for ( size_t x=0; x<sx; x++ )
+                    {
+                        if ( pTarget[offset+x] != bg_value_ )
+                        {
+                            pWarped[offset+x] = (*interp_)(ix_source[x], iy_source[x]);
+                        }
+                    }
+                }
+            }
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Errors happened in hoImageRegWarper<TargetType, SourceType, CoordType>::warpWithDeformationField2D(...) ... ");
+            return false;
+        }
+
+        return true;
+    }
+
     template<typename TargetType, typename SourceType, typename CoordType> 
     void hoImageRegWarper<TargetType, SourceType, CoordType>::print(std::ostream& os) const
     {
@@ -21,12 +21,14 @@
 #include "linearOperatorSolver.h"
 #include "cgCallback.h"
 #include "cgPreconditioner.h"
+#include "solverUpdates.h"
 #include "real_utilities.h"
 #include "complext.h"
 
 #include <vector>
 #include <iostream>
 #include <limits>
+#include <utility>
 
 namespace Gadgetron{
 
@@ -50,6 +52,9 @@ namespace Gadgetron{
       alpha_ = std::numeric_limits<ELEMENT_TYPE>::quiet_NaN();
       iterations_ = 10;
       tc_tolerance_ = (REAL)1e-3;
+      reuse_workspace_ = false;
+      pipelined_ = false;
+      beta_ = REAL(0);
       cb_ = boost::shared_ptr< relativeResidualTCB<ARRAY_TYPE> >( new relativeResidualTCB<ARRAY_TYPE>() );
     }
   
@@ -88,6 +93,37 @@ namespace Gadgetron{
 
     virtual void set_tc_tolerance( REAL tolerance ) { tc_tolerance_ = tolerance; }
     virtual REAL get_tc_tolerance() { return tc_tolerance_; }
+
+
+    // Keep the internal arrays between calls to solve when the dimensions are unchanged,
+    // rather than allocating them for every solve. Only the returned solution is allocated per solve.
+    //
+
+    virtual void set_reuse_workspace( bool reuse ) {
+      reuse_workspace_ = reuse;
+      if( !reuse ) release_workspace();
+    }
+    virtual bool get_reuse_workspace() { return reuse_workspace_; }
+
+
+    // Use the pipelined (Chronopoulos-Gear) formulation of the iteration.
+    // Its two inner products are computed in a single pass after the operator application,
+    // and the updates of p, s, x and r in another, at the cost of three extra arrays.
+    // It is mathematically equivalent to the standard recurrence but rounds differently.
+    //
+
+    virtual void set_pipelined( bool pipelined ) { pipelined_ = pipelined; }
+    virtual bool get_pipelined() { return pipelined_; }
+
+
+    // Free the arrays kept by set_reuse_workspace
+    //
+
+    virtual void release_workspace()
+    {
+      p_.reset(); r_.reset(); q_.reset(); tmp_.reset();
+      s_.reset(); u_.reset(); w_.reset();
+    }
   
 
     // Virtual function that is provided with the intermediate solution at each solver iteration.
@@ -147,7 +183,10 @@ namespace Gadgetron{
         REAL tc_metric;
         bool tc_terminate;
       
-        this->iterate( it, &tc_metric, &tc_terminate );
+        if( pipelined_ )
+          this->iterate_pipelined( it, &tc_metric, &tc_terminate );
+        else
+          this->iterate( it, &tc_metric, &tc_terminate );
 
         solver_dump( x_.get());
       
@@ -182,26 +221,20 @@ namespace Gadgetron{
       	throw std::runtime_error( "Error: cgSolver::compute_rhs : encoding operator has not set domain dimension" );
       }
 
-      // Create result array and clear
+      // Create result array
       //
 
       boost::shared_ptr<ARRAY_TYPE> result = boost::shared_ptr<ARRAY_TYPE>(new ARRAY_TYPE(image_dims.get()));
-      clear(result.get());
-    
-      // Create temporary array
-      //
-
-      ARRAY_TYPE tmp(image_dims.get() );
 
       // Compute operator adjoint
       //
 
-      this->encoding_operator_->mult_MH( d, &tmp );
+      this->encoding_operator_->mult_MH( d, result.get() );
     
       // Apply weight
       //
 
-      axpy(ELEMENT_TYPE(this->encoding_operator_->get_weight()), &tmp, result.get() );
+      *result *= ELEMENT_TYPE(this->encoding_operator_->get_weight());
     
       return result;
     }
@@ -225,7 +258,7 @@ namespace Gadgetron{
       	throw std::runtime_error( "Error: cgSolver::initialize : empty or NULL rhs provided" );
       }
     
-      // Result, x
+      // Result, x. It is returned to the caller, so it is never part of the workspace.
       //
 
       x_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(rhs->get_dimensions()) );
@@ -234,8 +267,12 @@ namespace Gadgetron{
       // Initialize r,p,x
       //
 
-      r_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*rhs) );
-      p_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*r_) );
+      prepare_workspace( r_, rhs );
+      prepare_workspace( p_, rhs );
+      prepare_workspace( q_, rhs );
+
+      *r_ = *rhs;
+      *p_ = *r_;
     
       if( !this->get_x0().get() ){ // no starting image provided      
 	clear(x_.get());
@@ -259,15 +296,13 @@ namespace Gadgetron{
 	
         *x_ = *(this->get_x0());
         
-        ARRAY_TYPE mhmX( rhs->get_dimensions());
-
         if( this->output_mode_ >= solver<ARRAY_TYPE,ARRAY_TYPE>::OUTPUT_VERBOSE ) {
           GDEBUG_STREAM("Preparing guess..." << std::endl);
         }
         
-        mult_MH_M( this->get_x0().get(), &mhmX );
+        mult_MH_M( this->get_x0().get(), q_.get() );
         
-        *r_ -= mhmX;
+        *r_ -= *q_;
         *p_ = *r_;
         
         // Apply preconditioning, twice (should change preconditioners to do this)
@@ -280,6 +315,9 @@ namespace Gadgetron{
       }
       
       rq_ = real( dot( r_.get(), p_.get() ));
+
+      if( pipelined_ )
+        initialize_pipelined();
       
       // Invoke termination callback initialization
       //
@@ -292,9 +330,35 @@ namespace Gadgetron{
 
     virtual void deinitialize()
     {
-      p_.reset();
-      r_.reset();
       x_.reset();
+      if( !reuse_workspace_ )
+        release_workspace();
+    }
+
+    // Set up u = M*r, w = A*u and the step length for the first pipelined iteration.
+    // p already holds M*r, and with beta zero the first update sets p = u and s = w.
+    //
+
+    virtual void initialize_pipelined()
+    {
+      if( precond_.get() ){
+        if( u_ == r_ ) u_.reset();
+        prepare_workspace( u_, r_.get() );
+        *u_ = *p_;
+      }
+      else
+        u_ = r_;
+
+      prepare_workspace( w_, r_.get() );
+      prepare_workspace( s_, r_.get() );
+      clear(s_.get());
+
+      mult_MH_M( u_.get(), w_.get() );
+
+      std::pair<REAL,REAL> dots = pipelined_cg_dots( r_.get(), u_.get(), w_.get() );
+      rq_ = dots.first;
+      alpha_ = ELEMENT_TYPE( dots.first/dots.second );
+      beta_ = REAL(0);
     }
 
     // Perform full cg iteration
@@ -302,42 +366,39 @@ namespace Gadgetron{
 
     virtual void iterate( unsigned int iteration, REAL *tc_metric, bool *tc_terminate )
     {
-      ARRAY_TYPE q = ARRAY_TYPE(x_->get_dimensions());
+      ARRAY_TYPE *q = q_.get();
 
       // Perform one iteration of the solver
       //
 
-      mult_MH_M( p_.get(), &q );
+      mult_MH_M( p_.get(), q );
     
       // Update solution
       //
 
-      alpha_ = rq_/dot( p_.get(), &q );
-      axpy( alpha_, p_.get(), x_.get());
+      alpha_ = rq_/dot( p_.get(), q );
 
-      // Update residual
+      // Update solution and residual.
+      // Without preconditioning the new residual norm is computed in the same pass.
       //
 
-      axpy( -alpha_, &q, r_.get());
+      REAL tmp_rq = cg_update( alpha_, p_.get(), q, x_.get(), r_.get(), !precond_.get() );
 
       // Apply preconditioning
       //
 
       if( precond_.get() ){
 
-        precond_->apply( r_.get(), &q );
-        precond_->apply( &q, &q );
+        precond_->apply( r_.get(), q );
+        precond_->apply( q, q );
         
-        REAL tmp_rq = real(dot( r_.get(), &q ));      
-        *p_ *= ELEMENT_TYPE((tmp_rq/rq_));
-        axpy( ELEMENT_TYPE(1), &q, p_.get() );
+        tmp_rq = real(dot( r_.get(), q ));      
+        axpby( ELEMENT_TYPE(1), q, ELEMENT_TYPE((tmp_rq/rq_)), p_.get() );
         rq_ = tmp_rq;
       } 
       else{
         
-        REAL tmp_rq = real(dot( r_.get(), r_.get()) );
-        *p_ *= ELEMENT_TYPE((tmp_rq/rq_));           
-        axpy( ELEMENT_TYPE(1), r_.get(), p_.get() );
+        axpby( ELEMENT_TYPE(1), r_.get(), ELEMENT_TYPE((tmp_rq/rq_)), p_.get() );
         rq_ = tmp_rq;      
       }
       
@@ -348,6 +409,54 @@ namespace Gadgetron{
         throw std::runtime_error( "Error: cgSolver::iterate : termination callback iteration failed" );
       }    
     }
+
+    // Perform one iteration of the pipelined (Chronopoulos-Gear) conjugate gradient method.
+    // s tracks A*p and w = A*u, so both inner products are available after a single operator application.
+    //
+
+    virtual void iterate_pipelined( unsigned int iteration, REAL *tc_metric, bool *tc_terminate )
+    {
+      // p = u + beta*p, s = w + beta*s, x += alpha*p, r -= alpha*s
+      //
+
+      pipelined_cg_update( alpha_, ELEMENT_TYPE(beta_), u_.get(), w_.get(), p_.get(), s_.get(), x_.get(), r_.get() );
+
+      // u = M*r and w = A*u
+      //
+
+      if( precond_.get() ){
+        precond_->apply( r_.get(), u_.get() );
+        precond_->apply( u_.get(), u_.get() );
+      }
+
+      mult_MH_M( u_.get(), w_.get() );
+
+      // Step lengths for the next iteration
+      //
+
+      std::pair<REAL,REAL> dots = pipelined_cg_dots( r_.get(), u_.get(), w_.get() );
+      REAL gamma = dots.first, delta = dots.second;
+
+      beta_ = gamma/rq_;
+      alpha_ = ELEMENT_TYPE( gamma/(delta - beta_*gamma/real(alpha_)) );
+      rq_ = gamma;
+
+      // Invoke termination callback iteration
+      //
+
+      if( !cb_->iterate( iteration, tc_metric, tc_terminate ) ){
+        throw std::runtime_error( "Error: cgSolver::iterate_pipelined : termination callback iteration failed" );
+      }
+    }
+
+    // Allocate a workspace array with the dimensions of like, unless a reusable one is already there
+    //
+
+    void prepare_workspace( boost::shared_ptr<ARRAY_TYPE> &array, ARRAY_TYPE *like )
+    {
+      if( !reuse_workspace_ || !array.get() || !array->dimensions_equal( like ) )
+        array = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(like->get_dimensions()) );
+    }
     
     // Perform mult_MH_M of the encoding and regularization matrices
     //
@@ -365,27 +474,22 @@ namespace Gadgetron{
         throw std::runtime_error( "Error: cgSolver::mult_MH_M : array dimensionality mismatch" );
       }
     
-      // Intermediate storage
+      // Apply encoding operator directly into the output
       //
 
-      ARRAY_TYPE q = ARRAY_TYPE(in->get_dimensions());
-
-      // Start by clearing the output
-      //
-      clear(out);
+      this->encoding_operator_->mult_MH_M( in, out, false );
+      if( this->encoding_operator_->get_weight() != REAL(1) )
+        *out *= ELEMENT_TYPE(this->encoding_operator_->get_weight());
 
-      // Apply encoding operator
+      // Iterate over regularization operators, using intermediate storage
       //
 
-      this->encoding_operator_->mult_MH_M( in, &q, false );
-      axpy( ELEMENT_TYPE (this->encoding_operator_->get_weight()), &q, out );
-
-      // Iterate over regularization operators
-      //
+      if( this->regularization_operators_.size() > 0 )
+        prepare_workspace( tmp_, in );
 
       for( unsigned int i=0; i<this->regularization_operators_.size(); i++ ){      
-        this->regularization_operators_[i]->mult_MH_M( in, &q, false );
-        axpy( ELEMENT_TYPE(this->regularization_operators_[i]->get_weight()), &q, out );
+        this->regularization_operators_[i]->mult_MH_M( in, tmp_.get(), false );
+        axpy( ELEMENT_TYPE(this->regularization_operators_[i]->get_weight()), tmp_.get(), out );
       }      
     }
     
@@ -403,10 +507,18 @@ namespace Gadgetron{
     // Maximum number of iterations
     unsigned int iterations_;
 
+    // Workspace reuse and iteration variant
+    bool reuse_workspace_;
+    bool pipelined_;
+
     // Internal variables. 
     REAL rq_;
     REAL rq0_;
+    REAL beta_;
     ELEMENT_TYPE alpha_;
     boost::shared_ptr<ARRAY_TYPE> x_, p_, r_;
+
+    // Workspace: q = A*p and intermediate operator results, and s = A*p, u = M*r, w = A*u of the pipelined variant
+    boost::shared_ptr<ARRAY_TYPE> q_, tmp_, s_, u_, w_;
   };
 }
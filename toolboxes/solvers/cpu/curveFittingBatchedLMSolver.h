@@ -0,0 +1,363 @@
+/** \file       curveFittingBatchedLMSolver.h
+    \brief      Levenberg-Marquardt solver fitting a batch of small curve fitting problems at once.
+
+                All problems share the sampling points x and have their own measurements y and parameters b.
+                They are stored in structure-of-arrays layout with the problem (lane) index running fastest,
+                so the signal model, the normal equations and the parameter updates are computed across the
+                lanes in simd loops, without per problem allocations or virtual calls.
+
+                The signal model is a struct with the number of parameters as num_of_paras and an inline
+                static evaluate(x, b, y, grad) computing the signal and its gradient at one point, see e.g.
+                twoParaExpRecoveryModel in twoParaExpRecoveryOperator.h.
+
+    \author     Hui Xue
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+namespace Gadgetron {
+
+template <typename T, typename Model>
+class curveFittingBatchedLMSolver
+{
+public:
+
+    typedef curveFittingBatchedLMSolver<T, Model> Self;
+
+    /// number of parameters of the signal model
+    static const size_t N = Model::num_of_paras;
+
+    curveFittingBatchedLMSolver();
+    virtual ~curveFittingBatchedLMSolver();
+
+    /// x: sampling points, [num]
+    /// y: measurements, [lanes num]
+    /// b: initial guess on input and fitted parameters on output, [lanes N]
+    void solve(const T* x, size_t num, const T* y, size_t lanes, T* b);
+
+    /// standard deviation of the fitted parameters b, [lanes N]
+    /// estimated as CmrParametricMapping::compute_sd_impl does, from the robust deviation of the residuals and the inverse of J'J
+    /// lanes whose deviation is too small or whose J'J is singular get 0
+    void compute_sd(const T* x, size_t num, const T* y, size_t lanes, const T* b, T* sd);
+
+    /// maximal number of iterations
+    size_t max_iter_;
+    /// a lane is converged once an accepted step reduces its cost by less than this fraction
+    T thres_fun_;
+    /// initial damping factor, relative to the diagonal of J'J
+    T lambda_;
+
+protected:
+
+    /// allocate the workspace for a batch
+    void prepare(size_t num, size_t lanes);
+
+    /// cost, J'J and J'r at b, for the lanes with update_[lane] set
+    void normal_equations(const T* x, size_t num, const T* y, size_t lanes, const T* b);
+
+    /// cost at b, for the lanes with active_[lane] set
+    void compute_cost(const T* x, size_t num, const T* y, size_t lanes, const T* b, T* cost);
+
+    /// solve A d = r for a symmetric positive definite A, [N N], with the Cholesky decomposition
+    /// return false if A is not positive definite
+    static inline bool cholesky_solve(T* A, const T* r, T* d);
+
+    /// workspace, all [lanes ...]
+    std::vector<T> JtJ_;
+    std::vector<T> Jtr_;
+    std::vector<T> cost_;
+    std::vector<T> cost_trial_;
+    std::vector<T> b_trial_;
+    std::vector<T> lambda_lane_;
+    std::vector<T> res_;
+    std::vector<unsigned char> active_;
+    std::vector<unsigned char> update_;
+};
+
+template <typename T, typename Model>
+curveFittingBatchedLMSolver<T, Model>::curveFittingBatchedLMSolver() : max_iter_(150), thres_fun_(1e-4), lambda_(1e-3)
+{
+}
+
+template <typename T, typename Model>
+curveFittingBatchedLMSolver<T, Model>::~curveFittingBatchedLMSolver()
+{
+}
+
+template <typename T, typename Model>
+void curveFittingBatchedLMSolver<T, Model>::prepare(size_t num, size_t lanes)
+{
+    JtJ_.resize(N*N*lanes);
+    Jtr_.resize(N*lanes);
+    cost_.resize(lanes);
+    cost_trial_.resize(lanes);
+    b_trial_.resize(N*lanes);
+    lambda_lane_.resize(lanes);
+    res_.resize(num);
+    active_.resize(lanes);
+    update_.resize(lanes);
+}
+
+template <typename T, typename Model>
+inline bool curveFittingBatchedLMSolver<T, Model>::cholesky_solve(T* A, const T* r, T* d)
+{
+    size_t i, j, k;
+
+    // A = L L', L stored in the lower triangle of A
+    for (j = 0; j < N; j++)
+    {
+        T v = A[j*N + j];
+        for (k = 0; k < j; k++) v -= A[j*N + k] * A[j*N + k];
+        if (!(v > 0)) return false;
+
+        v = std::sqrt(v);
+        A[j*N + j] = v;
+
+        for (i = j + 1; i < N; i++)
+        {
+            T w = A[i*N + j];
+            for (k = 0; k < j; k++) w -= A[i*N + k] * A[j*N + k];
+            A[i*N + j] = w / v;
+        }
+    }
+
+    // L z = r, L' d = z
+    for (i = 0; i < N; i++)
+    {
+        T v = r[i];
+        for (k = 0; k < i; k++) v -= A[i*N + k] * d[k];
+        d[i] = v / A[i*N + i];
+    }
+
+    for (i = N; i-- > 0; )
+    {
+        T v = d[i];
+        for (k = i + 1; k < N; k++) v -= A[k*N + i] * d[k];
+        d[i] = v / A[i*N + i];
+    }
+
+    return true;
+}
+
+template <typename T, typename Model>
+void curveFittingBatchedLMSolver<T, Model>::normal_equations(const T* x, size_t num, const T* y, size_t lanes, const T* b)
+{
+    T* pJtJ = &JtJ_[0];
+    T* pJtr = &Jtr_[0];
+    T* pCost = &cost_[0];
+    const unsigned char* pUpdate = &update_[0];
+
+    size_t l, n, p, q;
+
+    for (l = 0; l < lanes; l++)
+    {
+        if (!pUpdate[l]) continue;
+
+        pCost[l] = 0;
+        for (p = 0; p < N; p++) pJtr[p*lanes + l] = 0;
+        for (p = 0; p < N*N; p++) pJtJ[p*lanes + l] = 0;
+    }
+
+    for (n = 0; n < num; n++)
+    {
+        const T xn = x[n];
+        const T* yn = y + n*lanes;
+
+#pragma omp simd private(p, q)
+        for (l = 0; l < lanes; l++)
+        {
+            if (!pUpdate[l]) continue;
+
+            T bl[N], grad[N], v;
+            for (p = 0; p < N; p++) bl[p] = b[p*lanes + l];
+
+            Model::evaluate(xn, bl, v, grad);
+
+            T r = v - yn[l];
+            pCost[l] += r*r;
+
+            for (p = 0; p < N; p++)
+            {
+                pJtr[p*lanes + l] += grad[p] * r;
+                for (q = 0; q <= p; q++) pJtJ[(p*N + q)*lanes + l] += grad[p] * grad[q];
+            }
+        }
+    }
+}
+
+template <typename T, typename Model>
+void curveFittingBatchedLMSolver<T, Model>::compute_cost(const T* x, size_t num, const T* y, size_t lanes, const T* b, T* cost)
+{
+    const unsigned char* pActive = &active_[0];
+
+    size_t l, n, p;
+
+    for (l = 0; l < lanes; l++) cost[l] = 0;
+
+    for (n = 0; n < num; n++)
+    {
+        const T xn = x[n];
+        const T* yn = y + n*lanes;
+
+#pragma omp simd private(p)
+        for (l = 0; l < lanes; l++)
+        {
+            if (!pActive[l]) continue;
+
+            T bl[N], grad[N], v;
+            for (p = 0; p < N; p++) bl[p] = b[p*lanes + l];
+
+            Model::evaluate(xn, bl, v, grad);
+
+            T r = v - yn[l];
+            cost[l] += r*r;
+        }
+    }
+}
+
+template <typename T, typename Model>
+void curveFittingBatchedLMSolver<T, Model>::solve(const T* x, size_t num, const T* y, size_t lanes, T* b)
+{
+    if (lanes == 0) return;
+
+    this->prepare(num, lanes);
+
+    size_t l, p, q, iter;
+
+    std::fill(active_.begin(), active_.end(), 1);
+    std::fill(update_.begin(), update_.end(), 1);
+    std::fill(lambda_lane_.begin(), lambda_lane_.end(), lambda_);
+
+    this->normal_equations(x, num, y, lanes, b);
+
+    for (iter = 0; iter < max_iter_; iter++)
+    {
+        // damped Gauss-Newton step for every active lane
+        for (l = 0; l < lanes; l++)
+        {
+            for (p = 0; p < N; p++) b_trial_[p*lanes + l] = b[p*lanes + l];
+            if (!active_[l]) continue;
+
+            T A[N*N], r[N], d[N];
+            for (p = 0; p < N; p++)
+            {
+                for (q = 0; q <= p; q++) A[p*N + q] = JtJ_[(p*N + q)*lanes + l];
+                A[p*N + p] *= (1 + lambda_lane_[l]);
+                r[p] = -Jtr_[p*lanes + l];
+            }
+
+            if (cholesky_solve(A, r, d))
+            {
+                for (p = 0; p < N; p++) b_trial_[p*lanes + l] += d[p];
+            }
+        }
+
+        this->compute_cost(x, num, y, lanes, &b_trial_[0], &cost_trial_[0]);
+
+        // accept the steps reducing the cost, otherwise increase the damping
+        bool any_active = false;
+        for (l = 0; l < lanes; l++)
+        {
+            update_[l] = 0;
+            if (!active_[l]) continue;
+
+            if (cost_trial_[l] < cost_[l])
+            {
+                bool converged = (cost_[l] - cost_trial_[l] <= thres_fun_ * cost_[l]);
+
+                for (p = 0; p < N; p++) b[p*lanes + l] = b_trial_[p*lanes + l];
+                lambda_lane_[l] = std::max(lambda_lane_[l] * (T)0.1, (T)1e-12);
+
+                if (converged)
+                {
+                    active_[l] = 0;
+                }
+                else
+                {
+                    update_[l] = 1;
+                }
+            }
+            else
+            {
+                lambda_lane_[l] *= 10;
+                if (lambda_lane_[l] > (T)1e10) active_[l] = 0;
+            }
+
+            any_active = any_active || active_[l];
+        }
+
+        if (!any_active) break;
+
+        this->normal_equations(x, num, y, lanes, b);
+    }
+}
+
+template <typename T, typename Model>
+void curveFittingBatchedLMSolver<T, Model>::compute_sd(const T* x, size_t num, const T* y, size_t lanes, const T* b, T* sd)
+{
+    if (lanes == 0) return;
+
+    std::fill(sd, sd + N*lanes, (T)0);
+    if (num < N) return;
+
+    this->prepare(num, lanes);
+
+    std::fill(update_.begin(), update_.end(), 1);
+    this->normal_equations(x, num, y, lanes, b);
+
+    size_t l, n, p, q;
+
+    // rank
+    size_t rank = num - (N - 1);
+
+    for (l = 0; l < lanes; l++)
+    {
+        T bl[N], grad[N], v;
+        for (p = 0; p < N; p++) bl[p] = b[p*lanes + l];
+
+        for (n = 0; n < num; n++)
+        {
+            Model::evaluate(x[n], bl, v, grad);
+            res_[n] = std::abs(v - y[n*lanes + l]);
+        }
+
+        // median of the residuals, leaving out the N-1 smallest
+        std::sort(res_.begin(), res_.end());
+
+        T std;
+        if (rank % 2 == 0)
+        {
+            std = (res_[N - 1 + rank / 2] + res_[N - 1 + rank / 2 - 1]) / 2 / (T)0.6745;
+        }
+        else
+        {
+            std = res_[N - 1 + rank / 2] / (T)0.6745;
+        }
+
+        if (std::abs(std) < FLT_EPSILON) continue;
+
+        // diagonal of the inverse of J'J, one column at a time
+        T A[N*N], e[N], d[N];
+        for (p = 0; p < N; p++)
+        {
+            for (q = 0; q < N*N; q++) A[q] = JtJ_[q*lanes + l];
+            for (q = 0; q < N; q++) e[q] = (q == p) ? 1 : 0;
+
+            if (!cholesky_solve(A, e, d) || !(d[p] > 0))
+            {
+                for (q = 0; q < N; q++) sd[q*lanes + l] = 0;
+                break;
+            }
+
+            sd[p*lanes + l] = std * std::sqrt(d[p]);
+        }
+    }
+}
+
+}
@@ -10,6 +10,7 @@
 
 #include "cgSolver.h"
 #include "hoNDArray_math.h"
+#include "hoSolverUtils.h"
 
 namespace Gadgetron{
 
@@ -18,11 +19,13 @@ namespace Gadgetron{
       
       The class hoCgSolver is a convienience wrapper for the device independent cgSolver class.
       hoCgSolver instantiates the cgSolver for type hoNDArray<T>.
+      The workspace is kept between solves, as the solver is typically called repeatedly on arrays of the same size,
+      and the vector updates use the fused single pass versions of hoSolverUtils.h.
   */
   template <class T> class hoCgSolver : public cgSolver< hoNDArray<T> >
   {
   public:
-    hoCgSolver() : cgSolver<hoNDArray<T> >() {}
+    hoCgSolver() : cgSolver<hoNDArray<T> >() { this->reuse_workspace_ = true; }
     virtual ~hoCgSolver() {}
   };
 }
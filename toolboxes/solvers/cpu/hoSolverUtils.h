@@ -2,8 +2,11 @@
 
 #include "hoNDArray.h"
 #include "hoNDArray_math.h"
+#include "hoNDArray_expressions.h"
 #include "complext.h"
 
+#include <utility>
+
 #ifdef USE_OMP
 #include <omp.h>
 #endif
@@ -53,5 +56,95 @@ template<class T> void updateFgroup(std::vector<hoNDArray<T> >& datas, typename
 
     }
 }
+
+// Fused versions of the solver updates in solverUpdates.h, each computed in a single pass over the arrays.
+
+template<class T> void axpby(T a, hoNDArray<T> *x, T b, hoNDArray<T> *y)
+{
+  using namespace Expressions;
+  evaluate(a * lazy(*x) + b * lazy(*y), *y);
+}
+
+template<class T> typename realType<T>::Type
+cg_update(T alpha, hoNDArray<T> *p, hoNDArray<T> *q, hoNDArray<T> *x, hoNDArray<T> *r, bool residual_norm)
+{
+  using namespace Expressions;
+  using REAL = typename realType<T>::Type;
+
+  evaluate(lazy(*x) + alpha * lazy(*p), *x);
+  if (!residual_norm) {
+    evaluate(lazy(*r) - alpha * lazy(*q), *r);
+    return REAL(0);
+  }
+  return REAL(evaluate_abs_square_sum(lazy(*r) - alpha * lazy(*q), *r));
+}
+
+template<class T> void add_abs_square(hoNDArray<T> *x, hoNDArray<typename realType<T>::Type> *acc, bool first)
+{
+  using namespace Expressions;
+  if (first)
+    evaluate(abs_square(lazy(*x)), *acc);
+  else
+    evaluate(lazy(*acc) + abs_square(lazy(*x)), *acc);
 }
 
+template<class T> void pipelined_cg_update(T alpha, T beta, hoNDArray<T> *u, hoNDArray<T> *w, hoNDArray<T> *p,
+                                           hoNDArray<T> *s, hoNDArray<T> *x, hoNDArray<T> *r)
+{
+  using namespace Expressions;
+  using V = detail::compute_type_t<T>;
+
+  const long long N = (long long)x->get_number_of_elements();
+  const V a = V(alpha), b = V(beta);
+  const V* pu = reinterpret_cast<const V*>(u->get_data_ptr());
+  const V* pw = reinterpret_cast<const V*>(w->get_data_ptr());
+  V* pp = reinterpret_cast<V*>(p->get_data_ptr());
+  V* ps = reinterpret_cast<V*>(s->get_data_ptr());
+  V* px = reinterpret_cast<V*>(x->get_data_ptr());
+  V* pr = reinterpret_cast<V*>(r->get_data_ptr());
+
+  // u may be r itself, so it is read before r is written.
+  long long n;
+#pragma omp parallel for private(n) if (N > (long long)detail::parallel_threshold)
+  for (n = 0; n < N; n++) {
+    V pn = pu[n] + b * pp[n];
+    V sn = pw[n] + b * ps[n];
+    pp[n] = pn;
+    ps[n] = sn;
+    px[n] += a * pn;
+    pr[n] -= a * sn;
+  }
+}
+
+template<class T> std::pair<typename realType<T>::Type, typename realType<T>::Type>
+pipelined_cg_dots(hoNDArray<T> *r, hoNDArray<T> *u, hoNDArray<T> *w)
+{
+  using namespace Expressions;
+  using V = detail::compute_type_t<T>;
+  using REAL = typename realType<T>::Type;
+  using A = detail::accumulation_type_t<REAL>;
+
+  const long long N = (long long)u->get_number_of_elements();
+  const V* pr = reinterpret_cast<const V*>(r->get_data_ptr());
+  const V* pu = reinterpret_cast<const V*>(u->get_data_ptr());
+  const V* pw = reinterpret_cast<const V*>(w->get_data_ptr());
+
+  // Real parts of conj(r)*u and conj(w)*u, which are all the pipelined recurrence needs.
+  A ru = 0, wu = 0;
+  long long n;
+#pragma omp parallel for private(n) reduction(+:ru,wu) if (N > (long long)detail::parallel_threshold)
+  for (n = 0; n < N; n++) {
+    if constexpr (detail::is_complex<V>::value) {
+      ru += A(pr[n].real()) * pu[n].real() + A(pr[n].imag()) * pu[n].imag();
+      wu += A(pw[n].real()) * pu[n].real() + A(pw[n].imag()) * pu[n].imag();
+    } else {
+      ru += A(pr[n]) * pu[n];
+      wu += A(pw[n]) * pu[n];
+    }
+  }
+
+  return { REAL(ru), REAL(wu) };
+}
+}
+
+
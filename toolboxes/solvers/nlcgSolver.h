@@ -5,6 +5,7 @@
 #include "real_utilities.h"
 #include "complext.h"
 #include "cgPreconditioner.h"
+#include "solverUpdates.h"
 
 #include <vector>
 #include <iostream>
@@ -168,11 +169,9 @@ public:
 				REAL betaHS = real(dot(&g_step,&g_old))/real(dot(&d,&g_old));
 				REAL beta = std::max(REAL(0),std::min(betaDy,betaHS)); //Hybrid step size from Dai and Yuan 2001
 
-				d *= beta;
-
 				if (this->precond_.get()) this->precond_->apply(&g_step,&g_step); //Perform the rest of the preconditioning
 
-				d -= g_step;
+				axpby(ELEMENT_TYPE(-1),&g_step,ELEMENT_TYPE(beta),&d);
 				GDEBUG_STREAM("Beta " << beta << std::endl);
 			}
 
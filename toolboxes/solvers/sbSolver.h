@@ -10,6 +10,7 @@
 #include "vector_td_utilities.h"
 #include "encodingOperatorContainer.h"
 #include "identityOperator.h"
+#include "solverUpdates.h"
 
 #include <vector>
 #include <iostream>
@@ -197,7 +198,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,&tmp[i],true);
 				if (this->prior.get())
 					tmp[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square<ELEMENT_TYPE>(&tmp[i]) : s_k += *abs_square<ELEMENT_TYPE>(&tmp[i]);
+				add_abs_square( &tmp[i], &s_k, i==0 );
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -213,7 +214,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,b_ks[i].get(),true);
 				if (this->prior.get())
 					*b_ks[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square(b_ks[i].get()) : s_k += *abs_square(b_ks[i].get());
+				add_abs_square( b_ks[i].get(), &s_k, i==0 );
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -297,7 +298,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,&tmp[i],true);
 				if (this->prior.get())
 					tmp[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square<ELEMENT_TYPE>(&tmp[i]) : s_k += *abs_square<ELEMENT_TYPE>(&tmp[i]);
+				add_abs_square( &tmp[i], &s_k, i==0 );
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -313,7 +314,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,b_ks[i].get(),true);
 				if (this->prior.get())
 					*b_ks[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square(b_ks[i].get()) : s_k += *abs_square(b_ks[i].get());
+				add_abs_square( b_ks[i].get(), &s_k, i==0 );
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -346,10 +347,12 @@ protected:
 		{
 			*this->d_k = *this->b_k;
 			this->reg_op->mult_M(u_k,this->d_k.get(),true);
+			ELEMENT_TYPE scale = ELEMENT_TYPE(REAL(1)/(1+this->reg_op->get_weight()));
 			if (this->prior.get()){
-				*this->d_k -= *this->p_M;
+				axpby(-scale, this->p_M.get(), scale, this->d_k.get());
 			}
-			*(this->d_k) *= REAL(1)/(1+this->reg_op->get_weight());
+			else
+				*(this->d_k) *= scale;
 		}
 
 		virtual void update_dk_bk(ARRAY_TYPE_ELEMENT* u_k){
@@ -0,0 +1,60 @@
+/** \file solverUpdates.h
+    \brief Vector updates shared by the iterative solvers.
+
+    The generic versions here are built from the array operators every array type provides.
+    Array types with a faster fused implementation overload them; the overload is picked up by
+    argument dependent lookup when the solver is instantiated (see hoSolverUtils.h for hoNDArray).
+*/
+
+#pragma once
+
+#include "complext.h"
+
+#include <utility>
+
+namespace Gadgetron {
+
+  /// y = a*x + b*y
+  template<class ARRAY_TYPE, class T> void axpby( T a, ARRAY_TYPE *x, T b, ARRAY_TYPE *y )
+  {
+    *y *= b;
+    axpy( a, x, y );
+  }
+
+  /// x += alpha*p and r -= alpha*q, the solution and residual update of the conjugate gradient method.
+  /// Returns the squared norm of the updated residual if residual_norm is set, otherwise zero.
+  template<class ARRAY_TYPE, class T> typename realType<T>::Type
+  cg_update( T alpha, ARRAY_TYPE *p, ARRAY_TYPE *q, ARRAY_TYPE *x, ARRAY_TYPE *r, bool residual_norm )
+  {
+    axpy( alpha, p, x );
+    axpy( -alpha, q, r );
+    return residual_norm ? real(dot( r, r )) : typename realType<T>::Type(0);
+  }
+
+  /// acc = |x|^2 if first is set, otherwise acc += |x|^2
+  template<class REAL_ARRAY_TYPE, class ARRAY_TYPE> void add_abs_square( ARRAY_TYPE *x, REAL_ARRAY_TYPE *acc, bool first )
+  {
+    if( first )
+      *acc = *abs_square(x);
+    else
+      *acc += *abs_square(x);
+  }
+
+  /// p = u + beta*p, s = w + beta*s, x += alpha*p and r -= alpha*s, the update of the pipelined conjugate gradient method.
+  /// u may be the same array as r.
+  template<class ARRAY_TYPE, class T> void
+  pipelined_cg_update( T alpha, T beta, ARRAY_TYPE *u, ARRAY_TYPE *w, ARRAY_TYPE *p, ARRAY_TYPE *s, ARRAY_TYPE *x, ARRAY_TYPE *r )
+  {
+    axpby( T(1), u, beta, p );
+    axpby( T(1), w, beta, s );
+    axpy( alpha, p, x );
+    axpy( -alpha, s, r );
+  }
+
+  /// The real parts of dot(r,u) and dot(w,u), the two inner products of an iteration of the pipelined conjugate gradient method.
+  template<class ARRAY_TYPE> std::pair<typename realType<typename ARRAY_TYPE::element_type>::Type, typename realType<typename ARRAY_TYPE::element_type>::Type>
+  pipelined_cg_dots( ARRAY_TYPE *r, ARRAY_TYPE *u, ARRAY_TYPE *w )
+  {
+    return { real(dot( r, u )), real(dot( w, u )) };
+  }
+}